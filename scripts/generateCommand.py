@@ -135,6 +135,7 @@ std::unique_ptr<Reply> {{CommandNameHdl}}::execute() {
 r'''{{ReturnType}} IOSessionProxy::{{InterfaceMethod}}({{RequestArgumentList}}) const {
 {{CommandNameCmd}}::RequestParams params({{RequestArguments}});
 {{CommandNameRequest}} request(params, IDGenerator::nextID(), m_remoteSid);
+std::lock_guard<std::mutex> lock(m_channelMutex);
 auto reply = sendRequestChecked(m_inputChannel, request);
 return reply->getParams().getResult();
 }
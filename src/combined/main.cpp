@@ -12,6 +12,7 @@
 #include "mocca/net/ConnectionFactorySelector.h"
 #include "mocca/net/Endpoint.h"
 
+#include "common/HostBrickCache.h"
 #include "io-base/FractalListData.h"
 #include "io-base/IONode.h"
 #include "io-base/UVFListData.h"
@@ -82,6 +83,22 @@ mocca::CommandLineParser::Option ProcWsPortOption(int16_t& port) {
     return option;
 }
 
+mocca::CommandLineParser::Option BrickCacheSizeOption(uint64_t& megabytes) {
+    mocca::CommandLineParser::Option option;
+    option.key = "--BrickCacheMB";
+    option.help = "host memory for bricks received from IO nodes in MB, shared by all datasets, 0 disables the cache (default: 1024)";
+    option.callback = [&](const std::string& value) { megabytes = std::stoull(value); };
+    return option;
+}
+
+mocca::CommandLineParser::Option BrickCacheLz4Option(bool& compress) {
+    mocca::CommandLineParser::Option option;
+    option.key = "--BrickCacheLz4";
+    option.help = "LZ4 compress the bricks in the host memory cache, 0 or 1 (default: 0)";
+    option.callback = [&](const std::string& value) { compress = std::stoi(value) != 0; };
+    return option;
+}
+
 int main(int argc, const char** argv) {
     init();
 
@@ -89,6 +106,8 @@ int main(int argc, const char** argv) {
     int16_t ioWsPort = 6679;
     int16_t procTcpPort = 8678;
     int16_t procWsPort = 8679;
+    uint64_t brickCacheMB = HostBrickCache::defaultBudget >> 20;
+    bool brickCacheLz4 = false;
 
     mocca::CommandLineParser parser;
     std::string uvfDataPath = ".";
@@ -97,6 +116,8 @@ int main(int argc, const char** argv) {
     parser.addOption(IoWsPortOption(ioWsPort));
     parser.addOption(ProcTcpPortOption(procTcpPort));
     parser.addOption(ProcWsPortOption(procWsPort));
+    parser.addOption(BrickCacheSizeOption(brickCacheMB));
+    parser.addOption(BrickCacheLz4Option(brickCacheLz4));
 
 
     try {
@@ -105,6 +126,7 @@ int main(int argc, const char** argv) {
         std::cerr << err.what() << std::endl;
         std::exit(0);
     }
+    HostBrickCache::setDefaults(brickCacheMB << 20, brickCacheLz4);
 
     Endpoint ioTCPEp(ConnectionFactorySelector::tcpPrefixed(), "localhost", std::to_string(ioTcpPort));
     Endpoint ioWSEp(ConnectionFactorySelector::tcpWebSocket(), "localhost", std::to_string(ioWsPort));
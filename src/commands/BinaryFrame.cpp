@@ -0,0 +1,96 @@
+#include "commands/BinaryFrame.h"
+
+#include "common/MemBlockPool.h"
+#include "common/TrinityError.h"
+
+#include "blosc/blosc/blosc.h"
+#include "lz4/lz4.h"
+#include "lzma/LzmaDec.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+using namespace trinity;
+
+namespace {
+void* allocForLzma(void*, size_t size) {
+    return malloc(size);
+}
+void freeForLzma(void*, void* address) {
+    free(address);
+}
+ISzAlloc allocatorForLzma = {&allocForLzma, &freeForLzma};
+}
+
+void BinaryFrameHeader::write(std::vector<uint8_t>& frame) const {
+    // codec (1 byte), properties (5 bytes), padding (2 bytes), uncompressed size (8 bytes)
+    frame[0] = static_cast<uint8_t>(codec);
+    std::copy(begin(properties), end(properties), frame.begin() + 1);
+    frame[6] = 0;
+    frame[7] = 0;
+    std::memcpy(frame.data() + 8, &uncompressedSize, sizeof(uncompressedSize));
+}
+
+BinaryFrameHeader BinaryFrameHeader::read(const std::vector<uint8_t>& frame) {
+    if (frame.size() < size) {
+        throw TrinityError("Invalid binary frame: too small", __FILE__, __LINE__);
+    }
+    if (frame[0] > static_cast<uint8_t>(BinaryCodec::LZMA)) {
+        throw TrinityError("Invalid binary frame: unknown codec " + std::to_string(frame[0]), __FILE__, __LINE__);
+    }
+    BinaryFrameHeader header;
+    header.codec = static_cast<BinaryCodec>(frame[0]);
+    std::copy(frame.begin() + 1, frame.begin() + 6, begin(header.properties));
+    std::memcpy(&header.uncompressedSize, frame.data() + 8, sizeof(header.uncompressedSize));
+    return header;
+}
+
+std::shared_ptr<std::vector<uint8_t>> trinity::decodeBinaryFrame(const std::vector<uint8_t>& frame, uint64_t maxSize) {
+    const auto header = BinaryFrameHeader::read(frame);
+    const uint8_t* payload = frame.data() + BinaryFrameHeader::size;
+    const size_t payloadSize = frame.size() - BinaryFrameHeader::size;
+    if (header.uncompressedSize > maxSize) {
+        throw TrinityError("Invalid binary frame: size " + std::to_string(header.uncompressedSize) + " exceeds " +
+                               std::to_string(maxSize),
+                           __FILE__, __LINE__);
+    }
+    if (header.codec == BinaryCodec::None && payloadSize != header.uncompressedSize) {
+        throw TrinityError("Invalid binary frame: payload size " + std::to_string(payloadSize) + " does not match " +
+                               std::to_string(header.uncompressedSize),
+                           __FILE__, __LINE__);
+    }
+
+    auto decoded = MemBlockPool::instance().get(header.uncompressedSize);
+    decoded->resize(header.uncompressedSize);
+    bool valid = false;
+    switch (header.codec) {
+    case BinaryCodec::None:
+        std::memcpy(decoded->data(), payload, payloadSize);
+        valid = true;
+        break;
+    case BinaryCodec::Blosc:
+        valid = blosc_decompress_ctx(payload, decoded->data(), decoded->size(), 5) == static_cast<int>(header.uncompressedSize);
+        break;
+    case BinaryCodec::LZ4:
+        valid = header.uncompressedSize <= uint64_t(std::numeric_limits<int>::max()) &&
+                LZ4_decompress_safe(reinterpret_cast<const char*>(payload), reinterpret_cast<char*>(decoded->data()),
+                                    static_cast<int>(payloadSize), static_cast<int>(decoded->size())) == static_cast<int>(header.uncompressedSize);
+        break;
+    case BinaryCodec::LZMA: {
+        SizeT decodedSize = decoded->size();
+        SizeT sourceSize = payloadSize;
+        ELzmaStatus status;
+        valid = LzmaDecode(decoded->data(), &decodedSize, payload, &sourceSize, header.properties.data(), LZMA_PROPS_SIZE,
+                           LZMA_FINISH_END, &status, &allocatorForLzma) == SZ_OK &&
+                decodedSize == header.uncompressedSize;
+        break;
+    }
+    }
+    if (!valid) {
+        throw TrinityError("Invalid binary frame: decoding failed", __FILE__, __LINE__);
+    }
+    return decoded;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace trinity {
+
+enum class BinaryCodec : uint8_t {
+    None = 0,  // payload is stored as is
+    Blosc = 1, // compressed by the sender
+    LZ4 = 2,   // forwarded as stored by the IO backend
+    LZMA = 3,  // forwarded as stored by the IO backend, properties in the header
+};
+
+// header in front of every binary message part in CompressionMode::Framed; it tells the receiver how to
+// decode the payload, so data that is compressed already (e.g. bricks on disk) can be forwarded untouched
+struct BinaryFrameHeader {
+    static const size_t size = 16;
+    // bound for frames received before the dataset is known, e.g. the brick table of its descriptor; sessions
+    // replace it by the size of the dataset's largest brick (see DatasetDescriptor::getMaxBinaryPartSize)
+    static const uint64_t defaultMaxSize = uint64_t(1) << 28;
+
+    BinaryCodec codec;
+    std::array<uint8_t, 5> properties; // codec specific
+    uint64_t uncompressedSize;
+
+    // writes the header to the first size bytes of frame, which must exist already
+    void write(std::vector<uint8_t>& frame) const;
+    static BinaryFrameHeader read(const std::vector<uint8_t>& frame);
+};
+
+// returns the decoded payload of a frame; the uncompressed size comes from the wire, so frames announcing more than
+// maxSize bytes are rejected before any memory is allocated
+std::shared_ptr<std::vector<uint8_t>> decodeBinaryFrame(const std::vector<uint8_t>& frame, uint64_t maxSize);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace trinity {
+
+// read-only binary data owned by someone else, e.g. a brick inside a memory mapped file; data shares ownership
+// of the owner, so the bytes stay valid as long as the view exists
+struct BinaryView {
+    std::shared_ptr<const uint8_t> data;
+    size_t size;
+
+    explicit operator bool() const { return data != nullptr; }
+};
+}
@@ -6,9 +6,9 @@
 using namespace trinity;
 
 std::vector<std::shared_ptr<std::vector<uint8_t>>> BrickMetaData::createBinary(const std::vector<BrickMetaData>& metaDataVec) {
-    static size_t metaDataSize = 4 * sizeof(double) + 3 * sizeof(uint32_t);
-    static size_t dataPerPart = 1024 * 1024;
-    static size_t binaryPartSize = dataPerPart * metaDataSize;
+    const size_t metaDataSize = binaryEntrySize;
+    const size_t dataPerPart = entriesPerBinaryPart;
+    const size_t binaryPartSize = dataPerPart * metaDataSize;
     size_t numBinaryParts = metaDataVec.size() / dataPerPart + 1;
     
     std::vector<std::shared_ptr<std::vector<uint8_t>>> result;
@@ -37,9 +37,9 @@ std::vector<std::shared_ptr<std::vector<uint8_t>>> BrickMetaData::createBinary(c
 }
 
 std::vector<BrickMetaData> BrickMetaData::createFromBinary(const std::vector<std::shared_ptr<std::vector<uint8_t>>>& binary) {
-    static size_t metaDataSize = 4 * sizeof(double) + 3 * sizeof(uint32_t);
-    static size_t dataPerPart = 1024 * 1024;
-    static size_t binaryPartSize = dataPerPart * metaDataSize;
+    const size_t metaDataSize = binaryEntrySize;
+    const size_t dataPerPart = entriesPerBinaryPart;
+    const size_t binaryPartSize = dataPerPart * metaDataSize;
     size_t numElements = (binary.size() - 1) * dataPerPart + binary.back()->size() / metaDataSize;
 
     std::vector<BrickMetaData> result;
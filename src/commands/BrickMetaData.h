@@ -14,6 +14,10 @@ struct BrickMetaData {
     double maxGradient;
     Core::Math::Vec3ui voxelSize;
 
+    // the binary form stores each entry in binaryEntrySize bytes and splits the entries into parts of entriesPerBinaryPart
+    static const size_t binaryEntrySize = 4 * sizeof(double) + 3 * sizeof(uint32_t);
+    static const size_t entriesPerBinaryPart = 1024 * 1024;
+
     static std::vector<std::shared_ptr<std::vector<uint8_t>>> createBinary(const std::vector<BrickMetaData>& metaDataVec);
     static std::vector<BrickMetaData> createFromBinary(const std::vector<std::shared_ptr<std::vector<uint8_t>>>& binary);
 };
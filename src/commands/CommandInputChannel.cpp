@@ -11,7 +11,8 @@
 using namespace trinity;
 
 CommandInputChannel::CommandInputChannel(const mocca::net::Endpoint& endpoint, CompressionMode compressionMode)
-    : m_endpoint(endpoint), m_compressionMode(compressionMode) {}
+    : m_endpoint(endpoint), m_compressionMode(compressionMode), m_maxBinaryPartSize(BinaryFrameHeader::defaultMaxSize),
+      m_receiving(false) {}
 
 bool CommandInputChannel::connect() const {
     try {
@@ -28,8 +29,10 @@ bool CommandInputChannel::connect() const {
 void CommandInputChannel::sendRequest(const Request& request) const {
     if (!m_mainChannel)
         throw TrinityError("(chn) cannot send command: channel not connected", __FILE__, __LINE__);
+    auto message = Request::createMessage(request, m_compressionMode);
+    std::lock_guard<std::mutex> lock(m_sendMutex);
     try {
-        m_mainChannel->send(Request::createMessage(request, m_compressionMode));
+        m_mainChannel->send(std::move(message));
     } catch (const mocca::net::NetworkError& err) {
         LERROR("(chn) cannot send request: " << err.what());
     }
@@ -39,10 +42,75 @@ mocca::net::Endpoint CommandInputChannel::getEndpoint() const {
     return m_endpoint;
 }
 
-std::unique_ptr<Reply> CommandInputChannel::getReply() const {
-    auto serialReply = m_mainChannel->receive();
-    if (serialReply.empty()) {
-        throw TrinityError("(chn) no reply arrived", __FILE__, __LINE__);
+void CommandInputChannel::setMaxBinaryPartSize(uint64_t maxSize) {
+    m_maxBinaryPartSize = maxSize;
+}
+
+size_t CommandInputChannel::getPendingReplyCount() const {
+    std::lock_guard<std::mutex> lock(m_replyMutex);
+    return m_pendingReplies.size();
+}
+
+namespace {
+template <typename Container> void dropOldest(Container& container, size_t maxSize) {
+    while (container.size() > maxSize) {
+        container.erase(begin(container));
+    }
+}
+}
+
+std::unique_ptr<Reply> CommandInputChannel::getReply(int rid) const {
+    std::unique_lock<std::mutex> lock(m_replyMutex);
+    // asking again for a reply means it is wanted after all
+    m_abandonedRids.erase(rid);
+    while (true) {
+        auto pending = m_pendingReplies.find(rid);
+        if (pending != end(m_pendingReplies)) {
+            auto reply = std::move(pending->second);
+            m_pendingReplies.erase(pending);
+            return reply;
+        }
+        if (m_receiving) {
+            m_replyArrived.wait(lock);
+            continue;
+        }
+
+        // the replies are received and decoded without the lock, so that the other threads can pick up theirs
+        m_receiving = true;
+        lock.unlock();
+        std::unique_ptr<Reply> reply;
+        try {
+            auto serialReply = m_mainChannel->receive();
+            if (!serialReply.empty()) {
+                reply = Reply::createFromMessage(serialReply, m_compressionMode, m_maxBinaryPartSize);
+            }
+        } catch (...) {
+            lock.lock();
+            m_receiving = false;
+            m_replyArrived.notify_all();
+            m_abandonedRids.insert(rid);
+            dropOldest(m_abandonedRids, maxPendingReplies);
+            throw;
+        }
+        lock.lock();
+        m_receiving = false;
+        m_replyArrived.notify_all();
+        if (!reply) {
+            m_abandonedRids.insert(rid);
+            dropOldest(m_abandonedRids, maxPendingReplies);
+            throw TrinityError("(chn) no reply arrived", __FILE__, __LINE__);
+        }
+        if (reply->getRid() == rid) {
+            return reply;
+        }
+        if (m_abandonedRids.erase(reply->getRid()) > 0) {
+            LWARNING("(chn) dropped the late reply to request " << reply->getRid());
+            continue;
+        }
+        m_pendingReplies[reply->getRid()] = std::move(reply);
+        if (m_pendingReplies.size() > maxPendingReplies) {
+            LWARNING("(chn) dropped the reply to request " << begin(m_pendingReplies)->first << " that was never asked for");
+            dropOldest(m_pendingReplies, maxPendingReplies);
+        }
     }
-    return Reply::createFromMessage(serialReply, m_compressionMode);
 }
\ No newline at end of file
@@ -8,6 +8,12 @@
 #include "mocca/net/Endpoint.h"
 #include "mocca/net/IMessageConnection.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+
 namespace trinity {
 class CommandInputChannel {
 
@@ -15,13 +21,35 @@ public:
     CommandInputChannel(const mocca::net::Endpoint& endpoint, CompressionMode compressionMode);
 
     bool connect() const;
+    // sendRequest and getReply may be called by several threads at the same time, so that their requests are
+    // in flight together
     void sendRequest(const Request& request) const;
-    std::unique_ptr<Reply> getReply() const;
+    // returns the reply to the request with the given id; sessions may answer requests out of order, so
+    // replies to other requests that arrive first are kept until they are asked for
+    std::unique_ptr<Reply> getReply(int rid) const;
     mocca::net::Endpoint getEndpoint() const;
+    // bounds the decoded size of each binary part of the replies, see BinaryFrameHeader::defaultMaxSize
+    void setMaxBinaryPartSize(uint64_t maxSize);
+
+    // number of replies that arrived before they were asked for
+    size_t getPendingReplyCount() const;
+
+    // replies that arrived early are kept for at most this many requests; request ids increase, so the
+    // oldest ones are dropped first
+    static const size_t maxPendingReplies = 64;
 
 private:
     mocca::net::Endpoint m_endpoint;
     CompressionMode m_compressionMode;
+    std::atomic<uint64_t> m_maxBinaryPartSize;
     mutable std::unique_ptr<mocca::net::IMessageConnection> m_mainChannel;
+    mutable std::mutex m_sendMutex;
+    // one waiting thread at a time receives replies and hands them to the others
+    mutable std::mutex m_replyMutex;
+    mutable std::condition_variable m_replyArrived;
+    mutable bool m_receiving;
+    mutable std::map<int, std::unique_ptr<Reply>> m_pendingReplies;
+    // requests whose getReply gave up, their replies are dropped when they arrive late
+    mutable std::set<int> m_abandonedRids;
 };
 }
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include "commands/DatasetDescriptor.h"
+
+#include "commands/BrickMetaData.h"
+#include "commands/ISerialReader.h"
+#include "commands/ISerialWriter.h"
+#include "common/TrinityError.h"
+
+#include "mocca/base/ContainerTools.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace trinity;
+
+namespace {
+uint64_t valueSize(IIO::ValueType type) {
+    switch (type) {
+    case IIO::ValueType::T_UINT8:
+    case IIO::ValueType::T_INT8:
+        return 1;
+    case IIO::ValueType::T_UINT16:
+    case IIO::ValueType::T_INT16:
+        return 2;
+    case IIO::ValueType::T_FLOAT:
+    case IIO::ValueType::T_UINT32:
+    case IIO::ValueType::T_INT32:
+        return 4;
+    case IIO::ValueType::T_DOUBLE:
+    case IIO::ValueType::T_UINT64:
+    case IIO::ValueType::T_INT64:
+        return 8;
+    }
+    throw TrinityError("invalid value type", __FILE__, __LINE__);
+}
+}
+
+void ModalityDescriptor::serialize(ISerialWriter& writer) const {
+    writer.appendString("valueType", IIO::valueTypeMapper().getByFirst(valueType));
+    writer.appendString("semantic", IIO::semanticMapper().getByFirst(semantic));
+    writer.appendInt("componentCount", componentCount);
+    writer.appendInt("largestSingleBrickLOD", largestSingleBrickLOD);
+    writer.appendObject("range", range);
+    writer.appendObject("domainScale", domainScale);
+    writer.appendObjectVec("domainSizes", mocca::transformToBasePtrVec<ISerializable>(begin(domainSizes), end(domainSizes)));
+    writer.appendObjectVec("brickLayouts", mocca::transformToBasePtrVec<ISerializable>(begin(brickLayouts), end(brickLayouts)));
+    writer.appendObjectVec("floatBrickLayouts",
+                           mocca::transformToBasePtrVec<ISerializable>(begin(floatBrickLayouts), end(floatBrickLayouts)));
+}
+
+void ModalityDescriptor::deserialize(const ISerialReader& reader) {
+    valueType = IIO::valueTypeMapper().getBySecond(reader.getString("valueType"));
+    semantic = IIO::semanticMapper().getBySecond(reader.getString("semantic"));
+    componentCount = reader.getUInt64("componentCount");
+    largestSingleBrickLOD = reader.getUInt64("largestSingleBrickLOD");
+    range = reader.getSerializable<Core::Math::Vec2f>("range");
+    domainScale = reader.getSerializable<Core::Math::Vec3f>("domainScale");
+    domainSizes = reader.getSerializableVec<Core::Math::Vec3ui64>("domainSizes");
+    brickLayouts = reader.getSerializableVec<Core::Math::Vec3ui>("brickLayouts");
+    floatBrickLayouts = reader.getSerializableVec<Core::Math::Vec3f>("floatBrickLayouts");
+}
+
+bool ModalityDescriptor::equals(const ModalityDescriptor& other) const {
+    return valueType == other.valueType && semantic == other.semantic && componentCount == other.componentCount &&
+           largestSingleBrickLOD == other.largestSingleBrickLOD && range == other.range && domainScale == other.domainScale &&
+           domainSizes == other.domainSizes && brickLayouts == other.brickLayouts && floatBrickLayouts == other.floatBrickLayouts;
+}
+
+DatasetDescriptor DatasetDescriptor::create(const IIO& io) {
+    DatasetDescriptor result;
+    result.m_maxBrickSize = io.getMaxBrickSize();
+    result.m_maxUsedBrickSizes = io.getMaxUsedBrickSizes();
+    result.m_brickOverlapSize = io.getBrickOverlapSize();
+    result.m_numberOfTimesteps = io.getNumberOfTimesteps();
+
+    const uint64_t modalityCount = io.getModalityCount();
+    result.m_modalities.resize(modalityCount);
+    result.m_brickVoxelCounts.resize(modalityCount);
+    result.m_brickExtents.resize(modalityCount);
+    for (uint64_t modality = 0; modality < modalityCount; ++modality) {
+        auto& desc = result.m_modalities[modality];
+        desc.valueType = io.getType(modality);
+        desc.semantic = io.getSemantic(modality);
+        desc.componentCount = io.getComponentCount(modality);
+        desc.largestSingleBrickLOD = io.getLargestSingleBrickLOD(modality);
+        desc.range = io.getRange(modality);
+        desc.domainScale = io.getDomainScale(modality);
+
+        auto& voxelCounts = result.m_brickVoxelCounts[modality];
+        auto& extents = result.m_brickExtents[modality];
+        voxelCounts.reserve(io.getTotalBrickCount(modality));
+        extents.reserve(io.getTotalBrickCount(modality));
+
+        const uint64_t lodCount = io.getLODLevelCount(modality);
+        for (uint64_t lod = 0; lod < lodCount; ++lod) {
+            desc.domainSizes.push_back(io.getDomainSize(lod, modality));
+            desc.brickLayouts.push_back(io.getBrickLayout(lod, modality));
+            desc.floatBrickLayouts.push_back(io.getFloatBrickLayout(lod, modality));
+
+            const uint64_t brickCount = desc.brickLayouts.back().volume();
+            for (uint64_t index = 0; index < brickCount; ++index) {
+                const BrickKey key(modality, 0, lod, index);
+                voxelCounts.push_back(io.getBrickVoxelCounts(key));
+                extents.push_back(io.getBrickExtents(key));
+            }
+        }
+    }
+    return result;
+}
+
+void DatasetDescriptor::serialize(ISerialWriter& writer) const {
+    writer.appendObject("maxBrickSize", m_maxBrickSize);
+    writer.appendObject("maxUsedBrickSizes", m_maxUsedBrickSizes);
+    writer.appendObject("brickOverlapSize", m_brickOverlapSize);
+    writer.appendInt("numberOfTimesteps", m_numberOfTimesteps);
+    writer.appendObjectVec("modalities", mocca::transformToBasePtrVec<ISerializable>(begin(m_modalities), end(m_modalities)));
+
+    // the brick tables can be large, so they are packed into a binary message part
+    static const size_t brickEntrySize = 3 * sizeof(uint32_t) + 3 * sizeof(float);
+    auto binary = std::make_shared<std::vector<uint8_t>>();
+    size_t totalBrickCount = 0;
+    for (const auto& voxelCounts : m_brickVoxelCounts) {
+        totalBrickCount += voxelCounts.size();
+    }
+    binary->reserve(totalBrickCount * brickEntrySize);
+    for (size_t modality = 0; modality < m_modalities.size(); ++modality) {
+        for (size_t i = 0; i < m_brickVoxelCounts[modality].size(); ++i) {
+            const auto& voxelCount = m_brickVoxelCounts[modality][i];
+            const auto& extent = m_brickExtents[modality][i];
+            mocca::net::appendToMessagePart(*binary, voxelCount.x);
+            mocca::net::appendToMessagePart(*binary, voxelCount.y);
+            mocca::net::appendToMessagePart(*binary, voxelCount.z);
+            mocca::net::appendToMessagePart(*binary, extent.x);
+            mocca::net::appendToMessagePart(*binary, extent.y);
+            mocca::net::appendToMessagePart(*binary, extent.z);
+        }
+    }
+    writer.appendBinary(binary);
+}
+
+void DatasetDescriptor::deserialize(const ISerialReader& reader) {
+    m_maxBrickSize = reader.getSerializable<Core::Math::Vec3ui64>("maxBrickSize");
+    m_maxUsedBrickSizes = reader.getSerializable<Core::Math::Vec3ui64>("maxUsedBrickSizes");
+    m_brickOverlapSize = reader.getSerializable<Core::Math::Vec3ui>("brickOverlapSize");
+    m_numberOfTimesteps = reader.getUInt64("numberOfTimesteps");
+    m_modalities = reader.getSerializableVec<ModalityDescriptor>("modalities");
+
+    // the brick table must be the only binary part of the message
+    static const size_t brickEntrySize = 3 * sizeof(uint32_t) + 3 * sizeof(float);
+    const auto binary = reader.getBinary();
+    if (binary.size() != 1) {
+        throw TrinityError("Invalid dataset descriptor: brick table missing", __FILE__, __LINE__);
+    }
+    const uint8_t* ptr = binary[0]->data();
+    const uint8_t* const end = ptr + binary[0]->size();
+
+    m_brickVoxelCounts.assign(m_modalities.size(), std::vector<Core::Math::Vec3ui>());
+    m_brickExtents.assign(m_modalities.size(), std::vector<Core::Math::Vec3f>());
+    for (size_t modality = 0; modality < m_modalities.size(); ++modality) {
+        size_t brickCount = 0;
+        for (const auto& layout : m_modalities[modality].brickLayouts) {
+            brickCount += layout.volume();
+        }
+        if (static_cast<size_t>(end - ptr) < brickCount * brickEntrySize) {
+            throw TrinityError("Invalid dataset descriptor: brick table too small", __FILE__, __LINE__);
+        }
+        auto& voxelCounts = m_brickVoxelCounts[modality];
+        auto& extents = m_brickExtents[modality];
+        voxelCounts.resize(brickCount);
+        extents.resize(brickCount);
+        for (size_t i = 0; i < brickCount; ++i) {
+            ptr = mocca::net::readFromMessagePart(ptr, voxelCounts[i].x);
+            ptr = mocca::net::readFromMessagePart(ptr, voxelCounts[i].y);
+            ptr = mocca::net::readFromMessagePart(ptr, voxelCounts[i].z);
+            ptr = mocca::net::readFromMessagePart(ptr, extents[i].x);
+            ptr = mocca::net::readFromMessagePart(ptr, extents[i].y);
+            ptr = mocca::net::readFromMessagePart(ptr, extents[i].z);
+        }
+    }
+}
+
+std::string DatasetDescriptor::toString() const {
+    std::stringstream stream;
+    stream << "maxBrickSize: " << m_maxBrickSize << "; maxUsedBrickSizes: " << m_maxUsedBrickSizes
+           << "; brickOverlapSize: " << m_brickOverlapSize << "; numberOfTimesteps: " << m_numberOfTimesteps
+           << "; modalities: " << m_modalities.size() << " (brick tables as binary data)";
+    return stream.str();
+}
+
+bool DatasetDescriptor::equals(const DatasetDescriptor& other) const {
+    return m_maxBrickSize == other.m_maxBrickSize && m_maxUsedBrickSizes == other.m_maxUsedBrickSizes &&
+           m_brickOverlapSize == other.m_brickOverlapSize && m_numberOfTimesteps == other.m_numberOfTimesteps &&
+           m_modalities == other.m_modalities && m_brickVoxelCounts == other.m_brickVoxelCounts &&
+           m_brickExtents == other.m_brickExtents;
+}
+
+Core::Math::Vec3ui64 DatasetDescriptor::getMaxBrickSize() const {
+    return m_maxBrickSize;
+}
+
+Core::Math::Vec3ui64 DatasetDescriptor::getMaxUsedBrickSizes() const {
+    return m_maxUsedBrickSizes;
+}
+
+Core::Math::Vec3ui DatasetDescriptor::getBrickOverlapSize() const {
+    return m_brickOverlapSize;
+}
+
+uint64_t DatasetDescriptor::getNumberOfTimesteps() const {
+    return m_numberOfTimesteps;
+}
+
+uint64_t DatasetDescriptor::getModalityCount() const {
+    return m_modalities.size();
+}
+
+uint64_t DatasetDescriptor::getLODLevelCount(uint64_t modality) const {
+    return getModality(modality).brickLayouts.size();
+}
+
+uint64_t DatasetDescriptor::getLargestSingleBrickLOD(uint64_t modality) const {
+    return getModality(modality).largestSingleBrickLOD;
+}
+
+uint64_t DatasetDescriptor::getComponentCount(uint64_t modality) const {
+    return getModality(modality).componentCount;
+}
+
+uint64_t DatasetDescriptor::getTotalBrickCount(uint64_t modality) const {
+    getModality(modality);
+    return m_brickVoxelCounts[modality].size();
+}
+
+IIO::ValueType DatasetDescriptor::getType(uint64_t modality) const {
+    return getModality(modality).valueType;
+}
+
+IIO::Semantic DatasetDescriptor::getSemantic(uint64_t modality) const {
+    return getModality(modality).semantic;
+}
+
+Core::Math::Vec2f DatasetDescriptor::getRange(uint64_t modality) const {
+    return getModality(modality).range;
+}
+
+Core::Math::Vec3f DatasetDescriptor::getDomainScale(uint64_t modality) const {
+    return getModality(modality).domainScale;
+}
+
+Core::Math::Vec3ui64 DatasetDescriptor::getDomainSize(uint64_t lod, uint64_t modality) const {
+    checkLOD(lod, modality);
+    return m_modalities[modality].domainSizes[lod];
+}
+
+Core::Math::Vec3ui DatasetDescriptor::getBrickLayout(uint64_t lod, uint64_t modality) const {
+    checkLOD(lod, modality);
+    return m_modalities[modality].brickLayouts[lod];
+}
+
+Core::Math::Vec3f DatasetDescriptor::getFloatBrickLayout(uint64_t lod, uint64_t modality) const {
+    checkLOD(lod, modality);
+    return m_modalities[modality].floatBrickLayouts[lod];
+}
+
+Core::Math::Vec3ui DatasetDescriptor::getBrickVoxelCounts(const BrickKey& key) const {
+    // the index validates the modality, so it has to be computed first
+    const size_t index = getBrickTableIndex(key);
+    return m_brickVoxelCounts[key.modality][index];
+}
+
+Core::Math::Vec3f DatasetDescriptor::getBrickExtents(const BrickKey& key) const {
+    const size_t index = getBrickTableIndex(key);
+    return m_brickExtents[key.modality][index];
+}
+
+uint64_t DatasetDescriptor::getMaxBinaryPartSize() const {
+    uint64_t result = 0;
+    for (size_t modality = 0; modality < m_modalities.size(); ++modality) {
+        const auto& desc = m_modalities[modality];
+        const uint64_t brickSize = m_maxBrickSize.volume() * desc.componentCount * valueSize(desc.valueType);
+        uint64_t metaDataCount = m_brickVoxelCounts[modality].size();
+        if (metaDataCount > BrickMetaData::entriesPerBinaryPart) {
+            metaDataCount = BrickMetaData::entriesPerBinaryPart;
+        }
+        result = std::max(result, std::max(brickSize, metaDataCount * BrickMetaData::binaryEntrySize));
+    }
+    return result;
+}
+
+const ModalityDescriptor& DatasetDescriptor::getModality(uint64_t modality) const {
+    if (modality >= m_modalities.size()) {
+        throw TrinityError("invalid modality", __FILE__, __LINE__);
+    }
+    return m_modalities[modality];
+}
+
+void DatasetDescriptor::checkLOD(uint64_t lod, uint64_t modality) const {
+    if (lod >= getModality(modality).brickLayouts.size()) {
+        throw TrinityError("invalid LOD", __FILE__, __LINE__);
+    }
+}
+
+size_t DatasetDescriptor::getBrickTableIndex(const BrickKey& key) const {
+    checkLOD(key.lod, key.modality);
+    const auto& layouts = m_modalities[key.modality].brickLayouts;
+    size_t offset = 0;
+    for (uint64_t lod = 0; lod < key.lod; ++lod) {
+        offset += layouts[lod].volume();
+    }
+    if (key.index >= layouts[key.lod].volume()) {
+        throw TrinityError("invalid brick index", __FILE__, __LINE__);
+    }
+    return offset + key.index;
+}
+
+namespace trinity {
+bool operator==(const ModalityDescriptor& lhs, const ModalityDescriptor& rhs) {
+    return lhs.equals(rhs);
+}
+bool operator==(const DatasetDescriptor& lhs, const DatasetDescriptor& rhs) {
+    return lhs.equals(rhs);
+}
+std::ostream& operator<<(std::ostream& os, const DatasetDescriptor& obj) {
+    return os << obj.toString();
+}
+}
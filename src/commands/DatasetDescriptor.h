@@ -0,0 +1,85 @@
+#pragma once
+
+#include "commands/ISerializable.h"
+#include "common/IIO.h"
+
+#include "silverbullet/dataio/base/Brick.h"
+#include "silverbullet/math/Vectors.h"
+
+#include <vector>
+
+namespace trinity {
+
+// immutable per-modality facts of a dataset; LOD-dependent values are indexed by LOD
+struct ModalityDescriptor : public SerializableTemplate<ModalityDescriptor> {
+    IIO::ValueType valueType;
+    IIO::Semantic semantic;
+    uint64_t componentCount;
+    uint64_t largestSingleBrickLOD;
+    Core::Math::Vec2f range;
+    Core::Math::Vec3f domainScale;
+    std::vector<Core::Math::Vec3ui64> domainSizes;
+    std::vector<Core::Math::Vec3ui> brickLayouts;
+    std::vector<Core::Math::Vec3f> floatBrickLayouts;
+
+    void serialize(ISerialWriter& writer) const override;
+    void deserialize(const ISerialReader& reader) override;
+
+    bool equals(const ModalityDescriptor& other) const;
+};
+
+// snapshot of all immutable facts of a dataset, so that they can be transferred in a single round trip;
+// as in the IO backends, all timesteps are assumed to share the brick layout of timestep 0
+class DatasetDescriptor : public SerializableTemplate<DatasetDescriptor> {
+public:
+    DatasetDescriptor() = default;
+    static DatasetDescriptor create(const IIO& io);
+
+    void serialize(ISerialWriter& writer) const override;
+    void deserialize(const ISerialReader& reader) override;
+
+    std::string toString() const;
+    bool equals(const DatasetDescriptor& other) const;
+
+    Core::Math::Vec3ui64 getMaxBrickSize() const;
+    Core::Math::Vec3ui64 getMaxUsedBrickSizes() const;
+    Core::Math::Vec3ui getBrickOverlapSize() const;
+    uint64_t getNumberOfTimesteps() const;
+    uint64_t getModalityCount() const;
+    uint64_t getLODLevelCount(uint64_t modality) const;
+    uint64_t getLargestSingleBrickLOD(uint64_t modality) const;
+    uint64_t getComponentCount(uint64_t modality) const;
+    uint64_t getTotalBrickCount(uint64_t modality) const;
+    IIO::ValueType getType(uint64_t modality) const;
+    IIO::Semantic getSemantic(uint64_t modality) const;
+    Core::Math::Vec2f getRange(uint64_t modality) const;
+    Core::Math::Vec3f getDomainScale(uint64_t modality) const;
+    Core::Math::Vec3ui64 getDomainSize(uint64_t lod, uint64_t modality) const;
+    Core::Math::Vec3ui getBrickLayout(uint64_t lod, uint64_t modality) const;
+    Core::Math::Vec3f getFloatBrickLayout(uint64_t lod, uint64_t modality) const;
+    Core::Math::Vec3ui getBrickVoxelCounts(const BrickKey& key) const;
+    Core::Math::Vec3f getBrickExtents(const BrickKey& key) const;
+    // size of the largest binary part a reply about this dataset carries, a brick of the largest size or a
+    // part of the brick metadata of a modality
+    uint64_t getMaxBinaryPartSize() const;
+
+private:
+    const ModalityDescriptor& getModality(uint64_t modality) const;
+    void checkLOD(uint64_t lod, uint64_t modality) const;
+    size_t getBrickTableIndex(const BrickKey& key) const;
+
+private:
+    Core::Math::Vec3ui64 m_maxBrickSize;
+    Core::Math::Vec3ui64 m_maxUsedBrickSizes;
+    Core::Math::Vec3ui m_brickOverlapSize;
+    uint64_t m_numberOfTimesteps;
+    std::vector<ModalityDescriptor> m_modalities;
+    // per modality: voxel counts and extents of all bricks, ordered by LOD and index within the LOD
+    std::vector<std::vector<Core::Math::Vec3ui>> m_brickVoxelCounts;
+    std::vector<std::vector<Core::Math::Vec3f>> m_brickExtents;
+};
+
+bool operator==(const ModalityDescriptor& lhs, const ModalityDescriptor& rhs);
+bool operator==(const DatasetDescriptor& lhs, const DatasetDescriptor& rhs);
+std::ostream& operator<<(std::ostream& os, const DatasetDescriptor& obj);
+}
@@ -1,5 +1,7 @@
 #include "commands/IOCommands.h"
 
+#include "common/TrinityError.h"
+
 #include "mocca/base/ContainerTools.h"
 #include "mocca/base/StringTools.h"
 #include "mocca/log/LogManager.h"
@@ -915,13 +917,24 @@ BrickKey GetBrickCmd::RequestParams::getBrickKey() const {
     return m_brickKey;
 }
 
-GetBrickCmd::ReplyParams::ReplyParams(std::shared_ptr<std::vector<uint8_t>> brick, bool success)
+GetBrickCmd::ReplyParams::ReplyParams(std::shared_ptr<std::vector<uint8_t>> brick, bool success, bool encoded)
+    : m_success(success)
+    , m_brick(brick)
+    , m_encoded(encoded) {}
+
+GetBrickCmd::ReplyParams::ReplyParams(BinaryView brick, bool success)
     : m_success(success)
-    , m_brick(brick) {}
+    , m_view(std::move(brick)) {}
 
 void GetBrickCmd::ReplyParams::serialize(ISerialWriter& writer) const {
     writer.appendBool("success", m_success);
-    writer.appendBinary(m_brick);
+    if (m_view) {
+        writer.appendBinaryView(m_view);
+    } else if (m_encoded) {
+        writer.appendEncodedBinary(m_brick);
+    } else {
+        writer.appendBinary(m_brick);
+    }
 }
 
 void GetBrickCmd::ReplyParams::deserialize(const ISerialReader& reader) {
@@ -937,7 +950,11 @@ std::string GetBrickCmd::ReplyParams::toString() const {
     std::stringstream stream;
     stream << "success: " << m_success;
     stream << "; brick: ";
-    ::operator<<(stream, *m_brick); // ugly, but necessary because of namespaces
+    if (m_view) {
+        stream << m_view.size << " bytes (view)";
+    } else {
+        ::operator<<(stream, *m_brick); // ugly, but necessary because of namespaces
+    }
     return stream.str();
 }
 
@@ -1554,6 +1571,134 @@ std::string GetBrickMetaDataCmd::ReplyParams::toString() const {
     return stream.str();
 }
 
+////////////// GetBricksCmd //////////////
+
+VclType GetBricksCmd::Type = VclType::GetBricks;
+
+GetBricksCmd::RequestParams::RequestParams(const std::vector<BrickKey>& brickKeys)
+    : m_brickKeys(brickKeys) {}
+
+void GetBricksCmd::RequestParams::serialize(ISerialWriter& writer) const {
+    writer.appendObjectVec("brickKeys", mocca::transformToBasePtrVec<ISerializable>(begin(m_brickKeys), end(m_brickKeys)));
+}
+
+void GetBricksCmd::RequestParams::deserialize(const ISerialReader& reader) {
+    m_brickKeys = reader.getSerializableVec<BrickKey>("brickKeys");
+}
+
+bool GetBricksCmd::RequestParams::equals(const GetBricksCmd::RequestParams& other) const {
+    return m_brickKeys == other.m_brickKeys;
+}
+
+std::string GetBricksCmd::RequestParams::toString() const {
+    std::stringstream stream;
+    stream << "brickKeys: ";
+    ::operator<<(stream, m_brickKeys); // ugly, but necessary because of namespaces
+    return stream.str();
+}
+
+std::vector<BrickKey> GetBricksCmd::RequestParams::getBrickKeys() const {
+    return m_brickKeys;
+}
+
+GetBricksCmd::ReplyParams::ReplyParams(std::vector<std::shared_ptr<std::vector<uint8_t>>> bricks, std::vector<bool> success,
+                                       std::vector<bool> encoded, std::vector<BinaryView> views)
+    : m_success(std::move(success))
+    , m_bricks(std::move(bricks))
+    , m_encoded(std::move(encoded))
+    , m_views(std::move(views)) {}
+
+void GetBricksCmd::ReplyParams::serialize(ISerialWriter& writer) const {
+    writer.appendBoolVec("success", m_success);
+    for (size_t i = 0; i < m_bricks.size(); ++i) {
+        if (i < m_views.size() && m_views[i]) {
+            writer.appendBinaryView(m_views[i]);
+        } else if (i < m_encoded.size() && m_encoded[i]) {
+            writer.appendEncodedBinary(m_bricks[i]);
+        } else {
+            writer.appendBinary(m_bricks[i]);
+        }
+    }
+}
+
+void GetBricksCmd::ReplyParams::deserialize(const ISerialReader& reader) {
+    m_success = reader.getBoolVec("success");
+    m_bricks = reader.getBinary();
+    if (m_bricks.size() != m_success.size()) {
+        throw TrinityError("GetBricks reply: number of bricks does not match number of status flags", __FILE__, __LINE__);
+    }
+}
+
+bool GetBricksCmd::ReplyParams::equals(const GetBricksCmd::ReplyParams& other) const {
+    if (m_success != other.m_success || m_bricks.size() != other.m_bricks.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < m_bricks.size(); ++i) {
+        if (*m_bricks[i] != *other.m_bricks[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string GetBricksCmd::ReplyParams::toString() const {
+    std::stringstream stream;
+    stream << "success: ";
+    ::operator<<(stream, m_success); // ugly, but necessary because of namespaces
+    stream << "; bricks: " << m_bricks.size() << " (binary data)";
+    return stream.str();
+}
+
+std::vector<bool> GetBricksCmd::ReplyParams::getSuccess() const {
+    return m_success;
+}
+
+std::vector<std::shared_ptr<std::vector<uint8_t>>> GetBricksCmd::ReplyParams::getBricks() const {
+    return m_bricks;
+}
+
+////////////// GetDatasetDescriptorCmd //////////////
+
+VclType GetDatasetDescriptorCmd::Type = VclType::GetDatasetDescriptor;
+
+void GetDatasetDescriptorCmd::RequestParams::serialize(ISerialWriter& writer) const {}
+
+void GetDatasetDescriptorCmd::RequestParams::deserialize(const ISerialReader& reader) {}
+
+bool GetDatasetDescriptorCmd::RequestParams::equals(const GetDatasetDescriptorCmd::RequestParams& other) const {
+    return true;
+}
+
+std::string GetDatasetDescriptorCmd::RequestParams::toString() const {
+    std::stringstream stream;
+    return stream.str();
+}
+
+GetDatasetDescriptorCmd::ReplyParams::ReplyParams(DatasetDescriptor descriptor)
+    : m_descriptor(std::move(descriptor)) {}
+
+void GetDatasetDescriptorCmd::ReplyParams::serialize(ISerialWriter& writer) const {
+    writer.appendObject("descriptor", m_descriptor);
+}
+
+void GetDatasetDescriptorCmd::ReplyParams::deserialize(const ISerialReader& reader) {
+    m_descriptor = reader.getSerializable<DatasetDescriptor>("descriptor");
+}
+
+bool GetDatasetDescriptorCmd::ReplyParams::equals(const GetDatasetDescriptorCmd::ReplyParams& other) const {
+    return m_descriptor == other.m_descriptor;
+}
+
+std::string GetDatasetDescriptorCmd::ReplyParams::toString() const {
+    std::stringstream stream;
+    stream << "descriptor: " << m_descriptor;
+    return stream.str();
+}
+
+DatasetDescriptor GetDatasetDescriptorCmd::ReplyParams::releaseDescriptor() {
+    return std::move(m_descriptor);
+}
+
 /* AUTOGEN CommandImpl */
 
 namespace trinity {
@@ -1956,5 +2101,31 @@ std::ostream& operator<<(std::ostream& os, const GetBrickMetaDataCmd::ReplyParam
     return os << obj.toString();
 }
 
+bool operator==(const GetBricksCmd::RequestParams& lhs, const GetBricksCmd::RequestParams& rhs) {
+    return lhs.equals(rhs);
+}
+bool operator==(const GetBricksCmd::ReplyParams& lhs, const GetBricksCmd::ReplyParams& rhs) {
+    return lhs.equals(rhs);
+}
+std::ostream& operator<<(std::ostream& os, const GetBricksCmd::RequestParams& obj) {
+    return os << obj.toString();
+}
+std::ostream& operator<<(std::ostream& os, const GetBricksCmd::ReplyParams& obj) {
+    return os << obj.toString();
+}
+
+bool operator==(const GetDatasetDescriptorCmd::RequestParams& lhs, const GetDatasetDescriptorCmd::RequestParams& rhs) {
+    return lhs.equals(rhs);
+}
+bool operator==(const GetDatasetDescriptorCmd::ReplyParams& lhs, const GetDatasetDescriptorCmd::ReplyParams& rhs) {
+    return lhs.equals(rhs);
+}
+std::ostream& operator<<(std::ostream& os, const GetDatasetDescriptorCmd::RequestParams& obj) {
+    return os << obj.toString();
+}
+std::ostream& operator<<(std::ostream& os, const GetDatasetDescriptorCmd::ReplyParams& obj) {
+    return os << obj.toString();
+}
+
 /* AUTOGEN CommandImplOperators */
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "commands/BrickMetaData.h"
+#include "commands/DatasetDescriptor.h"
 #include "commands/IOData.h"
 #include "commands/ISerializable.h"
 #include "commands/Reply.h"
@@ -793,7 +794,10 @@ struct GetBrickCmd {
     class ReplyParams : public SerializableTemplate<ReplyParams> {
     public:
         ReplyParams() = default;
-        explicit ReplyParams(std::shared_ptr<std::vector<uint8_t>> brick, bool success);
+        // an encoded brick is a binary frame (see BinaryFrame.h), the receiver gets the decoded brick
+        explicit ReplyParams(std::shared_ptr<std::vector<uint8_t>> brick, bool success, bool encoded = false);
+        // the brick is sent straight from the view (e.g. a mapped file), getBrick is only valid on the receiver
+        ReplyParams(BinaryView brick, bool success);
 
         void serialize(ISerialWriter& writer) const override;
         void deserialize(const ISerialReader& reader) override;
@@ -807,6 +811,8 @@ struct GetBrickCmd {
     private:
         bool m_success;
         std::shared_ptr<std::vector<uint8_t>> m_brick;
+        bool m_encoded = false;
+        BinaryView m_view;
     };
 };
 
@@ -1344,5 +1350,99 @@ using GetBrickMetaDataRequest = RequestTemplate<GetBrickMetaDataCmd>;
 std::ostream& operator<<(std::ostream& os, const GetBrickMetaDataCmd::ReplyParams& obj);
 using GetBrickMetaDataReply = ReplyTemplate<GetBrickMetaDataCmd>;
 
+// batched version of GetBrickCmd: the reply carries one binary message part per requested brick
+struct GetBricksCmd {
+    static VclType Type;
+
+    class RequestParams : public SerializableTemplate<RequestParams> {
+    public:
+        RequestParams() = default;
+        explicit RequestParams(const std::vector<BrickKey>& brickKeys);
+
+        void serialize(ISerialWriter& writer) const override;
+        void deserialize(const ISerialReader& reader) override;
+
+        std::string toString() const;
+        bool equals(const RequestParams& other) const;
+
+        std::vector<BrickKey> getBrickKeys() const;
+
+    private:
+        std::vector<BrickKey> m_brickKeys;
+    };
+
+    class ReplyParams : public SerializableTemplate<ReplyParams> {
+    public:
+        ReplyParams() = default;
+        // encoded flags the bricks that are binary frames (see BinaryFrame.h), it may be empty if none is;
+        // bricks with a set view are sent straight from it instead
+        ReplyParams(std::vector<std::shared_ptr<std::vector<uint8_t>>> bricks, std::vector<bool> success,
+                    std::vector<bool> encoded = std::vector<bool>(), std::vector<BinaryView> views = std::vector<BinaryView>());
+
+        void serialize(ISerialWriter& writer) const override;
+        void deserialize(const ISerialReader& reader) override;
+
+        std::string toString() const;
+        bool equals(const ReplyParams& other) const;
+
+        std::vector<bool> getSuccess() const;
+        std::vector<std::shared_ptr<std::vector<uint8_t>>> getBricks() const;
+
+    private:
+        std::vector<bool> m_success;
+        std::vector<std::shared_ptr<std::vector<uint8_t>>> m_bricks;
+        std::vector<bool> m_encoded;
+        std::vector<BinaryView> m_views;
+    };
+};
+
+bool operator==(const GetBricksCmd::RequestParams& lhs, const GetBricksCmd::RequestParams& rhs);
+bool operator==(const GetBricksCmd::ReplyParams& lhs, const GetBricksCmd::ReplyParams& rhs);
+std::ostream& operator<<(std::ostream& os, const GetBricksCmd::RequestParams& obj);
+std::ostream& operator<<(std::ostream& os, const GetBricksCmd::ReplyParams& obj);
+
+using GetBricksRequest = RequestTemplate<GetBricksCmd>;
+using GetBricksReply = ReplyTemplate<GetBricksCmd>;
+
+struct GetDatasetDescriptorCmd {
+    static VclType Type;
+
+    class RequestParams : public SerializableTemplate<RequestParams> {
+    public:
+        RequestParams() = default;
+
+        void serialize(ISerialWriter& writer) const override;
+        void deserialize(const ISerialReader& reader) override;
+
+        std::string toString() const;
+        bool equals(const RequestParams& other) const;
+    };
+
+    class ReplyParams : public SerializableTemplate<ReplyParams> {
+    public:
+        ReplyParams() = default;
+        explicit ReplyParams(DatasetDescriptor descriptor);
+
+        void serialize(ISerialWriter& writer) const override;
+        void deserialize(const ISerialReader& reader) override;
+
+        std::string toString() const;
+        bool equals(const ReplyParams& other) const;
+
+        DatasetDescriptor releaseDescriptor();
+
+    private:
+        DatasetDescriptor m_descriptor;
+    };
+};
+
+bool operator==(const GetDatasetDescriptorCmd::RequestParams& lhs, const GetDatasetDescriptorCmd::RequestParams& rhs);
+bool operator==(const GetDatasetDescriptorCmd::ReplyParams& lhs, const GetDatasetDescriptorCmd::ReplyParams& rhs);
+std::ostream& operator<<(std::ostream& os, const GetDatasetDescriptorCmd::RequestParams& obj);
+std::ostream& operator<<(std::ostream& os, const GetDatasetDescriptorCmd::ReplyParams& obj);
+
+using GetDatasetDescriptorRequest = RequestTemplate<GetDatasetDescriptorCmd>;
+using GetDatasetDescriptorReply = ReplyTemplate<GetDatasetDescriptorCmd>;
+
 /* AUTOGEN CommandHeader */
 }
\ No newline at end of file
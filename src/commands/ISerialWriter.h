@@ -1,5 +1,7 @@
 #pragma once
 
+#include "commands/BinaryView.h"
+
 #include "mocca/net/Message.h"
 
 #include <string>
@@ -33,6 +35,11 @@ public:
     virtual void appendObjectVec(const std::string& key, const std::vector<ISerializable*>& vec) = 0;
 
     virtual void appendBinary(std::shared_ptr<std::vector<uint8_t>> binary) = 0;
+    // appends a binary frame (see BinaryFrame.h), the reader sees the decoded payload like any other binary
+    virtual void appendEncodedBinary(std::shared_ptr<std::vector<uint8_t>> frame) = 0;
+    // appends binary data that is not owned by a vector; the writer reads the view only when the message is
+    // written, compressing writers compress straight from it, the reader sees it like any other binary
+    virtual void appendBinaryView(BinaryView view) = 0;
 
     virtual mocca::net::Message writeMessage() const = 0;
 };
@@ -1,5 +1,6 @@
 #include "commands/JsonReader.h"
 
+#include "commands/BinaryFrame.h"
 #include "commands/ISerializable.h"
 #include "common/MemBlockPool.h"
 #include "common/TrinityError.h"
@@ -26,6 +27,13 @@ mocca::net::MessagePart trinity::BinaryDecompressReader::read(mocca::net::Messag
     return uncompressed;
 }
 
+trinity::BinaryFramedReader::BinaryFramedReader(uint64_t maxSize)
+    : m_maxSize(maxSize) {}
+
+mocca::net::MessagePart trinity::BinaryFramedReader::read(mocca::net::MessagePart part) {
+    return decodeBinaryFrame(*part, m_maxSize);
+}
+
 JsonReader::JsonReader(const std::string& json)
     : m_binaryReader(mocca::make_unique<BinaryNullReader>()) {
     JsonCpp::Reader reader;
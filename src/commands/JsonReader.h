@@ -1,5 +1,6 @@
 #pragma once
 
+#include "commands/BinaryFrame.h"
 #include "commands/ISerialReader.h"
 
 #include "thirdparty/jsoncpp/json.h"
@@ -10,6 +11,7 @@ namespace trinity {
 
 class BinaryReader {
 public:
+    virtual ~BinaryReader() {}
     virtual mocca::net::MessagePart read(mocca::net::MessagePart part) = 0;
 };
 
@@ -23,6 +25,16 @@ public:
     mocca::net::MessagePart read(mocca::net::MessagePart part) override;
 };
 
+// decodes binary frames according to their codec, frames larger than maxSize are rejected
+class BinaryFramedReader : public BinaryReader {
+public:
+    explicit BinaryFramedReader(uint64_t maxSize);
+    mocca::net::MessagePart read(mocca::net::MessagePart part) override;
+
+private:
+    uint64_t m_maxSize;
+};
+
 class JsonReader : public ISerialReader {
 public:
     JsonReader(const std::string& json);
@@ -1,5 +1,6 @@
 #include "commands/JsonWriter.h"
 
+#include "commands/BinaryFrame.h"
 #include "commands/ISerializable.h"
 #include "common/MemBlockPool.h"
 
@@ -7,16 +8,61 @@
 
 using namespace trinity;
 
+mocca::net::MessagePart trinity::BinaryWriter::writeEncoded(mocca::net::MessagePart frame) {
+    // the frame comes from the local IO backend, so the size it announces is trusted
+    return write(decodeBinaryFrame(*frame, BinaryFrameHeader::read(*frame).uncompressedSize));
+}
+
+namespace {
+mocca::net::MessagePart bloscCompress(const uint8_t* data, size_t size) {
+    auto compressed = MemBlockPool::instance().get(size + BLOSC_MAX_OVERHEAD);
+    compressed->resize(size + BLOSC_MAX_OVERHEAD);
+    auto compressedSize = blosc_compress_ctx(7, BLOSC_SHUFFLE, 8, size, data, compressed->data(), compressed->size(), "snappy", 0, 6);
+    compressed->resize(compressedSize);
+    return compressed;
+}
+
+mocca::net::MessagePart bloscFrame(const uint8_t* data, size_t size) {
+    const size_t maxSize = BinaryFrameHeader::size + size + BLOSC_MAX_OVERHEAD;
+    auto frame = MemBlockPool::instance().get(maxSize);
+    frame->resize(maxSize);
+    BinaryFrameHeader header{BinaryCodec::Blosc, {}, size};
+    header.write(*frame);
+    auto compressedSize = blosc_compress_ctx(7, BLOSC_SHUFFLE, 8, size, data, frame->data() + BinaryFrameHeader::size,
+                                             maxSize - BinaryFrameHeader::size, "snappy", 0, 6);
+    frame->resize(BinaryFrameHeader::size + compressedSize);
+    return frame;
+}
+}
+
+mocca::net::MessagePart trinity::BinaryWriter::writeView(const BinaryView& view) {
+    auto part = MemBlockPool::instance().get(view.size);
+    part->assign(view.data.get(), view.data.get() + view.size);
+    return write(part);
+}
+
 mocca::net::MessagePart trinity::BinaryNullWriter::write(mocca::net::MessagePart part) {
     return part;
 }
 
 mocca::net::MessagePart trinity::BinaryCompressWriter::write(mocca::net::MessagePart part) {
-    auto compressed = MemBlockPool::instance().get(part->size() + BLOSC_MAX_OVERHEAD);
-    compressed->resize(part->size() + BLOSC_MAX_OVERHEAD);
-    auto compressedSize = blosc_compress_ctx(7, BLOSC_SHUFFLE, 8, part->size(), part->data(), compressed->data(), compressed->size(), "snappy", 0, 6);
-    compressed->resize(compressedSize);
-    return compressed;
+    return bloscCompress(part->data(), part->size());
+}
+
+mocca::net::MessagePart trinity::BinaryCompressWriter::writeView(const BinaryView& view) {
+    return bloscCompress(view.data.get(), view.size);
+}
+
+mocca::net::MessagePart trinity::BinaryFramedWriter::write(mocca::net::MessagePart part) {
+    return bloscFrame(part->data(), part->size());
+}
+
+mocca::net::MessagePart trinity::BinaryFramedWriter::writeView(const BinaryView& view) {
+    return bloscFrame(view.data.get(), view.size);
+}
+
+mocca::net::MessagePart trinity::BinaryFramedWriter::writeEncoded(mocca::net::MessagePart frame) {
+    return frame;
 }
 
 JsonWriter::JsonWriter(std::unique_ptr<BinaryWriter> binaryWriter)
@@ -119,7 +165,15 @@ void JsonWriter::appendObjectVec(const std::string& key, const std::vector<ISeri
 }
 
 void JsonWriter::appendBinary(std::shared_ptr<std::vector<uint8_t>> binary) {
-    m_binary->push_back(binary);
+    m_binary->push_back(BinaryPart{binary, false, BinaryView()});
+}
+
+void JsonWriter::appendEncodedBinary(std::shared_ptr<std::vector<uint8_t>> frame) {
+    m_binary->push_back(BinaryPart{frame, true, BinaryView()});
+}
+
+void JsonWriter::appendBinaryView(BinaryView view) {
+    m_binary->push_back(BinaryPart{nullptr, false, std::move(view)});
 }
 
 // bit hacky, but the effort won't be worth it. Should be deleted one day.
@@ -135,15 +189,21 @@ mocca::net::Message JsonWriter::writeMessage() const {
 #ifdef JSON_EXPORT_ENABLED
     std::stringstream ss;
 #endif
-    JsonCpp::StyledStreamWriter streamWriter;
-    streamWriter.write(os, m_root);
+    // the header is only read by machines, so it is written without indentation
+    JsonCpp::FastWriter fastWriter;
+    os << fastWriter.write(m_root);
 #ifdef JSON_EXPORT_ENABLED
+    JsonCpp::StyledStreamWriter streamWriter;
     streamWriter.write(ss, m_root);
 #endif
     mocca::net::Message message;
     message.push_back(jsonData);
-    for (auto& sharedData : *m_binary) {
-        message.push_back(m_binaryWriter->write(sharedData));
+    for (auto& part : *m_binary) {
+        if (part.view) {
+            message.push_back(m_binaryWriter->writeView(part.view));
+        } else {
+            message.push_back(part.encoded ? m_binaryWriter->writeEncoded(part.data) : m_binaryWriter->write(part.data));
+        }
     }
 #ifdef JSON_EXPORT_ENABLED
     LINFO(ss.str());
@@ -10,7 +10,13 @@ namespace trinity {
 
 class BinaryWriter {
 public:
+    virtual ~BinaryWriter() {}
     virtual mocca::net::MessagePart write(mocca::net::MessagePart part) = 0;
+    // writes a part that is a binary frame already (see BinaryFrame.h); unless the writer produces frames
+    // itself, the frame is decoded and written like any other part
+    virtual mocca::net::MessagePart writeEncoded(mocca::net::MessagePart frame);
+    // writes data that is not owned by a vector; the default implementation copies it into a part
+    virtual mocca::net::MessagePart writeView(const BinaryView& view);
 };
 
 class BinaryNullWriter : public BinaryWriter {
@@ -21,6 +27,15 @@ public:
 class BinaryCompressWriter : public BinaryWriter {
 public:
     mocca::net::MessagePart write(mocca::net::MessagePart part) override;
+    mocca::net::MessagePart writeView(const BinaryView& view) override;
+};
+
+// compresses parts into blosc frames and forwards encoded parts untouched
+class BinaryFramedWriter : public BinaryWriter {
+public:
+    mocca::net::MessagePart write(mocca::net::MessagePart part) override;
+    mocca::net::MessagePart writeEncoded(mocca::net::MessagePart frame) override;
+    mocca::net::MessagePart writeView(const BinaryView& view) override;
 };
 
 class JsonWriter : public ISerialWriter {
@@ -47,6 +62,8 @@ public:
     void appendObjectVec(const std::string& key, const std::vector<ISerializable*>& vec) override;
 
     void appendBinary(std::shared_ptr<std::vector<uint8_t>> binary) override;
+    void appendEncodedBinary(std::shared_ptr<std::vector<uint8_t>> frame) override;
+    void appendBinaryView(BinaryView view) override;
 
     mocca::net::Message writeMessage() const override;
 
@@ -78,7 +95,12 @@ private:
         std::vector<uint8_t>& m_vec;
     };
 
-    using SharedDataVec = std::vector<std::shared_ptr<std::vector<uint8_t>>>;
+    struct BinaryPart {
+        std::shared_ptr<std::vector<uint8_t>> data;
+        bool encoded;    // data is a binary frame
+        BinaryView view; // used instead of data if set
+    };
+    using SharedDataVec = std::vector<BinaryPart>;
     JsonWriter(std::shared_ptr<SharedDataVec> binary);
 
 private:
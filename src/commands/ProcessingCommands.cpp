@@ -4,22 +4,26 @@ using namespace trinity;
 
 ////////////// StreamingParams //////////////
 
-StreamingParams::StreamingParams(int resX, int resY)
+StreamingParams::StreamingParams(int resX, int resY, bool frameRegions)
     : m_resX(resX)
-    , m_resY(resY) {}
+    , m_resY(resY)
+    , m_frameRegions(frameRegions) {}
 
 StreamingParams::StreamingParams()
     : m_resX(1024)
-    , m_resY(768) {}
+    , m_resY(768)
+    , m_frameRegions(true) {}
 
 void StreamingParams::serialize(ISerialWriter& writer) const {
     writer.appendInt("xres", m_resX);
     writer.appendInt("yres", m_resY);
+    writer.appendBool("regions", m_frameRegions);
 }
 
 void StreamingParams::deserialize(const ISerialReader& reader) {
     m_resX = reader.getInt32("xres");
     m_resY = reader.getInt32("yres");
+    m_frameRegions = reader.getBool("regions");
 }
 
 int StreamingParams::getResX() const {
@@ -29,14 +33,87 @@ int StreamingParams::getResY() const {
     return m_resY;
 }
 
+bool StreamingParams::getFrameRegions() const {
+    return m_frameRegions;
+}
+
+void StreamingParams::setFrameRegions(bool frameRegions) {
+    m_frameRegions = frameRegions;
+}
+
 std::string StreamingParams::toString() const {
     std::stringstream stream;
-    stream << "xres: " << m_resX << "; yres: " << m_resY;
+    stream << "xres: " << m_resX << "; yres: " << m_resY << "; regions: " << m_frameRegions;
     return stream.str();
 }
 
 bool StreamingParams::equals(const StreamingParams& other) const {
-    return m_resX == other.m_resX && m_resY == other.m_resY;
+    return m_resX == other.m_resX && m_resY == other.m_resY && m_frameRegions == other.m_frameRegions;
+}
+
+////////////// StreamQuality //////////////
+
+StreamQuality::StreamQuality()
+    : m_jpegQuality(75)
+    , m_subsampling(2)
+    , m_resolutionScale(1.0f)
+    , m_framesPerSecond(0.0f)
+    , m_bytesPerSecond(0.0f) {}
+
+StreamQuality::StreamQuality(int jpegQuality, int subsampling, float resolutionScale, float framesPerSecond, float bytesPerSecond)
+    : m_jpegQuality(jpegQuality)
+    , m_subsampling(subsampling)
+    , m_resolutionScale(resolutionScale)
+    , m_framesPerSecond(framesPerSecond)
+    , m_bytesPerSecond(bytesPerSecond) {}
+
+void StreamQuality::serialize(ISerialWriter& writer) const {
+    writer.appendInt("jpegquality", m_jpegQuality);
+    writer.appendInt("subsampling", m_subsampling);
+    writer.appendFloat("resolutionscale", m_resolutionScale);
+    writer.appendFloat("fps", m_framesPerSecond);
+    writer.appendFloat("bps", m_bytesPerSecond);
+}
+
+void StreamQuality::deserialize(const ISerialReader& reader) {
+    m_jpegQuality = reader.getInt32("jpegquality");
+    m_subsampling = reader.getInt32("subsampling");
+    m_resolutionScale = reader.getFloat("resolutionscale");
+    m_framesPerSecond = reader.getFloat("fps");
+    m_bytesPerSecond = reader.getFloat("bps");
+}
+
+int StreamQuality::getJpegQuality() const {
+    return m_jpegQuality;
+}
+
+int StreamQuality::getSubsampling() const {
+    return m_subsampling;
+}
+
+float StreamQuality::getResolutionScale() const {
+    return m_resolutionScale;
+}
+
+float StreamQuality::getFramesPerSecond() const {
+    return m_framesPerSecond;
+}
+
+float StreamQuality::getBytesPerSecond() const {
+    return m_bytesPerSecond;
+}
+
+std::string StreamQuality::toString() const {
+    std::stringstream stream;
+    stream << "jpegQuality: " << m_jpegQuality << "; subsampling: " << m_subsampling << "; resolutionScale: " << m_resolutionScale
+           << "; fps: " << m_framesPerSecond << "; bps: " << m_bytesPerSecond;
+    return stream.str();
+}
+
+bool StreamQuality::equals(const StreamQuality& other) const {
+    return m_jpegQuality == other.m_jpegQuality && m_subsampling == other.m_subsampling &&
+           m_resolutionScale == other.m_resolutionScale && m_framesPerSecond == other.m_framesPerSecond &&
+           m_bytesPerSecond == other.m_bytesPerSecond;
 }
 
 ////////////// InitProcessingSessionCmd //////////////
@@ -1921,6 +1998,48 @@ std::string SetUserWorldMatrixCmd::RequestParams::toString() const {
     return stream.str();
 }
 
+////////////// GetStreamQualityCmd //////////////
+
+VclType GetStreamQualityCmd::Type = VclType::GetStreamQuality;
+
+void GetStreamQualityCmd::RequestParams::serialize(ISerialWriter& writer) const {}
+
+void GetStreamQualityCmd::RequestParams::deserialize(const ISerialReader& reader) {}
+
+bool GetStreamQualityCmd::RequestParams::equals(const GetStreamQualityCmd::RequestParams& other) const {
+    return true;
+}
+
+std::string GetStreamQualityCmd::RequestParams::toString() const {
+    std::stringstream stream;
+    return stream.str();
+}
+
+GetStreamQualityCmd::ReplyParams::ReplyParams(const StreamQuality& quality)
+    : m_quality(quality) {}
+
+void GetStreamQualityCmd::ReplyParams::serialize(ISerialWriter& writer) const {
+    writer.appendObject("quality", m_quality);
+}
+
+void GetStreamQualityCmd::ReplyParams::deserialize(const ISerialReader& reader) {
+    m_quality = reader.getSerializable<StreamQuality>("quality");
+}
+
+bool GetStreamQualityCmd::ReplyParams::equals(const GetStreamQualityCmd::ReplyParams& other) const {
+    return m_quality == other.m_quality;
+}
+
+std::string GetStreamQualityCmd::ReplyParams::toString() const {
+    std::stringstream stream;
+    stream << "quality: " << m_quality;
+    return stream.str();
+}
+
+StreamQuality GetStreamQualityCmd::ReplyParams::getQuality() const {
+    return m_quality;
+}
+
 /* AUTOGEN CommandImpl */
 
 namespace trinity {
@@ -1931,6 +2050,13 @@ std::ostream& operator<<(std::ostream& os, const StreamingParams& obj) {
     return os << obj.toString();
 }
 
+bool operator==(const StreamQuality& lhs, const StreamQuality& rhs) {
+    return lhs.equals(rhs);
+}
+std::ostream& operator<<(std::ostream& os, const StreamQuality& obj) {
+    return os << obj.toString();
+}
+
 bool operator==(const InitProcessingSessionCmd::RequestParams& lhs, const InitProcessingSessionCmd::RequestParams& rhs) {
     return lhs.equals(rhs);
 }
@@ -2424,5 +2550,18 @@ std::ostream& operator<<(std::ostream& os, const SetUserWorldMatrixCmd::RequestP
     return os << obj.toString();
 }
 
+bool operator==(const GetStreamQualityCmd::RequestParams& lhs, const GetStreamQualityCmd::RequestParams& rhs) {
+    return lhs.equals(rhs);
+}
+std::ostream& operator<<(std::ostream& os, const GetStreamQualityCmd::RequestParams& obj) {
+    return os << obj.toString();
+}
+bool operator==(const GetStreamQualityCmd::ReplyParams& lhs, const GetStreamQualityCmd::ReplyParams& rhs) {
+    return lhs.equals(rhs);
+}
+std::ostream& operator<<(std::ostream& os, const GetStreamQualityCmd::ReplyParams& obj) {
+    return os << obj.toString();
+}
+
 /* AUTOGEN CommandImplOperators */
 }
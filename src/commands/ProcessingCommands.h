@@ -12,24 +12,57 @@ namespace trinity {
 class StreamingParams : public SerializableTemplate<StreamingParams> {
 public:
     StreamingParams();
-    explicit StreamingParams(int resX, int resY);
+    // receivers that cannot assemble a frame from several regions get frames made of a single image
+    explicit StreamingParams(int resX, int resY, bool frameRegions = true);
 
     void serialize(ISerialWriter& writer) const override;
     void deserialize(const ISerialReader& reader) override;
 
     int getResX() const;
     int getResY() const;
+    bool getFrameRegions() const;
+    void setFrameRegions(bool frameRegions);
 
     std::string toString() const;
     bool equals(const StreamingParams& other) const;
 
 private:
     int m_resX, m_resY;
+    bool m_frameRegions;
 };
 
 bool operator==(const StreamingParams& lhs, const StreamingParams& rhs);
 std::ostream& operator<<(std::ostream& os, const StreamingParams& obj);
 
+// encoding settings currently chosen for the vis stream, together with the measured stream rates
+class StreamQuality : public SerializableTemplate<StreamQuality> {
+public:
+    StreamQuality();
+    StreamQuality(int jpegQuality, int subsampling, float resolutionScale, float framesPerSecond = 0.0f, float bytesPerSecond = 0.0f);
+
+    void serialize(ISerialWriter& writer) const override;
+    void deserialize(const ISerialReader& reader) override;
+
+    int getJpegQuality() const;
+    int getSubsampling() const; // value of JPEGEncoder::ChrominanceSubsampling
+    float getResolutionScale() const;
+    float getFramesPerSecond() const;
+    float getBytesPerSecond() const;
+
+    std::string toString() const;
+    bool equals(const StreamQuality& other) const;
+
+private:
+    int m_jpegQuality;
+    int m_subsampling;
+    float m_resolutionScale;
+    float m_framesPerSecond;
+    float m_bytesPerSecond;
+};
+
+bool operator==(const StreamQuality& lhs, const StreamQuality& rhs);
+std::ostream& operator<<(std::ostream& os, const StreamQuality& obj);
+
 struct InitProcessingSessionCmd {
     static VclType Type;
 
@@ -1683,5 +1716,45 @@ bool operator==(const SetUserWorldMatrixCmd::RequestParams& lhs, const SetUserWo
 std::ostream& operator<<(std::ostream& os, const SetUserWorldMatrixCmd::RequestParams& obj);
 using SetUserWorldMatrixRequest = RequestTemplate<SetUserWorldMatrixCmd>;
 
+struct GetStreamQualityCmd {
+    static VclType Type;
+
+    class RequestParams : public SerializableTemplate<RequestParams> {
+    public:
+        RequestParams() = default;
+
+        void serialize(ISerialWriter& writer) const override;
+        void deserialize(const ISerialReader& reader) override;
+
+        std::string toString() const;
+        bool equals(const RequestParams& other) const;
+    };
+
+    class ReplyParams : public SerializableTemplate<ReplyParams> {
+    public:
+        ReplyParams() = default;
+        ReplyParams(const StreamQuality& quality);
+
+        void serialize(ISerialWriter& writer) const override;
+        void deserialize(const ISerialReader& reader) override;
+
+        std::string toString() const;
+        bool equals(const ReplyParams& other) const;
+
+        StreamQuality getQuality() const;
+
+    private:
+        StreamQuality m_quality;
+    };
+};
+
+bool operator==(const GetStreamQualityCmd::RequestParams& lhs, const GetStreamQualityCmd::RequestParams& rhs);
+std::ostream& operator<<(std::ostream& os, const GetStreamQualityCmd::RequestParams& obj);
+using GetStreamQualityRequest = RequestTemplate<GetStreamQualityCmd>;
+
+bool operator==(const GetStreamQualityCmd::ReplyParams& lhs, const GetStreamQualityCmd::ReplyParams& rhs);
+std::ostream& operator<<(std::ostream& os, const GetStreamQualityCmd::ReplyParams& obj);
+using GetStreamQualityReply = ReplyTemplate<GetStreamQualityCmd>;
+
 /* AUTOGEN CommandHeader */
 }
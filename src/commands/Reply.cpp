@@ -56,6 +56,8 @@ std::unique_ptr<Reply> Reply::createReplyInternal(const ISerialReader& reader) {
         return reader.getSerializablePtr<IsIdleReply>("rep");
     } else if (type == ProceedRenderingReply::Ifc::Type) {
         return reader.getSerializablePtr<ProceedRenderingReply>("rep");
+    } else if (type == GetStreamQualityReply::Ifc::Type) {
+        return reader.getSerializablePtr<GetStreamQualityReply>("rep");
     }
     /* AUTOGEN ProcReplyFactoryEntry */
 
@@ -118,6 +120,10 @@ std::unique_ptr<Reply> Reply::createReplyInternal(const ISerialReader& reader) {
         return reader.getSerializablePtr<GetRootsReply>("rep");
     } else if (type == GetBrickMetaDataReply::Ifc::Type) {
         return reader.getSerializablePtr<GetBrickMetaDataReply>("rep");
+    } else if (type == GetBricksReply::Ifc::Type) {
+        return reader.getSerializablePtr<GetBricksReply>("rep");
+    } else if (type == GetDatasetDescriptorReply::Ifc::Type) {
+        return reader.getSerializablePtr<GetDatasetDescriptorReply>("rep");
     }
     /* AUTOGEN IOReplyFactoryEntry */
 
@@ -129,8 +135,9 @@ std::unique_ptr<Reply> Reply::createReplyInternal(const ISerialReader& reader) {
     throw TrinityError("Invalid reply type", __FILE__, __LINE__);
 }
 
-std::unique_ptr<Reply> Reply::createFromMessage(const mocca::net::Message& message, CompressionMode compressionMode) {
-    auto reader = ISerializerFactory::defaultFactory().createReader(message, compressionMode);
+std::unique_ptr<Reply> Reply::createFromMessage(const mocca::net::Message& message, CompressionMode compressionMode,
+                                                uint64_t maxBinarySize) {
+    auto reader = ISerializerFactory::defaultFactory().createReader(message, compressionMode, maxBinarySize);
     return createReplyInternal(*reader);
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/Enums.h"
+#include "commands/BinaryFrame.h"
 #include "commands/ISerialReader.h"
 #include "commands/ISerialWriter.h"
 #include "commands/ISerializable.h"
@@ -29,7 +30,8 @@ public:
     int getRid() const { return m_rid; }
     int getSid() const { return m_sid; }
 
-    static std::unique_ptr<Reply> createFromMessage(const mocca::net::Message& message, CompressionMode compressionMode);
+    static std::unique_ptr<Reply> createFromMessage(const mocca::net::Message& message, CompressionMode compressionMode,
+                                                    uint64_t maxBinarySize = BinaryFrameHeader::defaultMaxSize);
     static mocca::net::Message createMessage(const Reply& reply, CompressionMode compressionMode);
 
 private:
@@ -117,6 +117,8 @@ std::unique_ptr<Request> Request::createRequestInternal(const ISerialReader& rea
         return reader.getSerializablePtr<SetUserViewMatrixRequest>("req");
     } else if (type == SetUserWorldMatrixRequest::Ifc::Type) {
         return reader.getSerializablePtr<SetUserWorldMatrixRequest>("req");
+    } else if (type == GetStreamQualityRequest::Ifc::Type) {
+        return reader.getSerializablePtr<GetStreamQualityRequest>("req");
     }
     /* AUTOGEN ProcRequestFactoryEntry */
 
@@ -179,6 +181,10 @@ std::unique_ptr<Request> Request::createRequestInternal(const ISerialReader& rea
         return reader.getSerializablePtr<GetRootsRequest>("req");
     } else if (type == GetBrickMetaDataRequest::Ifc::Type) {
         return reader.getSerializablePtr<GetBrickMetaDataRequest>("req");
+    } else if (type == GetBricksRequest::Ifc::Type) {
+        return reader.getSerializablePtr<GetBricksRequest>("req");
+    } else if (type == GetDatasetDescriptorRequest::Ifc::Type) {
+        return reader.getSerializablePtr<GetDatasetDescriptorRequest>("req");
     }
     /* AUTOGEN IORequestFactoryEntry */
 
@@ -18,17 +18,24 @@ std::unique_ptr<ISerialWriter> JsonSerializerFactory::createWriter(CompressionMo
     if (compressionMode == CompressionMode::Uncompressed) {
         binaryWriter = mocca::make_unique<BinaryNullWriter>();
     }
+    else if (compressionMode == CompressionMode::Framed) {
+        binaryWriter = mocca::make_unique<BinaryFramedWriter>();
+    }
     else {
         binaryWriter = mocca::make_unique<BinaryCompressWriter>();
     }
     return mocca::make_unique<JsonWriter>(std::move(binaryWriter));
 }
 
-std::unique_ptr<ISerialReader> JsonSerializerFactory::createReader(const mocca::net::Message &message, CompressionMode compressionMode) const {
+std::unique_ptr<ISerialReader> JsonSerializerFactory::createReader(const mocca::net::Message &message, CompressionMode compressionMode,
+                                                                   uint64_t maxBinarySize) const {
     std::unique_ptr<BinaryReader> binaryReader;
     if (compressionMode == CompressionMode::Uncompressed) {
         binaryReader = mocca::make_unique<BinaryNullReader>();
     }
+    else if (compressionMode == CompressionMode::Framed) {
+        binaryReader = mocca::make_unique<BinaryFramedReader>(maxBinarySize);
+    }
     else {
         binaryReader = mocca::make_unique<BinaryDecompressReader>();
     }
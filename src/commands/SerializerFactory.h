@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/Enums.h"
+#include "commands/BinaryFrame.h"
 #include "commands/ISerialReader.h"
 #include "commands/ISerialWriter.h"
 
@@ -14,7 +15,9 @@ namespace trinity {
 class ISerializerFactory {
 public:
     virtual std::unique_ptr<ISerialWriter> createWriter(CompressionMode compressionMode = CompressionMode::Uncompressed) const = 0;
-    virtual std::unique_ptr<ISerialReader> createReader(const mocca::net::Message &message, CompressionMode compressionMode = CompressionMode::Uncompressed) const = 0;
+    // maxBinarySize bounds the decoded size of each binary part in CompressionMode::Framed
+    virtual std::unique_ptr<ISerialReader> createReader(const mocca::net::Message &message, CompressionMode compressionMode = CompressionMode::Uncompressed,
+                                                        uint64_t maxBinarySize = BinaryFrameHeader::defaultMaxSize) const = 0;
 
     static const ISerializerFactory& defaultFactory(); // edit this method to change the default serializer
 };
@@ -22,6 +25,7 @@ public:
 class JsonSerializerFactory : public ISerializerFactory {
 public:
     std::unique_ptr<ISerialWriter> createWriter(CompressionMode compressionMode = CompressionMode::Uncompressed) const override;
-    std::unique_ptr<ISerialReader> createReader(const mocca::net::Message &message, CompressionMode compressionMode = CompressionMode::Uncompressed) const override;
+    std::unique_ptr<ISerialReader> createReader(const mocca::net::Message &message, CompressionMode compressionMode = CompressionMode::Uncompressed,
+                                                uint64_t maxBinarySize = BinaryFrameHeader::defaultMaxSize) const override;
 };
 }
@@ -104,6 +104,9 @@ enum class VclType {
     SetUserWorldMatrix,
     GetRoots,
     GetBrickMetaData,
+    GetBricks,
+    GetDatasetDescriptor,
+    GetStreamQuality,
     /* AUTOGEN VclEnumEntry */
     First = InitRenderer,
     Last = GetDomainSize,
@@ -221,6 +224,9 @@ private:
         m_cmdMap.insert("SetUserWorldMatrix", VclType::SetUserWorldMatrix);
         m_cmdMap.insert("GetRoots", VclType::GetRoots);
         m_cmdMap.insert("GetBrickMetaData", VclType::GetBrickMetaData);
+        m_cmdMap.insert("GetBricks", VclType::GetBricks);
+        m_cmdMap.insert("GetDatasetDescriptor", VclType::GetDatasetDescriptor);
+        m_cmdMap.insert("GetStreamQuality", VclType::GetStreamQuality);
         /* AUTOGEN VclMapEntry */
 
         assertCompleteLanguage();
@@ -12,10 +12,13 @@
 using namespace mocca::net;
 using namespace trinity;
 
-AbstractSession::AbstractSession(const std::string& protocol, CompressionMode compressionMode)
+AbstractSession::AbstractSession(const std::string& protocol, CompressionMode compressionMode, size_t workerCount)
     : m_sid(IDGenerator::nextID()), m_compressionMode(compressionMode)
     // FIXME dmc: "localhost" should be "*", but then the tests fail -> find out why!
-    , m_acceptor(ConnectionFactorySelector::bind(Endpoint(protocol, "localhost", Endpoint::autoPort()))) {}
+    , m_acceptor(ConnectionFactorySelector::bind(Endpoint(protocol, "localhost", Endpoint::autoPort())))
+    , m_workerCount(workerCount)
+    , m_pendingCount(0)
+    , m_stopWorkers(false) {}
 
 AbstractSession::~AbstractSession() {
     LINFO("(session) joining session...");
@@ -41,30 +44,113 @@ void AbstractSession::run() {
 
     try {
         performThreadSpecificInit();
+        startWorkers();
         while (!isInterrupted()) {
             auto message = m_controlConnection->receive();
             if (!message.empty()) {
                 auto request = Request::createFromMessage(message, m_compressionMode);
                 // LINFO("request: " << *request);
-                auto handler = createHandler(*request);
-                std::unique_ptr<Reply> reply = nullptr;
-                try {
-                    reply = handler->execute();
-                } catch (const TrinityError& err) {
-                    ErrorCmd::ReplyParams replyParams(err.what());
-                    auto errorReply = mocca::make_unique<ErrorReply>(replyParams, request->getRid(), m_sid);
-                    auto serialReply = Reply::createMessage(*errorReply, m_compressionMode);
-                    m_controlConnection->send(std::move(serialReply));
-                }
-                if (reply != nullptr) { // not tested yet
-                    auto serialReply = Reply::createMessage(*reply, m_compressionMode);
-                    m_controlConnection->send(std::move(serialReply));
+                if (m_workerCount > 0 && isConcurrent(*request)) {
+                    dispatch(std::move(request));
+                } else {
+                    waitUntilIdle();
+                    execute(*request);
                 }
             }
+            rethrowWorkerError();
         }
     } catch (...) {
         interrupt();
         setException(std::current_exception());
     }
+    stopWorkers();
     performThreadSpecificTeardown();
 }
+
+void AbstractSession::execute(const Request& request) {
+    auto handler = createHandler(request);
+    std::unique_ptr<Reply> reply = nullptr;
+    try {
+        reply = handler->execute();
+    } catch (const TrinityError& err) {
+        ErrorCmd::ReplyParams replyParams(err.what());
+        reply = mocca::make_unique<ErrorReply>(replyParams, request.getRid(), m_sid);
+    }
+    if (reply != nullptr) { // not tested yet
+        sendReply(*reply);
+    }
+}
+
+void AbstractSession::sendReply(const Reply& reply) {
+    auto serialReply = Reply::createMessage(reply, m_compressionMode);
+    std::lock_guard<std::mutex> lock(m_sendMutex);
+    m_controlConnection->send(std::move(serialReply));
+}
+
+void AbstractSession::startWorkers() {
+    for (size_t i = 0; i < m_workerCount; ++i) {
+        m_workers.emplace_back(&AbstractSession::workerLoop, this);
+    }
+}
+
+void AbstractSession::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        // requests that have not been started are dropped, the client is gone or the session failed
+        m_queue.clear();
+        m_stopWorkers = true;
+    }
+    m_requestQueued.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void AbstractSession::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    while (true) {
+        m_requestQueued.wait(lock, [this] { return m_stopWorkers || !m_queue.empty(); });
+        if (m_stopWorkers) {
+            return;
+        }
+        auto request = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            execute(*request);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error && !m_workerError) {
+            m_workerError = error;
+        }
+        --m_pendingCount;
+        m_requestDone.notify_all();
+    }
+}
+
+void AbstractSession::dispatch(std::unique_ptr<Request> request) {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back(std::move(request));
+        ++m_pendingCount;
+    }
+    m_requestQueued.notify_one();
+}
+
+void AbstractSession::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    m_requestDone.wait(lock, [this] { return m_pendingCount == 0; });
+}
+
+void AbstractSession::rethrowWorkerError() {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    if (m_workerError) {
+        std::rethrow_exception(m_workerError);
+    }
+}
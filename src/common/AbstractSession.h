@@ -9,15 +9,24 @@
 #include "mocca/net/IMessageConnection.h"
 #include "mocca/net/IMessageConnectionAcceptor.h"
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace trinity {
 
 class AbstractSession : public mocca::Runnable {
 
 public:
-    AbstractSession(const std::string& protocol, CompressionMode compressionMode);
+    // with workerCount > 0 the handlers of concurrent requests (see isConcurrent) are executed by that many
+    // worker threads, and their replies are sent as soon as they are ready, i.e. possibly out of order
+    AbstractSession(const std::string& protocol, CompressionMode compressionMode, size_t workerCount = 0);
     virtual ~AbstractSession();
 
     int getSid() const { return m_sid; }
@@ -28,12 +37,38 @@ private:
     virtual void performThreadSpecificInit() {}
     void run() override;
     virtual std::unique_ptr<ICommandHandler> createHandler(const Request& request) = 0;
+    // whether the request may be executed by a worker, concurrently with other requests; all other requests
+    // are executed on the session thread after all previous requests have been answered, and before the next
+    // request is started
+    virtual bool isConcurrent(const Request&) const { return false; }
+
+    void execute(const Request& request);
+    void sendReply(const Reply& reply);
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop();
+    void dispatch(std::unique_ptr<Request> request);
+    void waitUntilIdle();
+    void rethrowWorkerError();
 
 private:
     int m_sid;
     CompressionMode m_compressionMode;
     std::unique_ptr<mocca::net::IMessageConnectionAcceptor> m_acceptor;
     std::unique_ptr<mocca::net::IMessageConnection> m_controlConnection;
+    std::mutex m_sendMutex;
+
+    size_t m_workerCount;
+    std::vector<std::thread> m_workers;
+    std::mutex m_queueMutex;
+    std::condition_variable m_requestQueued;
+    std::condition_variable m_requestDone;
+    std::deque<std::unique_ptr<Request>> m_queue;
+    // requests that have been dispatched but not answered yet
+    size_t m_pendingCount;
+    bool m_stopWorkers;
+    // the first error that is not reported to the client, rethrown on the session thread
+    std::exception_ptr m_workerError;
 
     // todo: one day, we might want to release ids
 };
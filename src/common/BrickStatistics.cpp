@@ -0,0 +1,369 @@
+#include "common/BrickStatistics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRINITY_BRICKSTATS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TRINITY_TARGET_SSE41
+#define TRINITY_TARGET_AVX2
+#else
+#define TRINITY_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TRINITY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace trinity;
+
+namespace {
+SimdLevel detectSimdLevel() {
+#ifdef TRINITY_BRICKSTATS_X86
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    // AVX registers have to be enabled by the OS as well
+    const bool avxState = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && avxState) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse41 = __builtin_cpu_supports("sse4.1") != 0;
+    const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+    if (avx2 && sse41) return SimdLevel::AVX2;
+    if (sse41) return SimdLevel::SSE41;
+#endif
+    return SimdLevel::Scalar;
+}
+
+std::atomic<int>& activeLevel() {
+    static std::atomic<int> level(static_cast<int>(supportedSimdLevel()));
+    return level;
+}
+
+template <typename T> void initMinMax(const T* data, size_t componentCount, T* min, T* max) {
+    for (size_t c = 0; c < componentCount; ++c) {
+        min[c] = data[c];
+        max[c] = data[c];
+    }
+}
+
+template <typename T>
+void minMaxScalar(const T* data, size_t count, size_t componentCount, T* min, T* max, uint64_t* histogram) {
+    if (componentCount == 1) {
+        for (size_t v = 0; v < count; ++v) {
+            if (data[v] < *min) *min = data[v];
+            if (data[v] > *max) *max = data[v];
+            if (histogram) ++histogram[size_t(data[v])];
+        }
+        return;
+    }
+    for (size_t v = 0; v < count; ++v) {
+        const T* voxel = data + v * componentCount;
+        for (size_t c = 0; c < componentCount; ++c) {
+            if (voxel[c] < min[c]) min[c] = voxel[c];
+            if (voxel[c] > max[c]) max[c] = voxel[c];
+        }
+        if (histogram) ++histogram[size_t(voxel[0])];
+    }
+}
+
+// the same operations in the same order as the vector kernels, so all implementations agree to the last bit
+template <typename T> double gradientMagnitude(const T* center, size_t step, size_t line, size_t slice, double normalization) {
+    const double gx = (double(*(center - step)) - double(*(center + step))) / (normalization * 2);
+    const double gy = (double(*(center - step * line)) - double(*(center + step * line))) / (normalization * 2);
+    const double gz = (double(*(center - step * slice)) - double(*(center + step * slice))) / (normalization * 2);
+    return std::sqrt(gx * gx + gy * gy + gz * gz);
+}
+
+template <typename T>
+void gradientScalar(const T* data, const Core::Math::Vec3ui& size, size_t componentCount, uint32_t x0, uint32_t x1,
+                    uint32_t y, uint32_t z, double normalization, double* magnitudes) {
+    const size_t line = size.x;
+    const size_t slice = size_t(size.x) * size.y;
+    for (uint32_t x = x0; x < x1; ++x) {
+        const T* center = data + componentCount * (x + y * line + z * slice);
+        magnitudes[x - x0] = gradientMagnitude(center, componentCount, line, slice, normalization);
+    }
+}
+
+#ifdef TRINITY_BRICKSTATS_X86
+namespace sse41 {
+template <typename T> struct Ops { static const bool supported = false; };
+
+template <typename T> struct IntOps {
+    typedef __m128i V;
+    static const bool supported = true;
+    static const size_t lanes = 16 / sizeof(T);
+    TRINITY_TARGET_SSE41 static V load(const T* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    TRINITY_TARGET_SSE41 static void store(T* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+};
+
+// loads the bytes of two 8 or 16 bit values
+template <typename T> TRINITY_TARGET_SSE41 __m128i loadPair(const T* p) {
+    int32_t v = 0;
+    std::memcpy(&v, p, 2 * sizeof(T));
+    return _mm_cvtsi32_si128(v);
+}
+
+template <> struct Ops<uint8_t> : IntOps<uint8_t> {
+    TRINITY_TARGET_SSE41 static V min(V a, V b) { return _mm_min_epu8(a, b); }
+    TRINITY_TARGET_SSE41 static V max(V a, V b) { return _mm_max_epu8(a, b); }
+    TRINITY_TARGET_SSE41 static __m128d toDouble(const uint8_t* p) { return _mm_cvtepi32_pd(_mm_cvtepu8_epi32(loadPair(p))); }
+};
+template <> struct Ops<int8_t> : IntOps<int8_t> {
+    TRINITY_TARGET_SSE41 static V min(V a, V b) { return _mm_min_epi8(a, b); }
+    TRINITY_TARGET_SSE41 static V max(V a, V b) { return _mm_max_epi8(a, b); }
+    TRINITY_TARGET_SSE41 static __m128d toDouble(const int8_t* p) { return _mm_cvtepi32_pd(_mm_cvtepi8_epi32(loadPair(p))); }
+};
+template <> struct Ops<uint16_t> : IntOps<uint16_t> {
+    TRINITY_TARGET_SSE41 static V min(V a, V b) { return _mm_min_epu16(a, b); }
+    TRINITY_TARGET_SSE41 static V max(V a, V b) { return _mm_max_epu16(a, b); }
+    TRINITY_TARGET_SSE41 static __m128d toDouble(const uint16_t* p) { return _mm_cvtepi32_pd(_mm_cvtepu16_epi32(loadPair(p))); }
+};
+template <> struct Ops<int16_t> : IntOps<int16_t> {
+    TRINITY_TARGET_SSE41 static V min(V a, V b) { return _mm_min_epi16(a, b); }
+    TRINITY_TARGET_SSE41 static V max(V a, V b) { return _mm_max_epi16(a, b); }
+    TRINITY_TARGET_SSE41 static __m128d toDouble(const int16_t* p) { return _mm_cvtepi32_pd(_mm_cvtepi16_epi32(loadPair(p))); }
+};
+template <> struct Ops<uint32_t> : IntOps<uint32_t> {
+    TRINITY_TARGET_SSE41 static V min(V a, V b) { return _mm_min_epu32(a, b); }
+    TRINITY_TARGET_SSE41 static V max(V a, V b) { return _mm_max_epu32(a, b); }
+    // there is no unsigned conversion, so the values are shifted into the signed range and back
+    TRINITY_TARGET_SSE41 static __m128d toDouble(const uint32_t* p) {
+        const __m128i v = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi32(int32_t(0x80000000)));
+        return _mm_add_pd(_mm_cvtepi32_pd(v), _mm_set1_pd(2147483648.0));
+    }
+};
+template <> struct Ops<int32_t> : IntOps<int32_t> {
+    TRINITY_TARGET_SSE41 static V min(V a, V b) { return _mm_min_epi32(a, b); }
+    TRINITY_TARGET_SSE41 static V max(V a, V b) { return _mm_max_epi32(a, b); }
+    TRINITY_TARGET_SSE41 static __m128d toDouble(const int32_t* p) {
+        return _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    }
+};
+template <> struct Ops<float> {
+    typedef __m128 V;
+    static const bool supported = true;
+    static const size_t lanes = 4;
+    TRINITY_TARGET_SSE41 static V load(const float* p) { return _mm_loadu_ps(p); }
+    TRINITY_TARGET_SSE41 static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    TRINITY_TARGET_SSE41 static V min(V a, V b) { return _mm_min_ps(a, b); }
+    TRINITY_TARGET_SSE41 static V max(V a, V b) { return _mm_max_ps(a, b); }
+    TRINITY_TARGET_SSE41 static __m128d toDouble(const float* p) {
+        return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+    }
+};
+template <> struct Ops<double> {
+    typedef __m128d V;
+    static const bool supported = true;
+    static const size_t lanes = 2;
+    TRINITY_TARGET_SSE41 static V load(const double* p) { return _mm_loadu_pd(p); }
+    TRINITY_TARGET_SSE41 static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+    TRINITY_TARGET_SSE41 static V min(V a, V b) { return _mm_min_pd(a, b); }
+    TRINITY_TARGET_SSE41 static V max(V a, V b) { return _mm_max_pd(a, b); }
+    TRINITY_TARGET_SSE41 static __m128d toDouble(const double* p) { return _mm_loadu_pd(p); }
+};
+
+struct DoubleOps {
+    typedef __m128d V;
+    static const size_t lanes = 2;
+    TRINITY_TARGET_SSE41 static V set1(double v) { return _mm_set1_pd(v); }
+    TRINITY_TARGET_SSE41 static V add(V a, V b) { return _mm_add_pd(a, b); }
+    TRINITY_TARGET_SSE41 static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    TRINITY_TARGET_SSE41 static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    TRINITY_TARGET_SSE41 static V div(V a, V b) { return _mm_div_pd(a, b); }
+    TRINITY_TARGET_SSE41 static V sqrt(V a) { return _mm_sqrt_pd(a); }
+    TRINITY_TARGET_SSE41 static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+};
+
+#define TRINITY_KERNEL_TARGET TRINITY_TARGET_SSE41
+#include "common/BrickStatisticsKernels.inc"
+#undef TRINITY_KERNEL_TARGET
+}
+
+namespace avx2 {
+template <typename T> struct Ops { static const bool supported = false; };
+
+template <typename T> struct IntOps {
+    typedef __m256i V;
+    static const bool supported = true;
+    static const size_t lanes = 32 / sizeof(T);
+    TRINITY_TARGET_AVX2 static V load(const T* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    TRINITY_TARGET_AVX2 static void store(T* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+};
+
+// loads the bytes of four 8 bit values
+template <typename T> TRINITY_TARGET_AVX2 __m128i loadQuad(const T* p) {
+    int32_t v = 0;
+    std::memcpy(&v, p, 4);
+    return _mm_cvtsi32_si128(v);
+}
+
+template <> struct Ops<uint8_t> : IntOps<uint8_t> {
+    TRINITY_TARGET_AVX2 static V min(V a, V b) { return _mm256_min_epu8(a, b); }
+    TRINITY_TARGET_AVX2 static V max(V a, V b) { return _mm256_max_epu8(a, b); }
+    TRINITY_TARGET_AVX2 static __m256d toDouble(const uint8_t* p) { return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(loadQuad(p))); }
+};
+template <> struct Ops<int8_t> : IntOps<int8_t> {
+    TRINITY_TARGET_AVX2 static V min(V a, V b) { return _mm256_min_epi8(a, b); }
+    TRINITY_TARGET_AVX2 static V max(V a, V b) { return _mm256_max_epi8(a, b); }
+    TRINITY_TARGET_AVX2 static __m256d toDouble(const int8_t* p) { return _mm256_cvtepi32_pd(_mm_cvtepi8_epi32(loadQuad(p))); }
+};
+template <> struct Ops<uint16_t> : IntOps<uint16_t> {
+    TRINITY_TARGET_AVX2 static V min(V a, V b) { return _mm256_min_epu16(a, b); }
+    TRINITY_TARGET_AVX2 static V max(V a, V b) { return _mm256_max_epu16(a, b); }
+    TRINITY_TARGET_AVX2 static __m256d toDouble(const uint16_t* p) {
+        return _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+    }
+};
+template <> struct Ops<int16_t> : IntOps<int16_t> {
+    TRINITY_TARGET_AVX2 static V min(V a, V b) { return _mm256_min_epi16(a, b); }
+    TRINITY_TARGET_AVX2 static V max(V a, V b) { return _mm256_max_epi16(a, b); }
+    TRINITY_TARGET_AVX2 static __m256d toDouble(const int16_t* p) {
+        return _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+    }
+};
+template <> struct Ops<uint32_t> : IntOps<uint32_t> {
+    TRINITY_TARGET_AVX2 static V min(V a, V b) { return _mm256_min_epu32(a, b); }
+    TRINITY_TARGET_AVX2 static V max(V a, V b) { return _mm256_max_epu32(a, b); }
+    // there is no unsigned conversion, so the values are shifted into the signed range and back
+    TRINITY_TARGET_AVX2 static __m256d toDouble(const uint32_t* p) {
+        const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi32(int32_t(0x80000000)));
+        return _mm256_add_pd(_mm256_cvtepi32_pd(v), _mm256_set1_pd(2147483648.0));
+    }
+};
+template <> struct Ops<int32_t> : IntOps<int32_t> {
+    TRINITY_TARGET_AVX2 static V min(V a, V b) { return _mm256_min_epi32(a, b); }
+    TRINITY_TARGET_AVX2 static V max(V a, V b) { return _mm256_max_epi32(a, b); }
+    TRINITY_TARGET_AVX2 static __m256d toDouble(const int32_t* p) {
+        return _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+};
+template <> struct Ops<float> {
+    typedef __m256 V;
+    static const bool supported = true;
+    static const size_t lanes = 8;
+    TRINITY_TARGET_AVX2 static V load(const float* p) { return _mm256_loadu_ps(p); }
+    TRINITY_TARGET_AVX2 static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    TRINITY_TARGET_AVX2 static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    TRINITY_TARGET_AVX2 static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    TRINITY_TARGET_AVX2 static __m256d toDouble(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+};
+template <> struct Ops<double> {
+    typedef __m256d V;
+    static const bool supported = true;
+    static const size_t lanes = 4;
+    TRINITY_TARGET_AVX2 static V load(const double* p) { return _mm256_loadu_pd(p); }
+    TRINITY_TARGET_AVX2 static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+    TRINITY_TARGET_AVX2 static V min(V a, V b) { return _mm256_min_pd(a, b); }
+    TRINITY_TARGET_AVX2 static V max(V a, V b) { return _mm256_max_pd(a, b); }
+    TRINITY_TARGET_AVX2 static __m256d toDouble(const double* p) { return _mm256_loadu_pd(p); }
+};
+
+struct DoubleOps {
+    typedef __m256d V;
+    static const size_t lanes = 4;
+    TRINITY_TARGET_AVX2 static V set1(double v) { return _mm256_set1_pd(v); }
+    TRINITY_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    TRINITY_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    TRINITY_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    TRINITY_TARGET_AVX2 static V div(V a, V b) { return _mm256_div_pd(a, b); }
+    TRINITY_TARGET_AVX2 static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+    TRINITY_TARGET_AVX2 static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+};
+
+#define TRINITY_KERNEL_TARGET TRINITY_TARGET_AVX2
+#include "common/BrickStatisticsKernels.inc"
+#undef TRINITY_KERNEL_TARGET
+}
+#endif
+
+template <typename T>
+void minMaxDispatch(const T* data, size_t count, size_t componentCount, T* min, T* max, uint64_t* histogram) {
+    if (count == 0) return;
+    initMinMax(data, componentCount, min, max);
+#ifdef TRINITY_BRICKSTATS_X86
+    switch (static_cast<SimdLevel>(activeLevel().load(std::memory_order_relaxed))) {
+    case SimdLevel::AVX2:
+        if (avx2::Kernels<T>::minMax(data, count, componentCount, min, max, histogram)) return;
+        break;
+    case SimdLevel::SSE41:
+        if (sse41::Kernels<T>::minMax(data, count, componentCount, min, max, histogram)) return;
+        break;
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    minMaxScalar(data, count, componentCount, min, max, histogram);
+}
+}
+
+SimdLevel trinity::supportedSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+SimdLevel trinity::activeSimdLevel() {
+    return static_cast<SimdLevel>(activeLevel().load(std::memory_order_relaxed));
+}
+
+void trinity::setSimdLevel(SimdLevel level) {
+    activeLevel() = static_cast<int>(std::min(level, supportedSimdLevel()));
+}
+
+template <typename T> void trinity::minMax(const T* data, size_t count, size_t componentCount, T* min, T* max) {
+    minMaxDispatch(data, count, componentCount, min, max, nullptr);
+}
+
+template <typename T>
+void trinity::minMaxHistogram(const T* data, size_t count, size_t componentCount, T* min, T* max, uint64_t* histogram) {
+    minMaxDispatch(data, count, componentCount, min, max, histogram);
+}
+
+template <typename T>
+void trinity::gradientMagnitudes(const T* data, const Core::Math::Vec3ui& size, size_t componentCount, uint32_t x0,
+                                 uint32_t x1, uint32_t y, uint32_t z, double normalization, double* magnitudes) {
+    if (x1 <= x0) return;
+#ifdef TRINITY_BRICKSTATS_X86
+    switch (activeSimdLevel()) {
+    case SimdLevel::AVX2:
+        if (avx2::Kernels<T>::gradient(data, size, componentCount, x0, x1, y, z, normalization, magnitudes)) return;
+        break;
+    case SimdLevel::SSE41:
+        if (sse41::Kernels<T>::gradient(data, size, componentCount, x0, x1, y, z, normalization, magnitudes)) return;
+        break;
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    gradientScalar(data, size, componentCount, x0, x1, y, z, normalization, magnitudes);
+}
+
+#define TRINITY_INSTANTIATE_BRICKSTATS(T)                                                                                   \
+    template void trinity::minMax<T>(const T*, size_t, size_t, T*, T*);                                                     \
+    template void trinity::minMaxHistogram<T>(const T*, size_t, size_t, T*, T*, uint64_t*);                                 \
+    template void trinity::gradientMagnitudes<T>(const T*, const Core::Math::Vec3ui&, size_t, uint32_t, uint32_t, uint32_t, \
+                                                 uint32_t, double, double*);
+
+TRINITY_INSTANTIATE_BRICKSTATS(float)
+TRINITY_INSTANTIATE_BRICKSTATS(double)
+TRINITY_INSTANTIATE_BRICKSTATS(uint8_t)
+TRINITY_INSTANTIATE_BRICKSTATS(uint16_t)
+TRINITY_INSTANTIATE_BRICKSTATS(uint32_t)
+TRINITY_INSTANTIATE_BRICKSTATS(uint64_t)
+TRINITY_INSTANTIATE_BRICKSTATS(int8_t)
+TRINITY_INSTANTIATE_BRICKSTATS(int16_t)
+TRINITY_INSTANTIATE_BRICKSTATS(int32_t)
+TRINITY_INSTANTIATE_BRICKSTATS(int64_t)
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "silverbullet/math/Vectors.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Kernels for the statistics of brick data: value ranges, histograms and gradient magnitudes. They exist
+// for all value types of IIO::ValueType; the SSE4.1 and AVX2 implementations are chosen at runtime
+// depending on the CPU, everything else (64 bit integers, other CPUs) uses the scalar implementation.
+
+namespace trinity {
+
+enum class SimdLevel { Scalar, SSE41, AVX2 };
+
+// the best level the CPU supports, detected once
+SimdLevel supportedSimdLevel();
+// the level used by the kernels, supportedSimdLevel() unless lowered by setSimdLevel
+SimdLevel activeSimdLevel();
+// selects the implementation used by the kernels, e.g. to compare them; levels the CPU does not support
+// are lowered to the supported one
+void setSimdLevel(SimdLevel level);
+
+// minimum and maximum of count voxels with componentCount interleaved components, min and max receive
+// componentCount values each; for count 0 they are left untouched
+template <typename T> void minMax(const T* data, size_t count, size_t componentCount, T* min, T* max);
+
+// minMax fused with the histogram of the first component, every value v increments histogram[size_t(v)],
+// so the histogram must cover the value range of the data
+template <typename T>
+void minMaxHistogram(const T* data, size_t count, size_t componentCount, T* min, T* max, uint64_t* histogram);
+
+// magnitudes of the central difference gradients of the first component for the voxels [x0, x1) of line
+// (y, z) in a brick of the given size, the differences are divided by 2 * normalization; the voxels must
+// not lie on the border of the brick
+template <typename T>
+void gradientMagnitudes(const T* data, const Core::Math::Vec3ui& size, size_t componentCount, uint32_t x0, uint32_t x1,
+                        uint32_t y, uint32_t z, double normalization, double* magnitudes);
+}
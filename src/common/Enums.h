@@ -1,5 +1,7 @@
 #pragma once
 
 namespace trinity {
-    enum class CompressionMode { Compressed, Uncompressed };
+    // Framed: binary parts carry a header naming their codec (see commands/BinaryFrame.h), which allows
+    // forwarding data that is compressed already instead of compressing everything with blosc
+    enum class CompressionMode { Compressed, Uncompressed, Framed };
 }
\ No newline at end of file
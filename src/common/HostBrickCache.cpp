@@ -0,0 +1,154 @@
+#include "common/HostBrickCache.h"
+
+#include "lz4/lz4.h"
+
+#include <map>
+
+using namespace trinity;
+
+namespace {
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, std::weak_ptr<HostBrickCache>> caches;
+    std::shared_ptr<HostBrickCache::Budget> budget = HostBrickCache::makeBudget(HostBrickCache::defaultBudget);
+    bool compress = false;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+}
+
+const uint64_t HostBrickCache::defaultBudget;
+
+HostBrickCache::HostBrickCache(uint64_t budget, bool compress)
+    : HostBrickCache(makeBudget(budget), compress) {}
+
+HostBrickCache::HostBrickCache(std::shared_ptr<Budget> budget, bool compress)
+    : m_budget(std::move(budget))
+    , m_compress(compress)
+    , m_statistics() {}
+
+HostBrickCache::~HostBrickCache() {
+    // the bricks cannot be requested anymore, their bytes go back to the other caches of the budget
+    clear();
+}
+
+std::shared_ptr<HostBrickCache::Budget> HostBrickCache::makeBudget(uint64_t bytes) {
+    return std::make_shared<Budget>(bytes);
+}
+
+std::shared_ptr<HostBrickCache> HostBrickCache::forDataset(const std::string& datasetId) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (!reg.budget) {
+        return nullptr;
+    }
+    auto cache = reg.caches[datasetId].lock();
+    if (!cache) {
+        // forget the datasets nobody uses anymore
+        for (auto it = begin(reg.caches); it != end(reg.caches);) {
+            it = it->second.expired() ? reg.caches.erase(it) : std::next(it);
+        }
+        cache = std::make_shared<HostBrickCache>(reg.budget, reg.compress);
+        reg.caches[datasetId] = cache;
+    }
+    return cache;
+}
+
+void HostBrickCache::setDefaults(uint64_t budget, bool compress) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.budget = budget > 0 ? makeBudget(budget) : nullptr;
+    reg.compress = compress;
+}
+
+std::shared_ptr<std::vector<uint8_t>> HostBrickCache::get(const BrickKey& brickKey) {
+    std::shared_ptr<std::vector<uint8_t>> data;
+    uint64_t rawSize = 0;
+    bool compressed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_budget->m_mutex);
+        auto it = m_entries.find(brickKey);
+        if (it == end(m_entries)) {
+            ++m_statistics.misses;
+            return nullptr;
+        }
+        ++m_statistics.hits;
+        m_budget->m_lru.splice(begin(m_budget->m_lru), m_budget->m_lru, it->second);
+        data = it->second->data;
+        rawSize = it->second->rawSize;
+        compressed = it->second->compressed;
+    }
+    if (!compressed) {
+        return data;
+    }
+
+    // the block is never modified, so it can be decompressed outside of the lock
+    auto brick = std::make_shared<std::vector<uint8_t>>(size_t(rawSize));
+    const int size = LZ4_decompress_safe((const char*)data->data(), (char*)brick->data(), int(data->size()), int(rawSize));
+    return size == int(rawSize) ? brick : nullptr;
+}
+
+void HostBrickCache::put(const BrickKey& brickKey, std::shared_ptr<std::vector<uint8_t>> brick) {
+    if (!brick) {
+        return;
+    }
+    Entry entry{this, brickKey, std::move(brick), 0, false};
+    entry.rawSize = entry.data->size();
+    if (m_compress && entry.rawSize > 0) {
+        std::vector<uint8_t> block(size_t(LZ4_compressBound(int(entry.rawSize))));
+        const int size = LZ4_compress((const char*)entry.data->data(), (char*)block.data(), int(entry.rawSize));
+        if (size > 0 && uint64_t(size) < entry.rawSize) {
+            block.resize(size_t(size));
+            block.shrink_to_fit();
+            entry.data = std::make_shared<std::vector<uint8_t>>(std::move(block));
+            entry.compressed = true;
+        }
+    }
+
+    const uint64_t size = cachedSize(entry);
+    Budget& budget = *m_budget;
+    std::lock_guard<std::mutex> lock(budget.m_mutex);
+    if (size > budget.m_bytes || m_entries.find(brickKey) != end(m_entries)) {
+        return;
+    }
+    // the least recently used brick may belong to another cache of the budget
+    while (budget.m_cachedBytes + size > budget.m_bytes) {
+        auto victim = std::prev(end(budget.m_lru));
+        ++victim->cache->m_statistics.evictions;
+        victim->cache->erase(victim);
+    }
+    budget.m_lru.push_front(std::move(entry));
+    m_entries[brickKey] = begin(budget.m_lru);
+    budget.m_cachedBytes += size;
+    m_statistics.cachedBytes += size;
+    ++m_statistics.brickCount;
+}
+
+void HostBrickCache::clear() {
+    std::lock_guard<std::mutex> lock(m_budget->m_mutex);
+    while (!m_entries.empty()) {
+        erase(begin(m_entries)->second);
+    }
+}
+
+HostBrickCache::Statistics HostBrickCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(m_budget->m_mutex);
+    return m_statistics;
+}
+
+uint64_t HostBrickCache::cachedSize(const Entry& entry) {
+    // received bricks may come from a pool with rounded up capacities
+    return entry.data->capacity();
+}
+
+void HostBrickCache::erase(EntryList::iterator entry) {
+    const uint64_t size = cachedSize(*entry);
+    m_budget->m_cachedBytes -= size;
+    m_statistics.cachedBytes -= size;
+    --m_statistics.brickCount;
+    m_entries.erase(entry->key);
+    m_budget->m_lru.erase(entry);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "silverbullet/dataio/base/Brick.h"
+
+namespace trinity {
+
+// Keeps bricks received from an IO node in host memory, so a brick that was evicted from the GPU brick pool can be
+// uploaded again without another round trip to the IO node. Bricks are kept as received or, if enabled, LZ4
+// compressed when that makes them smaller; the least recently used bricks are dropped once the cached bytes exceed
+// the budget. All render sessions of a processing node that open the same dataset share one cache (see forDataset),
+// and the caches of all datasets share one budget, so the least recently used brick of any dataset is dropped first.
+class HostBrickCache {
+public:
+    static const uint64_t defaultBudget = uint64_t(1) << 30;
+
+    // the byte budget and the order of use of the bricks of all caches created with it
+    class Budget;
+
+    // creates a cache with a budget of its own
+    HostBrickCache(uint64_t budget = defaultBudget, bool compress = false);
+    HostBrickCache(std::shared_ptr<Budget> budget, bool compress = false);
+    ~HostBrickCache();
+
+    static std::shared_ptr<Budget> makeBudget(uint64_t bytes);
+
+    // returns the cache of the dataset, which lives as long as one of its users; nullptr if caching is disabled
+    static std::shared_ptr<HostBrickCache> forDataset(const std::string& datasetId);
+    // the budget is shared by the caches forDataset creates afterwards, a budget of 0 disables caching
+    static void setDefaults(uint64_t budget, bool compress);
+
+    // returns nullptr if the brick is not cached; cached bricks are shared and must not be modified
+    std::shared_ptr<std::vector<uint8_t>> get(const BrickKey& brickKey);
+    void put(const BrickKey& brickKey, std::shared_ptr<std::vector<uint8_t>> brick);
+    void clear();
+
+    struct Statistics {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t cachedBytes; // memory held by the cached bricks, after compression
+        uint64_t brickCount;
+    };
+    Statistics getStatistics() const;
+
+private:
+    struct Entry {
+        HostBrickCache* cache;
+        BrickKey key;
+        std::shared_ptr<std::vector<uint8_t>> data; // the brick itself or its LZ4 block
+        uint64_t rawSize;
+        bool compressed;
+    };
+    using EntryList = std::list<Entry>;
+
+    static uint64_t cachedSize(const Entry& entry);
+    // requires the lock of the budget
+    void erase(EntryList::iterator entry);
+
+private:
+    const std::shared_ptr<Budget> m_budget;
+    const bool m_compress;
+
+    // guarded by the mutex of the budget, the entries are in its list
+    std::unordered_map<BrickKey, EntryList::iterator, BKeyHash> m_entries;
+    Statistics m_statistics;
+};
+
+class HostBrickCache::Budget {
+public:
+    explicit Budget(uint64_t bytes)
+        : m_bytes(bytes)
+        , m_cachedBytes(0) {}
+
+private:
+    friend class HostBrickCache;
+
+    const uint64_t m_bytes;
+    std::mutex m_mutex;
+    // the bricks of all caches, most recently used brick first
+    EntryList m_lru;
+    uint64_t m_cachedBytes;
+};
+}
@@ -27,4 +27,26 @@ const IIO::ValueTypeMapper& IIO::valueTypeMapper() {
         mapper.insert(ValueType::T_INT64, "T_INT64");
     }
     return mapper;
+}
+
+std::shared_ptr<std::vector<uint8_t>> IIO::getEncodedBrick(const BrickKey& brickKey) const {
+    return nullptr;
+}
+
+BinaryView IIO::getBrickView(const BrickKey& brickKey) const {
+    return BinaryView();
+}
+
+std::vector<std::shared_ptr<std::vector<uint8_t>>> IIO::getBricks(const std::vector<BrickKey>& brickKeys,
+                                                                  std::vector<bool>& success) const {
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> result;
+    result.reserve(brickKeys.size());
+    success.clear();
+    success.reserve(brickKeys.size());
+    for (const auto& key : brickKeys) {
+        bool brickSuccess = false;
+        result.push_back(getBrick(key, brickSuccess));
+        success.push_back(brickSuccess);
+    }
+    return result;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "commands/TransferFunction1D.h"
 
+#include "commands/BinaryView.h"
 #include "commands/BrickMetaData.h"
 
 #include "silverbullet/dataio/base/Brick.h"
@@ -12,6 +13,7 @@
 
 namespace trinity {
 
+  // the methods are called concurrently by the workers of an IOSession
   class IIO {
   public:
     virtual ~IIO() {}
@@ -45,10 +47,23 @@ namespace trinity {
     virtual Core::Math::Vec2f getRange(uint64_t modality) const = 0;
     virtual uint64_t getTotalBrickCount(uint64_t modality) const = 0;
     virtual std::shared_ptr<std::vector<uint8_t>> getBrick(const BrickKey& brickKey, bool& success) const = 0;
+    // fetches several bricks at once; the default implementation simply calls getBrick for each key
+    virtual std::vector<std::shared_ptr<std::vector<uint8_t>>> getBricks(const std::vector<BrickKey>& brickKeys,
+                                                                         std::vector<bool>& success) const;
+    // returns the brick as stored by the backend, wrapped into a binary frame (see commands/BinaryFrame.h), so
+    // it can be forwarded without decompressing and recompressing it; nullptr if the brick is not stored in a
+    // forwardable form, the default implementation always returns nullptr
+    virtual std::shared_ptr<std::vector<uint8_t>> getEncodedBrick(const BrickKey& brickKey) const;
+    // returns the brick as a view into memory owned by the backend (e.g. a memory mapped file), so it can be sent
+    // without copying it first; an empty view if the brick is not available like that, which the default
+    // implementation always returns
+    virtual BinaryView getBrickView(const BrickKey& brickKey) const;
     virtual ValueType getType(uint64_t modality) const = 0;
     virtual Semantic getSemantic(uint64_t modality) const = 0;
     virtual uint64_t getDefault1DTransferFunctionCount() const = 0;
     virtual uint64_t getDefault2DTransferFunctionCount() const = 0;
+    // histograms of the (first component of the) data for transfer function editing, empty if the backend cannot
+    // provide them; the 2D histogram consists of one row of 256 gradient magnitude bins per value bin
     virtual std::vector<uint64_t> get1DHistogram() const = 0;
     virtual std::vector<uint64_t> get2DHistogram() const = 0;
     virtual TransferFunction1D getDefault1DTransferFunction(uint64_t index) const = 0;
@@ -19,7 +19,7 @@ IONodeProxy::IONodeProxy(const mocca::net::Endpoint& ep)
 std::unique_ptr<IOSessionProxy> IONodeProxy::initIO(const std::string& fileId, bool useLoopback) {
     std::string protocol = useLoopback ? trinity::ioLoopbackEndpoint().protocol : m_inputChannel.getEndpoint().protocol;
     std::string machine = useLoopback ? trinity::ioLoopbackEndpoint().machine : m_inputChannel.getEndpoint().machine;
-    auto compressionMode = useLoopback ? CompressionMode::Uncompressed : CompressionMode::Compressed;
+    auto compressionMode = useLoopback ? CompressionMode::Uncompressed : CompressionMode::Framed;
 
     InitIOSessionCmd::RequestParams params(protocol, fileId);
     InitIOSessionRequest request(params, IDGenerator::nextID(), 0);
@@ -29,7 +29,10 @@ std::unique_ptr<IOSessionProxy> IONodeProxy::initIO(const std::string& fileId, b
     // BIG TODO HERE!!!
     mocca::net::Endpoint controlEndpoint(protocol, machine, reply->getParams().getControlPort());   
 
-    return mocca::make_unique<IOSessionProxy>(reply->getSid(), controlEndpoint, compressionMode);
+    auto ioSession = mocca::make_unique<IOSessionProxy>(reply->getSid(), controlEndpoint, compressionMode);
+    // sessions that open the same file on the same io node share the bricks received so far
+    ioSession->setBrickCache(HostBrickCache::forDataset(m_inputChannel.getEndpoint().toString() + "|" + fileId));
+    return ioSession;
 }
 
 std::vector<IOData> IONodeProxy::listFiles(const std::string& dirID) const {
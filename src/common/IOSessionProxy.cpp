@@ -1,4 +1,6 @@
 #include "IOSessionProxy.h"
+#include <algorithm>
+#include <deque>
 #include <thread>
 
 #include "commands/ErrorCommands.h"
@@ -12,45 +14,40 @@ using namespace trinity;
 
 IOSessionProxy::IOSessionProxy(const int remoteSid, const mocca::net::Endpoint& ioEndpoint, CompressionMode compressionMode)
     : m_inputChannel(ioEndpoint, compressionMode)
-    , m_remoteSid(remoteSid) {
+    , m_remoteSid(remoteSid)
+    , m_bricksPerBatch(defaultBricksPerBatch)
+    , m_maxBatchesInFlight(defaultMaxBatchesInFlight) {
     if (!connectInputChannel(m_inputChannel)) {
         throw TrinityError("Error connecting to IO session", __FILE__, __LINE__);
     }
+
+    // immutable dataset facts are fetched once and answered locally afterwards
+    GetDatasetDescriptorCmd::RequestParams params;
+    GetDatasetDescriptorRequest request(params, IDGenerator::nextID(), m_remoteSid);
+    auto reply = sendRequestChecked(m_inputChannel, request);
+    m_descriptor = reply->releaseParams().releaseDescriptor();
+    // from now on no binary part may be larger than the largest brick of the dataset
+    m_inputChannel.setMaxBinaryPartSize(m_descriptor.getMaxBinaryPartSize());
 }
 
 Core::Math::Vec3ui64 IOSessionProxy::getMaxBrickSize() const {
-    GetMaxBrickSizeCmd::RequestParams params;
-    GetMaxBrickSizeRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getMaxBrickSize();
+    return m_descriptor.getMaxBrickSize();
 }
 
 Core::Math::Vec3ui64 IOSessionProxy::getMaxUsedBrickSizes() const {
-    GetMaxUsedBrickSizesCmd::RequestParams params;
-    GetMaxUsedBrickSizesRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getMaxUsedBrickSizes();
+    return m_descriptor.getMaxUsedBrickSizes();
 }
 
 uint64_t IOSessionProxy::getLODLevelCount(uint64_t modality) const {
-    GetLODLevelCountCmd::RequestParams params(modality);
-    GetLODLevelCountRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getLODLevelCount();
+    return m_descriptor.getLODLevelCount(modality);
 }
 
 uint64_t IOSessionProxy::getNumberOfTimesteps() const {
-    GetNumberOfTimestepsCmd::RequestParams params;
-    GetNumberOfTimestepsRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getNumberOfTimesteps();
+    return m_descriptor.getNumberOfTimesteps();
 }
 
 Core::Math::Vec3ui64 IOSessionProxy::getDomainSize(uint64_t lod, uint64_t modality) const {
-    GetDomainSizeCmd::RequestParams params(lod, modality);
-    GetDomainSizeRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getDomainSize();
+    return m_descriptor.getDomainSize(lod, modality);
 }
 
 Core::Math::Mat4d IOSessionProxy::getTransformation(uint64_t modality) const {
@@ -61,89 +58,67 @@ Core::Math::Mat4d IOSessionProxy::getTransformation(uint64_t modality) const {
 }
 
 Core::Math::Vec3ui IOSessionProxy::getBrickOverlapSize() const {
-    GetBrickOverlapSizeCmd::RequestParams params;
-    GetBrickOverlapSizeRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getOverlapSize();
+    return m_descriptor.getBrickOverlapSize();
 }
 
 uint64_t IOSessionProxy::getLargestSingleBrickLOD(uint64_t modality) const {
-    GetLargestSingleBrickLODCmd::RequestParams params(modality);
-    GetLargestSingleBrickLODRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getLargestSingleBrickLOD();
+    return m_descriptor.getLargestSingleBrickLOD(modality);
 }
 
 Core::Math::Vec3ui IOSessionProxy::getBrickVoxelCounts(const BrickKey& brickKey) const {
-    GetBrickVoxelCountsCmd::RequestParams params(brickKey);
-    GetBrickVoxelCountsRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getBrickVoxelCounts();
+    return m_descriptor.getBrickVoxelCounts(brickKey);
 }
 
 Core::Math::Vec3f IOSessionProxy::getBrickExtents(const BrickKey& brickKey) const {
-    GetBrickExtentsCmd::RequestParams params(brickKey);
-    GetBrickExtentsRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getBrickExtents();
+    return m_descriptor.getBrickExtents(brickKey);
 }
 
 Core::Math::Vec3ui IOSessionProxy::getBrickLayout(uint64_t lod, uint64_t modality) const {
-    GetBrickLayoutCmd::RequestParams params(lod, modality);
-    GetBrickLayoutRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getBrickLayout();
+    return m_descriptor.getBrickLayout(lod, modality);
 }
 
 uint64_t IOSessionProxy::getModalityCount() const {
-    GetModalityCountCmd::RequestParams params;
-    GetModalityCountRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getModalityCount();
+    return m_descriptor.getModalityCount();
 }
 
 uint64_t IOSessionProxy::getComponentCount(uint64_t modality) const {
-    GetComponentCountCmd::RequestParams params(modality);
-    GetComponentCountRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getComponentCount();
+    return m_descriptor.getComponentCount(modality);
 }
 
 Core::Math::Vec2f IOSessionProxy::getRange(uint64_t modality) const {
-    GetRangeCmd::RequestParams params(modality);
-    GetRangeRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getRange();
+    return m_descriptor.getRange(modality);
 }
 
 uint64_t IOSessionProxy::getTotalBrickCount(uint64_t modality) const {
-    GetTotalBrickCountCmd::RequestParams params(modality);
-    GetTotalBrickCountRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getTotalBrickCount();
+    return m_descriptor.getTotalBrickCount(modality);
 }
 
 std::shared_ptr<std::vector<uint8_t>> IOSessionProxy::getBrick(const BrickKey& brickKey, bool& success) const {
+    if (m_brickCache) {
+        auto brick = m_brickCache->get(brickKey);
+        if (brick) {
+            success = true;
+            return brick;
+        }
+    }
     GetBrickCmd::RequestParams params(brickKey);
     GetBrickRequest request(params, IDGenerator::nextID(), m_remoteSid);
     auto reply = sendRequestChecked(m_inputChannel, request);
     const auto replyParams = reply->getParams();
     success = replyParams.getSuccess();
-    return replyParams.getBrick();
+    auto brick = replyParams.getBrick();
+    if (success && m_brickCache) {
+        m_brickCache->put(brickKey, brick);
+    }
+    return brick;
 }
 
 IIO::ValueType IOSessionProxy::getType(uint64_t modality) const {
-    GetTypeCmd::RequestParams params(modality);
-    GetTypeRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getValueType();
+    return m_descriptor.getType(modality);
 }
 
 IIO::Semantic IOSessionProxy::getSemantic(uint64_t modality) const {
-    GetSemanticCmd::RequestParams params(modality);
-    GetSemanticRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getSemantic();
+    return m_descriptor.getSemantic(modality);
 }
 
 uint64_t IOSessionProxy::getDefault1DTransferFunctionCount() const {
@@ -189,17 +164,11 @@ TransferFunction1D IOSessionProxy::getDefault1DTransferFunction(uint64_t index)
 }
 
 Core::Math::Vec3f IOSessionProxy::getDomainScale(uint64_t modality) const {
-    GetDomainScaleCmd::RequestParams params(modality);
-    GetDomainScaleRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getResult();
+    return m_descriptor.getDomainScale(modality);
 }
 
 Core::Math::Vec3f IOSessionProxy::getFloatBrickLayout(uint64_t lod, uint64_t modality) const {
-    GetFloatBrickLayoutCmd::RequestParams params(lod, modality);
-    GetFloatBrickLayoutRequest request(params, IDGenerator::nextID(), m_remoteSid);
-    auto reply = sendRequestChecked(m_inputChannel, request);
-    return reply->getParams().getResult();
+    return m_descriptor.getFloatBrickLayout(lod, modality);
 }
 
 std::vector<BrickMetaData> IOSessionProxy::getBrickMetaData(uint64_t modality, uint64_t timestep) const {
@@ -209,4 +178,98 @@ std::vector<BrickMetaData> IOSessionProxy::getBrickMetaData(uint64_t modality, u
     return reply->releaseParams().releaseResult();
 }
 
+std::vector<std::shared_ptr<std::vector<uint8_t>>> IOSessionProxy::getBricks(const std::vector<BrickKey>& brickKeys,
+                                                                             std::vector<bool>& success) const {
+    if (!m_brickCache) {
+        return fetchBricks(brickKeys, success);
+    }
+
+    // only the bricks missing in the cache are requested from the io session
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> result(brickKeys.size());
+    success.assign(brickKeys.size(), true);
+    std::vector<BrickKey> missingKeys;
+    std::vector<size_t> missingIndices;
+    for (size_t i = 0; i < brickKeys.size(); ++i) {
+        result[i] = m_brickCache->get(brickKeys[i]);
+        if (!result[i]) {
+            missingKeys.push_back(brickKeys[i]);
+            missingIndices.push_back(i);
+        }
+    }
+    if (missingKeys.empty()) {
+        return result;
+    }
+
+    std::vector<bool> fetchedSuccess;
+    const auto fetched = fetchBricks(missingKeys, fetchedSuccess);
+    for (size_t j = 0; j < missingKeys.size(); ++j) {
+        result[missingIndices[j]] = fetched[j];
+        success[missingIndices[j]] = fetchedSuccess[j];
+        if (fetchedSuccess[j]) {
+            m_brickCache->put(missingKeys[j], fetched[j]);
+        }
+    }
+    return result;
+}
+
+std::vector<std::shared_ptr<std::vector<uint8_t>>> IOSessionProxy::fetchBricks(const std::vector<BrickKey>& brickKeys,
+                                                                               std::vector<bool>& success) const {
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> result;
+    result.reserve(brickKeys.size());
+    success.clear();
+    success.reserve(brickKeys.size());
+
+    // the keys are split into batches; up to maxBatchesInFlight requests are sent before the first reply is
+    // awaited, so that the io session works on several batches concurrently while replies are being transferred;
+    // concurrent calls share the channel, so the batches of all of them are in flight together
+    size_t bricksPerBatch, maxBatchesInFlight;
+    {
+        std::lock_guard<std::mutex> lock(m_batchingMutex);
+        bricksPerBatch = m_bricksPerBatch;
+        maxBatchesInFlight = m_maxBatchesInFlight;
+    }
+    std::deque<GetBricksRequest> inFlight;
+    auto nextKey = begin(brickKeys);
+    while (nextKey != end(brickKeys) || !inFlight.empty()) {
+        while (nextKey != end(brickKeys) && inFlight.size() < maxBatchesInFlight) {
+            const auto batchSize = std::min<size_t>(bricksPerBatch, std::distance(nextKey, end(brickKeys)));
+            GetBricksCmd::RequestParams params(std::vector<BrickKey>(nextKey, nextKey + batchSize));
+            inFlight.emplace_back(params, IDGenerator::nextID(), m_remoteSid);
+            m_inputChannel.sendRequest(inFlight.back());
+            nextKey += batchSize;
+        }
+        const auto request = inFlight.front();
+        inFlight.pop_front();
+        std::unique_ptr<GetBricksReply> reply;
+        try {
+            reply = receiveReplyChecked(m_inputChannel, request);
+        } catch (const TrinityError&) {
+            // drain the replies of the remaining batches, they would be kept by the channel otherwise
+            for (const auto& pending : inFlight) {
+                m_inputChannel.getReply(pending.getRid());
+            }
+            throw;
+        }
+        const auto replyParams = reply->getParams();
+        const auto bricks = replyParams.getBricks();
+        const auto batchSuccess = replyParams.getSuccess();
+        result.insert(end(result), begin(bricks), end(bricks));
+        success.insert(end(success), begin(batchSuccess), end(batchSuccess));
+    }
+    return result;
+}
+
+void IOSessionProxy::setBrickBatching(size_t bricksPerBatch, size_t maxBatchesInFlight) {
+    if (bricksPerBatch == 0 || maxBatchesInFlight == 0) {
+        throw TrinityError("Invalid brick batching parameters", __FILE__, __LINE__);
+    }
+    std::lock_guard<std::mutex> lock(m_batchingMutex);
+    m_bricksPerBatch = bricksPerBatch;
+    m_maxBatchesInFlight = maxBatchesInFlight;
+}
+
+void IOSessionProxy::setBrickCache(std::shared_ptr<HostBrickCache> brickCache) {
+    m_brickCache = std::move(brickCache);
+}
+
 /* AUTOGEN IOSessionProxyImpl */
\ No newline at end of file
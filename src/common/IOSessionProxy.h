@@ -1,12 +1,15 @@
 #pragma once
 
+#include "common/HostBrickCache.h"
 #include "common/IIO.h"
 #include "commands/CommandInputChannel.h"
+#include "commands/DatasetDescriptor.h"
 
 #include "mocca/net/Endpoint.h"
 #include "mocca/net/IMessageConnection.h"
 
 #include <memory>
+#include <mutex>
 
 namespace trinity {
 
@@ -14,6 +17,10 @@ class IOSessionProxy : public IIO {
 
 public:
     IOSessionProxy(const int remoteSid, const mocca::net::Endpoint& ioEndpoint, CompressionMode compressionMode);
+
+    static const size_t defaultBricksPerBatch = 8;
+    static const size_t defaultMaxBatchesInFlight = 4;
+
     Core::Math::Vec3ui64 getMaxBrickSize() const override;
     Core::Math::Vec3ui64 getMaxUsedBrickSizes() const override;
     uint64_t getLODLevelCount(uint64_t modality) const override;
@@ -41,10 +48,24 @@ public:
     Core::Math::Vec3f getDomainScale(uint64_t modality) const override;
     Core::Math::Vec3f getFloatBrickLayout(uint64_t lod, uint64_t modality) const override;
     std::vector<BrickMetaData> getBrickMetaData(uint64_t modality, uint64_t timestep) const override;
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> getBricks(const std::vector<BrickKey>& brickKeys,
+                                                                 std::vector<bool>& success) const override;
     /* AUTOGEN IOInterfaceOverride */
 
+    void setBrickBatching(size_t bricksPerBatch, size_t maxBatchesInFlight);
+    // bricks found in the cache are not requested from the io session, received bricks are added to it
+    void setBrickCache(std::shared_ptr<HostBrickCache> brickCache);
+
 private:
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> fetchBricks(const std::vector<BrickKey>& brickKeys,
+                                                                   std::vector<bool>& success) const;
+
     CommandInputChannel m_inputChannel;
     const int m_remoteSid;
+    mutable std::mutex m_batchingMutex;
+    size_t m_bricksPerBatch;
+    size_t m_maxBatchesInFlight;
+    DatasetDescriptor m_descriptor;
+    std::shared_ptr<HostBrickCache> m_brickCache;
 };
 }
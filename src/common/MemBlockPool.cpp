@@ -5,23 +5,75 @@
 
 #include <algorithm>
 
-MemBlockPool::MemBlockPool() {
-    std::vector<std::pair<size_t, size_t>> initialSizes{
-        { 16, 512 * 1024 },
-        { 64, 1024 * 1024 },
-        { 64, 2 * 1024 * 1024 },
-        { 32, 4 * 1024 * 1024 },
-        { 16, 8 * 1024 * 1024 },
-        { 4, 16 * 1024 * 1024 }
-    };
-    for (const auto& s : initialSizes) {
-        for (size_t i = 0; i < s.first; ++i) {
-            m_capacities.push_back(s.second);
-            auto block = mocca::make_unique<std::vector<uint8_t>>();
-            block->reserve(s.second);
-            m_pool.push_back(std::move(block));
+namespace {
+uint32_t nodeOf(uint64_t head) {
+    return static_cast<uint32_t>(head);
+}
+
+uint64_t nextHead(uint64_t head, uint32_t node) {
+    return ((head >> 32) + 1) << 32 | node;
+}
+}
+
+MemBlockPool::FreeList::FreeList()
+    : m_head(invalidNode) {}
+
+void MemBlockPool::FreeList::push(MemBlockPool& pool, uint32_t index) {
+    Node& node = pool.node(index);
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    do {
+        node.next.store(nodeOf(head), std::memory_order_relaxed);
+    } while (!m_head.compare_exchange_weak(head, nextHead(head, index), std::memory_order_release, std::memory_order_relaxed));
+}
+
+uint32_t MemBlockPool::FreeList::pop(MemBlockPool& pool) {
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    while (nodeOf(head) != invalidNode) {
+        // the node may be popped concurrently, but it stays valid and the tag makes the exchange fail then
+        const uint32_t next = pool.node(nodeOf(head)).next.load(std::memory_order_relaxed);
+        if (m_head.compare_exchange_weak(head, nextHead(head, next), std::memory_order_acquire, std::memory_order_acquire)) {
+            return nodeOf(head);
         }
     }
+    return invalidNode;
+}
+
+MemBlockPool::ThreadCache::ThreadCache()
+    : bytes(0) {
+    for (size_t i = 0; i < classCount; ++i) {
+        nodes[i].reserve(threadCacheLimit(i));
+    }
+}
+
+MemBlockPool::ThreadCache::~ThreadCache() {
+    // hand the cached blocks back to the shared free lists when the thread exits
+    auto& pool = MemBlockPool::instance();
+    for (size_t i = 0; i < classCount; ++i) {
+        for (auto index : nodes[i]) {
+            pool.m_freeLists[i].push(pool, index);
+        }
+    }
+}
+
+MemBlockPool::MemBlockPool()
+    : m_nodeCount(0)
+    , m_memoryCap(0)
+    , m_pooledBytes(0)
+    , m_usedBytes(0)
+    , m_highWaterMark(0)
+    , m_allocations(0)
+    , m_reuses(0)
+    , m_oversized(0)
+    , m_capped(0) {
+    for (auto& segment : m_segments) {
+        segment = nullptr;
+    }
+}
+
+MemBlockPool::~MemBlockPool() {
+    for (auto& segment : m_segments) {
+        delete[] segment.load();
+    }
 }
 
 MemBlockPool& MemBlockPool::instance() {
@@ -29,35 +81,136 @@ MemBlockPool& MemBlockPool::instance() {
     return pool;
 }
 
+MemBlockPool::ThreadCache& MemBlockPool::threadCache() {
+    static thread_local ThreadCache cache;
+    return cache;
+}
+
+size_t MemBlockPool::classSize(size_t sizeClass) {
+    return size_t(1) << (minClassShift + sizeClass);
+}
+
+size_t MemBlockPool::threadCacheLimit(size_t sizeClass) {
+    const size_t blocks = threadCacheBytes / classSize(sizeClass);
+    return blocks < threadCacheBlocks ? blocks : threadCacheBlocks;
+}
+
+MemBlockPool::Node& MemBlockPool::node(uint32_t index) {
+    return m_segments[index >> segmentShift].load(std::memory_order_acquire)[index & (segmentSize - 1)];
+}
+
 MemBlockPool::MemBlock MemBlockPool::get(size_t capacity) {
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto capIt = std::lower_bound(begin(m_capacities), end(m_capacities), capacity);
-        if (capIt != end(m_capacities)) {
-            auto poolIt = begin(m_pool);
-            std::advance(poolIt, std::distance(begin(m_capacities), capIt));
-            m_capacities.erase(capIt);
-            auto block = std::move(*poolIt);
-            m_pool.erase(poolIt);
-            return MemBlock(block.release(), Deleter());
+    size_t sizeClass = 0;
+    while (sizeClass < classCount && classSize(sizeClass) < capacity) {
+        ++sizeClass;
+    }
+
+    uint32_t index = invalidNode;
+    if (sizeClass < classCount) {
+        index = acquire(sizeClass);
+    } else {
+        ++m_oversized;
+        LDEBUG("MemBlockPool: Could not satisfy request for block of size " << capacity);
+    }
+
+    if (index == invalidNode) {
+        MemBlock block = std::make_shared<std::vector<uint8_t>>();
+        block->reserve(capacity);
+        return block;
+    }
+
+    const uint64_t used = m_usedBytes += classSize(sizeClass);
+    uint64_t highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+    while (used > highWaterMark && !m_highWaterMark.compare_exchange_weak(highWaterMark, used, std::memory_order_relaxed)) {
+    }
+    return MemBlock(node(index).block.get(), Deleter{index});
+}
+
+uint32_t MemBlockPool::acquire(size_t sizeClass) {
+    auto& cache = threadCache();
+    auto& cached = cache.nodes[sizeClass];
+    if (!cached.empty()) {
+        const uint32_t index = cached.back();
+        cached.pop_back();
+        cache.bytes -= classSize(sizeClass);
+        ++m_reuses;
+        return index;
+    }
+    const uint32_t index = m_freeLists[sizeClass].pop(*this);
+    if (index != invalidNode) {
+        ++m_reuses;
+        return index;
+    }
+    return createNode(sizeClass);
+}
+
+uint32_t MemBlockPool::createNode(size_t sizeClass) {
+    const uint64_t size = classSize(sizeClass);
+    const uint64_t cap = m_memoryCap.load(std::memory_order_relaxed);
+    if ((m_pooledBytes += size) > cap && cap != 0) {
+        m_pooledBytes -= size;
+        ++m_capped;
+        return invalidNode;
+    }
+
+    const uint32_t index = m_nodeCount++;
+    const size_t segment = index >> segmentShift;
+    if (segment >= maxSegments) {
+        m_pooledBytes -= size;
+        ++m_capped;
+        return invalidNode;
+    }
+    if (!m_segments[segment].load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_segmentMutex);
+        if (!m_segments[segment].load(std::memory_order_relaxed)) {
+            m_segments[segment].store(new Node[segmentSize], std::memory_order_release);
         }
     }
-    LDEBUG("MemBlockPool: Could not satisfy request for block of size " << capacity);
-    MemBlock block = std::make_shared<std::vector<uint8_t>>();
-    block->reserve(capacity);
-    return block;
+
+    Node& newNode = node(index);
+    newNode.block = mocca::make_unique<std::vector<uint8_t>>();
+    newNode.block->reserve(size);
+    newNode.sizeClass = static_cast<uint32_t>(sizeClass);
+    ++m_allocations;
+    return index;
 }
 
-void MemBlockPool::Deleter::operator()(std::vector<uint8_t>* p) const {
-    p->clear();
-    std::unique_ptr<std::vector<uint8_t>> ptr(p);
-    auto& inst = MemBlockPool::instance();
-    {
-        std::lock_guard<std::mutex> lock(inst.m_mutex);
-        auto capIt = std::lower_bound(begin(inst.m_capacities), end(inst.m_capacities), p->capacity());
-        auto poolIt = begin(inst.m_pool);
-        std::advance(poolIt, std::distance(begin(inst.m_capacities), capIt));
-        inst.m_capacities.insert(capIt, p->capacity());
-        inst.m_pool.insert(poolIt, std::move(ptr));
+void MemBlockPool::release(uint32_t index) {
+    Node& released = node(index);
+    const size_t size = classSize(released.sizeClass);
+    released.block->clear();
+    if (released.block->capacity() < size) {
+        // the owner has swapped the storage away or shrunk it
+        released.block->reserve(size);
+    }
+    m_usedBytes -= size;
+
+    auto& cache = threadCache();
+    auto& cached = cache.nodes[released.sizeClass];
+    if (cached.size() < threadCacheLimit(released.sizeClass) && cache.bytes + size <= threadCacheBytes) {
+        cached.push_back(index);
+        cache.bytes += size;
+    } else {
+        m_freeLists[released.sizeClass].push(*this, index);
     }
+}
+
+void MemBlockPool::Deleter::operator()(std::vector<uint8_t>*) const {
+    MemBlockPool::instance().release(node);
+}
+
+MemBlockPool::Statistics MemBlockPool::getStatistics() const {
+    Statistics statistics;
+    statistics.pooledBytes = m_pooledBytes;
+    statistics.usedBytes = m_usedBytes;
+    statistics.highWaterMark = m_highWaterMark;
+    statistics.allocations = m_allocations;
+    statistics.reuses = m_reuses;
+    statistics.oversized = m_oversized;
+    statistics.capped = m_capped;
+    return statistics;
+}
+
+void MemBlockPool::setMemoryCap(uint64_t bytes) {
+    m_memoryCap = bytes;
 }
\ No newline at end of file
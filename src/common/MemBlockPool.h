@@ -1,9 +1,16 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <mutex>
 
+// Pool of reusable byte buffers. Requests are rounded up to power of two size
+// classes; each class keeps its free blocks in a lock-free stack, and every
+// thread caches a few blocks per class so most get/release pairs do not touch
+// shared state at all. The thread caches are bounded in bytes, blocks beyond
+// the bound go back to the shared free lists where other threads can use them.
 class MemBlockPool {
 public:
     static MemBlockPool& instance();
@@ -11,15 +18,86 @@ public:
     using MemBlock = std::shared_ptr<std::vector<uint8_t>>;
     MemBlock get(size_t capacity = 1024 * 1024);
 
+    struct Statistics {
+        uint64_t pooledBytes;   // capacity of all blocks owned by the pool, free or in use
+        uint64_t usedBytes;     // capacity of the pooled blocks currently handed out
+        uint64_t highWaterMark; // maximum of usedBytes so far
+        uint64_t allocations;   // pooled blocks that had to be allocated
+        uint64_t reuses;        // requests served by a free block
+        uint64_t oversized;     // requests larger than the largest size class, not pooled
+        uint64_t capped;        // requests not pooled because of the memory cap
+    };
+    Statistics getStatistics() const;
+
+    // limits pooledBytes, requests beyond the cap are served by unpooled blocks; 0 disables the cap
+    void setMemoryCap(uint64_t bytes);
+
 private:
+    static const size_t minClassShift = 16; // 64 KiB
+    static const size_t classCount = 11;    // up to 64 MiB
+    static const size_t threadCacheBytes = 4 * 1024 * 1024; // all classes of one thread together
+    static const size_t threadCacheBlocks = 8;               // per class
+    static const uint32_t invalidNode = 0xffffffff;
+    static const size_t segmentShift = 10;
+    static const size_t segmentSize = size_t(1) << segmentShift;
+    static const size_t maxSegments = 1024;
+
+    struct Node {
+        std::unique_ptr<std::vector<uint8_t>> block;
+        std::atomic<uint32_t> next;
+        uint32_t sizeClass;
+    };
+
+    // lock-free stack of node indices; the head carries a tag in its upper half that changes with
+    // every update, so a pop cannot succeed on a head that has been popped and pushed again (ABA)
+    class FreeList {
+    public:
+        FreeList();
+        void push(MemBlockPool& pool, uint32_t index);
+        uint32_t pop(MemBlockPool& pool);
+
+    private:
+        std::atomic<uint64_t> m_head;
+    };
+
+    struct ThreadCache {
+        ThreadCache();
+        ~ThreadCache();
+        std::array<std::vector<uint32_t>, classCount> nodes;
+        size_t bytes;
+    };
+
     struct Deleter {
+        uint32_t node;
         void operator()(std::vector<uint8_t>* p) const;
     };
 
     MemBlockPool();
+    ~MemBlockPool();
+
+    static ThreadCache& threadCache();
+    static size_t classSize(size_t sizeClass);
+    static size_t threadCacheLimit(size_t sizeClass);
+
+    Node& node(uint32_t index);
+    uint32_t acquire(size_t sizeClass);
+    uint32_t createNode(size_t sizeClass);
+    void release(uint32_t index);
 
 private:
-    std::vector<size_t> m_capacities;
-    std::vector<std::unique_ptr<std::vector<uint8_t>>> m_pool;
-    std::mutex m_mutex;
+    std::array<FreeList, classCount> m_freeLists;
+
+    // nodes are never freed, so an index stays valid for the lifetime of the pool
+    std::array<std::atomic<Node*>, maxSegments> m_segments;
+    std::atomic<uint32_t> m_nodeCount;
+    std::mutex m_segmentMutex;
+
+    std::atomic<uint64_t> m_memoryCap;
+    std::atomic<uint64_t> m_pooledBytes;
+    std::atomic<uint64_t> m_usedBytes;
+    std::atomic<uint64_t> m_highWaterMark;
+    std::atomic<uint64_t> m_allocations;
+    std::atomic<uint64_t> m_reuses;
+    std::atomic<uint64_t> m_oversized;
+    std::atomic<uint64_t> m_capped;
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "common/ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+uint32_t trinity::defaultWorkerCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void trinity::parallelFor(uint64_t itemCount, const std::function<void(uint32_t, uint64_t)>& func, uint32_t workerCount) {
+    std::atomic<uint64_t> next(0);
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+
+    auto worker = [&](uint32_t w) {
+        try {
+            for (uint64_t i = next++; i < itemCount; i = next++) {
+                func(w, i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!firstError) {
+                firstError = std::current_exception();
+            }
+            next = itemCount; // stops the other workers early
+        }
+    };
+
+    if (workerCount == 0) {
+        workerCount = defaultWorkerCount();
+    }
+    workerCount = uint32_t(std::max<uint64_t>(1, std::min<uint64_t>(workerCount, itemCount)));
+    std::vector<std::thread> threads;
+    for (uint32_t w = 1; w < workerCount; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+void trinity::parallelForRanges(uint64_t itemCount, uint64_t minItemsPerRange,
+                                const std::function<void(uint64_t, uint64_t)>& func) {
+    const uint64_t rangeCount =
+        std::min<uint64_t>(defaultWorkerCount(), std::max<uint64_t>(1, itemCount / std::max<uint64_t>(1, minItemsPerRange)));
+    parallelFor(rangeCount,
+                [&](uint32_t, uint64_t r) { func(itemCount * r / rangeCount, itemCount * (r + 1) / rangeCount); },
+                uint32_t(rangeCount));
+}
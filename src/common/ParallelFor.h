@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// Minimal fork-join helpers shared by the IO and processing code. Worker 0 is the calling thread, the other
+// workers are threads started for the call; the call returns when all items are done.
+
+namespace trinity {
+
+// number of workers used for workerCount 0, one per hardware thread
+uint32_t defaultWorkerCount();
+
+// calls func(worker, item) for every item in [0, itemCount) on at most workerCount workers (0 for
+// defaultWorkerCount()), worker is below that count, so it can index per-worker state. The workers take the
+// items from a shared counter, so uneven item costs balance out. The first exception thrown by func is
+// rethrown once all workers have finished, the remaining items are skipped.
+void parallelFor(uint64_t itemCount, const std::function<void(uint32_t, uint64_t)>& func, uint32_t workerCount = 0);
+
+// calls func(begin, end) once per worker on consecutive ranges of [0, itemCount) that hold at least
+// minItemsPerRange items, for passes too cheap per item to pay for a call each
+void parallelForRanges(uint64_t itemCount, uint64_t minItemsPerRange,
+                       const std::function<void(uint64_t, uint64_t)>& func);
+}
@@ -13,11 +13,11 @@
 
 namespace trinity {
 
+// receives the reply to a request that has already been sent over the channel
 template <typename RequestType>
-std::unique_ptr<typename RequestType::ReplyType> sendRequestChecked(const CommandInputChannel& channel, const RequestType& request) {
+std::unique_ptr<typename RequestType::ReplyType> receiveReplyChecked(const CommandInputChannel& channel, const RequestType& request) {
     using ReplyType = typename RequestType::ReplyType;
-    channel.sendRequest(request);
-    auto reply = channel.getReply();
+    auto reply = channel.getReply(request.getRid());
     if (reply->getType() == VclType::TrinityError) {
         const auto& error = static_cast<const ErrorReply&>(*reply);
         throw TrinityError("Error received: " + error.getParams().getError(), __FILE__, __LINE__);
@@ -28,5 +28,11 @@ std::unique_ptr<typename RequestType::ReplyType> sendRequestChecked(const Comman
     return std::unique_ptr<ReplyType>(static_cast<ReplyType*>(reply.release()));
 }
 
+template <typename RequestType>
+std::unique_ptr<typename RequestType::ReplyType> sendRequestChecked(const CommandInputChannel& channel, const RequestType& request) {
+    channel.sendRequest(request);
+    return receiveReplyChecked(channel, request);
+}
+
 bool connectInputChannel(const CommandInputChannel& inputChannel);
 }
\ No newline at end of file
@@ -1,26 +1,81 @@
 #include "VisStream.h"
 
-#include <chrono>
-
 using namespace trinity;
 
 VisStream::VisStream(StreamingParams params)
-    : m_streamingParams(params) {}
+    : m_streamingParams(params)
+    , m_writeSlot(0)
+    , m_readSlot(1)
+    , m_sharedSlot(2)
+    , m_droppedFrames(0)
+    , m_consumerWaiting(false)
+    , m_closed(false) {
+    const size_t frameSize = static_cast<size_t>(params.getResX()) * params.getResY() * 4;
+    for (auto& frame : m_frames) {
+        frame.reserve(frameSize);
+    }
+}
 
 const StreamingParams& VisStream::getStreamingParams() const {
     return m_streamingParams;
 }
 
+Frame& VisStream::beginPut() {
+    return m_frames[m_writeSlot];
+}
+
+void VisStream::endPut() {
+    const uint8_t previous = m_sharedSlot.exchange(m_writeSlot | freshBit);
+    m_writeSlot = previous & slotMask;
+    if (previous & freshBit) {
+        ++m_droppedFrames;
+    }
+
+    // the exchange above and the waiting flag are sequentially consistent, so either the consumer
+    // sees the new frame before going to sleep or we see that it is (about to be) sleeping
+    if (m_consumerWaiting) {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_cv.notify_one();
+    }
+}
+
 void VisStream::put(Frame frame) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_frame = std::move(frame);
-    m_cv.notify_one();
+    beginPut().swap(frame);
+    endPut();
 }
 
-Frame VisStream::get() {
-    std::unique_lock<std::mutex> lock(m_mutex);
-    if (!m_cv.wait_for(lock, std::chrono::milliseconds(10), [&] { return !m_frame.empty(); })) {
-        return Frame();
+bool VisStream::acquireFrame() {
+    // only the consumer clears the fresh bit, so it cannot vanish between load and exchange
+    if (!(m_sharedSlot.load() & freshBit)) {
+        return false;
     }
-    return std::move(m_frame);
+    m_readSlot = m_sharedSlot.exchange(m_readSlot) & slotMask;
+    return true;
+}
+
+const Frame& VisStream::get() {
+    if (!acquireFrame()) {
+        std::unique_lock<std::mutex> lock(m_waitMutex);
+        m_consumerWaiting = true;
+        m_cv.wait(lock, [&] { return (m_sharedSlot.load() & freshBit) || m_closed; });
+        m_consumerWaiting = false;
+        if (!acquireFrame()) {
+            return m_emptyFrame;
+        }
+    }
+    return m_frames[m_readSlot];
+}
+
+const Frame& VisStream::tryGet() {
+    return acquireFrame() ? m_frames[m_readSlot] : m_emptyFrame;
+}
+
+void VisStream::close() {
+    std::lock_guard<std::mutex> lock(m_waitMutex);
+    m_closed = true;
+    m_cv.notify_all();
+}
+
+uint64_t VisStream::getDroppedFrameCount() const {
+    return m_droppedFrames;
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include "mocca/base/Nullable.h"
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 
@@ -11,19 +13,50 @@ namespace trinity {
 
 using Frame = std::vector<uint8_t>;
 
+// single producer / single consumer hand-over of frames: three preallocated
+// buffers rotate between producer, consumer and a shared slot that is exchanged
+// atomically; an unread frame is replaced by a newer one (latest frame wins)
 class VisStream {
 public:
     VisStream(StreamingParams params);
 
     const StreamingParams& getStreamingParams() const;
 
+    // producer: fill the buffer returned by beginPut (its storage is recycled
+    // from earlier frames) and publish it with endPut
+    Frame& beginPut();
+    void endPut();
     void put(Frame frame);
-    Frame get();
+
+    // consumer: the returned frame stays valid until the next call to get or
+    // tryGet; an empty frame means that no new frame is available
+    const Frame& get();    // blocks until a new frame arrives or the stream is closed
+    const Frame& tryGet(); // never blocks
+
+    // wakes up a consumer blocked in get; from then on get does not block anymore
+    void close();
+
+    uint64_t getDroppedFrameCount() const;
 
 private:
+    bool acquireFrame();
+
+private:
+    static const uint8_t freshBit = 0x4;
+    static const uint8_t slotMask = 0x3;
+
     StreamingParams m_streamingParams;
-    Frame m_frame;
-    std::mutex m_mutex;
+    std::array<Frame, 3> m_frames;
+    uint8_t m_writeSlot;              // owned by the producer
+    uint8_t m_readSlot;               // owned by the consumer
+    std::atomic<uint8_t> m_sharedSlot; // slot index | freshBit if not read yet
+    std::atomic<uint64_t> m_droppedFrames;
+    const Frame m_emptyFrame;
+
+    // only used to put the consumer to sleep, the frames themselves are exchanged lock-free
+    std::atomic<bool> m_consumerWaiting;
+    std::atomic<bool> m_closed;
+    std::mutex m_waitMutex;
     std::condition_variable m_cv;
 };
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "common/VisStreamProtocol.h"
+
+#include "common/TrinityError.h"
+
+#include "mocca/net/Message.h"
+
+using namespace trinity;
+
+namespace {
+const size_t fixedHeaderSize = 4 * sizeof(uint32_t);
+const size_t regionSize = 4 * sizeof(uint32_t);
+}
+
+std::shared_ptr<std::vector<uint8_t>> FrameHeader::write() const {
+    auto part = std::make_shared<std::vector<uint8_t>>();
+    part->reserve(fixedHeaderSize + regions.size() * regionSize);
+    mocca::net::appendToMessagePart(*part, static_cast<uint32_t>(encoding));
+    mocca::net::appendToMessagePart(*part, width);
+    mocca::net::appendToMessagePart(*part, height);
+    mocca::net::appendToMessagePart(*part, static_cast<uint32_t>(regions.size()));
+    for (const auto& region : regions) {
+        mocca::net::appendToMessagePart(*part, region.x);
+        mocca::net::appendToMessagePart(*part, region.y);
+        mocca::net::appendToMessagePart(*part, region.width);
+        mocca::net::appendToMessagePart(*part, region.height);
+    }
+    return part;
+}
+
+FrameHeader FrameHeader::read(const std::vector<uint8_t>& part) {
+    if (part.size() < fixedHeaderSize) {
+        throw TrinityError("Invalid frame header: too small", __FILE__, __LINE__);
+    }
+    FrameHeader header;
+    uint32_t encoding, regionCount;
+    const uint8_t* ptr = part.data();
+    ptr = mocca::net::readFromMessagePart(ptr, encoding);
+    ptr = mocca::net::readFromMessagePart(ptr, header.width);
+    ptr = mocca::net::readFromMessagePart(ptr, header.height);
+    ptr = mocca::net::readFromMessagePart(ptr, regionCount);
+    if (encoding > static_cast<uint32_t>(Encoding::Delta)) {
+        throw TrinityError("Invalid frame header: unknown encoding", __FILE__, __LINE__);
+    }
+    if (part.size() != fixedHeaderSize + regionCount * regionSize) {
+        throw TrinityError("Invalid frame header: region count mismatch", __FILE__, __LINE__);
+    }
+    header.encoding = static_cast<Encoding>(encoding);
+    header.regions.resize(regionCount);
+    for (auto& region : header.regions) {
+        ptr = mocca::net::readFromMessagePart(ptr, region.x);
+        ptr = mocca::net::readFromMessagePart(ptr, region.y);
+        ptr = mocca::net::readFromMessagePart(ptr, region.width);
+        ptr = mocca::net::readFromMessagePart(ptr, region.height);
+        if (uint64_t(region.x) + region.width > header.width || uint64_t(region.y) + region.height > header.height) {
+            throw TrinityError("Invalid frame header: region exceeds the frame", __FILE__, __LINE__);
+        }
+    }
+    return header;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace trinity {
+
+// rectangle of a frame in buffer coordinates (rows in memory order)
+struct FrameRegion {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+// first part of every vis stream message; each further part holds the JPEG image of one region
+struct FrameHeader {
+    enum class Encoding : uint32_t {
+        Full = 0,  // the regions cover the whole frame
+        Delta = 1, // the regions patch the previous frame
+    };
+
+    Encoding encoding;
+    uint32_t width;
+    uint32_t height;
+    std::vector<FrameRegion> regions;
+
+    std::shared_ptr<std::vector<uint8_t>> write() const;
+    static FrameHeader read(const std::vector<uint8_t>& part);
+};
+}
@@ -3,6 +3,7 @@
 #include "commands/ProcessingCommands.h"
 #include "common/ProxyUtils.h"
 #include "common/TrinityError.h"
+#include "frontend-base/VisStreamReceiver.h"
 
 #include "mocca/base/Memory.h"
 
@@ -19,8 +20,12 @@ ProcessingNodeProxy::ProcessingNodeProxy(const mocca::net::Endpoint& ep)
 std::unique_ptr<RendererProxy> ProcessingNodeProxy::initRenderer(const VclType& type, const std::string& fileId,
                                                                  const mocca::net::Endpoint& ioEndpoint,
                                                                  const StreamingParams& streamingParams) {
+    // the renderer only sends frames the receiver can decode
+    StreamingParams receiverParams(streamingParams);
+    receiverParams.setFrameRegions(streamingParams.getFrameRegions() && VisStreamReceiver::decodesFrameRegions());
+
     // creating the cmd that will initialize a remote renderer of the given type
-    InitProcessingSessionCmd::RequestParams params(m_inputChannel.getEndpoint().protocol, type, fileId, ioEndpoint, streamingParams);
+    InitProcessingSessionCmd::RequestParams params(m_inputChannel.getEndpoint().protocol, type, fileId, ioEndpoint, receiverParams);
     InitProcessingSessionRequest request(params, IDGenerator::nextID(), 0);
 
     auto reply = sendRequestChecked(m_inputChannel, request);
@@ -30,7 +35,7 @@ std::unique_ptr<RendererProxy> ProcessingNodeProxy::initRenderer(const VclType&
                                          replyParams.getControlPort());
     mocca::net::Endpoint visEndpoint(m_inputChannel.getEndpoint().protocol, m_inputChannel.getEndpoint().machine, replyParams.getVisPort());
 
-    std::shared_ptr<VisStream> stream = std::make_shared<VisStream>(streamingParams);
+    std::shared_ptr<VisStream> stream = std::make_shared<VisStream>(receiverParams);
     LINFO("(f) creating render proxy for " + controlEndpoint.machine);
 
     return mocca::make_unique<RendererProxy>(stream, std::move(controlEndpoint), std::move(visEndpoint), reply->getSid());
@@ -354,4 +354,11 @@ void RendererProxy::setUserWorldMatrix(Core::Math::Mat4f m) {
     m_inputChannel.sendRequest(request);
 }
 
+StreamQuality RendererProxy::getStreamQuality() const {
+    GetStreamQualityCmd::RequestParams params;
+    GetStreamQualityRequest request(params, IDGenerator::nextID(), m_remoteSid);
+    auto reply = sendRequestChecked(m_inputChannel, request);
+    return reply->getParams().getQuality();
+}
+
 /* AUTOGEN RendererProxyImpl */
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <memory>
 
 #include "common/IRenderer.h"
+#include "commands/ProcessingCommands.h"
 #include "commands/CommandInputChannel.h"
 #include "frontend-base/VisStreamReceiver.h"
 
@@ -74,6 +75,9 @@ public:
     void setUserWorldMatrix(Core::Math::Mat4f m) override;
     /* AUTOGEN RendererInterfaceOverride */
 
+    // encoding settings the processing node currently uses for the vis stream
+    StreamQuality getStreamQuality() const;
+
 private:
     CommandInputChannel m_inputChannel;
     VisStreamReceiver m_visReceiver;
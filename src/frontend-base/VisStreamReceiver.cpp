@@ -1,5 +1,8 @@
 #include "VisStreamReceiver.h"
 
+#include "common/TrinityError.h"
+#include "common/VisStreamProtocol.h"
+
 #include "silverbullet/base/DetectEnv.h"
 
 #include "mocca/base/Error.h"
@@ -8,12 +11,32 @@
 #include "mocca/net/NetworkError.h"
 #include "mocca/base/Thread.h"
 
+#include <algorithm>
+#include <cstring>
+
 #if !defined(DETECTED_IOS_SIMULATOR) && !defined(DETECTED_IOS)
 #include "jpeg/JPEGDecoder.h"
 #endif
 
 using namespace trinity;
 
+#if !defined(DETECTED_IOS_SIMULATOR) && !defined(DETECTED_IOS)
+namespace {
+// nearest neighbor upscaling of frames the sender has encoded at a reduced resolution
+void upscale(const Frame& source, int width, int height, Frame& target, int targetWidth, int targetHeight) {
+    const size_t channels = source.size() / (size_t(width) * height);
+    target.resize(size_t(targetWidth) * targetHeight * channels);
+    for (int y = 0; y < targetHeight; ++y) {
+        const size_t sourceRow = size_t(y) * height / targetHeight * width;
+        for (int x = 0; x < targetWidth; ++x) {
+            const uint8_t* pixel = &source[(sourceRow + size_t(x) * width / targetWidth) * channels];
+            std::copy(pixel, pixel + channels, &target[(size_t(y) * targetWidth + x) * channels]);
+        }
+    }
+}
+}
+#endif
+
 VisStreamReceiver::VisStreamReceiver(const mocca::net::Endpoint endpoint, std::shared_ptr<VisStream> s)
     : m_visStream(s)
     , m_endpoint(endpoint) {}
@@ -22,6 +45,15 @@ VisStreamReceiver::~VisStreamReceiver() {
     join();
 }
 
+bool VisStreamReceiver::decodesFrameRegions() {
+#if !defined(DETECTED_IOS_SIMULATOR) && !defined(DETECTED_IOS)
+    return true;
+#else
+    // the images are handed to the platform decoder as they are
+    return false;
+#endif
+}
+
 void VisStreamReceiver::startStreaming() {
     start();
 }
@@ -49,16 +81,74 @@ void VisStreamReceiver::run() {
 
 #if !defined(DETECTED_IOS_SIMULATOR) && !defined(DETECTED_IOS)
     JPEGDecoder jpeg(JPEGDecoder::Format_RGBA, false);
+    Frame decoded;
+    uint32_t width = 0;
+    uint32_t height = 0;
 #endif
     try {
         while (!isInterrupted()) {
             auto bytepacket = m_connection->receive();
             if (!bytepacket.empty()) {
 #if !defined(DETECTED_IOS_SIMULATOR) && !defined(DETECTED_IOS)
-                auto frame = jpeg.decode(*bytepacket[0]);
-                m_visStream->put(std::move(frame));
+                // the first message part is the frame header, each further part is one JPEG image
+                // covering a region of the frame; delta frames only patch the regions that changed
+                FrameHeader header;
+                try {
+                    header = FrameHeader::read(*bytepacket[0]);
+                } catch (const TrinityError& err) {
+                    LWARNING("(f) dropping malformed frame: " << err.what());
+                    continue;
+                }
+                if (bytepacket.size() != header.regions.size() + 1) {
+                    LWARNING("(f) dropping frame with " << bytepacket.size() - 1 << " instead of " << header.regions.size()
+                                                        << " regions");
+                    continue;
+                }
+                if (header.encoding == FrameHeader::Encoding::Full) {
+                    width = header.width;
+                    height = header.height;
+                    decoded.resize(size_t(width) * height * 4);
+                } else if (header.width != width || header.height != height) {
+                    LWARNING("(f) dropping delta frame without matching reference frame");
+                    continue;
+                }
+                bool complete = true;
+                for (size_t i = 0; i < header.regions.size() && complete; ++i) {
+                    const FrameRegion& region = header.regions[i];
+                    int regionWidth = 0;
+                    int regionHeight = 0;
+                    auto image = jpeg.decode(*bytepacket[i + 1], regionWidth, regionHeight);
+                    complete = !image.empty() && uint32_t(regionWidth) == region.width && uint32_t(regionHeight) == region.height &&
+                               region.x + region.width <= width && region.y + region.height <= height;
+                    for (uint32_t row = 0; complete && row < region.height; ++row) {
+                        std::memcpy(&decoded[((size_t(region.y) + row) * width + region.x) * 4], &image[size_t(row) * region.width * 4],
+                                    region.width * 4);
+                    }
+                }
+                if (complete) {
+                    // the decoded frame is kept as reference for the next delta, so it is copied rather than swapped
+                    auto const& params = m_visStream->getStreamingParams();
+                    Frame& frame = m_visStream->beginPut();
+                    if (width == uint32_t(params.getResX()) && height == uint32_t(params.getResY())) {
+                        frame.assign(decoded.begin(), decoded.end());
+                    } else {
+                        upscale(decoded, width, height, frame, params.getResX(), params.getResY());
+                    }
+                    m_visStream->endPut();
+                } else {
+                    // the reference frame is corrupt now, wait for the next full frame
+                    LWARNING("(f) decoding frame regions failed");
+                    width = 0;
+                    height = 0;
+                }
 #else
-                m_visStream->put(std::move(*bytepacket[0]));
+                // the renderer was asked for full frames made of a single image (see decodesFrameRegions),
+                // which follows the frame header
+                if (bytepacket.size() == 2) {
+                    m_visStream->put(std::move(*bytepacket[1]));
+                } else {
+                    LWARNING("(f) dropping frame with " << bytepacket.size() - 1 << " regions");
+                }
 #endif
             }
         }
@@ -17,6 +17,9 @@ public:
     void startStreaming();
     void endStreaming();
 
+    // whether frames made of several regions and delta frames can be decoded
+    static bool decodesFrameRegions();
+
 private:
     std::shared_ptr<VisStream> m_visStream;
     void run() override;
@@ -76,7 +76,7 @@ int main(int argc, char** argv) {
     while (!exitFlag) {
         std::this_thread::sleep_for(std::chrono::seconds(2));
         auto visStream = renderer->getVisStream();
-        auto frame = visStream->get();
+        auto const& frame = visStream->tryGet();
         if (frame.empty())
             LINFO("no frame arrived yet");
         else {
@@ -35,7 +35,7 @@ void MainWindow::update() {
     int resX = visStream.getStreamingParams().getResX();
     int resY = visStream.getStreamingParams().getResY();
     try {
-        auto frame = visStream.get();
+        auto const& frame = visStream.tryGet();
         if (!frame.empty()) {
             m_ui->openGLWidget->setData(resX, resY, frame.data());
             m_ui->openGLWidget->repaint();
@@ -13,11 +13,13 @@ struct FractalData {
   FractalData(const std::string& container,
               const IOData& ioData,
               Vec3ui64 size = Vec3ui64(),
-              Vec3ui64 brick = Vec3ui64()) :
+              Vec3ui64 brick = Vec3ui64(),
+              MandelbulbMode mode = MandelbulbMode::Reference) :
   m_container(container),
   m_ioData(ioData),
   m_size(size),
-  m_brick(brick)
+  m_brick(brick),
+  m_mode(mode)
   {}
   
   
@@ -25,9 +27,10 @@ struct FractalData {
   IOData m_ioData;
   Vec3ui64 m_size;
   Vec3ui64 m_brick;
+  MandelbulbMode m_mode;
 };
 
-static std::array<FractalData, 23> data {
+static std::array<FractalData, 28> data {
   {FractalData(FractalDataRoot, IOData("Flat Data", "FractalData@Flat",
                                        IOData::DataType::Directory)),
     FractalData(FractalDataRoot, IOData("Bricked Data", "FractalData@Bricked",
@@ -45,6 +48,10 @@ static std::array<FractalData, 23> data {
                                               IOData::DataType::Directory)),
     FractalData("FractalData@Bricked", IOData("Non Power of 2", "FractalData@2b",
                                               IOData::DataType::Directory)),
+    // generated with the single precision vectorized generator, for
+    // capacity tests that need many bricks quickly
+    FractalData("FractalData@Bricked", IOData("Vectorized Generator", "FractalData@2c",
+                                              IOData::DataType::Directory)),
     
     // used for testing and dummy purposes. DO NOT REMOVE
     FractalData("FractalData@1a", IOData("DUMMY AND TEST IO DATA", "FractalData@3",
@@ -98,7 +105,24 @@ static std::array<FractalData, 23> data {
                 Vec3ui64(4000, 4000, 4000), Vec3ui64(32, 32, 32)),
     FractalData("FractalData@2b", IOData("4000^3 (30^3 bricks)","FractalData@10b",
                                          IOData::DataType::Dataset),
-                Vec3ui64(4000, 4000, 4000), Vec3ui64(30, 30, 30))}
+                Vec3ui64(4000, 4000, 4000), Vec3ui64(30, 30, 30)),
+    
+    FractalData("FractalData@2c", IOData("512^3 (32^3 bricks)", "FractalData@6c",
+                                         IOData::DataType::Dataset),
+                Vec3ui64(512, 512, 512), Vec3ui64(32, 32, 32),
+                MandelbulbMode::VectorizedFloat),
+    FractalData("FractalData@2c", IOData("1024^3 (32^3 bricks)", "FractalData@7c",
+                                         IOData::DataType::Dataset),
+                Vec3ui64(1024, 1024, 1024), Vec3ui64(32, 32, 32),
+                MandelbulbMode::VectorizedFloat),
+    FractalData("FractalData@2c", IOData("2048^3 (32^3 bricks)", "FractalData@8c",
+                                         IOData::DataType::Dataset),
+                Vec3ui64(2048, 2048, 2048), Vec3ui64(32, 32, 32),
+                MandelbulbMode::VectorizedFloat),
+    FractalData("FractalData@2c", IOData("4096^3 (32^3 bricks)", "FractalData@9c",
+                                         IOData::DataType::Dataset),
+                Vec3ui64(4096, 4096, 4096), Vec3ui64(32, 32, 32),
+                MandelbulbMode::VectorizedFloat)}
 };
 
 bool FractalListData::containsIOData(const std::string& fileOrDirID) const {
@@ -140,6 +164,16 @@ Vec3ui64 FractalListData::brickSize(const std::string& fileID) const {
 }
 
 
+MandelbulbMode FractalListData::generatorMode(const std::string& fileID) const {
+  for(const auto& s: data) {
+    if (s.m_ioData.getFileId() == fileID &&
+        s.m_ioData.getDataType() == IOData::DataType::Dataset)
+      return s.m_mode;
+  }
+  throw TrinityError("invalid file ID", __FILE__, __LINE__);
+}
+
+
 std::unique_ptr<trinity::IIO> FractalListData::createIO(const std::string& fileId) const {
   return std::unique_ptr<FractalIO>(new FractalIO(fileId, *this));
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "io-base/IListData.h"
+#include "io-base/fractal/Mandelbulb.h"
 #include "silverbullet/math/Vectors.h"
 
 namespace trinity {
@@ -12,8 +13,9 @@ public:
     std::unique_ptr<IIO> createIO(const std::string& dirID) const override;
     std::string getRoot() const override;
 
-    // special fractal functions
-    Core::Math::Vec3ui64 totalSize(const std::string& fileID) const;
-    Core::Math::Vec3ui64 brickSize(const std::string& fileID) const;
+    // special fractal functions, virtual so tests can describe their own datasets
+    virtual Core::Math::Vec3ui64 totalSize(const std::string& fileID) const;
+    virtual Core::Math::Vec3ui64 brickSize(const std::string& fileID) const;
+    virtual MandelbulbMode generatorMode(const std::string& fileID) const;
 };
 }
\ No newline at end of file
@@ -113,6 +113,12 @@ std::unique_ptr<ICommandHandler> IOSessionCommandFactory::createHandler(const Re
     case VclType::GetBrickMetaData:
         return mocca::make_unique<GetBrickMetaDataHdl>(static_cast<const GetBrickMetaDataRequest&>(request), session);
         break;
+    case VclType::GetBricks:
+        return mocca::make_unique<GetBricksHdl>(static_cast<const GetBricksRequest&>(request), session);
+        break;
+    case VclType::GetDatasetDescriptor:
+        return mocca::make_unique<GetDatasetDescriptorHdl>(static_cast<const GetDatasetDescriptorRequest&>(request), session);
+        break;
     /* AUTOGEN IOCommandFactoryEntry */
     default:
         throw TrinityError("command unknown: " + (Vcl::instance().toString(type)), __FILE__, __LINE__);
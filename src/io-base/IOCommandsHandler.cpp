@@ -25,7 +25,7 @@ std::unique_ptr<Reply> InitIOSessionHdl::execute() {
     auto compressionMode = m_node->executionMode() == AbstractNode::ExecutionMode::Combined &&
                                    requestParams.getProtocol() == mocca::net::ConnectionFactorySelector::loopback()
                                ? CompressionMode::Uncompressed
-                               : CompressionMode::Compressed;
+                               : CompressionMode::Framed;
     auto fileID = requestParams.getFileId();
     auto& listData = m_node->getListDataForID(fileID);
     auto session = mocca::make_unique<IOSession>(requestParams.getProtocol(), compressionMode, listData.createIO(fileID));
@@ -196,9 +196,20 @@ GetBrickHdl::GetBrickHdl(const GetBrickRequest& request, IOSession* session)
 
 std::unique_ptr<Reply> GetBrickHdl::execute() {
     auto brickKey = m_request.getParams().getBrickKey();
-    bool success;
-    auto brick = m_session->getIO().getBrick(brickKey, success);
-    GetBrickCmd::ReplyParams params(brick, success);
+    bool success = true;
+    // uncompressed bricks are sent straight from the backend's memory if the IO supports it
+    auto view = m_session->getIO().getBrickView(brickKey);
+    if (view) {
+        GetBrickCmd::ReplyParams params(std::move(view), success);
+        return mocca::make_unique<GetBrickReply>(params, m_request.getRid(), m_session->getSid());
+    }
+    // compressed bricks are forwarded as stored if the IO supports it
+    auto brick = m_session->getIO().getEncodedBrick(brickKey);
+    const bool encoded = brick != nullptr;
+    if (!encoded) {
+        brick = m_session->getIO().getBrick(brickKey, success);
+    }
+    GetBrickCmd::ReplyParams params(brick, success, encoded);
     return mocca::make_unique<GetBrickReply>(params, m_request.getRid(), m_session->getSid());
 }
 
@@ -314,4 +325,53 @@ std::unique_ptr<Reply> GetBrickMetaDataHdl::execute() {
     return mocca::make_unique<GetBrickMetaDataReply>(std::move(params), m_request.getRid(), m_session->getSid());
 }
 
+GetBricksHdl::GetBricksHdl(const GetBricksRequest& request, IOSession* session)
+    : m_request(request)
+    , m_session(session) {}
+
+std::unique_ptr<Reply> GetBricksHdl::execute() {
+    const auto& io = m_session->getIO();
+    const auto brickKeys = m_request.getParams().getBrickKeys();
+
+    // bricks are sent from the backend's memory or forwarded as stored if the IO supports it, the others are
+    // fetched in one batch
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> bricks(brickKeys.size());
+    std::vector<bool> success(brickKeys.size(), true);
+    std::vector<bool> encoded(brickKeys.size(), false);
+    std::vector<BinaryView> views(brickKeys.size());
+    std::vector<BrickKey> decodedKeys;
+    std::vector<size_t> decodedIndices;
+    for (size_t i = 0; i < brickKeys.size(); ++i) {
+        views[i] = io.getBrickView(brickKeys[i]);
+        if (views[i]) {
+            continue;
+        }
+        bricks[i] = io.getEncodedBrick(brickKeys[i]);
+        encoded[i] = bricks[i] != nullptr;
+        if (!encoded[i]) {
+            decodedKeys.push_back(brickKeys[i]);
+            decodedIndices.push_back(i);
+        }
+    }
+    if (!decodedKeys.empty()) {
+        std::vector<bool> decodedSuccess;
+        auto decodedBricks = io.getBricks(decodedKeys, decodedSuccess);
+        for (size_t i = 0; i < decodedIndices.size(); ++i) {
+            bricks[decodedIndices[i]] = decodedBricks[i];
+            success[decodedIndices[i]] = decodedSuccess[i];
+        }
+    }
+    GetBricksCmd::ReplyParams params(std::move(bricks), std::move(success), std::move(encoded), std::move(views));
+    return mocca::make_unique<GetBricksReply>(std::move(params), m_request.getRid(), m_session->getSid());
+}
+
+GetDatasetDescriptorHdl::GetDatasetDescriptorHdl(const GetDatasetDescriptorRequest& request, IOSession* session)
+    : m_request(request)
+    , m_session(session) {}
+
+std::unique_ptr<Reply> GetDatasetDescriptorHdl::execute() {
+    GetDatasetDescriptorCmd::ReplyParams params(DatasetDescriptor::create(m_session->getIO()));
+    return mocca::make_unique<GetDatasetDescriptorReply>(std::move(params), m_request.getRid(), m_session->getSid());
+}
+
 /* AUTOGEN IOCommandHandlerImpl */
\ No newline at end of file
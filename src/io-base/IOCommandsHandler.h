@@ -337,5 +337,27 @@ private:
     IOSession* m_session;
 };
 
+class GetBricksHdl : public ICommandHandler {
+public:
+    GetBricksHdl(const GetBricksRequest& request, IOSession* session);
+
+    std::unique_ptr<Reply> execute() override;
+
+private:
+    GetBricksRequest m_request;
+    IOSession* m_session;
+};
+
+class GetDatasetDescriptorHdl : public ICommandHandler {
+public:
+    GetDatasetDescriptorHdl(const GetDatasetDescriptorRequest& request, IOSession* session);
+
+    std::unique_ptr<Reply> execute() override;
+
+private:
+    GetDatasetDescriptorRequest m_request;
+    IOSession* m_session;
+};
+
 /* AUTOGEN IOCommandHandlerHeader */
 }
\ No newline at end of file
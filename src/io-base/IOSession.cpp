@@ -11,10 +11,16 @@
 
 using namespace trinity;
 
-IOSession::IOSession(const std::string& protocol, CompressionMode compressionMode, std::unique_ptr<IIO> io)
-    : AbstractSession(protocol, compressionMode), m_io(std::move(io)) {
+IOSession::IOSession(const std::string& protocol, CompressionMode compressionMode, std::unique_ptr<IIO> io,
+                     size_t workerCount)
+    : AbstractSession(protocol, compressionMode, workerCount), m_io(std::move(io)) {
 }
 
 std::unique_ptr<ICommandHandler> IOSession::createHandler(const Request& request) {
     return m_factory.createHandler(request, this);
 }
+
+bool IOSession::isConcurrent(const Request&) const {
+    // all io commands only read from the dataset
+    return true;
+}
@@ -18,12 +18,18 @@
 namespace trinity {
 class IOSession : public AbstractSession {
 public:
-    IOSession(const std::string& protocol, CompressionMode compressionMode, std::unique_ptr<IIO> io);
+    // brick requests can take long, so requests are executed by a few workers; this requires the IIO to be
+    // safe to use from several threads
+    static const size_t defaultWorkerCount = 4;
+
+    IOSession(const std::string& protocol, CompressionMode compressionMode, std::unique_ptr<IIO> io,
+              size_t workerCount = defaultWorkerCount);
 
     const IIO& getIO() const { return *m_io; }
     
 private:
     std::unique_ptr<ICommandHandler> createHandler(const Request& request) override;
+    bool isConcurrent(const Request& request) const override;
 
 private:
     IOSessionCommandFactory m_factory;
@@ -1,18 +1,138 @@
 #include "BrickCacher.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <map>
+
+#include "lz4/lz4.h"
+#include "mocca/log/LogManager.h"
+#include "silverbullet/io/FileTools.h"
+
+using namespace Core::IO;
 using namespace Core::IO::FileTools;
 
+namespace {
+  const uint32_t IndexMagic = 0x49434254;  // "TBCI"
+  const uint32_t RecordMagic = 0x52434254; // "TBCR"
+  const uint32_t IndexVersion = 1;
+  const uint64_t InitialCapacity = 1024;
+
+  const uint32_t FlagUsed = 1;
+  const uint32_t FlagCompressed = 2;
+
+  uint32_t checksum(const uint8_t* data, size_t size) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+  }
+
+  struct Registry {
+    std::mutex mutex;
+    std::map<std::string, std::weak_ptr<BrickCacher>> cachers;
+  };
+
+  Registry& registry() {
+    static Registry instance;
+    return instance;
+  }
+}
+
+struct BrickCacher::IndexHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t capacity;
+  // bytes of the data file that belong to indexed records
+  uint64_t dataSize;
+  uint64_t useCounter;
+};
+
+struct BrickCacher::IndexEntry {
+  uint64_t key[4];
+  uint64_t offset;
+  uint64_t storedSize;
+  uint64_t rawSize;
+  uint8_t  min[8];
+  uint8_t  max[8];
+  uint64_t lastUse;
+  uint32_t flags;
+  uint32_t checksum;
+};
+
+namespace {
+  // precedes each brick in the data file, so the index can be rebuilt
+  struct RecordHeader {
+    uint32_t magic;
+    uint32_t flags;
+    uint64_t key[4];
+    uint64_t storedSize;
+    uint64_t rawSize;
+    uint8_t  min[8];
+    uint8_t  max[8];
+    uint32_t checksum;
+    uint32_t reserved;
+  };
+
+  void setKey(uint64_t* target, const BrickKey& key) {
+    target[0] = key.modality;
+    target[1] = key.timestep;
+    target[2] = key.lod;
+    target[3] = key.index;
+  }
+
+  BrickKey getKey(const uint64_t* source) {
+    return BrickKey(source[0], source[1], source[2], source[3]);
+  }
+}
 
 BrickCacher::BrickCacher(const std::string& dir,
                          const std::string& prefix,
-                         const std::string& ext) :
+                         const std::string& ext,
+                         uint64_t maxSize,
+                         bool compress) :
 m_dir(dir),
 m_prefix(prefix),
-m_ext(ext)
+m_ext(ext),
+m_maxSize(maxSize),
+m_compress(compress),
+m_liveSize(0)
 {
+  open();
+}
+
+BrickCacher::~BrickCacher() {
+  close();
+}
+
+std::shared_ptr<BrickCacher> BrickCacher::shared(const std::string& dir,
+                                                 const std::string& prefix,
+                                                 const std::string& ext,
+                                                 uint64_t maxSize,
+                                                 bool compress) {
+  // different spellings of the same directory share the instance
+  const std::string key = canonicalizePath(dir) + std::string("/") + prefix +
+                          std::string(".") + ext;
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  std::shared_ptr<BrickCacher> cacher = reg.cachers[key].lock();
+  if (!cacher) {
+    for (auto it = reg.cachers.begin(); it != reg.cachers.end();) {
+      it = it->second.expired() ? reg.cachers.erase(it) : std::next(it);
+    }
+    cacher = std::make_shared<BrickCacher>(dir, prefix, ext, maxSize,
+                                           compress);
+    reg.cachers[key] = cacher;
+  }
+  return cacher;
 }
 
 void BrickCacher::clear() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  close();
+  // also removes the files of the previous one file per brick format
   std::vector<std::string> names = getDirContents(m_dir);
   for (const std::string& name : names) {
     if (getExt(name) == m_ext &&
@@ -20,9 +140,376 @@ void BrickCacher::clear() const {
       remove(name.c_str());
     }
   }
+  remove(dataFilename().c_str());
+  remove(indexFilename().c_str());
+  open();
+}
+
+std::string BrickCacher::dataFilename() const {
+  return m_dir + std::string("/") + m_prefix + std::string(".") + m_ext +
+         std::string("Data");
+}
+
+std::string BrickCacher::indexFilename() const {
+  return m_dir + std::string("/") + m_prefix + std::string(".") + m_ext +
+         std::string("Index");
+}
+
+void BrickCacher::open() const {
+  m_slots.clear();
+  m_lru.clear();
+  m_freeEntries.clear();
+  m_liveSize = 0;
+
+  if (!fileExists(dataFilename())) {
+    std::ofstream create(dataFilename(), std::ios::binary);
+  }
+  m_data.open(dataFilename(), std::ios::in | std::ios::out | std::ios::binary);
+  if (!m_data.is_open() || !mapIndex(InitialCapacity)) {
+    LWARNING("(brickcacher) cannot open the brick cache in " << m_dir);
+    close();
+    return;
+  }
+
+  m_data.seekg(0, std::ios::end);
+  const uint64_t fileSize = uint64_t(m_data.tellg());
+  const uint64_t indexSize = m_index->GetFileLength();
+  IndexHeader& h = header();
+  if (h.magic != IndexMagic || h.version != IndexVersion ||
+      indexSize < sizeof(IndexHeader) + h.capacity * sizeof(IndexEntry) ||
+      h.dataSize > fileSize) {
+    if (fileSize > 0) {
+      LINFO("(brickcacher) rebuilding the index of " << dataFilename());
+    }
+    rebuildIndex();
+    return;
+  }
+
+  // records after dataSize were not indexed before a crash and are
+  // overwritten by the next append
+  std::vector<size_t> used;
+  for (size_t i = 0; i < h.capacity; ++i) {
+    const IndexEntry& e = entry(i);
+    if ((e.flags & FlagUsed) &&
+        e.offset + sizeof(RecordHeader) + e.storedSize <= h.dataSize) {
+      used.push_back(i);
+    } else {
+      m_freeEntries.push_back(i);
+    }
+  }
+  std::sort(used.begin(), used.end(), [this](size_t a, size_t b) {
+    return entry(a).lastUse > entry(b).lastUse;
+  });
+  for (size_t i : used) {
+    const BrickKey key = getKey(entry(i).key);
+    m_lru.push_back(key);
+    m_slots[key] = Slot{i, std::prev(m_lru.end())};
+    m_liveSize += sizeof(RecordHeader) + entry(i).storedSize;
+  }
+}
+
+void BrickCacher::close() const {
+  if (m_index) {
+    m_index->Flush();
+    m_index.reset();
+  }
+  if (m_data.is_open()) {
+    m_data.close();
+  }
+  m_data.clear();
+}
+
+bool BrickCacher::mapIndex(uint64_t capacity) const {
+  m_index.reset(new MemMappedFile(indexFilename(), MMFILE_ACCESS_READWRITE,
+                                  sizeof(IndexHeader) +
+                                  capacity * sizeof(IndexEntry)));
+  if (!m_index->IsOpen()) {
+    m_index.reset();
+    return false;
+  }
+  return true;
+}
+
+bool BrickCacher::growIndex() const {
+  const uint64_t capacity = header().capacity * 2;
+  m_index->Flush();
+  if (!mapIndex(capacity)) {
+    return false;
+  }
+  // the file was extended with zeros, i.e. unused entries
+  for (size_t i = size_t(header().capacity); i < capacity; ++i) {
+    m_freeEntries.push_back(i);
+  }
+  header().capacity = capacity;
+  return true;
+}
+
+void BrickCacher::rebuildIndex() const {
+  IndexHeader& h = header();
+  h.magic = 0;
+  h.version = IndexVersion;
+  h.capacity = (m_index->GetFileLength() - sizeof(IndexHeader)) /
+               sizeof(IndexEntry);
+  h.dataSize = 0;
+  h.useCounter = 0;
+  memset(&entry(0), 0, size_t(h.capacity * sizeof(IndexEntry)));
+  for (size_t i = size_t(h.capacity); i > 0; --i) {
+    m_freeEntries.push_back(i - 1);
+  }
+
+  // take over all complete records, the scan stops at the first damaged one;
+  // growIndex remaps the index, so header() is not kept in a reference
+  std::vector<uint8_t> payload;
+  m_data.clear();
+  m_data.seekg(0);
+  for (;;) {
+    RecordHeader record;
+    const uint64_t offset = header().dataSize;
+    if (!m_data.read((char*)&record, sizeof(record)) ||
+        record.magic != RecordMagic) {
+      break;
+    }
+    payload.resize(size_t(record.storedSize));
+    if (!m_data.read((char*)payload.data(), payload.size()) ||
+        checksum(payload.data(), payload.size()) != record.checksum) {
+      break;
+    }
+    header().dataSize = offset + sizeof(record) + record.storedSize;
+
+    const BrickKey key = getKey(record.key);
+    auto existing = m_slots.find(key);
+    if (existing != m_slots.end()) {
+      evict(key);
+    }
+    if (m_freeEntries.empty() && !growIndex()) {
+      break;
+    }
+    const size_t i = m_freeEntries.back();
+    m_freeEntries.pop_back();
+    IndexEntry& e = entry(i);
+    memcpy(e.key, record.key, sizeof(e.key));
+    e.offset = offset;
+    e.storedSize = record.storedSize;
+    e.rawSize = record.rawSize;
+    memcpy(e.min, record.min, sizeof(e.min));
+    memcpy(e.max, record.max, sizeof(e.max));
+    e.lastUse = ++header().useCounter;
+    e.checksum = record.checksum;
+    e.flags = FlagUsed | (record.flags & FlagCompressed);
+    m_lru.push_front(key);
+    m_slots[key] = Slot{i, m_lru.begin()};
+    m_liveSize += sizeof(record) + record.storedSize;
+  }
+  m_data.clear();
+  header().magic = IndexMagic;
+  m_index->Flush();
+}
+
+BrickCacher::IndexHeader& BrickCacher::header() const {
+  return *(IndexHeader*)m_index->GetDataPointer();
+}
+
+BrickCacher::IndexEntry& BrickCacher::entry(size_t i) const {
+  return ((IndexEntry*)((uint8_t*)m_index->GetDataPointer() +
+                        sizeof(IndexHeader)))[i];
+}
+
+void BrickCacher::touch(Slot& slot) const {
+  entry(slot.entry).lastUse = ++header().useCounter;
+  m_lru.splice(m_lru.begin(), m_lru, slot.lru);
+}
+
+void BrickCacher::evict(const BrickKey& brickKey) const {
+  auto slot = m_slots.find(brickKey);
+  if (slot == m_slots.end()) return;
+  IndexEntry& e = entry(slot->second.entry);
+  m_liveSize -= sizeof(RecordHeader) + e.storedSize;
+  e.flags = 0;
+  m_freeEntries.push_back(slot->second.entry);
+  m_lru.erase(slot->second.lru);
+  m_slots.erase(slot);
+}
+
+void BrickCacher::makeRoom(uint64_t size) const {
+  while (!m_lru.empty() && m_liveSize + size > m_maxSize) {
+    evict(m_lru.back());
+  }
+  // evicted records stay in the data file until most of it is unused
+  if (header().dataSize > 2 * m_liveSize &&
+      header().dataSize + size > m_maxSize) {
+    compact();
+  }
+}
+
+void BrickCacher::compact() const {
+  // the live records are copied into a new file, the index is switched
+  // over to it only after it has been written completely
+  const std::string tempFilename = dataFilename() + std::string("Temp");
+  std::ofstream target(tempFilename, std::ios::binary);
+  std::vector<std::pair<size_t, uint64_t>> offsets;
+  std::vector<uint8_t> record;
+  uint64_t targetSize = 0;
+  for (const BrickKey& key : m_lru) {
+    const IndexEntry& e = entry(m_slots[key].entry);
+    record.resize(size_t(sizeof(RecordHeader) + e.storedSize));
+    m_data.seekg(std::streamoff(e.offset));
+    if (!m_data.read((char*)record.data(), record.size())) {
+      m_data.clear();
+      continue;
+    }
+    target.write((const char*)record.data(), record.size());
+    offsets.push_back(std::make_pair(m_slots[key].entry, targetSize));
+    targetSize += record.size();
+  }
+  target.close();
+  if (!target) {
+    LWARNING("(brickcacher) cannot compact " << dataFilename());
+    remove(tempFilename.c_str());
+    return;
+  }
+
+  // the old file stays in place until the new one replaces it, so if that
+  // fails the index still matches the old file
+  m_data.close();
+  if (!replaceFile(tempFilename, dataFilename())) {
+    LWARNING("(brickcacher) cannot replace " << dataFilename());
+    remove(tempFilename.c_str());
+    m_data.clear();
+    m_data.open(dataFilename(), std::ios::in | std::ios::out | std::ios::binary);
+    return;
+  }
+  // a crash before this point leaves stale offsets in the index, which
+  // the record checks of readBrick detect
+  for (const auto& offset : offsets) {
+    entry(offset.first).offset = offset.second;
+  }
+  header().dataSize = targetSize;
+  m_index->Flush();
+  m_data.clear();
+  m_data.open(dataFilename(), std::ios::in | std::ios::out | std::ios::binary);
+}
+
+bool BrickCacher::readRange(const BrickKey& brickKey,
+                            uint8_t* min, uint8_t* max) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto slot = m_slots.find(brickKey);
+  if (!m_index || slot == m_slots.end()) {
+    return false;
+  }
+  const IndexEntry& e = entry(slot->second.entry);
+  memcpy(min, e.min, sizeof(e.min));
+  memcpy(max, e.max, sizeof(e.max));
+  return true;
+}
+
+bool BrickCacher::readBrick(const BrickKey& brickKey,
+                            std::vector<uint8_t>& data) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto slot = m_slots.find(brickKey);
+  if (!m_index || slot == m_slots.end()) {
+    return false;
+  }
+  const IndexEntry& e = entry(slot->second.entry);
+
+  RecordHeader record;
+  std::vector<uint8_t> payload(size_t(e.storedSize));
+  m_data.seekg(std::streamoff(e.offset));
+  m_data.read((char*)&record, sizeof(record));
+  m_data.read((char*)payload.data(), payload.size());
+  if (!m_data || record.magic != RecordMagic ||
+      !(getKey(record.key) == brickKey) || record.storedSize != e.storedSize ||
+      checksum(payload.data(), payload.size()) != e.checksum) {
+    m_data.clear();
+    LWARNING("(brickcacher) dropping damaged brick " << brickKey.toString());
+    evict(brickKey);
+    return false;
+  }
+
+  data.resize(size_t(e.rawSize));
+  if (e.flags & FlagCompressed) {
+    const int size = LZ4_decompress_safe((const char*)payload.data(),
+                                         (char*)data.data(),
+                                         int(payload.size()), int(data.size()));
+    if (size != int(data.size())) {
+      LWARNING("(brickcacher) dropping damaged brick " << brickKey.toString());
+      evict(brickKey);
+      return false;
+    }
+  } else {
+    data.swap(payload);
+  }
+  touch(slot->second);
+  return true;
 }
 
-std::string BrickCacher::genFilename(const BrickKey& brickKey) const {
-  return m_dir + std::string("/") + m_prefix + std::string("_") +
-         brickKey.toFileDesc() + std::string(".") + m_ext;
+bool BrickCacher::writeBrick(const BrickKey& brickKey,
+                             const std::vector<uint8_t>& data,
+                             const uint8_t* min, const uint8_t* max) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_index || m_slots.find(brickKey) != m_slots.end()) {
+    return false;
+  }
+
+  RecordHeader record;
+  memset(&record, 0, sizeof(record));
+  record.magic = RecordMagic;
+  setKey(record.key, brickKey);
+  record.rawSize = data.size();
+  memcpy(record.min, min, sizeof(record.min));
+  memcpy(record.max, max, sizeof(record.max));
+
+  std::vector<uint8_t> compressed;
+  const uint8_t* payload = data.data();
+  record.storedSize = data.size();
+  if (m_compress) {
+    compressed.resize(size_t(LZ4_compressBound(int(data.size()))));
+    const int size = LZ4_compress((const char*)data.data(),
+                                  (char*)compressed.data(), int(data.size()));
+    if (size > 0 && size_t(size) < data.size()) {
+      payload = compressed.data();
+      record.storedSize = uint64_t(size);
+      record.flags = FlagCompressed;
+    }
+  }
+  record.checksum = checksum(payload, size_t(record.storedSize));
+
+  const uint64_t recordSize = sizeof(record) + record.storedSize;
+  if (recordSize > m_maxSize) {
+    return false;
+  }
+  makeRoom(recordSize);
+  if (m_freeEntries.empty() && !growIndex()) {
+    return false;
+  }
+
+  // append the record first, it becomes visible with its index entry
+  const uint64_t offset = header().dataSize;
+  m_data.seekp(std::streamoff(offset));
+  m_data.write((const char*)&record, sizeof(record));
+  m_data.write((const char*)payload, size_t(record.storedSize));
+  m_data.flush();
+  if (!m_data) {
+    m_data.clear();
+    LWARNING("(brickcacher) cannot write to " << dataFilename());
+    return false;
+  }
+
+  const size_t i = m_freeEntries.back();
+  m_freeEntries.pop_back();
+  IndexEntry& e = entry(i);
+  memcpy(e.key, record.key, sizeof(e.key));
+  e.offset = offset;
+  e.storedSize = record.storedSize;
+  e.rawSize = record.rawSize;
+  memcpy(e.min, record.min, sizeof(e.min));
+  memcpy(e.max, record.max, sizeof(e.max));
+  e.lastUse = ++header().useCounter;
+  e.checksum = record.checksum;
+  e.flags = FlagUsed | record.flags;
+  header().dataSize = offset + recordSize;
+
+  m_lru.push_front(brickKey);
+  m_slots[brickKey] = Slot{i, m_lru.begin()};
+  m_liveSize += recordSize;
+  return true;
 }
\ No newline at end of file
@@ -1,104 +1,131 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <fstream>
-#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
-#include "silverbullet/io/FileTools.h"
+#include <unordered_map>
+#include <vector>
+#include "common/BrickStatistics.h"
+#include "silverbullet/io/MemMappedFile.h"
 #include "silverbullet/dataio/base/Brick.h"
 
+// Caches generated bricks on disk. All bricks are appended to one data file,
+// and a memory mapped index maps the brick keys to their records and value
+// ranges, so getMaxMin never touches the data file. Bricks are LZ4 compressed
+// if that makes them smaller. If the cached bricks exceed maxSize bytes the
+// least recently used ones are evicted; the data file is rewritten once most
+// of it is unused. The index is only updated after a record has been
+// written, and every read checks the key and checksum of the record, so a
+// crash at any point only loses the bricks that were being written.
+// Two instances on the same files would overwrite each other's records, so
+// everyone in the process who caches into the same files has to use the
+// instance returned by shared().
 class BrickCacher {
 public:
   BrickCacher(const std::string& dir,
               const std::string& prefix,
-              const std::string& ext = "brickCache");
-  
+              const std::string& ext = "brickCache",
+              uint64_t maxSize = uint64_t(4) << 30,
+              bool compress = true);
+  ~BrickCacher();
+
+  // the instance for the files of dir, prefix and ext; as long as it is in
+  // use, the arguments maxSize and compress of later calls are ignored
+  static std::shared_ptr<BrickCacher> shared(const std::string& dir,
+                                             const std::string& prefix,
+                                             const std::string& ext = "brickCache",
+                                             uint64_t maxSize = uint64_t(4) << 30,
+                                             bool compress = true);
+
   void clear() const;
-  
+
   template <typename T>
   bool getMaxMin(const BrickKey& brickKey,
                  T& min, T& max) const {
-    std::string name = genFilename(brickKey);
-    if (!Core::IO::FileTools::fileExists(name)) {
+    static_assert(sizeof(T) <= 8, "value types are limited to 8 bytes");
+    uint8_t rawMin[8], rawMax[8];
+    if (!readRange(brickKey, rawMin, rawMax)) {
       return false;
-    } else {
-      std::ifstream brickfile (name, std::ios::binary);
-      if (!brickfile.is_open()) {
-        return false;
-      }
-      brickfile.read((char*)&min, sizeof(T));
-      brickfile.read((char*)&max, sizeof(T));
-      brickfile.close();
-      return true;
     }
+    memcpy(&min, rawMin, sizeof(T));
+    memcpy(&max, rawMax, sizeof(T));
+    return true;
   }
-  
+
   template <typename T>
   bool getBrick(const BrickKey& brickKey,
                 std::vector<uint8_t>& data) const {
-    
-    std::string name = genFilename(brickKey);
-    if (!Core::IO::FileTools::fileExists(name)) {
-      return false;
-    } else {
-      std::ifstream brickfile (name, std::ios::binary);
-      if (!brickfile.is_open()) {
-        return false;
-      }
-      T min, max;
-
-      brickfile.seekg (0, brickfile.end);
-      size_t length = brickfile.tellg();
-      brickfile.seekg (0, brickfile.beg);
-      data.resize(length-2*sizeof(T));
-      
-      brickfile.read((char*)&min, sizeof(T));
-      brickfile.read((char*)&max, sizeof(T));
-      brickfile.read((char*)data.data(), data.size());
-      brickfile.close();
-      return true;
-    }
+    return readBrick(brickKey, data);
   }
-  
+
+  // stores a brick unless it is cached already
   template <typename T>
   bool setBrick(const BrickKey& brickKey,
                 const std::vector<uint8_t>& data) const {
-    
-    std::string name = genFilename(brickKey);
-    if (Core::IO::FileTools::fileExists(name)) {
+    static_assert(sizeof(T) <= 8, "value types are limited to 8 bytes");
+    const T* typedData = (const T*)data.data();
+    size_t typedLength = data.size() / sizeof(T);
+    if (typedLength == 0) {
       return false;
-    } else {
-      std::ofstream brickfile (name, std::ios::binary);
-      if (!brickfile.is_open()) {
-        return false;
-      }
-      
-      T* typedData = (T*)data.data();
-      size_t typedLength = data.size() / sizeof(T);
-      
-      if (typedLength > 0) {
-        T min = *typedData;
-        T max = *typedData;
-        
-        for (size_t i = 1;i<typedLength;++i) {
-          if (*typedData < min) min = *typedData;
-          if (*typedData > max) max = *typedData;
-          typedData++;
-        }
-        
-        brickfile.write((char*)&min, sizeof(T));
-        brickfile.write((char*)&max, sizeof(T));
-        brickfile.write((char*)data.data(), data.size());
-      }
-      brickfile.close();
-      
-      return true;
     }
+
+    T min, max;
+    trinity::minMax(typedData, typedLength, 1, &min, &max);
+    uint8_t rawMin[8] = {0}, rawMax[8] = {0};
+    memcpy(rawMin, &min, sizeof(T));
+    memcpy(rawMax, &max, sizeof(T));
+    return writeBrick(brickKey, data, rawMin, rawMax);
   }
-  
+
 private:
+  struct IndexHeader;
+  struct IndexEntry;
+
+  struct Slot {
+    size_t entry;
+    std::list<BrickKey>::iterator lru;
+  };
+
   std::string m_dir;
   std::string m_prefix;
   std::string m_ext;
-  
-  std::string genFilename(const BrickKey& brickKey) const;
+  uint64_t    m_maxSize;
+  bool        m_compress;
+
+  mutable std::mutex m_mutex;
+  mutable std::unique_ptr<Core::IO::MemMappedFile> m_index;
+  mutable std::fstream m_data;
+  mutable std::unordered_map<BrickKey, Slot, BKeyHash> m_slots;
+  // most recently used brick first
+  mutable std::list<BrickKey> m_lru;
+  mutable std::vector<size_t> m_freeEntries;
+  // total size of the records that are still referenced
+  mutable uint64_t m_liveSize;
+
+  std::string dataFilename() const;
+  std::string indexFilename() const;
+
+  void open() const;
+  void close() const;
+  bool mapIndex(uint64_t capacity) const;
+  bool growIndex() const;
+  void rebuildIndex() const;
+  IndexHeader& header() const;
+  IndexEntry& entry(size_t i) const;
+
+  void touch(Slot& slot) const;
+  void evict(const BrickKey& brickKey) const;
+  void makeRoom(uint64_t size) const;
+  void compact() const;
+
+  bool readRange(const BrickKey& brickKey,
+                 uint8_t* min, uint8_t* max) const;
+  bool readBrick(const BrickKey& brickKey,
+                 std::vector<uint8_t>& data) const;
+  bool writeBrick(const BrickKey& brickKey, const std::vector<uint8_t>& data,
+                  const uint8_t* min, const uint8_t* max) const;
 };
@@ -1,19 +1,28 @@
 #include "io-base/fractal/FractalIO.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "common/BrickStatistics.h"
 #include "common/MemBlockPool.h"
+#include "common/ParallelFor.h"
 #include "common/TrinityError.h"
 #include "io-base/FractalListData.h"
+#include "silverbullet/io/FileTools.h"
 
 #include "mocca/base/Error.h"
 #include "mocca/log/LogManager.h"
 
+using namespace Core::IO::FileTools;
 using namespace Core::Math;
 using namespace trinity;
 
 FractalIO::FractalIO(const std::string& fileId, const IListData& listData)
-: m_fractalGenerator(nullptr)
+: m_fileId(fileId)
+, m_fractalGenerator(nullptr)
 #ifdef CACHE_BRICKS
-, m_bc(".",fileId)
+, m_bc(BrickCacher::shared(".",fileId))
 #endif
 {
   LINFO("(fractalio) initializing fractal for file id " + fileId);
@@ -24,6 +33,7 @@ FractalIO::FractalIO(const std::string& fileId, const IListData& listData)
     m_totalSize = fractalListData->totalSize(fileId);
     LINFO("(fractalio) acquiring brick size... ");
     m_brickSize = fractalListData->brickSize(fileId);
+    m_mode = fractalListData->generatorMode(fileId);
     m_bFlat = (m_totalSize.x <= m_brickSize.x &&
                m_totalSize.z <= m_brickSize.z &&
                m_totalSize.z <= m_brickSize.z);
@@ -168,49 +178,228 @@ Vec3ui FractalIO::getBrickVoxelCounts(const BrickKey& key) const {
   }
 }
 
+namespace {
+  // version 1 files hold estimated ranges that may miss voxels
+  const uint32_t MetaDataVersion = 2;
+}
+
 BrickMetaData FractalIO::getMetaForKey(const BrickKey& key) const {
   // TODO: compute gradients and fill 3rd and 4th parameters accordingly
-  
+  if (m_bFlat) {
+    return BrickMetaData{ 0.0, 255.0, 0.0, 1.0, getBrickVoxelCounts(key) };
+  }
+
   uint8_t min = 255, max = 0;
 #ifdef CACHE_BRICKS
-  if (m_bc.getMaxMin(key, min, max)) {
-      return BrickMetaData{ static_cast<double>(min), static_cast<double>(max), 0.0, 1.0, getBrickVoxelCounts(key) };
+  if (!m_bc->getMaxMin<uint8_t>(key, min, max))
+#endif
+  {
+    // samples cannot bound the iteration counts in between them, so all
+    // voxels are generated, row by row with the positions of getBrick
+    Vec3ui64 start, size;
+    Vec3d step;
+    genBrickParams(key, start, step, size);
+    const Vec3d dStart = Vec3d(start);
+    std::vector<uint64_t> xs(size.x);
+    for (uint64_t x = 0; x < size.x; ++x) {
+      xs[x] = uint64_t(dStart.x + step.x * x);
+    }
+    std::vector<uint8_t> row(size.x);
+    for (uint64_t z = 0; z < size.z; ++z) {
+      for (uint64_t y = 0; y < size.y; ++y) {
+        m_fractalGenerator->computeRow(xs.data(), xs.size(),
+                                       uint64_t(dStart.y + step.y * y),
+                                       uint64_t(dStart.z + step.z * z),
+                                       m_mode, row.data());
+        uint8_t rowMin, rowMax;
+        minMax(row.data(), row.size(), 1, &rowMin, &rowMax);
+        min = std::min(min, rowMin);
+        max = std::max(max, rowMax);
+      }
+    }
+  }
+  return BrickMetaData{ double(min), double(max), 0.0, 1.0,
+                        getBrickVoxelCounts(key) };
+}
+
+BrickMetaData FractalIO::deriveMetaForKey(const BrickKey& key,
+                                          const std::vector<BrickMetaData>& lod0) const {
+  uint8_t min = 255, max = 0;
+#ifdef CACHE_BRICKS
+  if (m_bc->getMaxMin<uint8_t>(key, min, max)) {
+    return BrickMetaData{ double(min), double(max), 0.0, 1.0,
+                          getBrickVoxelCounts(key) };
   }
 #endif
-  if (!m_bFlat) {
-    bool success;
-    auto data = getBrick(key, success);
-    
-    for (uint8_t v : *data) {
-      if (v < min) min = v;
-      if (v > max) max = v;
-      if (min == 0 && max == 255) break;
+
+  // the voxels of a coarser brick are samples of the full resolution
+  // volume; every sample inside the volume lies in the interior of a LoD 0
+  // brick, so the union of the LoD 0 bricks covering the sampled positions
+  // bounds them, only the samples outside the volume (the overlap at the
+  // border) are generated
+  Vec3ui64 start, size;
+  Vec3d step;
+  genBrickParams(key, start, step, size);
+  const Vec3d dStart = Vec3d(start);
+  const Vec3ui64 effectiveBricksize = getEffectiveBricksize();
+  const Vec3ui64 lod0Count = m_vLODTable[0].m_iLODBrickCount;
+
+  std::vector<uint64_t> positions[3];
+  std::vector<bool> outside[3];
+  uint64_t firstBrick[3], lastBrick[3];
+  bool hasInside = true;
+  for (size_t axis = 0; axis < 3; ++axis) {
+    uint64_t first = m_totalSize[axis], last = 0;
+    for (uint64_t i = 0; i < size[axis]; ++i) {
+      const uint64_t position = uint64_t(dStart[axis] + step[axis] * i);
+      positions[axis].push_back(position);
+      outside[axis].push_back(position >= m_totalSize[axis]);
+      if (position < m_totalSize[axis]) {
+        first = std::min(first, position);
+        last = std::max(last, position);
+      }
+    }
+    hasInside = hasInside && first <= last;
+    firstBrick[axis] = first / effectiveBricksize[axis];
+    lastBrick[axis] = std::min(last / effectiveBricksize[axis],
+                               lod0Count[axis] - 1);
+  }
+
+  if (hasInside) {
+    for (uint64_t z = firstBrick[2]; z <= lastBrick[2]; ++z) {
+      for (uint64_t y = firstBrick[1]; y <= lastBrick[1]; ++y) {
+        for (uint64_t x = firstBrick[0]; x <= lastBrick[0]; ++x) {
+          const BrickMetaData& child =
+            lod0[size_t(x + lod0Count.x * (y + lod0Count.y * z))];
+          min = std::min(min, uint8_t(child.minScalar));
+          max = std::max(max, uint8_t(child.maxScalar));
+        }
+      }
+    }
+  }
+
+  std::vector<uint64_t> outsideXs;
+  for (uint64_t x = 0; x < size.x; ++x) {
+    if (outside[0][x]) {
+      outsideXs.push_back(positions[0][x]);
     }
-    
-    return BrickMetaData{ static_cast<double>(min), static_cast<double>(max), 0.0, 1.0, getBrickVoxelCounts(key) };
   }
-  else {
-      return BrickMetaData{ 0.0, 255.0, 0.0, 1.0, getBrickVoxelCounts(key) };
+  std::vector<uint8_t> row(size.x);
+  for (uint64_t z = 0; z < size.z; ++z) {
+    for (uint64_t y = 0; y < size.y; ++y) {
+      const bool wholeRow = outside[2][z] || outside[1][y];
+      const std::vector<uint64_t>& xs = wholeRow ? positions[0] : outsideXs;
+      if (xs.empty()) {
+        continue;
+      }
+      m_fractalGenerator->computeRow(xs.data(), xs.size(), positions[1][y],
+                                     positions[2][z], m_mode, row.data());
+      uint8_t rowMin, rowMax;
+      minMax(row.data(), xs.size(), 1, &rowMin, &rowMax);
+      min = std::min(min, rowMin);
+      max = std::max(max, rowMax);
+    }
   }
+  return BrickMetaData{ double(min), double(max), 0.0, 1.0,
+                        getBrickVoxelCounts(key) };
 }
 
 
 std::vector<BrickMetaData> FractalIO::getBrickMetaData(uint64_t modality, uint64_t timestep) const {
-  uint64_t iTotalBrickCount = getTotalBrickCount(modality);
-  std::vector<BrickMetaData> result(iTotalBrickCount);
-  
+  std::vector<BrickMetaData> result;
+  if (loadMetaData(result)) {
+    return result;
+  }
+
+  // only the LoD 0 bricks are generated, which still computes every voxel
+  // of the full resolution volume once when no metadata file exists yet;
+  // the coarser levels are bounded by the LoD 0 ranges
   uint64_t levelCount = getLODLevelCount(modality);
-  
+  result.reserve(getTotalBrickCount(modality));
+  for (uint32_t lod = 0; lod < levelCount; lod++) {
+    const uint64_t indexInLodCount = getBrickLayout(lod, modality).volume();
+    const size_t first = result.size();
+    result.resize(first + size_t(indexInLodCount));
+    parallelFor(indexInLodCount, [&](uint32_t, uint64_t i) {
+      const BrickKey key(modality, timestep, lod, i);
+      result[first + size_t(i)] = lod == 0 ? getMetaForKey(key)
+                                           : deriveMetaForKey(key, result);
+    });
+  }
+
+  saveMetaData(result);
+  return result;
+}
+
+std::string FractalIO::metaDataFilename() const {
+  return std::string("./") + m_fileId + std::string(".brickMeta");
+}
+
+bool FractalIO::loadMetaData(std::vector<BrickMetaData>& result) const {
+  std::ifstream file(metaDataFilename(), std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  uint32_t version = 0;
+  uint64_t brickCount = 0;
+  uint64_t sizes[6] = {0};
+  file.read((char*)&version, sizeof(version));
+  file.read((char*)sizes, sizeof(sizes));
+  file.read((char*)&brickCount, sizeof(brickCount));
+  const Vec3ui64 totalSize(sizes[0], sizes[1], sizes[2]);
+  const Vec3ui64 brickSize(sizes[3], sizes[4], sizes[5]);
+  if (!file || version != MetaDataVersion || totalSize != m_totalSize || brickSize != m_brickSize ||
+      brickCount != getTotalBrickCount(0)) {
+    return false;
+  }
+
+  std::vector<uint8_t> ranges(size_t(brickCount) * 2);
+  file.read((char*)ranges.data(), ranges.size());
+  if (!file) {
+    return false;
+  }
+
+  result.clear();
+  result.reserve(size_t(brickCount));
+  uint64_t levelCount = getLODLevelCount(0);
   size_t i = 0;
   for (uint32_t lod = 0; lod < levelCount; lod++) {
-    uint64_t indexInLodCount = getBrickLayout(lod, modality).volume();
+    uint64_t indexInLodCount = getBrickLayout(lod, 0).volume();
     for (uint32_t indexInLod = 0; indexInLod < indexInLodCount; indexInLod++) {
-      BrickKey const key(modality, timestep, lod, indexInLodCount);
-      result[i++] = getMetaForKey(key);
+      const BrickKey key(0, 0, lod, indexInLod);
+      result.push_back(BrickMetaData{ double(ranges[i]), double(ranges[i + 1]),
+                                      0.0, 1.0, getBrickVoxelCounts(key) });
+      i += 2;
     }
   }
-  
-  return result;
+  return true;
+}
+
+void FractalIO::saveMetaData(const std::vector<BrickMetaData>& metaData) const {
+  std::vector<uint8_t> ranges;
+  ranges.reserve(metaData.size() * 2);
+  for (const auto& brick : metaData) {
+    ranges.push_back(uint8_t(brick.minScalar));
+    ranges.push_back(uint8_t(brick.maxScalar));
+  }
+
+  // the file is written next to the old one and replaces it when complete,
+  // so a crash or a concurrent reader never sees a truncated file
+  const std::string tempFilename = metaDataFilename() + ".tmp";
+  std::ofstream file(tempFilename, std::ios::binary);
+  const uint64_t brickCount = metaData.size();
+  const uint64_t sizes[6] = { m_totalSize.x, m_totalSize.y, m_totalSize.z,
+                              m_brickSize.x, m_brickSize.y, m_brickSize.z };
+  file.write((const char*)&MetaDataVersion, sizeof(MetaDataVersion));
+  file.write((const char*)sizes, sizeof(sizes));
+  file.write((const char*)&brickCount, sizeof(brickCount));
+  file.write((const char*)ranges.data(), ranges.size());
+  file.close();
+  if (!file || !replaceFile(tempFilename, metaDataFilename())) {
+    LWARNING("(fractalio) could not write brick metadata to " << metaDataFilename());
+    std::remove(tempFilename.c_str());
+  }
 }
 
 Vec3f FractalIO::getBrickExtents(const BrickKey& key) const {
@@ -344,7 +533,7 @@ std::shared_ptr<std::vector<uint8_t>> FractalIO::getBrick(const BrickKey& key, b
   data->resize(brickSize);
 
 #ifdef CACHE_BRICKS
-  if (m_bc.getBrick<uint8_t>(key, *data)) {
+  if (m_bc->getBrick<uint8_t>(key, *data)) {
     success = true;
     return data;
   }
@@ -355,33 +544,39 @@ std::shared_ptr<std::vector<uint8_t>> FractalIO::getBrick(const BrickKey& key, b
     Vec3ui64 start, end, size, pos;
     Vec3d step;
     genBrickParams(key, start, step, size);
-    pos = start;
     Vec3d dStart = Vec3d(start);
+    std::vector<uint64_t> xs(size.x);
+    for (uint64_t x = 0; x < size.x; ++x) {
+      xs[x] = uint64_t(dStart.x + step.x * x);
+    }
 #pragma omp parallel for
     for (int z = 0; z < size.z; ++z) {
       for (int y = 0; y < size.y; ++y) {
-        for (int x = 0; x < size.x; ++x) {
-          const size_t i = size_t(x + y * size.x + z * size.x * size.y);
-          const Vec3ui64 pos = Vec3ui64(dStart + step * Vec3d(x,y,z));
-          (*data)[i] = m_fractalGenerator->computePoint(pos.x, pos.y, pos.z);
-        }
+        const size_t i = size_t(y * size.x + z * size.x * size.y);
+        m_fractalGenerator->computeRow(xs.data(), xs.size(),
+                                       uint64_t(dStart.y + step.y * y),
+                                       uint64_t(dStart.z + step.z * z),
+                                       m_mode, &(*data)[i]);
       }
     }
   } else {
+    std::vector<uint64_t> xs(m_totalSize.x);
+    for (uint64_t x = 0; x < m_totalSize.x; ++x) {
+      xs[x] = x;
+    }
 #pragma omp parallel for
     for (int z = 0; z < m_totalSize.z; ++z) {
       for (int y = 0; y < m_totalSize.y; ++y) {
-        for (int x = 0; x < m_totalSize.x; ++x) {
-          const size_t i = size_t(x + y * m_totalSize.x + z *
-                                  m_totalSize.x * m_totalSize.y);
-          (*data)[i] = m_fractalGenerator->computePoint(x, y, z);
-        }
+        const size_t i = size_t(y * m_totalSize.x + z *
+                                m_totalSize.x * m_totalSize.y);
+        m_fractalGenerator->computeRow(xs.data(), xs.size(), y, z, m_mode,
+                                       &(*data)[i]);
       }
     }
   }
 
 #ifdef CACHE_BRICKS
-  m_bc.setBrick<uint8_t>(key, *data);
+  m_bc->setBrick<uint8_t>(key, *data);
 #endif
   
   success = true;
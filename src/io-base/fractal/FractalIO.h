@@ -55,13 +55,15 @@ namespace trinity {
     // todo end
     
   private:
+    std::string m_fileId;
     Core::Math::Vec3ui64 m_totalSize;
     Core::Math::Vec3ui64 m_brickSize;
     bool m_bFlat;
+    MandelbulbMode m_mode;
     std::unique_ptr<Mandelbulb<uint8_t>> m_fractalGenerator;
     
 #ifdef CACHE_BRICKS
-    BrickCacher          m_bc;
+    std::shared_ptr<BrickCacher> m_bc;
 #endif
  
     void genBrickParams(const BrickKey& brickKey, Core::Math::Vec3ui64& start, Core::Math::Vec3d& stepping,
@@ -80,7 +82,19 @@ namespace trinity {
     
     boolVec isLastBrick(const BrickKey& key) const;
     
+    // exact value range of a LoD 0 brick, from the brick cache if it holds
+    // the brick, otherwise from the generated voxels without storing it
     BrickMetaData getMetaForKey(const BrickKey& key) const;
+    // conservative value range of a brick of a coarser LoD, from the ranges
+    // of the LoD 0 bricks it samples, which are the first entries of lod0
+    BrickMetaData deriveMetaForKey(const BrickKey& key,
+                                   const std::vector<BrickMetaData>& lod0) const;
+    
+    // the metadata of all bricks is kept in a single file, in the order of
+    // getBrickMetaData
+    std::string metaDataFilename() const;
+    bool loadMetaData(std::vector<BrickMetaData>& result) const;
+    void saveMetaData(const std::vector<BrickMetaData>& metaData) const;
     
     void computeLODInfo();
     
@@ -3,6 +3,14 @@
 #include <cmath>   // sin, etc.
 #include <cstdint> // uint32_t etc.
 #include <limits>  // numeric_limits
+#include <vector>
+
+#include "io-base/fractal/MandelbulbKernels.h"
+
+// the reference generator evaluates the definition of the bulb with
+// trigonometric functions for every voxel, the vectorized ones use
+// trinity::mandelbulbRow in double or single precision
+enum class MandelbulbMode { Reference, Vectorized, VectorizedFloat };
 
 template <typename T> class Mandelbulb {
 public:
@@ -19,12 +27,36 @@ public:
   , m_n(n)  {}
   
   T computePoint(uint64_t sx, uint64_t sy, uint64_t sz) const {
-    return computePointFloat(m_bulbSize * double(sx) /
-                             (m_totalX - 1) - m_bulbSize / 2.0,
-                             m_bulbSize * double(sy) /
-                             (m_totalY - 1) - m_bulbSize / 2.0,
-                             m_bulbSize * double(sz) /
-                             (m_totalZ - 1) - m_bulbSize / 2.0);
+    return computePointFloat(coordinate(sx, m_totalX),
+                             coordinate(sy, m_totalY),
+                             coordinate(sz, m_totalZ));
+  }
+  
+  // computes the points (sx[i], sy, sz) for i < count; only the power 8 bulb
+  // has a vectorized implementation, the reference mode and other powers use
+  // computePoint
+  void computeRow(const uint64_t* sx, size_t count, uint64_t sy, uint64_t sz,
+                  MandelbulbMode mode, T* result) const {
+    if (mode == MandelbulbMode::Reference || m_n != 8) {
+      for (size_t i = 0; i < count; ++i) {
+        result[i] = computePoint(sx[i], sy, sz);
+      }
+      return;
+    }
+    
+    std::vector<double> cx(count);
+    for (size_t i = 0; i < count; ++i) {
+      cx[i] = coordinate(sx[i], m_totalX);
+    }
+    std::vector<uint32_t> iterations(count);
+    trinity::mandelbulbRow(cx.data(), count,
+                           coordinate(sy, m_totalY), coordinate(sz, m_totalZ),
+                           uint32_t(m_iMaxIterations), m_fBailout,
+                           mode == MandelbulbMode::VectorizedFloat,
+                           iterations.data());
+    for (size_t i = 0; i < count; ++i) {
+      result[i] = T(iterations[i]);
+    }
   }
   
   double getBailout() const { return m_fBailout; }
@@ -39,6 +71,10 @@ private:
   T m_iMaxIterations;
   uint32_t m_n;
   
+  double coordinate(uint64_t s, uint64_t total) const {
+    return m_bulbSize * double(s) / (total - 1) - m_bulbSize / 2.0;
+  }
+  
   double radius(double x, double y, double z) const {
     return std::sqrt(x * x + y * y + z * z);
   }
@@ -0,0 +1,191 @@
+#include "io-base/fractal/MandelbulbKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/BrickStatistics.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRINITY_MANDELBULB_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define TRINITY_TARGET_SSE41
+#define TRINITY_TARGET_AVX2
+#else
+#define TRINITY_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TRINITY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace trinity;
+
+namespace {
+
+// One step maps p = (x, y, z) to p^8 + c. With rho = |(x, y)| the angles of
+// p are the arguments of x + iy and z + i rho, so p^8 is obtained from the
+// 8th powers of these complex numbers: (z + i rho)^8 = r^8 (cos 8 theta +
+// i sin 8 theta), and the normalized (x + iy)^8 = cos 8 phi + i sin 8 phi.
+// On the z axis phi is 0, as atan2(0, 0) in the reference implementation.
+template <typename S>
+uint32_t pointScalar(S cx, S cy, S cz, uint32_t maxIterations, S bailout2) {
+  S x = 0, y = 0, z = 0;
+  for (uint32_t i = 0; i < maxIterations; ++i) {
+    const S rho = std::sqrt(x * x + y * y);
+    S u = rho > 0 ? x / rho : S(1);
+    S v = rho > 0 ? y / rho : S(0);
+    S a = z;
+    S b = rho;
+    for (int s = 0; s < 3; ++s) {
+      const S uv = u * v;
+      u = u * u - v * v;
+      v = uv + uv;
+      const S ab = a * b;
+      a = a * a - b * b;
+      b = ab + ab;
+    }
+    x = cx + b * u;
+    y = cy + b * v;
+    z = cz + a;
+    if (x * x + y * y + z * z > bailout2) {
+      return i;
+    }
+  }
+  return maxIterations;
+}
+
+template <typename S>
+void rowScalar(const double* cx, size_t count, double cy, double cz,
+               uint32_t maxIterations, double bailout, uint32_t* iterations) {
+  for (size_t i = 0; i < count; ++i) {
+    iterations[i] = pointScalar<S>(S(cx[i]), S(cy), S(cz), maxIterations,
+                                   S(bailout * bailout));
+  }
+}
+
+#ifdef TRINITY_MANDELBULB_X86
+// masks are vectors with all bits of the true lanes set, the iteration
+// counts are kept in the float lanes as well, which is exact below 2^24
+namespace sse41 {
+struct FloatOps {
+  typedef __m128 V;
+  typedef float Scalar;
+  static const size_t lanes = 4;
+  TRINITY_TARGET_SSE41 static V set1(float v) { return _mm_set1_ps(v); }
+  TRINITY_TARGET_SSE41 static V load(const float* p) { return _mm_loadu_ps(p); }
+  TRINITY_TARGET_SSE41 static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+  TRINITY_TARGET_SSE41 static V add(V a, V b) { return _mm_add_ps(a, b); }
+  TRINITY_TARGET_SSE41 static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+  TRINITY_TARGET_SSE41 static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+  TRINITY_TARGET_SSE41 static V div(V a, V b) { return _mm_div_ps(a, b); }
+  TRINITY_TARGET_SSE41 static V sqrt(V a) { return _mm_sqrt_ps(a); }
+  TRINITY_TARGET_SSE41 static V greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+  TRINITY_TARGET_SSE41 static V allTrue() { const V z = _mm_setzero_ps(); return _mm_cmpeq_ps(z, z); }
+  TRINITY_TARGET_SSE41 static V andMask(V a, V mask) { return _mm_and_ps(a, mask); }
+  TRINITY_TARGET_SSE41 static V andNot(V mask, V a) { return _mm_andnot_ps(mask, a); }
+  TRINITY_TARGET_SSE41 static V blend(V a, V b, V mask) { return _mm_blendv_ps(a, b, mask); }
+  TRINITY_TARGET_SSE41 static bool any(V mask) { return _mm_movemask_ps(mask) != 0; }
+};
+
+struct DoubleOps {
+  typedef __m128d V;
+  typedef double Scalar;
+  static const size_t lanes = 2;
+  TRINITY_TARGET_SSE41 static V set1(double v) { return _mm_set1_pd(v); }
+  TRINITY_TARGET_SSE41 static V load(const double* p) { return _mm_loadu_pd(p); }
+  TRINITY_TARGET_SSE41 static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+  TRINITY_TARGET_SSE41 static V add(V a, V b) { return _mm_add_pd(a, b); }
+  TRINITY_TARGET_SSE41 static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+  TRINITY_TARGET_SSE41 static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+  TRINITY_TARGET_SSE41 static V div(V a, V b) { return _mm_div_pd(a, b); }
+  TRINITY_TARGET_SSE41 static V sqrt(V a) { return _mm_sqrt_pd(a); }
+  TRINITY_TARGET_SSE41 static V greater(V a, V b) { return _mm_cmpgt_pd(a, b); }
+  TRINITY_TARGET_SSE41 static V allTrue() { const V z = _mm_setzero_pd(); return _mm_cmpeq_pd(z, z); }
+  TRINITY_TARGET_SSE41 static V andMask(V a, V mask) { return _mm_and_pd(a, mask); }
+  TRINITY_TARGET_SSE41 static V andNot(V mask, V a) { return _mm_andnot_pd(mask, a); }
+  TRINITY_TARGET_SSE41 static V blend(V a, V b, V mask) { return _mm_blendv_pd(a, b, mask); }
+  TRINITY_TARGET_SSE41 static bool any(V mask) { return _mm_movemask_pd(mask) != 0; }
+};
+
+#define TRINITY_KERNEL_TARGET TRINITY_TARGET_SSE41
+#include "io-base/fractal/MandelbulbKernels.inc"
+#undef TRINITY_KERNEL_TARGET
+}
+
+namespace avx2 {
+struct FloatOps {
+  typedef __m256 V;
+  typedef float Scalar;
+  static const size_t lanes = 8;
+  TRINITY_TARGET_AVX2 static V set1(float v) { return _mm256_set1_ps(v); }
+  TRINITY_TARGET_AVX2 static V load(const float* p) { return _mm256_loadu_ps(p); }
+  TRINITY_TARGET_AVX2 static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+  TRINITY_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_ps(a, b); }
+  TRINITY_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+  TRINITY_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+  TRINITY_TARGET_AVX2 static V div(V a, V b) { return _mm256_div_ps(a, b); }
+  TRINITY_TARGET_AVX2 static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+  TRINITY_TARGET_AVX2 static V greater(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  TRINITY_TARGET_AVX2 static V allTrue() { const V z = _mm256_setzero_ps(); return _mm256_cmp_ps(z, z, _CMP_EQ_OQ); }
+  TRINITY_TARGET_AVX2 static V andMask(V a, V mask) { return _mm256_and_ps(a, mask); }
+  TRINITY_TARGET_AVX2 static V andNot(V mask, V a) { return _mm256_andnot_ps(mask, a); }
+  TRINITY_TARGET_AVX2 static V blend(V a, V b, V mask) { return _mm256_blendv_ps(a, b, mask); }
+  TRINITY_TARGET_AVX2 static bool any(V mask) { return _mm256_movemask_ps(mask) != 0; }
+};
+
+struct DoubleOps {
+  typedef __m256d V;
+  typedef double Scalar;
+  static const size_t lanes = 4;
+  TRINITY_TARGET_AVX2 static V set1(double v) { return _mm256_set1_pd(v); }
+  TRINITY_TARGET_AVX2 static V load(const double* p) { return _mm256_loadu_pd(p); }
+  TRINITY_TARGET_AVX2 static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+  TRINITY_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_pd(a, b); }
+  TRINITY_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+  TRINITY_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+  TRINITY_TARGET_AVX2 static V div(V a, V b) { return _mm256_div_pd(a, b); }
+  TRINITY_TARGET_AVX2 static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+  TRINITY_TARGET_AVX2 static V greater(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+  TRINITY_TARGET_AVX2 static V allTrue() { const V z = _mm256_setzero_pd(); return _mm256_cmp_pd(z, z, _CMP_EQ_OQ); }
+  TRINITY_TARGET_AVX2 static V andMask(V a, V mask) { return _mm256_and_pd(a, mask); }
+  TRINITY_TARGET_AVX2 static V andNot(V mask, V a) { return _mm256_andnot_pd(mask, a); }
+  TRINITY_TARGET_AVX2 static V blend(V a, V b, V mask) { return _mm256_blendv_pd(a, b, mask); }
+  TRINITY_TARGET_AVX2 static bool any(V mask) { return _mm256_movemask_pd(mask) != 0; }
+};
+
+#define TRINITY_KERNEL_TARGET TRINITY_TARGET_AVX2
+#include "io-base/fractal/MandelbulbKernels.inc"
+#undef TRINITY_KERNEL_TARGET
+}
+#endif
+}
+
+void trinity::mandelbulbRow(const double* cx, size_t count, double cy, double cz,
+                            uint32_t maxIterations, double bailout,
+                            bool singlePrecision, uint32_t* iterations) {
+  if (count == 0) return;
+#ifdef TRINITY_MANDELBULB_X86
+  switch (activeSimdLevel()) {
+  case SimdLevel::AVX2:
+    if (singlePrecision) {
+      avx2::rowKernel<avx2::FloatOps>(cx, count, cy, cz, maxIterations, bailout, iterations);
+    } else {
+      avx2::rowKernel<avx2::DoubleOps>(cx, count, cy, cz, maxIterations, bailout, iterations);
+    }
+    return;
+  case SimdLevel::SSE41:
+    if (singlePrecision) {
+      sse41::rowKernel<sse41::FloatOps>(cx, count, cy, cz, maxIterations, bailout, iterations);
+    } else {
+      sse41::rowKernel<sse41::DoubleOps>(cx, count, cy, cz, maxIterations, bailout, iterations);
+    }
+    return;
+  case SimdLevel::Scalar:
+    break;
+  }
+#endif
+  if (singlePrecision) {
+    rowScalar<float>(cx, count, cy, cz, maxIterations, bailout, iterations);
+  } else {
+    rowScalar<double>(cx, count, cy, cz, maxIterations, bailout, iterations);
+  }
+}
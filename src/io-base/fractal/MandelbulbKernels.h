@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized generator of the power 8 Mandelbulb. Instead of the spherical
+// angles of the reference implementation the power is computed by repeated
+// squaring of complex numbers, which needs no trigonometric functions, and
+// 4 (SSE4.1) or 8 (AVX2) points are iterated at once until all of them
+// escaped. The instruction set is chosen by trinity::activeSimdLevel().
+
+namespace trinity {
+
+// iteration counts of the points (cx[i], cy, cz) for i < count, with the
+// semantics of Mandelbulb::computePoint; in single precision twice as many
+// points are iterated at once, but points close to the surface may get a
+// different count than in double precision
+void mandelbulbRow(const double* cx, size_t count, double cy, double cz,
+                   uint32_t maxIterations, double bailout,
+                   bool singlePrecision, uint32_t* iterations);
+}
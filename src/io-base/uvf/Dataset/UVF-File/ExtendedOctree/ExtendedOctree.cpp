@@ -306,15 +306,16 @@ const TOCEntry& ExtendedOctree::GetBrickToCData(size_t index) const {
  GetBrickData (scalar):
  
  Reads a brick from file and decompresses it if necessary. No magic here it 
- simply seeks to the position in the file, which is the header offset + the 
- brick-offset from the header, and then reads the data. Finally, checks if
- decompression is required.
+ simply reads the data at the position in the file, which is the header
+ offset + the brick-offset from the header. Finally, checks if decompression
+ is required. The read does not move the file position, so several threads
+ may fetch bricks at the same time.
 */ 
 void ExtendedOctree::GetBrickData(uint8_t* pData, uint64_t index) const {
 
   if(m_vTOC[size_t(index)].m_eCompression == CT_NONE) {
-    m_pLargeRAWFile->SeekPos(m_iOffset+m_vTOC[size_t(index)].m_iOffset);
-    m_pLargeRAWFile->ReadRAW(pData, m_vTOC[size_t(index)].m_iLength);
+    m_pLargeRAWFile->ReadAt(m_iOffset+m_vTOC[size_t(index)].m_iOffset, pData,
+                            m_vTOC[size_t(index)].m_iLength);
     return;
   }
 
@@ -330,8 +331,8 @@ void ExtendedOctree::GetBrickData(uint8_t* pData, uint64_t index) const {
 
   std::shared_ptr<uint8_t> out(pData, nonstd::null_deleter());
 
-  m_pLargeRAWFile->SeekPos(m_iOffset+m_vTOC[size_t(index)].m_iOffset);
-  m_pLargeRAWFile->ReadRAW(buf.get()->data(), m_vTOC[size_t(index)].m_iLength);
+  m_pLargeRAWFile->ReadAt(m_iOffset+m_vTOC[size_t(index)].m_iOffset,
+                          buf.get()->data(), m_vTOC[size_t(index)].m_iLength);
 
   switch (m_vTOC[size_t(index)].m_eCompression) {
   case CT_ZLIB:
@@ -365,6 +366,42 @@ void ExtendedOctree::GetBrickData(uint8_t* pData, const Core::Math::Vec4ui64& vB
   GetBrickData(pData, BrickCoordsToIndex(vBrickCoords));
 }
 
+/*
+ GetStoredBrickData:
+
+ Reads a brick from file like GetBrickData does but skips the decompression,
+ so compressed bricks can be handed on to someone else who decompresses them.
+*/
+COMPRESSION_TYPE ExtendedOctree::GetStoredBrickData(std::vector<uint8_t>& vData, const Core::Math::Vec4ui64& vBrickCoords) const {
+  const TOCEntry& entry = m_vTOC[size_t(BrickCoordsToIndex(vBrickCoords))];
+  const size_t iStart = vData.size();
+  vData.resize(iStart + size_t(entry.m_iLength));
+  m_pLargeRAWFile->ReadAt(m_iOffset+entry.m_iOffset, vData.data() + iStart,
+                          entry.m_iLength);
+  return entry.m_eCompression;
+}
+
+/*
+ GetBrickView:
+
+ Returns an uncompressed brick straight from the memory mapped file. As the
+ caller is about to touch the whole brick, the OS is asked to read it ahead.
+*/
+std::shared_ptr<const uint8_t> ExtendedOctree::GetBrickView(const Core::Math::Vec4ui64& vBrickCoords, uint64_t& iLength) const {
+  const TOCEntry& entry = m_vTOC[size_t(BrickCoordsToIndex(vBrickCoords))];
+  if (entry.m_eCompression != CT_NONE || !m_pLargeRAWFile->IsMapped())
+    return nullptr;
+
+  auto pView = m_pLargeRAWFile->GetMappedData(m_iOffset+entry.m_iOffset,
+                                              entry.m_iLength);
+  if (pView) {
+    m_pLargeRAWFile->Hint(LargeRAWFile::WILLNEED, m_iOffset+entry.m_iOffset,
+                          entry.m_iLength);
+    iLength = entry.m_iLength;
+  }
+  return pView;
+}
+
 /*
  IsLastBrick:
  
@@ -264,6 +264,27 @@ public:
   */
   void GetBrickData(uint8_t* pData, const Core::Math::Vec4ui64& vBrickCoords) const;
 
+  /**
+    use to get the data of a specific brick as it is stored in the file, i.e. without decompressing it
+    @param vData receives the stored data, it is appended to the current content
+    @param vBrickCoords coordinates of a brick: x,y,z are the spacial coordinates, w is the LoD level
+    @return the compression of the stored data
+  */
+  COMPRESSION_TYPE GetStoredBrickData(std::vector<uint8_t>& vData, const Core::Math::Vec4ui64& vBrickCoords) const;
+
+  /**
+    use to get the data of an uncompressed brick without copying it, if the file is memory mapped
+    @param vBrickCoords coordinates of a brick: x,y,z are the spacial coordinates, w is the LoD level
+    @param iLength receives the size of the brick in bytes
+    @return pointer into the mapped file that keeps the mapping alive, nullptr if the brick is compressed or the file is not mapped
+  */
+  std::shared_ptr<const uint8_t> GetBrickView(const Core::Math::Vec4ui64& vBrickCoords, uint64_t& iLength) const;
+
+  /**
+    Returns the encoded LZMA properties required to decompress CT_LZMA bricks
+  */
+  const std::array<uint8_t, 5>& GetLzmaProperties() const {return m_lzmaProps;}
+
 
   /**
     Returns the global aspect ratio of the volume
@@ -24,6 +24,7 @@
 
 // for find_if
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <map>
 #include <unordered_map>
@@ -36,6 +37,7 @@
 #include "LzmaCompression.h"
 #include "Lz4Compression.h"
 #include "BzlibCompression.h"
+#include "common/ParallelFor.h"
 #include "mocca/log/LogManager.h"
 
 
@@ -50,15 +52,19 @@
 
 ExtendedOctreeConverter::ExtendedOctreeConverter(
                           const Core::Math::Vec3ui64& vBrickSize,
-                          uint32_t iOverlap, uint64_t iMemLimit) :
+                          uint32_t iOverlap, uint64_t iMemLimit,
+                          uint32_t iThreadCount) :
     m_fProgress(0.0f),
     m_pProgressTimer(new ProgressTimer()),
     m_vBrickSize(vBrickSize),
     m_iOverlap(iOverlap),
     m_iMemLimit(iMemLimit),
-    m_iCacheAccessCounter(0),
+    m_iSlabMemLimit(iMemLimit/4),
+    m_iThreadCount(iThreadCount),
     m_pBrickStatVec(NULL)
 {
+  if (m_iThreadCount == 0)
+    m_iThreadCount = trinity::defaultWorkerCount();
   m_pProgressTimer->Start();
 }
 
@@ -112,7 +118,7 @@ bool ExtendedOctreeConverter::Convert(const std::string& filename,
   a bricked octree happens. It starts by creating a new ExtendedOctree
   object, passes the user's parameters on to that object and computes
   the header data. It creates LoD zero by permuting/bricking the input
-  data, then it computes the hierarchy. As this hierarchy computation
+  data and computes the hierarchy on the fly. As this hierarchy computation
   involves averaging we choose an appropriate template at this point.
   Next, the function writes the header to disk and flushes the
   write cache. Finally, the file is truncated to the appropriate length
@@ -160,77 +166,80 @@ bool ExtendedOctreeConverter::Convert(LargeRAWFile_ptr pLargeRAWFileIn,
 
   SetupCache(e);
 
-  // brick (permute) the input data
-  PermuteInputData(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
+  // the ToC of all levels is set up front, so the bricks of the levels
+  // can be computed in any order
+  for (uint64_t LoD = 0;LoD<e.GetLODCount();LoD++) {
+    AppendToC(e, LoD);
+  }
 
-  // compute hierarchy
+  // brick (permute) the input data and compute the hierarchy
 
   // now comes the really nasty part where we convert the input arguments
   // to template parameters, effectively writing out all branches
   if (bComputeMedian)  {
     switch (e.m_eComponentType) {
       case ExtendedOctree::CT_UINT8:
-        ComputeHierarchy<uint8_t, true>(e, bClampToEdge);
+        ComputeHierarchy<uint8_t, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_UINT16:
-        ComputeHierarchy<uint16_t, true>(e, bClampToEdge);
+        ComputeHierarchy<uint16_t, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_UINT32:
-        ComputeHierarchy<uint32_t, true>(e, bClampToEdge);
+        ComputeHierarchy<uint32_t, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_UINT64:
-        ComputeHierarchy<uint64_t, true>(e, bClampToEdge);
+        ComputeHierarchy<uint64_t, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_INT8:
-        ComputeHierarchy<int8_t, true>(e, bClampToEdge);
+        ComputeHierarchy<int8_t, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_INT16:
-        ComputeHierarchy<int16_t, true>(e, bClampToEdge);
+        ComputeHierarchy<int16_t, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_INT32:
-        ComputeHierarchy<int32_t, true>(e, bClampToEdge);
+        ComputeHierarchy<int32_t, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_INT64:
-        ComputeHierarchy<int64_t, true>(e, bClampToEdge);
+        ComputeHierarchy<int64_t, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_FLOAT32:
-        ComputeHierarchy<float, true>(e, bClampToEdge);
+        ComputeHierarchy<float, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_FLOAT64:
-        ComputeHierarchy<double, true>(e, bClampToEdge);
+        ComputeHierarchy<double, true>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
     }
   } else {
     switch (e.m_eComponentType) {
       case ExtendedOctree::CT_UINT8:
-        ComputeHierarchy<uint8_t, false>(e, bClampToEdge);
+        ComputeHierarchy<uint8_t, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_UINT16:
-        ComputeHierarchy<uint16_t, false>(e, bClampToEdge);
+        ComputeHierarchy<uint16_t, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_UINT32:
-        ComputeHierarchy<uint32_t, false>(e, bClampToEdge);
+        ComputeHierarchy<uint32_t, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_UINT64:
-        ComputeHierarchy<uint64_t, false>(e, bClampToEdge);
+        ComputeHierarchy<uint64_t, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_INT8:
-        ComputeHierarchy<int8_t, false>(e, bClampToEdge);
+        ComputeHierarchy<int8_t, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_INT16:
-        ComputeHierarchy<int16_t, false>(e, bClampToEdge);
+        ComputeHierarchy<int16_t, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_INT32:
-        ComputeHierarchy<int32_t, false>(e, bClampToEdge);
+        ComputeHierarchy<int32_t, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_INT64:
-        ComputeHierarchy<int64_t, false>(e, bClampToEdge);
+        ComputeHierarchy<int64_t, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_FLOAT32:
-        ComputeHierarchy<float, false>(e, bClampToEdge);
+        ComputeHierarchy<float, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
       case ExtendedOctree::CT_FLOAT64:
-        ComputeHierarchy<double, false>(e, bClampToEdge);
+        ComputeHierarchy<double, false>(e, pLargeRAWFileIn, iInOffset, bClampToEdge);
         break;
     }
   }
@@ -277,17 +286,17 @@ bool ExtendedOctreeConverter::Convert(LargeRAWFile_ptr pLargeRAWFileIn,
 /*
   GetInputBrick:
 
-  This function extracts data for a specified brick from the linear raw input file.
-  Index magic is explained in the function.
+  This function extracts data for a specified brick from the slab of the
+  linear raw input that is in memory. Index magic is explained in the function.
 */
 void ExtendedOctreeConverter::GetInputBrick(std::vector<uint8_t>& vData,
                                             ExtendedOctree &tree,
-                                            LargeRAWFile_ptr pLargeRAWFileIn,
-                                            uint64_t iInOffset, 
+                                            const InputSlab& slab,
                                             const Core::Math::Vec4ui64& coords,
                                             bool bClampToEdge) {
   const Core::Math::Vec3ui64 vBrickSize = tree.ComputeBrickSize(coords);
-  const uint64_t iBricksSize = (tree.m_vTOC.end()-1)->m_iLength;
+  const uint64_t iBricksSize =
+    tree.m_vTOC[size_t(tree.BrickCoordsToIndex(coords))].m_iLength;
   if (vData.size() != size_t(iBricksSize)) vData.resize(size_t(iBricksSize));
 
   // zero out the data (this makes sure boundaries are zero)
@@ -314,20 +323,19 @@ void ExtendedOctreeConverter::GetInputBrick(std::vector<uint8_t>& vData,
   for (uint64_t z = 0;z<zEnd-zStart;z++) {
     for (uint64_t y = 0;y<yEnd-yStart;y++) {
 
-      // the offset into the large raw file:
-      // as usual we skip beyond the user specified iInOffset next we compute the
-      // voxel coordinates multiplied with the size of a voxel to get to bytes.
+      // the offset into the slab:
+      // we compute the voxel coordinates in the volume, subtract the origin of
+      // the slab and multiply with the size of a voxel to get to bytes.
       // The voxel coordinates are computed as follows for all but the starting bricks
       // we fill the overlap (so step m_iOverlap steps back) from the x,y, and z positions
       // next add the coordinates of the brick to fetch multiplied with the effective
       // brick size (i.e. the brick size without the overlap regions on each side)
       // then do the usual 3D to 1D conversion by multiplying y coordinates with the
-      // length of a line (tree.m_vVolumeSize.x) and the z coordinate with the size
-      // of a slice (tree.m_vVolumeSize.x * tree.m_vVolumeSize.y) since we are indexing
-      // into the input volume we need to use tree.m_vVolumeSize for this
-      const uint64_t iCurrentInOffset = iInOffset + iVoxelSize * (0-(m_iOverlap-xStart) + coords.x * (m_vBrickSize.x-m_iOverlap*2) +
-                                                         (y-(m_iOverlap-yStart) + coords.y * (m_vBrickSize.y-m_iOverlap*2)) * tree.m_vVolumeSize.x +
-                                                         (z-(m_iOverlap-zStart) + coords.z * (m_vBrickSize.z-m_iOverlap*2)) * tree.m_vVolumeSize.x * tree.m_vVolumeSize.y);
+      // length of a line (slab.m_vSize.x) and the z coordinate with the size
+      // of a slice in the slab (slab.m_vSize.x * slab.m_vSize.y)
+      const uint64_t iCurrentInOffset = iVoxelSize * (0-(m_iOverlap-xStart) + coords.x * (m_vBrickSize.x-m_iOverlap*2) +
+                                                      (y-(m_iOverlap-yStart) + coords.y * (m_vBrickSize.y-m_iOverlap*2) - slab.m_iFirstY) * slab.m_vSize.x +
+                                                      (z-(m_iOverlap-zStart) + coords.z * (m_vBrickSize.z-m_iOverlap*2) - slab.m_iFirstZ) * slab.m_vSize.x * slab.m_vSize.y);
 
       // the offset into the target array
       // this is just a simple 3D to 1D conversion of the current position
@@ -349,8 +357,8 @@ void ExtendedOctreeConverter::GetInputBrick(std::vector<uint8_t>& vData,
         iLineSize -= m_iOverlap*iVoxelSize;
       }
 
-      pLargeRAWFileIn->SeekPos(iCurrentInOffset);
-      pLargeRAWFileIn->ReadRAW((uint8_t*)&vData[iOutOffset], iLineSize);
+      memcpy(&vData[iOutOffset], &slab.m_vData[size_t(iCurrentInOffset)],
+             size_t(iLineSize));
     }
   }
 
@@ -458,6 +466,10 @@ void ExtendedOctreeConverter::ClampToEdge(std::vector<uint8_t>& vData,
 
 /// Computes max min statistics for each brick and rewrites 
 /// it using compression, if desired.
+/// The bricks are processed in batches: the workers load, analyze and
+/// compress the bricks of a batch concurrently, then the batch is written
+/// in order. As a brick never grows by compression, writing a batch cannot
+/// overwrite bricks of the next batch that have not been read yet.
 void ExtendedOctreeConverter::ComputeStatsAndCompressAll(ExtendedOctree& tree)
 {
   FlushCache(tree); // be sure we've got everything on disk.
@@ -467,91 +479,126 @@ void ExtendedOctreeConverter::ComputeStatsAndCompressAll(ExtendedOctree& tree)
                             size_t(tree.m_iComponentCount);
   const size_t maxbricksize = static_cast<size_t>(tree.m_iBrickSize.volume() *
                                                   iVoxelSize);
-  std::shared_ptr<uint8_t> BrickData(new uint8_t[maxbricksize],
-                                     nonstd::DeleteArray<uint8_t>());
-  std::shared_ptr<uint8_t> compressed(new uint8_t[maxbricksize],
-                                      nonstd::DeleteArray<uint8_t>());
+  const size_t iBrickCount = tree.m_vTOC.size();
 
-  size_t iReportInterval = std::max<size_t>(1, tree.m_vTOC.size()/2000);
+  // BrickStat grows the vector on demand, the workers must not do that
+  assert(m_pBrickStatVec);
+  if (m_pBrickStatVec->size() < iBrickCount * size_t(tree.m_iComponentCount))
+    m_pBrickStatVec->resize(iBrickCount * size_t(tree.m_iComponentCount));
+
+  size_t iReportInterval = std::max<size_t>(1, iBrickCount/2000);
 
   if(m_eCompression == CT_NONE) {
     // compression is disabled.  That makes our job pretty easy: only compute
     // the brick stats
-    for(size_t i=0; i < tree.m_vTOC.size(); ++i) {
-      tree.GetBrickData(BrickData.get(), i);
-      BrickStat(m_pBrickStatVec, i, BrickData.get(), BrickSize(tree, i),
+    std::vector<std::shared_ptr<uint8_t>> vBrickData(m_iThreadCount);
+    for (auto& pBrickData : vBrickData)
+      pBrickData.reset(new uint8_t[maxbricksize], nonstd::DeleteArray<uint8_t>());
+
+    std::atomic<uint64_t> iProcessed(0);
+    trinity::parallelFor(iBrickCount, [&](uint32_t iWorker, uint64_t i) {
+      uint8_t* pBrickData = vBrickData[iWorker].get();
+      tree.GetBrickData(pBrickData, i);
+      BrickStat(m_pBrickStatVec, i, pBrickData, BrickSize(tree, i),
                 tree.m_iComponentCount, tree.m_eComponentType);
 
-      if (i % iReportInterval == 0) {
-        m_fProgress = float(i) / tree.m_vTOC.size();
+      const uint64_t iCount = ++iProcessed;
+      if (iWorker == 0 && iCount / iReportInterval != (iCount-1) / iReportInterval) {
+        m_fProgress = float(iCount) / iBrickCount;
         std::string msg = m_pProgressTimer->GetProgressMessage(m_fProgress);
         
         LINFO("Statistic computation ... "<< (m_fProgress*100.0f) << "% (" <<
               msg.c_str() << ")");
       }
-    }
+    }, m_iThreadCount);
   } else {
-    std::array<uint8_t, 5> lzmaProps;
+    // each brick of a batch keeps its uncompressed data in case compression
+    // does not pay off, so the batch size is bounded by the memory limit
+    const size_t iBatchSize = std::max<size_t>(m_iThreadCount,
+      std::min<size_t>(4 * m_iThreadCount, size_t(m_iMemLimit / (2 * maxbricksize))));
 
-    // foreach brick:
-    //   load it up
-    //   compress it
-    //   write compressed payload
+    struct Brick {
+      std::shared_ptr<uint8_t> pData;
+      std::shared_ptr<uint8_t> pCompressed;
+      uint64_t iCompressedLength;
+    };
+    std::vector<Brick> vBatch(iBatchSize);
+    for (auto& brick : vBatch)
+      brick.pData.reset(new uint8_t[maxbricksize], nonstd::DeleteArray<uint8_t>());
+
+    // foreach batch of bricks:
+    //   load them up, compute their stats and compress them in parallel
+    //   write the compressed payloads in order
     //   update brick metadata based on what compression changed
-    for(size_t i=0; i < tree.m_vTOC.size(); ++i) {
-      tree.GetBrickData(BrickData.get(), i);
-      BrickStat(m_pBrickStatVec, i, BrickData.get(), BrickSize(tree, i),
-                tree.m_iComponentCount, tree.m_eComponentType);
+    for (size_t iStart = 0; iStart < iBrickCount; iStart += iBatchSize) {
+      const size_t iEnd = std::min(iBrickCount, iStart + iBatchSize);
+
+      trinity::parallelFor(iEnd - iStart, [&](uint32_t, uint64_t j) {
+        const size_t i = iStart + size_t(j);
+        Brick& brick = vBatch[size_t(j)];
+        tree.GetBrickData(brick.pData.get(), i);
+        BrickStat(m_pBrickStatVec, i, brick.pData.get(), BrickSize(tree, i),
+                  tree.m_iComponentCount, tree.m_eComponentType);
+
+        switch (m_eCompression) {
+        case CT_ZLIB:
+          brick.iCompressedLength = zCompress(brick.pData, BrickSize(tree, i),
+                                              brick.pCompressed,
+                                              tree.m_iCompressionLevel); // 0..9 (0 no comp)
+          break;
+        case CT_LZMA: {
+          std::array<uint8_t, 5> lzmaProps;
+          brick.iCompressedLength = lzmaCompress(brick.pData, BrickSize(tree, i),
+                                                 brick.pCompressed, lzmaProps,
+                                                 tree.m_iCompressionLevel - 1); // 0..9
+          assert(lzmaProps == tree.m_lzmaProps);
+          break; }
+        case CT_LZ4:
+          brick.iCompressedLength = lz4Compress(brick.pData, BrickSize(tree, i),
+                                                brick.pCompressed,
+                                                tree.m_iCompressionLevel); // 1..17
+          break;
+        case CT_BZLIB:
+          brick.iCompressedLength = bzCompress(brick.pData, BrickSize(tree, i),
+                                               brick.pCompressed,
+                                               tree.m_iCompressionLevel); // 1..9
+          break;
+        case CT_LZHAM:
+          throw std::runtime_error("lzham compression format is not supported anymore by Trinity");
+          break;
+        default:
+          throw std::runtime_error("unknown compression format");
+        }
+      }, m_iThreadCount);
 
-      uint64_t newlen = 0;
-      switch (m_eCompression) {
-      case CT_ZLIB:
-        newlen = zCompress(BrickData, BrickSize(tree, i), compressed,
-                           tree.m_iCompressionLevel); // 0..9 (0 no comp)
-        break;
-      case CT_LZMA:
-        newlen = lzmaCompress(BrickData, BrickSize(tree, i), compressed,
-                              lzmaProps, tree.m_iCompressionLevel - 1); // 0..9
-        assert(lzmaProps == tree.m_lzmaProps);
-        break;
-      case CT_LZ4:
-        newlen = lz4Compress(BrickData, BrickSize(tree, i), compressed,
-                             tree.m_iCompressionLevel); // 1..17
-        break;
-      case CT_BZLIB:
-        newlen = bzCompress(BrickData, BrickSize(tree, i), compressed,
-                            tree.m_iCompressionLevel); // 1..9
-        break;
-      case CT_LZHAM:
-        throw std::runtime_error("lzham compression format is not supported anymore by Trinity");
-        break;
-      default:
-        throw std::runtime_error("unknown compression format");
-      }
-      std::shared_ptr<uint8_t> data;
-
-      if(newlen < BrickSize(tree, i)) {
-        tree.m_vTOC[i].m_iLength = newlen;
-        tree.m_vTOC[i].m_eCompression = m_eCompression;
-        data = compressed;
-      } else {
-        tree.m_vTOC[i].m_iLength = BrickSize(tree, i);
-        tree.m_vTOC[i].m_eCompression = CT_NONE;
-        data = BrickData;
-      }
-      if(i > 0) {
-        tree.m_vTOC[i].m_iOffset = tree.m_vTOC[i-1].m_iOffset +
-                                   tree.m_vTOC[i-1].m_iLength;
-      }
-      tree.m_pLargeRAWFile->SeekPos(tree.m_vTOC[i].m_iOffset);
-      tree.m_pLargeRAWFile->WriteRAW(data.get(), tree.m_vTOC[i].m_iLength);
-      
-      if (i % iReportInterval == 0) {
-        m_fProgress = float(i) / tree.m_vTOC.size();
-        std::string msg = m_pProgressTimer->GetProgressMessage(m_fProgress);
+      for (size_t i = iStart; i < iEnd; ++i) {
+        Brick& brick = vBatch[i - iStart];
+        std::shared_ptr<uint8_t> data;
+
+        if(brick.iCompressedLength < BrickSize(tree, i)) {
+          tree.m_vTOC[i].m_iLength = brick.iCompressedLength;
+          tree.m_vTOC[i].m_eCompression = m_eCompression;
+          data = brick.pCompressed;
+        } else {
+          tree.m_vTOC[i].m_iLength = BrickSize(tree, i);
+          tree.m_vTOC[i].m_eCompression = CT_NONE;
+          data = brick.pData;
+        }
+        if(i > 0) {
+          tree.m_vTOC[i].m_iOffset = tree.m_vTOC[i-1].m_iOffset +
+                                     tree.m_vTOC[i-1].m_iLength;
+        }
+        tree.m_pLargeRAWFile->SeekPos(tree.m_vTOC[i].m_iOffset);
+        tree.m_pLargeRAWFile->WriteRAW(data.get(), tree.m_vTOC[i].m_iLength);
+        brick.pCompressed.reset();
         
-        LINFO("Statistics and compression ... "<< (m_fProgress*100.0f) <<
-              "% (" << msg.c_str() << ")");
+        if (i % iReportInterval == 0) {
+          m_fProgress = float(i) / iBrickCount;
+          std::string msg = m_pProgressTimer->GetProgressMessage(m_fProgress);
+          
+          LINFO("Statistics and compression ... "<< (m_fProgress*100.0f) <<
+                "% (" << msg.c_str() << ")");
+        }
       }
     }
   }
@@ -890,18 +937,34 @@ void ExtendedOctreeConverter::GetBrick(uint8_t* pData, ExtendedOctree &tree,
   SetupCache:
 
   Computes the size of the cache: simply as available size divided
-  by the size of a cache element
+  by the size of a cache element. The elements are distributed over
+  a few shards per worker, so concurrent workers seldom compete for
+  the same shard lock.
 */
 void ExtendedOctreeConverter::SetupCache(ExtendedOctree &tree) {
   size_t CacheElementDataSize = size_t(tree.GetComponentTypeSize() * 
                                 tree.GetComponentCount() * 
                                 tree.m_iBrickSize.volume());
-  uint64_t iCacheElemCount = m_iMemLimit / (CacheElementDataSize + sizeof(CacheEntry));
+  uint64_t iCacheElemCount = (m_iMemLimit - m_iSlabMemLimit) /
+                             (CacheElementDataSize + sizeof(CacheEntry));
   iCacheElemCount = std::min(iCacheElemCount, tree.ComputeBrickCount());
-  m_vBrickCache.resize(size_t(iCacheElemCount));
 
-  for (BrickCacheIter i = m_vBrickCache.begin();i != m_vBrickCache.end();++i) {
-    i->SetSize(CacheElementDataSize);
+  m_vBrickCache.clear();
+  if (iCacheElemCount == 0) return;
+
+  const size_t iShardCount = size_t(std::min<uint64_t>(iCacheElemCount,
+                                                       4 * m_iThreadCount));
+  for (size_t s = 0;s<iShardCount;++s) {
+    m_vBrickCache.emplace_back(new CacheShard());
+    CacheShard& shard = *m_vBrickCache.back();
+    // spread the remainder over the first shards
+    const size_t iShardElemCount = size_t(iCacheElemCount / iShardCount) +
+                                   (s < iCacheElemCount % iShardCount ? 1 : 0);
+    for (size_t i = 0;i<iShardElemCount;++i) {
+      shard.m_entries.emplace_back();
+      shard.m_entries.back().SetSize(CacheElementDataSize);
+    }
+    shard.m_index.reserve(iShardElemCount);
   }
 }
 
@@ -913,25 +976,54 @@ void ExtendedOctreeConverter::SetupCache(ExtendedOctree &tree) {
 void ExtendedOctreeConverter::FlushCache(ExtendedOctree &tree) {
   double t1 = m_pProgressTimer->Elapsed();
 
-  for (BrickCacheIter i = m_vBrickCache.begin();i != m_vBrickCache.end();++i) {
-    if (i->m_bDirty) {
-      WriteBrickToDisk(tree, i);
-      m_fProgress = -std::distance(i, m_vBrickCache.begin()) /
-                     float(m_vBrickCache.size());
-
-      // Do not update display more than twice in a second!
-      const double t2 = m_pProgressTimer->Elapsed();
-      if ((t2 - t1) > 500) {
-        t1 = t2;
-        const std::string msg = m_pProgressTimer->GetProgressMessage(m_fProgress);
-        
-        LINFO("Flushing brick cache ... "<< (m_fProgress*100.0f) << "% (" <<
-              msg.c_str() << ")");
+  for (size_t s = 0;s<m_vBrickCache.size();++s) {
+    CacheShard& shard = *m_vBrickCache[s];
+    std::lock_guard<std::mutex> lock(shard.m_mutex);
+    for (BrickCacheIter i = shard.m_entries.begin();i != shard.m_entries.end();++i) {
+      if (i->m_bDirty) {
+        WriteBrickToDisk(tree, i);
+        m_fProgress = s / float(m_vBrickCache.size());
+
+        // Do not update display more than twice in a second!
+        const double t2 = m_pProgressTimer->Elapsed();
+        if ((t2 - t1) > 500) {
+          t1 = t2;
+          const std::string msg = m_pProgressTimer->GetProgressMessage(m_fProgress);
+          
+          LINFO("Flushing brick cache ... "<< (m_fProgress*100.0f) << "% (" <<
+                msg.c_str() << ")");
+        }
       }
     }
   }
 }
 
+/*
+  EvictCacheEntry:
+
+  Takes the least recently used entry of the shard (the last one), writes
+  it to disk if it's dirty and moves it to the front for the new brick
+*/
+ExtendedOctreeConverter::BrickCacheIter
+ExtendedOctreeConverter::EvictCacheEntry(ExtendedOctree &tree, CacheShard& shard,
+                                         size_t index) {
+  BrickCacheIter cacheEntry = std::prev(shard.m_entries.end());
+
+  if (cacheEntry->m_pData == NULL) {
+    // if this is a never before used cache entry allocate memory
+    cacheEntry->Allocate();
+  } else {
+    // if it's dirty, write to disk
+    if (cacheEntry->m_bDirty) WriteBrickToDisk(tree, cacheEntry);
+    shard.m_index.erase(cacheEntry->m_index);
+  }
+
+  shard.m_entries.splice(shard.m_entries.begin(), shard.m_entries, cacheEntry);
+  cacheEntry->m_index = index;
+  shard.m_index[index] = cacheEntry;
+  return cacheEntry;
+}
+
 // @returns the number of bytes needed to store the (uncompressed) given brick.
 uint64_t ExtendedOctreeConverter::BrickSize(const ExtendedOctree& tree,
                                             uint64_t index) {
@@ -996,10 +1088,16 @@ void ExtendedOctreeConverter::BrickStat(
 
 void ExtendedOctreeConverter::WriteBrickToDisk(ExtendedOctree &tree, BrickCacheIter element)
 {
-  WriteBrickToDisk(tree, element->m_pData, element->m_index);
+  WriteBrickToDiskLocked(tree, element->m_pData, element->m_index);
   element->m_bDirty = false;
 }
 
+void ExtendedOctreeConverter::WriteBrickToDiskLocked(ExtendedOctree &tree, uint8_t* pData, size_t index)
+{
+  std::lock_guard<std::mutex> lock(m_WriteMutex);
+  WriteBrickToDisk(tree, pData, index);
+}
+
 void ExtendedOctreeConverter::WriteBrickToDisk(ExtendedOctree &tree, uint8_t* pData, size_t index)
 {
   tree.m_pLargeRAWFile->SeekPos(tree.m_iOffset+tree.m_vTOC[index].m_iOffset);
@@ -1010,30 +1108,17 @@ void ExtendedOctreeConverter::WriteBrickToDisk(ExtendedOctree &tree, uint8_t* pD
   tree.m_pLargeRAWFile->WriteRAW(pData, tree.m_vTOC[index].m_iLength);
 }
 
-/*
-  HasIndex:
-
-  Function used for find_if, returns true iff a cache entry has a certain index
-*/
-struct HasIndex :
-  public std::binary_function<ExtendedOctreeConverter::CacheEntry,
-                              uint64_t, bool> {
-  bool operator()(const ExtendedOctreeConverter::CacheEntry& cacheEntry,
-                  uint64_t index) const {
-    return cacheEntry.m_index == index;
-  }
-};
-
 /*
   GetBrick:
 
   Retrieves a brick from the tree. First we check if the cache is
   enabled, if not we simply request the brick from the tree. Otherwise
-  we check the cache and, if we have a hit, return the cache copy
-  otherwise we fetch the data from disk and put a copy into the cache,
-  therefore we search for a suitable cache entry (the entry with the
-  oldest access counter). In either case (hit or miss) we update the
-  access counter, i.e. we use true LRU as caching strategy. */
+  we check the shard of the brick and, if we have a hit, return the cache
+  copy otherwise we fetch the data from disk and put a copy into the cache,
+  therefore we evict the least recently used entry of the shard. In either
+  case (hit or miss) the entry moves to the front of the shard, i.e. we use
+  true LRU per shard as caching strategy. The shard stays locked during the
+  disk access, so no other worker can see a brick while it is written out. */
 void ExtendedOctreeConverter::GetBrick(uint8_t* pData, ExtendedOctree &tree,
                                        uint64_t index) {
   if (m_vBrickCache.empty()) {
@@ -1041,40 +1126,27 @@ void ExtendedOctreeConverter::GetBrick(uint8_t* pData, ExtendedOctree &tree,
     return;
   }
 
-  BrickCacheIter cacheEntry = std::find_if(m_vBrickCache.begin(), m_vBrickCache.end(), std::bind2nd(HasIndex(), index));
+  CacheShard& shard = *m_vBrickCache[size_t(index % m_vBrickCache.size())];
+  std::lock_guard<std::mutex> lock(shard.m_mutex);
 
-  if (cacheEntry == m_vBrickCache.end()) {
+  auto hit = shard.m_index.find(size_t(index));
+  if (hit == shard.m_index.end()) {
     // cache miss
 
     // read data from disk
     tree.GetBrickData(pData, index);
 
-    // find cache entry to evict from cache
-    cacheEntry = m_vBrickCache.begin();
-    for (BrickCacheIter i = m_vBrickCache.begin();i != m_vBrickCache.end();++i) {
-      if (i->m_iAccess < cacheEntry->m_iAccess)
-        cacheEntry = i;
-    }
-
-    if (cacheEntry->m_iAccess == 0) {
-      // if this is a never before used cache entry allocate memory
-      cacheEntry->Allocate();
-    } else {
-      // if it's dirty, write to disk
-      if (cacheEntry->m_bDirty) WriteBrickToDisk(tree, cacheEntry);
-    }
-    uint64_t uncompressedLength = BrickSize(tree, index);
-
     // put new entry into cache
+    BrickCacheIter cacheEntry = EvictCacheEntry(tree, shard, size_t(index));
+    uint64_t uncompressedLength = BrickSize(tree, index);
     cacheEntry->m_bDirty = false;
-    cacheEntry->m_index = size_t(index);
-    cacheEntry->m_iAccess = ++m_iCacheAccessCounter;
     memcpy(cacheEntry->m_pData, pData, size_t(uncompressedLength));
   } else {
     // cache hit
+    BrickCacheIter cacheEntry = hit->second;
     uint64_t uncompressedLength = BrickSize(tree, cacheEntry->m_index);
     memcpy(pData, cacheEntry->m_pData, size_t(uncompressedLength));
-    cacheEntry->m_iAccess = ++m_iCacheAccessCounter;
+    shard.m_entries.splice(shard.m_entries.begin(), shard.m_entries, cacheEntry);
   }
 }
 
@@ -1082,57 +1154,45 @@ void ExtendedOctreeConverter::GetBrick(uint8_t* pData, ExtendedOctree &tree,
   SetBrick:
 
   Writes a brick to the tree. First we check if the cache is enabled, if not we simply write out
-  the brick to disk. Otherwise we check the cache and, if we have a hit, write into the cache copy
-  otherwise we search for a suitable cache entry (the entry with the oldest access counter).
-  In either case (hit or miss) we update the access counter, i.e. we use true LRU as caching strategy.
+  the brick to disk. Otherwise we check the shard of the brick and, if we have a hit, write into
+  the cache copy otherwise we evict the least recently used entry of the shard.
+  In either case (hit or miss) the entry moves to the front, i.e. we use true LRU as caching strategy.
   If bForceWrite is enabled we write the data to disk directly bypassing the write cache, if in this
   case a cache miss occurs we only write to disk and don't update the cache in a cache hit case we update
   the data and write to disk.
 */
 void ExtendedOctreeConverter::SetBrick(uint8_t* pData, ExtendedOctree &tree, uint64_t index, bool bForceWrite) {
   if (m_vBrickCache.empty()) {
-    WriteBrickToDisk(tree, pData, size_t(index));
+    WriteBrickToDiskLocked(tree, pData, size_t(index));
     return;
   }
 
-  BrickCacheIter cacheEntry = std::find_if(m_vBrickCache.begin(), m_vBrickCache.end(), std::bind2nd(HasIndex(), index));
+  CacheShard& shard = *m_vBrickCache[size_t(index % m_vBrickCache.size())];
+  std::lock_guard<std::mutex> lock(shard.m_mutex);
 
   tree.m_vTOC[size_t(index)].m_iLength =
     tree.ComputeBrickSize(tree.IndexToBrickCoords(index)).volume() *
     tree.GetComponentTypeSize() *
     tree.GetComponentCount();
-  if (cacheEntry == m_vBrickCache.end()) {
+
+  auto hit = shard.m_index.find(size_t(index));
+  if (hit == shard.m_index.end()) {
     // cache miss
 
     if (bForceWrite) {
-      WriteBrickToDisk(tree, pData, size_t(index));
+      WriteBrickToDiskLocked(tree, pData, size_t(index));
       return;
     }
 
-    // find cache entry to evict from cache
-    cacheEntry = m_vBrickCache.begin();
-    for (BrickCacheIter i = m_vBrickCache.begin();i != m_vBrickCache.end();++i) {
-      if (i->m_iAccess < cacheEntry->m_iAccess)
-        cacheEntry = i;
-    }
-
-    if (cacheEntry->m_iAccess == 0) {
-      // if this is a never before used cache entry allocate memory
-      cacheEntry->Allocate();
-    } else {
-      // if it's dirty, write to disk
-      if (cacheEntry->m_bDirty) WriteBrickToDisk(tree, cacheEntry);
-    }
-
     // put new entry into cache
+    BrickCacheIter cacheEntry = EvictCacheEntry(tree, shard, size_t(index));
     cacheEntry->m_bDirty = true;
-    cacheEntry->m_index = size_t(index);
-    cacheEntry->m_iAccess = ++m_iCacheAccessCounter;
     memcpy(cacheEntry->m_pData, pData, size_t(tree.m_vTOC[cacheEntry->m_index].m_iLength));
   } else {
     // cache hit
+    BrickCacheIter cacheEntry = hit->second;
     cacheEntry->m_bDirty = true;
-    cacheEntry->m_iAccess = ++m_iCacheAccessCounter;
+    shard.m_entries.splice(shard.m_entries.begin(), shard.m_entries, cacheEntry);
     memcpy(cacheEntry->m_pData, pData, size_t(tree.m_vTOC[size_t(index)].m_iLength));
     if (bForceWrite) WriteBrickToDisk(tree, cacheEntry);
   }
@@ -1368,48 +1428,125 @@ void ExtendedOctreeConverter::FillOverlap(ExtendedOctree &tree, uint64_t iLoD, b
 }
 
 /*
-  This method reorders the large input raw file into smaller bricks
-  of maximum size m_vBrickSize with an overlap of m_iOverlap i.e.
-  it computes LoD level zero. Therefore, it iterates over all bricks
-  to be created and grabs each from the source data. In the process it
-  also fills the tree ToC.
-*/
-void ExtendedOctreeConverter::PermuteInputData(ExtendedOctree &tree, LargeRAWFile_ptr 
-                                               pLargeRAWFileIn, uint64_t iInOffset,
-                                               bool bClampToEdge) {
-  std::vector<uint8_t> vData;
-  const Core::Math::Vec3ui64 baseBricks = tree.GetBrickCount(0);
+  AppendToC:
 
-  uint64_t iCurrentOutOffset = tree.ComputeHeaderSize();
-  for (uint64_t z = 0;z<baseBricks.z;z++) {
-    for (uint64_t y = 0;y<baseBricks.y;y++) {
-      for (uint64_t x = 0;x<baseBricks.x;x++) {
-        Core::Math::Vec4ui64 coords(x,y,z,0);
+  Appends the entries of all bricks of a level to the ToC, level zero
+  starts right after the header, all other levels after the previous one.
+*/
+void ExtendedOctreeConverter::AppendToC(ExtendedOctree &tree, uint64_t iLoD) {
+  const Core::Math::Vec3ui64 bricks = tree.GetBrickCount(iLoD);
+
+  uint64_t iCurrentOutOffset = tree.m_vTOC.empty()
+    ? tree.ComputeHeaderSize()
+    : (tree.m_vTOC.end()-1)->m_iOffset + (tree.m_vTOC.end()-1)->m_iLength;
+  for (uint64_t z = 0;z<bricks.z;z++) {
+    for (uint64_t y = 0;y<bricks.y;y++) {
+      for (uint64_t x = 0;x<bricks.x;x++) {
         uint64_t iUncompressedBrickSize =
-          tree.ComputeBrickSize(Core::Math::Vec4ui64(x,y,z,0)).volume() *
+          tree.ComputeBrickSize(Core::Math::Vec4ui64(x,y,z,iLoD)).volume() *
           tree.GetComponentTypeSize() *
           tree.GetComponentCount();
         TOCEntry t = {iCurrentOutOffset, iUncompressedBrickSize, CT_NONE,
                       iUncompressedBrickSize, Core::Math::Vec2ui(0,0)};
         tree.m_vTOC.push_back(t);
-
-        GetInputBrick(vData, tree, pLargeRAWFileIn, iInOffset, coords,
-                      bClampToEdge);
-        SetBrick(&(vData[0]), tree, coords);
-
         iCurrentOutOffset += iUncompressedBrickSize;
-        const float xf = float(x);
-        const float p = xf + y*baseBricks.x + z*baseBricks.x*baseBricks.y;
-        m_fProgress = p / float(baseBricks.volume());
       }
-      const std::string msg = m_pProgressTimer->GetProgressMessage(m_fProgress);
-      
-      LINFO("Generating LOD 0 ..." << (m_fProgress*100.0f) << "% (" <<
-            msg.c_str() << ")");
     }
   }
 }
 
+/*
+  ReadInputSlab:
+
+  Reads the voxels covered by a band of bricks, including their overlap,
+  from the raw input file. If the band spans whole slices the slab is
+  contiguous in the file and a single read suffices, otherwise every slice
+  is one read of consecutive lines.
+*/
+void ExtendedOctreeConverter::ReadInputSlab(ExtendedOctree &tree,
+                                            LargeRAWFile_ptr pLargeRAWFileIn,
+                                            uint64_t iInOffset, uint64_t z,
+                                            uint64_t yFirst, uint64_t yEnd,
+                                            InputSlab& slab) {
+  const uint64_t iVoxelSize = tree.GetComponentTypeSize() * tree.GetComponentCount();
+  const Core::Math::Vec3ui64& vVolumeSize = tree.m_vVolumeSize;
+  const uint64_t iInnerY = m_vBrickSize.y-m_iOverlap*2;
+  const uint64_t iInnerZ = m_vBrickSize.z-m_iOverlap*2;
+
+  // brick b covers the voxels [b*inner-overlap, (b+1)*inner+overlap)
+  // clamped to the volume
+  slab.m_iFirstY = (yFirst == 0) ? 0 : yFirst*iInnerY-m_iOverlap;
+  slab.m_iFirstZ = (z == 0) ? 0 : z*iInnerZ-m_iOverlap;
+  slab.m_vSize = Core::Math::Vec3ui64(
+    vVolumeSize.x,
+    std::min(vVolumeSize.y, yEnd*iInnerY+m_iOverlap) - slab.m_iFirstY,
+    std::min(vVolumeSize.z, (z+1)*iInnerZ+m_iOverlap) - slab.m_iFirstZ
+  );
+  slab.m_vData.resize(size_t(slab.m_vSize.volume()*iVoxelSize));
+
+  const uint64_t iSliceSize = vVolumeSize.x * vVolumeSize.y * iVoxelSize;
+  const uint64_t iSlabSliceSize = slab.m_vSize.x * slab.m_vSize.y * iVoxelSize;
+  const uint64_t iFirstByte = iInOffset + slab.m_iFirstZ * iSliceSize +
+                              slab.m_iFirstY * vVolumeSize.x * iVoxelSize;
+  if (slab.m_vSize.y == vVolumeSize.y) {
+    pLargeRAWFileIn->ReadAt(iFirstByte, &slab.m_vData[0],
+                            iSlabSliceSize * slab.m_vSize.z);
+  } else {
+    for (uint64_t i = 0;i<slab.m_vSize.z;i++) {
+      pLargeRAWFileIn->ReadAt(iFirstByte + i * iSliceSize,
+                              &slab.m_vData[size_t(i * iSlabSliceSize)],
+                              iSlabSliceSize);
+    }
+  }
+}
+
+/*
+  This method reorders one layer of the large input raw file into smaller
+  bricks of maximum size m_vBrickSize with an overlap of m_iOverlap, i.e.
+  it computes a part of LoD level zero. As many rows of bricks as fit into
+  m_iSlabMemLimit (at least one) are read into the slab at once, then the
+  workers cut the bricks from the slab. Slices the next layer does not need
+  are dropped from the OS cache, so streaming a volume much larger than
+  memory does not evict everything else.
+*/
+void ExtendedOctreeConverter::PermuteInputLayer(ExtendedOctree &tree,
+                                                LargeRAWFile_ptr pLargeRAWFileIn,
+                                                uint64_t iInOffset, uint64_t z,
+                                                bool bClampToEdge,
+                                                InputSlab& slab) {
+  const Core::Math::Vec3ui64 baseBricks = tree.GetBrickCount(0);
+  const uint64_t iVoxelSize = tree.GetComponentTypeSize() * tree.GetComponentCount();
+
+  // upper bound of the input size of one row of bricks
+  const uint64_t iRowSize = tree.m_vVolumeSize.x * m_vBrickSize.y *
+                            m_vBrickSize.z * iVoxelSize;
+  const uint64_t iRowsPerSlab = std::max<uint64_t>(1, m_iSlabMemLimit / iRowSize);
+
+  std::vector<std::vector<uint8_t>> vData(m_iThreadCount);
+  for (uint64_t yFirst = 0;yFirst<baseBricks.y;yFirst += iRowsPerSlab) {
+    const uint64_t yEnd = std::min(baseBricks.y, yFirst + iRowsPerSlab);
+    ReadInputSlab(tree, pLargeRAWFileIn, iInOffset, z, yFirst, yEnd, slab);
+
+    trinity::parallelFor(baseBricks.x * (yEnd - yFirst), [&](uint32_t iWorker, uint64_t i) {
+      const Core::Math::Vec4ui64 coords(i % baseBricks.x,
+                                        yFirst + i / baseBricks.x, z, 0);
+      GetInputBrick(vData[iWorker], tree, slab, coords, bClampToEdge);
+      SetBrick(&(vData[iWorker][0]), tree, coords);
+    }, m_iThreadCount);
+  }
+
+  // the overlap of the next layer reaches back into this one
+  const uint64_t iSliceSize = tree.m_vVolumeSize.x * tree.m_vVolumeSize.y * iVoxelSize;
+  const uint64_t iKeepZ = (z+1 < baseBricks.z)
+    ? (z+1)*(m_vBrickSize.z-m_iOverlap*2)-m_iOverlap
+    : tree.m_vVolumeSize.z;
+  if (iKeepZ > slab.m_iFirstZ) {
+    pLargeRAWFileIn->Hint(LargeRAWFile::DONTNEED,
+                          iInOffset + slab.m_iFirstZ * iSliceSize,
+                          (iKeepZ - slab.m_iFirstZ) * iSliceSize);
+  }
+}
+
 /*
  ExportToRAW:
 
@@ -29,6 +29,9 @@
 
 #include <cstring>
 #include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include "ExtendedOctree.h"
 #include "VolumeTools.h"
 #include "silverbullet/math/MathTools.h"
@@ -71,10 +74,12 @@ public:
     @param vBrickSize the maximum size of a brick (including overlap)
     @param iOverlap the voxel overlap (must be smaller than half the brick size in all dimensions)
     @param iMemLimit the amount of memory in bytes the converter is allowed to use for caching
-    @param progress debug channel to use for progress information
+                     and for reading the input
+    @param iThreadCount number of worker threads for downsampling and compression, 0 uses one per core
   */
   ExtendedOctreeConverter(const Core::Math::Vec3ui64& vBrickSize,
-                          uint32_t iOverlap, uint64_t iMemLimit);
+                          uint32_t iOverlap, uint64_t iMemLimit,
+                          uint32_t iThreadCount = 0);
 
   virtual ~ExtendedOctreeConverter();
 
@@ -286,9 +291,9 @@ public:
    *
    *  This class is used in a vector/list etc. like data structure within
    *  the ExtendedOctreeConverter class it mainly stores an array with the
-   *  brick data but also contains an access counter for the FIFO implementation,
-   *  a dirty bool to indicate that this brick has changed in mem but has not
-   *  yet written to disk, and index indicating to which brick the data belongs
+   *  brick data but also contains a dirty bool to indicate that this brick
+   *  has changed in mem but has not yet written to disk, and index indicating
+   *  to which brick the data belongs
    */
   class CacheEntry {
   public:
@@ -299,7 +304,6 @@ public:
       m_pData(NULL),
       m_bDirty(false),
       m_index(std::numeric_limits<size_t>::max()),
-      m_iAccess(0),
       m_size(0)
     {}
 
@@ -344,20 +348,47 @@ public:
     /// the ID of the data stored in this cache entry
     size_t m_index;
 
-    /// access timestamp for the replacement strategy
-    uint64_t m_iAccess;
-
   private:
     /// the size of the data block
     size_t m_size;
+
+    CacheEntry(const CacheEntry&);
+    CacheEntry& operator=(const CacheEntry&);
+  };
+
+  /*! \brief One part of the brick cache
+   *
+   *  Bricks are distributed over the shards by their index, each shard has its
+   *  own lock, so workers processing different bricks rarely wait for each other.
+   *  The entries are kept in least recently used order, the hash map finds the
+   *  entry of a brick without searching.
+   */
+  struct CacheShard {
+    std::mutex m_mutex;
+    /// most recently used entry first, unused entries at the end
+    std::list<CacheEntry> m_entries;
+    std::unordered_map<size_t, std::list<CacheEntry>::iterator> m_index;
   };
 
-  /// The brick cache is nothing but a vector of cache elements, we may
-  /// want to change that to a more complex data structure
-  typedef std::vector<CacheEntry> BrickCache;
+  /// The brick cache is a set of independently locked shards
+  typedef std::vector<std::unique_ptr<CacheShard>> BrickCache;
 
   /// Brick cache iterator
-  typedef BrickCache::iterator BrickCacheIter;
+  typedef std::list<CacheEntry>::iterator BrickCacheIter;
+
+  /*! \brief Part of the raw input that is held in memory
+   *
+   *  While LoD zero is built the input is read in slabs, each covering the
+   *  full x-range of the lines [m_iFirstY, m_iFirstY+m_vSize.y) in the slices
+   *  [m_iFirstZ, m_iFirstZ+m_vSize.z), i.e. all the input voxels of a band of
+   *  bricks including their overlap.
+   */
+  struct InputSlab {
+    uint64_t m_iFirstY;
+    uint64_t m_iFirstZ;
+    Core::Math::Vec3ui64 m_vSize;
+    std::vector<uint8_t> m_vData;
+  };
 
 private:
   /// internal data for the progress indicator call
@@ -374,9 +405,12 @@ private:
   /// the brick overlap
   uint32_t m_iOverlap;
 
-  /// max amount of memory in bytes to be used by the cache
+  /// max amount of memory in bytes to be used by the cache and the input slab
   uint64_t m_iMemLimit;
 
+  /// the part of m_iMemLimit reserved for the input slab
+  uint64_t m_iSlabMemLimit;
+
   /// desired compression method for new bricks, may be ignored by the system
   /// e.g. when a compressed brick would be larger than the uncompressed
   COMPRESSION_TYPE m_eCompression;
@@ -387,8 +421,11 @@ private:
   /// the brick cache collection
   BrickCache m_vBrickCache;
 
-  /// last timestamp used to access the brickCache
-  uint64_t m_iCacheAccessCounter;
+  /// number of worker threads
+  uint32_t m_iThreadCount;
+
+  /// serializes the seek and write pairs of the workers on the target file
+  std::mutex m_WriteMutex;
 
   /// if not NULL then the statistics for each brick are stored in this vector
   BrickStatVec* m_pBrickStatVec;
@@ -455,34 +492,63 @@ private:
                         size_t voxelSize);
 
   /**
-    Fetches a brick from the raw linear input file
+    Fetches a brick from the part of the raw linear input in memory
 
     @param vData vector to store the brick data
     @param tree target extended octree (used to extract metadata)
-    @param pLargeRAWFileIn source raw file
-    @param iInOffset offset into the source file
+    @param slab input slab, must contain all voxels of the brick
     @param coords brick coordinates of the brick to be extracted
     @param bClampToEdge use outer values to fill border (uses zeroes otherwise)
   */
   void GetInputBrick(std::vector<uint8_t>& vData,
-                     ExtendedOctree &tree, LargeRAWFile_ptr pLargeRAWFileIn,
-                     uint64_t iInOffset, const Core::Math::Vec4ui64& coords,
+                     ExtendedOctree &tree, const InputSlab& slab,
+                     const Core::Math::Vec4ui64& coords,
                      bool bClampToEdge);
 
   /**
-    This method reorders the large input raw file into smaller bricks
-    of maximum size m_vBrickSize with an overlap of m_iOverlap i.e.
-    it computes LoD level zero
+    Reads the input voxels of the LoD zero bricks [yFirst, yEnd) in
+    layer z into the slab, slice by slice
 
     @param tree target extended octree
     @param pLargeRAWFileIn source raw file
     @param iInOffset offset into the source file
+    @param z the brick layer
+    @param yFirst the first row of bricks
+    @param yEnd one past the last row of bricks
+    @param slab the slab to be filled
+  */
+  void ReadInputSlab(ExtendedOctree &tree, LargeRAWFile_ptr pLargeRAWFileIn,
+                     uint64_t iInOffset, uint64_t z, uint64_t yFirst,
+                     uint64_t yEnd, InputSlab& slab);
+
+  /**
+    Appends the ToC entries of all bricks in a level to the tree, the
+    bricks are stored uncompressed and back to back until the final
+    compression pass
+
+    @param tree target extended octree
+    @param iLoD the level of detail to be added
+  */
+  void AppendToC(ExtendedOctree &tree, uint64_t iLoD);
+
+  /**
+    This method reorders one layer of bricks from the large input raw file
+    into smaller bricks of maximum size m_vBrickSize with an overlap of
+    m_iOverlap i.e. it computes a part of LoD level zero. The input is read
+    sequentially in slabs that fit into m_iSlabMemLimit, so the input file
+    is streamed once no matter how large it is.
+
+    @param tree target extended octree
+    @param pLargeRAWFileIn source raw file
+    @param iInOffset offset into the source file
+    @param z the brick layer to be computed
     @param bClampToEdge use outer values to fill border (uses zeroes otherwise)
+    @param slab buffer for the input slab, reused between the layers
   */
-  void PermuteInputData(ExtendedOctree &tree,
-                        LargeRAWFile_ptr pLargeRAWFileIn,
-                        uint64_t iInOffset,
-                        bool bClampToEdge);
+  void PermuteInputLayer(ExtendedOctree &tree,
+                         LargeRAWFile_ptr pLargeRAWFileIn,
+                         uint64_t iInOffset, uint64_t z,
+                         bool bClampToEdge, InputSlab& slab);
 
   /**
     This method fills the overlaps between the bricks, it assumes
@@ -550,6 +616,18 @@ private:
   */
   void FlushCache(ExtendedOctree &tree);
 
+  /**
+    Returns the cache entry for a brick that is not cached yet: the least
+    recently used entry of the shard, which is written to disk first if it is
+    dirty, the caller has to hold the lock of the shard
+
+    @param tree target extended octree
+    @param shard the shard the brick belongs to
+    @param index the 1D-index of the brick
+  */
+  BrickCacheIter EvictCacheEntry(ExtendedOctree &tree, CacheShard& shard,
+                                 size_t index);
+
   /// Computes the number of bytes required to store the (uncompressed) brick.
   static uint64_t BrickSize(const ExtendedOctree&, uint64_t index);
 
@@ -560,21 +638,30 @@ private:
   );
 
   /**
-    Write a single brick at index i in the ToC to disk and updates
-    the minmax data structure if it is set
+    Writes a cached brick with WriteBrickToDiskLocked and marks the cache
+    entry as clean
 
     @param tree target extended octree
     @param element iterator to the element in the cache to be written to disk
   */
-  static void WriteBrickToDisk(ExtendedOctree &tree, BrickCacheIter element);
+  void WriteBrickToDisk(ExtendedOctree &tree, BrickCacheIter element);
+
+  /**
+    Writes a single brick uncompressed to its slot in the file while holding
+    m_WriteMutex, the workers share the write position of the file
+
+    @param tree target extended octree
+    @param pData the data of the brick
+    @param index index of the brick to be written
+  */
+  void WriteBrickToDiskLocked(ExtendedOctree &tree, uint8_t* pData, size_t index);
 
   /**
-    Write a single brick at index i in the ToC to disk and updates
-    the minmax data structure if it is set
+    Writes a single brick uncompressed to its slot in the file and updates
+    its ToC entry; concurrent callers have to serialize the writes
 
     @param tree target extended octree
     @param pData the data of the brick
-    @param eCompression desired compression method for new bricks, may be ignored by the system
     @param index index of the brick to be written
   */
   static void WriteBrickToDisk(ExtendedOctree &tree, uint8_t* pData, size_t index);
@@ -600,7 +687,9 @@ private:
   /**
     This function down-samples up to eight bricks into a single brick.
     to avoid new/delete calls this function takes two points to two
-    arrays of sufficient size to hold the largest bricks
+    arrays of sufficient size to hold the largest bricks, the ToC entry
+    of the target brick must exist already; different target bricks
+    may be processed concurrently
 
     @param tree target extended octree
     @param bClampToEdge use outer values to fill border (uses zeroes otherwise)
@@ -614,13 +703,20 @@ private:
                                          T* pData, T* pSourceData);
 
   /**
-    This function computes all the LoD levels on
-    top of the highest resolution (level 0)
+    This function computes the highest resolution (level 0) from the
+    input and all the LoD levels on top of it. Level 0 is built layer by
+    layer, as soon as the two source layers of a layer in the next level
+    are complete that layer is downsampled, so the source bricks are
+    usually still in the cache.
 
     @param tree target extended octree
+    @param pLargeRAWFileIn source raw file
+    @param iInOffset offset into the source file
     @param bClampToEdge use outer values to fill border (uses zeroes otherwise)
   */
   template<class T, bool bComputeMedian> void ComputeHierarchy(ExtendedOctree &tree,
+                                                               LargeRAWFile_ptr pLargeRAWFileIn,
+                                                               uint64_t iInOffset,
                                                                bool bClampToEdge);
 
 
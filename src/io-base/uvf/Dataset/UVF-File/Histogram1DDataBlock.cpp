@@ -1,6 +1,7 @@
 #include "Histogram1DDataBlock.h"
 
 #include "RasterDataBlock.h"
+#include "common/BrickStatistics.h"
 #include "silverbullet/math/MathTools.h"
 #include "mocca/log/LogManager.h"
 #include "ProgressTimer.h"
@@ -72,43 +73,42 @@ bool Histogram1DDataBlock::Compute(const TOCBlock* source, uint64_t iLevel) {
   std::fill(m_vHistData.begin(), m_vHistData.end(), 0);
   
   // compute histogram
+  size_t iSize = 0;
   switch (source->GetComponentType()) {
     case ExtendedOctree::CT_UINT8:
-      ComputeTemplate<uint8_t>(source, iLevel);
+      iSize = ComputeTemplate<uint8_t>(source, iLevel);
       break;
     case ExtendedOctree::CT_UINT16:
-      ComputeTemplate<uint16_t>(source, iLevel);
+      iSize = ComputeTemplate<uint16_t>(source, iLevel);
       break;
     case ExtendedOctree::CT_UINT32:
-      ComputeTemplate<uint32_t>(source, iLevel);
+      iSize = ComputeTemplate<uint32_t>(source, iLevel);
       break;
     case ExtendedOctree::CT_UINT64:
-      ComputeTemplate<uint64_t>(source, iLevel);
+      iSize = ComputeTemplate<uint64_t>(source, iLevel);
       break;
     case ExtendedOctree::CT_INT8:
-      ComputeTemplate<int8_t>(source, iLevel);
+      iSize = ComputeTemplate<int8_t>(source, iLevel);
       break;
     case ExtendedOctree::CT_INT16:
-      ComputeTemplate<int16_t>(source, iLevel);
+      iSize = ComputeTemplate<int16_t>(source, iLevel);
       break;
     case ExtendedOctree::CT_INT32:
-      ComputeTemplate<int32_t>(source, iLevel);
+      iSize = ComputeTemplate<int32_t>(source, iLevel);
       break;
     case ExtendedOctree::CT_INT64:
-      ComputeTemplate<int64_t>(source, iLevel);
+      iSize = ComputeTemplate<int64_t>(source, iLevel);
       break;
     case ExtendedOctree::CT_FLOAT32:
-      ComputeTemplate<float>(source, iLevel);
+      iSize = ComputeTemplate<float>(source, iLevel);
       break;
     case ExtendedOctree::CT_FLOAT64:
-      ComputeTemplate<double>(source, iLevel);
+      iSize = ComputeTemplate<double>(source, iLevel);
       break;
   }
   
   
-  // find maximum-index non zero entry and clip histogram data
-  size_t iSize = 0;
-  for (size_t i = 0;i<iValueRange;i++) if (m_vHistData[i] != 0) iSize = i+1;
+  // clip histogram data after the maximum-index non zero entry
   m_vHistData.resize(iSize);
   
   // set data block information
@@ -118,8 +118,8 @@ bool Histogram1DDataBlock::Compute(const TOCBlock* source, uint64_t iLevel) {
 }
 
 template <class T>
-void Histogram1DDataBlock::ComputeTemplate(const TOCBlock* source,
-                                           uint64_t iLevel) {
+size_t Histogram1DDataBlock::ComputeTemplate(const TOCBlock* source,
+                                             uint64_t iLevel) {
   // compute histogram by iterating over all bricks of the given level
   Core::Math::Vec3ui64 bricksInSourceLevel = source->GetBrickCount(iLevel);
   
@@ -132,21 +132,28 @@ void Histogram1DDataBlock::ComputeTemplate(const TOCBlock* source,
   ProgressTimer timer;
   timer.Start();
   
+  // the kernel computes the value range along with the histogram, the
+  // maximum tells us where the histogram ends
+  bool bHasData = false;
+  std::vector<T> vMin(iCompcount), vMax(iCompcount);
+  T maxValue = T(0);
   for (uint64_t bz = 0;bz<bricksInSourceLevel.z;bz++) {
     for (uint64_t by = 0;by<bricksInSourceLevel.y;by++) {
       for (uint64_t bx = 0;bx<bricksInSourceLevel.x;bx++) {
         Core::Math::Vec4ui64 brickCoords(bx,by,bz,iLevel);
         source->GetData((uint8_t*)pTempBrickData, brickCoords);
         Core::Math::Vec3ui bricksize = Core::Math::Vec3ui(source->GetBrickSize(brickCoords));
+        if (bricksize.x <= 2*iOverlap) continue;
         
         for (uint32_t z = iOverlap;z<bricksize.z-iOverlap;z++) {
           for (uint32_t y = iOverlap;y<bricksize.y-iOverlap;y++) {
-            for (uint32_t x = iOverlap;x<bricksize.x-iOverlap;x++) {
-              // TODO: think about what todo with multi component data
-              //       right now we only pick the first component
-              size_t val = size_t(pTempBrickData[iCompcount*(x+y*bricksize.x+z*bricksize.x*bricksize.y)]);
-              m_vHistData[val]++;
-            }
+            // TODO: think about what todo with multi component data
+            //       right now we only pick the first component
+            trinity::minMaxHistogram(pTempBrickData + iCompcount*(iOverlap+y*bricksize.x+z*bricksize.x*bricksize.y),
+                                     bricksize.x-2*iOverlap, iCompcount,
+                                     &vMin[0], &vMax[0], &m_vHistData[0]);
+            if (!bHasData || vMax[0] > maxValue) maxValue = vMax[0];
+            bHasData = true;
           }
         }
       }
@@ -161,6 +168,7 @@ void Histogram1DDataBlock::ComputeTemplate(const TOCBlock* source,
           << ")");
   }
   delete [] pTempBrickData;
+  return bHasData ? size_t(maxValue)+1 : 0;
 }
 
 
@@ -38,7 +38,8 @@ protected:
 
   virtual DataBlock* Clone() const;
 
-  template <class T> void ComputeTemplate(const TOCBlock* source,
-                                          uint64_t iLevel);
+  /// @return one past the largest value, i.e. the used size of the histogram
+  template <class T> size_t ComputeTemplate(const TOCBlock* source,
+                                            uint64_t iLevel);
 };
 #endif // UVF_HISTOGRAM1DDATABLOCK_H
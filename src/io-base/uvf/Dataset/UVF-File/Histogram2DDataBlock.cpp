@@ -4,6 +4,7 @@
 #include "TOCBlock.h"
 #include "mocca/log/LogManager.h"
 #include "ProgressTimer.h"
+#include "common/BrickStatistics.h"
 
 using namespace std;
 
@@ -322,29 +323,6 @@ bool Histogram2DDataBlock::Compute(
   return true;
 }
 
-template <class T>
-FUNC_PURE
-Core::Math::Vec3d Histogram2DDataBlock::ComputeGradient(const T* pTempBrickData,
-                                                    double normalizationFactor, size_t iCompcount,
-                                                    const Core::Math::Vec3ui& size,
-                                                    const Core::Math::Vec3ui& coords)
-{
-  // TODO: think about what todo with multi component data
-  //       right now we only pick the first component
-  size_t iCenter = size_t(coords.x+size.x*coords.y+size.x*size.y*coords.z);
-  size_t iLeft   = iCenter-1;
-  size_t iRight  = iCenter+1;
-  size_t iTop    = iCenter-size_t(size.x);
-  size_t iBottom = iCenter+size_t(size.x);
-  size_t iFront  = iCenter-size_t(size.x)*size_t(size.y);
-  size_t iBack   = iCenter+size_t(size.x)*size_t(size.y);
-  
-  Core::Math::Vec3d vGradient((double(pTempBrickData[iCompcount*iLeft]) -double(pTempBrickData[iCompcount*iRight])) /(normalizationFactor*2),
-                          (double(pTempBrickData[iCompcount*iTop])  -double(pTempBrickData[iCompcount*iBottom]))/(normalizationFactor*2),
-                          (double(pTempBrickData[iCompcount*iFront])-double(pTempBrickData[iCompcount*iBack]))  /(normalizationFactor*2));
-  return vGradient;
-}
-
 template <class T>
 void Histogram2DDataBlock::ComputeTemplate(const TOCBlock* source, double normalizationFactor,
                                            uint64_t iLevel, size_t iHistoBinCount,
@@ -362,6 +340,9 @@ void Histogram2DDataBlock::ComputeTemplate(const TOCBlock* source, double normal
   ProgressTimer timer;
   timer.Start();
   
+  // TODO: think about what todo with multi component data
+  //       right now we only pick the first component
+
   // find the maximum gradient magnitude
   for (uint64_t bz = 0;bz<bricksInSourceLevel.z;bz++) {
     for (uint64_t by = 0;by<bricksInSourceLevel.y;by++) {
@@ -371,89 +352,75 @@ void Histogram2DDataBlock::ComputeTemplate(const TOCBlock* source, double normal
         source->GetData((uint8_t*)pTempBrickData, brickCoords);
         Core::Math::Vec3ui bricksize = Core::Math::Vec3ui(source->GetBrickSize(brickCoords));
         
-#ifdef _MSC_VER
-# pragma omp parallel for shared(fMaxGradMagnitude)
-        for (int32_t z = iOverlap;uint32_t(z)<bricksize.z-iOverlap;z++) {
-#else
-# pragma omp parallel for collapse(3) shared(fMaxGradMagnitude)
-          for (uint32_t z = iOverlap;z<bricksize.z-iOverlap;z++) {
-#endif
-            for (uint32_t y = iOverlap;y<bricksize.y-iOverlap;y++) {
-              for (uint32_t x = iOverlap;x<bricksize.x-iOverlap;x++) {
-                Core::Math::Vec3d vGradient = ComputeGradient(
-                                                          pTempBrickData, normalizationFactor, iCompcount, bricksize,
-                                                          Core::Math::Vec3ui(x,y,z)
-                                                          );
-                
-#pragma omp flush(fMaxGradMagnitude)
-                if(vGradient.length() > fMaxGradMagnitude)
-#pragma omp critical
-                { if(vGradient.length() > fMaxGradMagnitude) {
-                  fMaxGradMagnitude = vGradient.length();
-                }
-                }
-              }
+#pragma omp parallel for
+        for (int32_t z = int32_t(iOverlap);z<int32_t(bricksize.z-iOverlap);z++) {
+          std::vector<double> vMagnitudes(bricksize.x);
+          double fSliceMax = 0;
+          for (uint32_t y = iOverlap;y<bricksize.y-iOverlap;y++) {
+            trinity::gradientMagnitudes(pTempBrickData, bricksize, iCompcount,
+                                        iOverlap, bricksize.x-iOverlap, y, uint32_t(z),
+                                        normalizationFactor, &vMagnitudes[0]);
+            for (uint32_t x = 0;x<bricksize.x-2*iOverlap;x++) {
+              fSliceMax = std::max(fSliceMax, vMagnitudes[x]);
             }
           }
+#pragma omp critical
+          fMaxGradMagnitude = std::max(fMaxGradMagnitude, fSliceMax);
         }
       }
-      float progress = 0.5f*float(bz)/float(bricksInSourceLevel.z);
-      
-      LINFO("Computing 2D Histogram "
-            << (progress * 100.0f)
-            << "% ("
-            << timer.GetProgressMessage(progress).c_str()
-            << ")");
     }
+    float progress = 0.5f*float(bz)/float(bricksInSourceLevel.z);
     
-    // fill the histogram the maximum gradient magnitude
-    for (uint64_t bz = 0;bz<bricksInSourceLevel.z;bz++) {
-      for (uint64_t by = 0;by<bricksInSourceLevel.y;by++) {
-        for (uint64_t bx = 0;bx<bricksInSourceLevel.x;bx++) {
-          
-          Core::Math::Vec4ui64 brickCoords(bx,by,bz,iLevel);
-          source->GetData((uint8_t*)pTempBrickData, brickCoords);
-          Core::Math::Vec3ui bricksize = Core::Math::Vec3ui(source->GetBrickSize(brickCoords));
-#pragma omp parallel for firstprivate(fMaxGradMagnitude)
-#ifdef _MSC_VER
-          for (int32_t z = iOverlap;uint32_t(z)<bricksize.z-iOverlap;z++) {
-#else
-            for (uint32_t z = iOverlap;z<bricksize.z-iOverlap;z++) {
-#endif
-              for (uint32_t y = iOverlap;y<bricksize.y-iOverlap;y++) {
-                for (uint32_t x = iOverlap;x<bricksize.x-iOverlap;x++) {
-                  const Core::Math::Vec3d vGradient = ComputeGradient(
-                                                                  pTempBrickData, normalizationFactor, iCompcount, bricksize,
-                                                                  Core::Math::Vec3ui(x,y,z)
-                                                                  );
-                  
-                  size_t iCenter = size_t(x+bricksize.x*y+bricksize.x*bricksize.y*z);
-                  size_t iGradientMagnitudeIndex = std::min<size_t>(255,size_t(vGradient.length()/fMaxGradMagnitude*255.0f));
-                  size_t iValue = (fMaxNonZeroValue <= double(iHistoBinCount-1))
-                  ? size_t(pTempBrickData[iCenter])
-                  : size_t(double(pTempBrickData[iCenter]) * double(iHistoBinCount-1)/fMaxNonZeroValue);
-                  // make sure round errors don't cause index to go out of bounds
-                  if (iGradientMagnitudeIndex > 255) iGradientMagnitudeIndex = 255;
-                  if (iValue > iHistoBinCount-1) iValue = iHistoBinCount-1;
+    LINFO("Computing 2D Histogram "
+          << (progress * 100.0f)
+          << "% ("
+          << timer.GetProgressMessage(progress).c_str()
+          << ")");
+  }
+  
+  // fill the histogram the maximum gradient magnitude
+  for (uint64_t bz = 0;bz<bricksInSourceLevel.z;bz++) {
+    for (uint64_t by = 0;by<bricksInSourceLevel.y;by++) {
+      for (uint64_t bx = 0;bx<bricksInSourceLevel.x;bx++) {
+        
+        Core::Math::Vec4ui64 brickCoords(bx,by,bz,iLevel);
+        source->GetData((uint8_t*)pTempBrickData, brickCoords);
+        Core::Math::Vec3ui bricksize = Core::Math::Vec3ui(source->GetBrickSize(brickCoords));
+#pragma omp parallel for
+        for (int32_t z = int32_t(iOverlap);z<int32_t(bricksize.z-iOverlap);z++) {
+          std::vector<double> vMagnitudes(bricksize.x);
+          for (uint32_t y = iOverlap;y<bricksize.y-iOverlap;y++) {
+            trinity::gradientMagnitudes(pTempBrickData, bricksize, iCompcount,
+                                        iOverlap, bricksize.x-iOverlap, y, uint32_t(z),
+                                        normalizationFactor, &vMagnitudes[0]);
+            for (uint32_t x = iOverlap;x<bricksize.x-iOverlap;x++) {
+              size_t iCenter = size_t(x+bricksize.x*y+bricksize.x*bricksize.y*uint32_t(z));
+              size_t iGradientMagnitudeIndex = std::min<size_t>(255,size_t(vMagnitudes[x-iOverlap]/fMaxGradMagnitude*255.0f));
+              size_t iValue = (fMaxNonZeroValue <= double(iHistoBinCount-1))
+              ? size_t(pTempBrickData[iCenter])
+              : size_t(double(pTempBrickData[iCenter]) * double(iHistoBinCount-1)/fMaxNonZeroValue);
+              // make sure round errors don't cause index to go out of bounds
+              if (iGradientMagnitudeIndex > 255) iGradientMagnitudeIndex = 255;
+              if (iValue > iHistoBinCount-1) iValue = iHistoBinCount-1;
 #pragma omp atomic
-                  m_vHistData[iValue][iGradientMagnitudeIndex]++;
-                }
-              }
+              m_vHistData[iValue][iGradientMagnitudeIndex]++;
             }
           }
         }
-        float progress = 0.5f+0.5f*float(bz)/float(bricksInSourceLevel.z);
-        LINFO("Computing 2D Histogram "
-              << (progress * 100.0f)
-              << "% ("
-              << timer.GetProgressMessage(progress).c_str()
-              << ")");
-
       }
-      m_fMaxGradMagnitude = float(fMaxGradMagnitude);
-      
-      delete [] pTempBrickData;
     }
+    float progress = 0.5f+0.5f*float(bz)/float(bricksInSourceLevel.z);
+    LINFO("Computing 2D Histogram "
+          << (progress * 100.0f)
+          << "% ("
+          << timer.GetProgressMessage(progress).c_str()
+          << ")");
+
+  }
+  m_fMaxGradMagnitude = float(fMaxGradMagnitude);
+  
+  delete [] pTempBrickData;
+}
     
     
     
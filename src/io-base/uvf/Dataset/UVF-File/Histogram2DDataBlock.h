@@ -48,13 +48,6 @@ protected:
   virtual DataBlock* Clone() const;
 
 
-  template <class T>
-  FUNC_PURE
-  Core::Math::Vec3d ComputeGradient(const T* pTempBrickData,
-                                double normalizationFactor, size_t iCompcount,
-                                const Core::Math::Vec3ui& size,
-                                const Core::Math::Vec3ui& coords);
-
   template <class T>
   void ComputeTemplate(const TOCBlock* source, double normalizationFactor,
                        uint64_t iLevel, size_t iHistoBinCount,
@@ -1,3 +1,5 @@
+#include <cstring>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <algorithm> // for std::max, std::min
@@ -7,7 +9,10 @@
 #define BLOCK_COPY_SIZE (uint64_t(64*1024*1024))
 
 #ifndef _WIN32
+  #include <cerrno>
+  #include <fcntl.h>
   #include <unistd.h>
+  #include <sys/mman.h>
   #include <sys/types.h>
 #endif
 
@@ -111,6 +116,7 @@ bool LargeRAWFile::Append() {
 
 
 void LargeRAWFile::Close() {
+  m_pMapping.reset();
   if (m_bIsOpen) {
 #ifdef _WIN32
     CloseHandle(m_StreamFile);
@@ -197,6 +203,69 @@ size_t LargeRAWFile::ReadRAW(unsigned char* pData, uint64_t iCount) {
   #endif
 }
 
+size_t LargeRAWFile::ReadAt(uint64_t iPos, unsigned char* pData, uint64_t iCount) const {
+  const uint64_t iStart = iPos + m_iHeaderSize;
+  if (m_pMapping) {
+    const uint64_t iLength = m_pMapping->GetFileLength();
+    if (iStart >= iLength) return 0;
+    const uint64_t iAvailable = std::min(iCount, iLength - iStart);
+    memcpy(pData, static_cast<const unsigned char*>(m_pMapping->GetDataPointer()) + iStart,
+           size_t(iAvailable));
+    return size_t(iAvailable);
+  }
+
+  uint64_t iTotalRead = 0;
+  #ifdef _WIN32
+  // with an explicit offset ReadFile does not depend on the shared file pointer
+  while (iTotalRead < iCount) {
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = DWORD((iStart + iTotalRead) & 0xFFFFFFFF);
+    overlapped.OffsetHigh = DWORD((iStart + iTotalRead) >> 32);
+    const DWORD dwCount = DWORD(std::min<uint64_t>(iCount - iTotalRead, std::numeric_limits<DWORD>::max()));
+    DWORD dwReadBytes = 0;
+    if (!ReadFile(m_StreamFile, pData + iTotalRead, dwCount, &dwReadBytes, &overlapped) || dwReadBytes == 0) {
+      break;
+    }
+    iTotalRead += dwReadBytes;
+  }
+  #else
+  // pread bypasses the stdio buffer, so pending writes have to reach the file first
+  if (m_bWritable) fflush(m_StreamFile);
+  const int fd = fileno(m_StreamFile);
+  while (iTotalRead < iCount) {
+    const ssize_t iReadBytes = pread(fd, pData + iTotalRead, size_t(iCount - iTotalRead),
+                                     off_t(iStart + iTotalRead));
+    if (iReadBytes < 0 && errno == EINTR) continue;
+    if (iReadBytes <= 0) break;
+    iTotalRead += uint64_t(iReadBytes);
+  }
+  #endif
+  return size_t(iTotalRead);
+}
+
+std::shared_ptr<const unsigned char>
+LargeRAWFile::GetMappedData(uint64_t iPos, uint64_t iCount) const {
+  if (!m_pMapping) return nullptr;
+  const uint64_t iStart = iPos + m_iHeaderSize;
+  const uint64_t iLength = m_pMapping->GetFileLength();
+  if (iStart > iLength || iCount > iLength - iStart) return nullptr;
+
+  // aliasing constructor: shares ownership of the mapping, points into it
+  return std::shared_ptr<const unsigned char>(m_pMapping,
+    static_cast<const unsigned char*>(m_pMapping->GetDataPointer()) + iStart);
+}
+
+bool LargeRAWFile::MapReadOnly() {
+  if (!m_bIsOpen || m_bWritable) return false;
+  if (m_pMapping) return true;
+
+  auto pMapping = std::make_shared<Core::IO::MemMappedFile>(
+    m_strFilename, Core::IO::MMFILE_ACCESS_READONLY);
+  if (!pMapping->IsOpen() || pMapping->GetDataPointer() == NULL) return false;
+  m_pMapping = pMapping;
+  return true;
+}
+
 size_t LargeRAWFile::WriteRAW(const unsigned char* pData, uint64_t iCount) {
   #ifdef _WIN32
   uint64_t iTotalWritten = 0;
@@ -262,9 +331,46 @@ bool LargeRAWFile::Truncate(uint64_t iPos) {
   #endif
 }
 
-// no-op, but I want to leave the argument names in the header so it's nicer to
-// implement it here.
-void LargeRAWFile::Hint(IOHint, uint64_t, uint64_t) const { }
+// passes the hint to madvise for mapped files and to posix_fadvise otherwise.
+void LargeRAWFile::Hint(IOHint hint, uint64_t offset, uint64_t length) const {
+#ifndef _WIN32
+  const uint64_t iStart = offset + m_iHeaderSize;
+  if (m_pMapping) {
+    const uint64_t iLength = m_pMapping->GetFileLength();
+    if (iStart >= iLength) return;
+    length = std::min(length, iLength - iStart);
+
+    int advice = MADV_NORMAL;
+    switch (hint) {
+      case NORMAL:     advice = MADV_NORMAL; break;
+      case SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+      case NOREUSE:    advice = MADV_NORMAL; break;
+      case WILLNEED:   advice = MADV_WILLNEED; break;
+      case DONTNEED:   advice = MADV_DONTNEED; break;
+    }
+    // madvise wants a page aligned start address
+    const uint64_t iPageSize = uint64_t(sysconf(_SC_PAGESIZE));
+    const uint64_t iAlignedStart = iStart - iStart % iPageSize;
+    unsigned char* pBase =
+      static_cast<unsigned char*>(m_pMapping->GetDataPointer());
+    madvise(pBase + iAlignedStart, size_t(length + iStart - iAlignedStart),
+            advice);
+    return;
+  }
+#if defined(__linux__)
+  if (!m_bIsOpen) return;
+  int advice = POSIX_FADV_NORMAL;
+  switch (hint) {
+    case NORMAL:     advice = POSIX_FADV_NORMAL; break;
+    case SEQUENTIAL: advice = POSIX_FADV_SEQUENTIAL; break;
+    case NOREUSE:    advice = POSIX_FADV_NOREUSE; break;
+    case WILLNEED:   advice = POSIX_FADV_WILLNEED; break;
+    case DONTNEED:   advice = POSIX_FADV_DONTNEED; break;
+  }
+  posix_fadvise(fileno(m_StreamFile), off_t(iStart), off_t(length), advice);
+#endif
+#endif
+}
 
 bool LargeRAWFile::Copy(const std::string& strSource,
                         const std::string& strTarget, uint64_t iSourceHeaderSkip,
@@ -3,8 +3,10 @@
 #define _FILE_OFFSET_BITS 64
 #define _LARGEFILE_SOURCE 1
 
+#include <memory>
 #include <string>
 #include <vector>
+#include "silverbullet/io/MemMappedFile.h"
 #include "silverbullet/math/EndianConvert.h"
 
 #ifdef _WIN32
@@ -47,6 +49,10 @@ public:
   virtual uint64_t GetPos();
   virtual void SeekPos(uint64_t iPos);
   virtual size_t ReadRAW(unsigned char* pData, uint64_t iCount);
+  // reads iCount bytes at iPos without touching the file position, so any
+  // number of threads may call it concurrently (as long as nobody seeks,
+  // reads or writes through the other calls at the same time)
+  virtual size_t ReadAt(uint64_t iPos, unsigned char* pData, uint64_t iCount) const;
   virtual size_t WriteRAW(const unsigned char* pData, uint64_t iCount);
   virtual bool CopyRAW(uint64_t iCount, uint64_t iSourcePos, uint64_t iTargetPos,
                        unsigned char* pBuffer, uint64_t iBufferSize);
@@ -128,6 +134,17 @@ public:
   // Hint to the underlying driver how we'll access data
   virtual void Hint(IOHint hint, uint64_t offset, uint64_t length) const;
 
+  // maps a file that is open read-only into memory, from then on ReadAt
+  // copies from the mapping instead of issuing a system call per read
+  // @return false if the file could not be mapped, ReadAt keeps working then
+  bool MapReadOnly();
+  bool IsMapped() const { return m_pMapping != nullptr; }
+  // returns iCount bytes at iPos straight from the mapping, without copying;
+  // the returned pointer keeps the mapping alive, even beyond Close
+  // @return nullptr if the file is not mapped or the range exceeds the file
+  std::shared_ptr<const unsigned char> GetMappedData(uint64_t iPos,
+                                                     uint64_t iCount) const;
+
   static bool Copy(const std::string& strSource, const std::string& strTarget,
                    uint64_t iSourceHeaderSkip=0, std::string* strMessage=NULL);
   static bool Copy(const std::wstring& wstrSource,
@@ -145,10 +162,9 @@ protected:
   bool          m_bIsOpen;
   bool          m_bWritable;
   uint64_t      m_iHeaderSize;
+  std::shared_ptr<Core::IO::MemMappedFile> m_pMapping;
 };
 
-#include <memory>
-
 typedef std::shared_ptr<LargeRAWFile> LargeRAWFile_ptr;
 
 // A TempFile is an RAII LargeRAWFile, which deletes itself when it
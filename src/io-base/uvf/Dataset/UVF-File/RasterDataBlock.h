@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <string>
 #include "DataBlock.h"
+#include "common/BrickStatistics.h"
 #include "silverbullet/math/Vectors.h"
 
 template<class T, size_t iVecLength>
@@ -16,26 +17,22 @@ void SimpleMaxMin(const void* pIn, size_t iStart, size_t iCount,
 
   fMinMax.resize(iVecLength);
 
+  // minMax leaves these untouched for empty ranges, which then report an empty interval
+  T minValues[iVecLength];
+  T maxValues[iVecLength];
+  std::fill(minValues, minValues + iVecLength, std::numeric_limits<T>::max());
+  std::fill(maxValues, maxValues + iVecLength, std::numeric_limits<T>::lowest());
+  trinity::minMax(pDataIn+iStart*iVecLength, iCount, iVecLength,
+                  minValues, maxValues);
+
   for (size_t i = 0;i<iVecLength;i++) {
-    fMinMax[i].x = pDataIn[iStart+i]; // .x will be the minimum
-    fMinMax[i].y = pDataIn[iStart+i]; // .y will be the max
+    fMinMax[i].x = static_cast<double>(minValues[i]); // .x will be the minimum
+    fMinMax[i].y = static_cast<double>(maxValues[i]); // .y will be the max
 
-    /// \todo remove this if the gradient computations is implemented below
+    /// \todo remove this if the gradient computations is implemented
     fMinMax[i].z = -std::numeric_limits<double>::max(); // min gradient
     fMinMax[i].w = std::numeric_limits<double>::max();  // max gradient
   }
-
-  for (size_t i = iStart+iVecLength;i<iStart+iCount;i++) {
-    for (size_t iComponent = 0;iComponent<iVecLength;iComponent++) {
-        fMinMax[iComponent].x = std::min(fMinMax[iComponent].x,
-                                         static_cast<double>
-                                         (pDataIn[i*iVecLength+iComponent]));
-        fMinMax[iComponent].y = std::max(fMinMax[iComponent].y,
-                                         static_cast<double>
-                                         (pDataIn[i*iVecLength+iComponent]));
-      /// \todo compute gradients
-    }
-  }
 }
 
 template<class T>
@@ -227,6 +227,14 @@ void TOCBlock::GetData(uint8_t* pData, Core::Math::Vec4ui64 coordinates) const {
   m_ExtendedOctree.GetBrickData(pData, coordinates);
 }
 
+COMPRESSION_TYPE TOCBlock::GetStoredData(std::vector<uint8_t>& vData, Core::Math::Vec4ui64 coordinates) const {
+  return m_ExtendedOctree.GetStoredBrickData(vData, coordinates);
+}
+
+std::shared_ptr<const uint8_t> TOCBlock::GetDataView(Core::Math::Vec4ui64 coordinates, uint64_t& iLength) const {
+  return m_ExtendedOctree.GetBrickView(coordinates, iLength);
+}
+
 Core::Math::Vec3ui64 TOCBlock::GetBrickCount(uint64_t iLoD) const {
   return m_ExtendedOctree.GetBrickCount(iLoD);
 }
@@ -76,6 +76,11 @@ public:
                      uint32_t iOverlap=0) const;
 
   void GetData(uint8_t* pData, Core::Math::Vec4ui64 coordinates) const;
+  COMPRESSION_TYPE GetStoredData(std::vector<uint8_t>& vData, Core::Math::Vec4ui64 coordinates) const;
+  std::shared_ptr<const uint8_t> GetDataView(Core::Math::Vec4ui64 coordinates, uint64_t& iLength) const;
+  const std::array<uint8_t, 5>& GetLzmaProperties() const {
+    return m_ExtendedOctree.GetLzmaProperties();
+  }
 
   uint64_t GetLoDCount() const;
   Core::Math::Vec3ui64 GetBrickCount(uint64_t iLoD) const;
@@ -88,6 +88,9 @@ bool UVF::Open(bool bMustBeSameVersion, bool bVerify, bool bReadWrite, std::stri
       return false;
     }
     ParseDataBlocks();
+    // on 64 bit systems the address space is large enough for any file, so
+    // read-only files are mapped and brick reads become plain copies
+    if (!bReadWrite && sizeof(void*) == 8) m_streamFile->MapReadOnly();
     return true;
   } else {
     Close(); // file is not a UVF file or checksum is invalid
@@ -827,6 +827,14 @@ void UVFDataset::GetHistograms(size_t) {
   }
 }
 
+const Histogram1DDataBlock* UVFDataset::GetStored1DHistogram() const {
+  return m_timesteps.empty() ? NULL : m_timesteps[0]->m_pHist1DDataBlock;
+}
+
+const Histogram2DDataBlock* UVFDataset::GetStored2DHistogram() const {
+  return m_timesteps.empty() ? NULL : m_timesteps[0]->m_pHist2DDataBlock;
+}
+
 Core::Math::Vec3ui UVFDataset::GetBrickVoxelCounts(const BrickKey& k) const
 {
  if (m_bToCBlock) {
@@ -1717,6 +1725,40 @@ bool UVFDataset::GetBrick(const BrickKey& k, std::vector<uint8_t>& vData) const
   return GetBrickTemplate<uint8_t>(k,vData);
 }
 
+bool UVFDataset::GetStoredBrick(const BrickKey& k, std::vector<uint8_t>& vData,
+                                COMPRESSION_TYPE& eCompression,
+                                std::array<uint8_t, 5>& lzmaProperties) const
+{
+  if(!m_bToCBlock) return false;
+
+  const Core::Math::Vec4ui64 coords = KeyToTOCVector(k);
+  const TOCTimestep* ts = static_cast<TOCTimestep*>(
+    m_timesteps[k.timestep]
+  );
+  const TOCEntry& entry = ts->GetDB()->GetBrickInfo(coords);
+  // atlased bricks have to be rearranged after decompression
+  if(entry.m_eCompression == CT_NONE || entry.m_iAtlasSize.area() != 0)
+    return false;
+
+  eCompression = ts->GetDB()->GetStoredData(vData, coords);
+  lzmaProperties = ts->GetDB()->GetLzmaProperties();
+  return true;
+}
+
+std::shared_ptr<const uint8_t> UVFDataset::GetBrickView(const BrickKey& k,
+                                                        uint64_t& iLength) const
+{
+  if(!m_bToCBlock) return nullptr;
+
+  const Core::Math::Vec4ui64 coords = KeyToTOCVector(k);
+  const TOCTimestep* ts = static_cast<TOCTimestep*>(
+    m_timesteps[k.timestep]
+  );
+  if(ts->GetDB()->GetAtlasSize(coords).area() != 0) return nullptr;
+
+  return ts->GetDB()->GetDataView(coords, iLength);
+}
+
 bool UVFDataset::GetBrick(const BrickKey& k, std::vector<int8_t>& vData) const {
   return GetBrickTemplate<int8_t>(k,vData);
 }
@@ -90,6 +90,22 @@ public:
   virtual bool GetBrick(const BrickKey&, std::vector<int32_t>&) const;
   virtual bool GetBrick(const BrickKey&, std::vector<float>&) const;
   virtual bool GetBrick(const BrickKey&, std::vector<double>&) const;
+
+  /// Appends the brick as it is stored in the file, i.e. possibly still
+  /// compressed, to vData.
+  /// @returns false if the brick is not stored compressed or only available
+  /// in decoded form (raster data blocks, atlased bricks); vData is
+  /// unchanged then
+  bool GetStoredBrick(const BrickKey& k, std::vector<uint8_t>& vData,
+                      COMPRESSION_TYPE& eCompression,
+                      std::array<uint8_t, 5>& lzmaProperties) const;
+
+  /// Returns an uncompressed brick as a view into the memory mapped file,
+  /// the pointer keeps the mapping alive.
+  /// @returns nullptr if the brick is compressed, atlased or the file is
+  /// not mapped
+  std::shared_ptr<const uint8_t> GetBrickView(const BrickKey& k,
+                                              uint64_t& iLength) const;
   
   /// Acceleration queries.
   virtual bool ContainsData(const BrickKey &k, double isoval) const;
@@ -126,6 +142,10 @@ public:
   // computes the range and caches it internally for the next call to
   // 'GetRange'.
   void ComputeRange();
+  /// the histograms stored in the file for the first timestep, NULL if the
+  /// file does not contain them
+  const Histogram1DDataBlock* GetStored1DHistogram() const;
+  const Histogram2DDataBlock* GetStored2DHistogram() const;
   
   // Global "Operations" and additional data not from the UVF file
   virtual bool Export(uint64_t iLODLevel, const std::string& targetFilename,
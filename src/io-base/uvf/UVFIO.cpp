@@ -1,9 +1,17 @@
 #include <algorithm>
+#include <fstream>
+#include <functional>
+#include <type_traits>
 
 #include "UVFIO.h"
 
+#include "commands/BinaryFrame.h"
+#include "common/BrickStatistics.h"
 #include "common/MemBlockPool.h"
+#include "common/ParallelFor.h"
 #include "io-base/UVFListData.h"
+#include "Dataset/UVF-File/Histogram1DDataBlock.h"
+#include "Dataset/UVF-File/Histogram2DDataBlock.h"
 #include "silverbullet/io/FileTools.h"
 #include "silverbullet/base/StringTools.h"
 
@@ -21,7 +29,8 @@ using namespace trinity;
 
 UVFIO::UVFIO(const std::string& fileId, const IListData& listData) :
   m_dataset(nullptr),
-  m_filename("")
+  m_filename(""),
+  m_histogramsReady(false)
 {
   LINFO("(UVFIO) initializing for file id " + fileId);
   const auto uvfListData = dynamic_cast<const UVFListData*>(&listData);
@@ -201,14 +210,303 @@ TransferFunction1D UVFIO::getDefault1DTransferFunction(uint64_t index) const {
  }
  */
 
+namespace {
+  // the coarse LOD used to compute histograms has at most this many voxels
+  const uint64_t MaxHistogramVoxels = 256*256*256;
+  const size_t GradientBinCount = 256;
+
+  // merges the bins of a histogram into binCount bins, each bin is added to
+  // the target bin that covers its start, so the total count is preserved
+  std::vector<uint64_t> rebin(const std::vector<uint64_t>& histogram,
+                              size_t binCount) {
+    std::vector<uint64_t> result(binCount);
+    for (size_t i = 0; i < histogram.size(); ++i) {
+      result[i * binCount / histogram.size()] += histogram[i];
+    }
+    return result;
+  }
+
+  // value range of the first component of the bricks without their overlap
+  template <typename T>
+  std::pair<double, double> valueRange(const std::vector<std::vector<T>>& bricks,
+                                       const std::vector<Vec3ui>& sizes,
+                                       size_t componentCount,
+                                       const Vec3ui& overlap) {
+    bool bHasData = false;
+    std::pair<double, double> range(0.0, 0.0);
+    std::vector<T> minValues(componentCount), maxValues(componentCount);
+    for (size_t b = 0; b < bricks.size(); ++b) {
+      const Vec3ui& size = sizes[b];
+      if (size.x <= 2 * overlap.x) continue;
+      for (uint32_t z = overlap.z; z + overlap.z < size.z; ++z) {
+        for (uint32_t y = overlap.y; y + overlap.y < size.y; ++y) {
+          minMax(bricks[b].data() + ((size_t(z) * size.y + y) * size.x +
+                                     overlap.x) * componentCount,
+                 size.x - 2 * overlap.x, componentCount,
+                 minValues.data(), maxValues.data());
+          if (!bHasData || minValues[0] < range.first) range.first = minValues[0];
+          if (!bHasData || maxValues[0] > range.second) range.second = maxValues[0];
+          bHasData = true;
+        }
+      }
+    }
+    return range;
+  }
+
+  // computes both histograms from the bricks of one LOD, the value range of
+  // the dataset is mapped to valueBinCount bins, unsigned integers with a
+  // small range get one bin per value like the histograms stored in UVF files
+  // readMutex guards the brick reads if they are not thread safe
+  template <typename T>
+  void computeHistograms(const UVFDataset& dataset, uint64_t lod,
+                         std::mutex* readMutex,
+                         std::vector<uint64_t>& histogram1D,
+                         std::vector<uint64_t>& histogram2D) {
+    // the LOD is small, so all bricks are read once and kept for both passes
+    const size_t brickCount = dataset.GetBrickLayout(lod, 0).volume();
+    const size_t componentCount = size_t(dataset.GetComponentCount());
+    const Vec3ui overlap = dataset.GetBrickOverlapSize();
+    std::vector<std::vector<T>> bricks(brickCount);
+    std::vector<Vec3ui> sizes(brickCount);
+    // z slices of all bricks are distributed over the threads
+    std::vector<std::pair<size_t, uint32_t>> slices;
+    for (size_t b = 0; b < brickCount; ++b) {
+      const BrickKey key(0, 0, lod, b);
+      std::unique_lock<std::mutex> lock;
+      if (readMutex) lock = std::unique_lock<std::mutex>(*readMutex);
+      if (!dataset.GetBrick(key, bricks[b])) {
+        throw TrinityError("could not read brick to compute histograms",
+                           __FILE__, __LINE__);
+      }
+      sizes[b] = dataset.GetBrickVoxelCounts(key);
+      for (uint32_t z = overlap.z; z + overlap.z < sizes[b].z; ++z) {
+        slices.push_back(std::make_pair(b, z));
+      }
+    }
+
+    // without MaxMin data the dataset reports the empty range (+1, -1), the
+    // range is then taken from the voxels of the LOD
+    std::pair<double, double> range = dataset.GetRange();
+    if (range.second < range.first) {
+      range = valueRange(bricks, sizes, componentCount, overlap);
+    }
+    const bool bValueBins = std::is_unsigned<T>::value &&
+                            range.second < MAX_TRANSFERFUNCTION_SIZE;
+    const size_t valueBinCount = bValueBins ? size_t(range.second) + 1
+                                            : MAX_TRANSFERFUNCTION_SIZE;
+    const double minValue = bValueBins ? 0.0 : range.first;
+    const double scale = range.second > minValue
+      ? double(valueBinCount - 1) / (range.second - minValue) : 0.0;
+    const auto valueBin = [&](T value) {
+      const double bin = (double(value) - minValue) * scale;
+      return bin > 0.0 ? std::min(valueBinCount - 1, size_t(bin)) : size_t(0);
+    };
+
+    // the slices are spread over the workers, each sums into its own partial
+    // histograms
+    const uint32_t workerCount = defaultWorkerCount();
+
+    // the gradients need the neighbors of a voxel, so without overlap the
+    // voxels on the border of a brick only contribute to the 1D histogram
+    const auto forEachLine = [&](size_t s, const std::function<void(
+      const T* data, const Vec3ui& size, uint32_t y, uint32_t z,
+      uint32_t x0, uint32_t x1, bool bGradients)>& line) {
+      const size_t b = slices[s].first;
+      const uint32_t z = slices[s].second;
+      const Vec3ui& size = sizes[b];
+      for (uint32_t y = overlap.y; y + overlap.y < size.y; ++y) {
+        const bool bGradients = z > 0 && z + 1 < size.z &&
+                                y > 0 && y + 1 < size.y;
+        line(bricks[b].data(), size, y, z, std::max(overlap.x, 1u),
+             size.x - std::max(overlap.x, 1u), bGradients);
+      }
+    };
+
+    std::vector<std::vector<double>> magnitudes(workerCount);
+    std::vector<std::vector<uint64_t>> partial1D(workerCount,
+      std::vector<uint64_t>(valueBinCount));
+    std::vector<double> maxGradients(workerCount);
+    parallelFor(slices.size(), [&](uint32_t w, uint64_t s) {
+      forEachLine(s, [&](const T* data, const Vec3ui& size, uint32_t y,
+                         uint32_t z, uint32_t x0, uint32_t x1,
+                         bool bGradients) {
+        const T* row = data + (size_t(z) * size.y + y) * size.x * componentCount;
+        for (uint32_t x = overlap.x; x + overlap.x < size.x; ++x) {
+          ++partial1D[w][valueBin(row[x * componentCount])];
+        }
+        if (bGradients && x0 < x1) {
+          magnitudes[w].resize(size.x);
+          gradientMagnitudes(data, size, componentCount, x0, x1, y, z, 1.0,
+                             magnitudes[w].data());
+          for (uint32_t x = 0; x < x1 - x0; ++x) {
+            maxGradients[w] = std::max(maxGradients[w], magnitudes[w][x]);
+          }
+        }
+      });
+    }, workerCount);
+    const double maxGradient = *std::max_element(maxGradients.begin(),
+                                                 maxGradients.end());
+
+    std::vector<std::vector<uint64_t>> partial2D(workerCount,
+      std::vector<uint64_t>(valueBinCount * GradientBinCount));
+    parallelFor(slices.size(), [&](uint32_t w, uint64_t s) {
+      forEachLine(s, [&](const T* data, const Vec3ui& size, uint32_t y,
+                         uint32_t z, uint32_t x0, uint32_t x1,
+                         bool bGradients) {
+        if (!bGradients || x0 >= x1) return;
+        const T* row = data + (size_t(z) * size.y + y) * size.x * componentCount;
+        magnitudes[w].resize(size.x);
+        gradientMagnitudes(data, size, componentCount, x0, x1, y, z, 1.0,
+                           magnitudes[w].data());
+        for (uint32_t x = x0; x < x1; ++x) {
+          const size_t gradientBin = maxGradient > 0
+            ? std::min(GradientBinCount - 1,
+                       size_t(magnitudes[w][x - x0] / maxGradient *
+                              double(GradientBinCount - 1)))
+            : 0;
+          ++partial2D[w][valueBin(row[x * componentCount]) * GradientBinCount +
+                         gradientBin];
+        }
+      });
+    }, workerCount);
+
+    histogram1D.assign(valueBinCount, 0);
+    histogram2D.assign(valueBinCount * GradientBinCount, 0);
+    for (uint32_t w = 0; w < workerCount; ++w) {
+      for (size_t i = 0; i < histogram1D.size(); ++i) {
+        histogram1D[i] += partial1D[w][i];
+      }
+      for (size_t i = 0; i < histogram2D.size(); ++i) {
+        histogram2D[i] += partial2D[w][i];
+      }
+    }
+  }
+
+  // finest LOD with at most MaxHistogramVoxels voxels
+  uint64_t histogramLOD(const UVFDataset& dataset) {
+    for (uint64_t lod = 0; lod + 1 < dataset.GetLODLevelCount(); ++lod) {
+      if (dataset.GetDomainSize(lod, 0).volume() <= MaxHistogramVoxels) {
+        return lod;
+      }
+    }
+    return dataset.GetLODLevelCount() - 1;
+  }
+}
+
 std::vector<uint64_t> UVFIO::get1DHistogram() const {
-  //TODO
-  return std::vector<uint64_t>();
+  prepareHistograms();
+  return m_1DHistogram;
 }
 
 std::vector<uint64_t> UVFIO::get2DHistogram() const {
-  //TODO
-  return std::vector<uint64_t>();
+  prepareHistograms();
+  return m_2DHistogram;
+}
+
+void UVFIO::prepareHistograms() const {
+  std::lock_guard<std::mutex> lock(m_histogramMutex);
+  if (m_histogramsReady) return;
+  m_histogramsReady = true;
+
+  const Histogram1DDataBlock* stored1D = m_dataset->GetStored1DHistogram();
+  const Histogram2DDataBlock* stored2D = m_dataset->GetStored2DHistogram();
+  if (stored1D && !stored1D->GetHistogram().empty()) {
+    const std::vector<uint64_t>& h = stored1D->GetHistogram();
+    m_1DHistogram = rebin(h, std::min<size_t>(h.size(),
+                                              MAX_TRANSFERFUNCTION_SIZE));
+  }
+  if (stored2D && !stored2D->GetHistogram().empty()) {
+    const std::vector<std::vector<uint64_t>>& h = stored2D->GetHistogram();
+    const size_t valueBins = std::min<size_t>(h.size(),
+                                              MAX_TRANSFERFUNCTION_SIZE);
+    m_2DHistogram.assign(valueBins * GradientBinCount, 0);
+    for (size_t v = 0; v < h.size(); ++v) {
+      const std::vector<uint64_t> row = rebin(h[v], GradientBinCount);
+      const size_t offset = v * valueBins / h.size() * GradientBinCount;
+      for (size_t g = 0; g < GradientBinCount; ++g) {
+        m_2DHistogram[offset + g] += row[g];
+      }
+    }
+  }
+  if (!m_1DHistogram.empty() && !m_2DHistogram.empty()) return;
+  if (loadHistogramCache()) return;
+
+  const uint64_t lod = histogramLOD(*m_dataset);
+  LINFO("(UVFIO) no histograms stored in the file, computing them from LOD "
+        << lod);
+  std::vector<uint64_t> histogram1D, histogram2D;
+  try {
+    std::mutex* readMutex = rasterReadMutex();
+    switch (getType(0)) {
+      case ValueType::T_UINT8:  computeHistograms<uint8_t>(*m_dataset, lod, readMutex, histogram1D, histogram2D); break;
+      case ValueType::T_INT8:   computeHistograms<int8_t>(*m_dataset, lod, readMutex, histogram1D, histogram2D); break;
+      case ValueType::T_UINT16: computeHistograms<uint16_t>(*m_dataset, lod, readMutex, histogram1D, histogram2D); break;
+      case ValueType::T_INT16:  computeHistograms<int16_t>(*m_dataset, lod, readMutex, histogram1D, histogram2D); break;
+      case ValueType::T_UINT32: computeHistograms<uint32_t>(*m_dataset, lod, readMutex, histogram1D, histogram2D); break;
+      case ValueType::T_INT32:  computeHistograms<int32_t>(*m_dataset, lod, readMutex, histogram1D, histogram2D); break;
+      case ValueType::T_FLOAT:  computeHistograms<float>(*m_dataset, lod, readMutex, histogram1D, histogram2D); break;
+      case ValueType::T_DOUBLE: computeHistograms<double>(*m_dataset, lod, readMutex, histogram1D, histogram2D); break;
+      default:
+        // the dataset cannot read 64 bit integer bricks
+        LWARNING("(UVFIO) cannot compute histograms for 64 bit integer data");
+        return;
+    }
+  } catch (const TrinityError& err) {
+    LWARNING("(UVFIO) " << err.what());
+    return;
+  }
+  if (m_1DHistogram.empty()) m_1DHistogram = histogram1D;
+  if (m_2DHistogram.empty()) m_2DHistogram = histogram2D;
+  saveHistogramCache();
+}
+
+std::string UVFIO::histogramCacheFilename() const {
+  return changeExt(m_filename, "hist");
+}
+
+bool UVFIO::loadHistogramCache() const {
+  const std::string filename = histogramCacheFilename();
+  LARGE_STAT_BUFFER datasetStats, cacheStats;
+  if (!getFileStats(m_filename, datasetStats) ||
+      !getFileStats(filename, cacheStats) ||
+      cacheStats.st_mtime < datasetStats.st_mtime) {
+    return false;
+  }
+
+  std::ifstream file(filename.c_str());
+  std::vector<uint64_t> histogram1D, histogram2D;
+  for (auto histogram : {&histogram1D, &histogram2D}) {
+    size_t size = 0;
+    file >> size;
+    histogram->resize(size);
+    for (auto& value : *histogram) {
+      file >> value;
+    }
+  }
+  if (!file) {
+    LWARNING("(UVFIO) ignoring invalid histogram cache " << filename);
+    return false;
+  }
+  if (m_1DHistogram.empty()) m_1DHistogram = histogram1D;
+  if (m_2DHistogram.empty()) m_2DHistogram = histogram2D;
+  LINFO("(UVFIO) loaded histograms from " << filename);
+  return true;
+}
+
+void UVFIO::saveHistogramCache() const {
+  const std::string filename = histogramCacheFilename();
+  std::ofstream file(filename.c_str());
+  for (auto histogram : {&m_1DHistogram, &m_2DHistogram}) {
+    file << histogram->size() << "\n";
+    for (auto value : *histogram) {
+      file << value << " ";
+    }
+    file << "\n";
+  }
+  if (!file) {
+    // e.g. a read only directory, the histograms are computed again next time
+    LWARNING("(UVFIO) could not write histogram cache " << filename);
+  }
 }
 
 std::string UVFIO::getUserDefinedSemantic(uint64_t modality) const {
@@ -228,10 +526,49 @@ uint64_t UVFIO::getTotalBrickCount(uint64_t modality) const {
 std::shared_ptr<std::vector<uint8_t>> UVFIO::getBrick(const BrickKey& key, bool& success) const {
     auto data = MemBlockPool::instance().get(getBrickVoxelCounts(key).volume() *
       m_dataset->GetBitWidth()/8 * m_dataset->GetComponentCount());
+    std::unique_lock<std::mutex> lock;
+    if (std::mutex* readMutex = rasterReadMutex()) {
+      lock = std::unique_lock<std::mutex>(*readMutex);
+    }
     success = m_dataset->GetBrick(key, *data);
     return data;
 }
 
+std::shared_ptr<std::vector<uint8_t>> UVFIO::getEncodedBrick(const BrickKey& key) const {
+    const uint64_t brickSize = getBrickVoxelCounts(key).volume() *
+      m_dataset->GetBitWidth()/8 * m_dataset->GetComponentCount();
+    auto frame = MemBlockPool::instance().get(BinaryFrameHeader::size + brickSize);
+    frame->resize(BinaryFrameHeader::size);
+
+    BinaryFrameHeader header;
+    COMPRESSION_TYPE compression;
+    if (!m_dataset->GetStoredBrick(key, *frame, compression, header.properties)) {
+      return nullptr;
+    }
+    // only codecs that the receiver can decode quickly are forwarded, the
+    // other bricks are decompressed here and sent the usual way
+    switch (compression) {
+      case CT_LZ4: header.codec = BinaryCodec::LZ4; break;
+      case CT_LZMA: header.codec = BinaryCodec::LZMA; break;
+      default: return nullptr;
+    }
+    header.uncompressedSize = brickSize;
+    header.write(*frame);
+    return frame;
+}
+
+BinaryView UVFIO::getBrickView(const BrickKey& key) const {
+    BinaryView view;
+    uint64_t length = 0;
+    view.data = m_dataset->GetBrickView(key, length);
+    view.size = size_t(length);
+    return view;
+}
+
+std::mutex* UVFIO::rasterReadMutex() const {
+  return m_dataset->IsTOCBlock() ? nullptr : &m_rasterReadMutex;
+}
+
 Vec3ui UVFIO::getBrickVoxelCounts(const BrickKey& key) const {
   return m_dataset->GetBrickVoxelCounts(key);
 }
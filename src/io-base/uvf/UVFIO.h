@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <vector>
 
 #include "common/IIO.h"
@@ -33,6 +34,8 @@ namespace trinity {
     Core::Math::Vec2f getRange(uint64_t modality) const override;
     uint64_t getTotalBrickCount(uint64_t modality) const override;
     std::shared_ptr<std::vector<uint8_t>> getBrick(const BrickKey& brickKey, bool& success) const override;
+    std::shared_ptr<std::vector<uint8_t>> getEncodedBrick(const BrickKey& brickKey) const override;
+    BinaryView getBrickView(const BrickKey& brickKey) const override;
     IIO::ValueType getType(uint64_t modality) const override;
     IIO::Semantic getSemantic(uint64_t modality) const override;
     uint64_t getDefault1DTransferFunctionCount() const override;
@@ -50,7 +53,25 @@ namespace trinity {
   private:
     std::unique_ptr<UVFDataset> m_dataset;
     std::string                 m_filename;
+    // bricks of files with a table of contents are read with positional
+    // reads, files in the old raster data block format seek and read through
+    // the file handle all threads share
+    mutable std::mutex          m_rasterReadMutex;
+    std::mutex* rasterReadMutex() const;
     
     Core::Math::Vec3ui64 getEffectiveBricksize() const;
+    
+    // the histograms are taken from the blocks stored in the file, files
+    // without them get histograms computed from a coarse LOD, which are
+    // cached in a file next to the dataset
+    mutable std::mutex            m_histogramMutex;
+    mutable bool                  m_histogramsReady;
+    mutable std::vector<uint64_t> m_1DHistogram;
+    mutable std::vector<uint64_t> m_2DHistogram;
+    
+    void prepareHistograms() const;
+    std::string histogramCacheFilename() const;
+    bool loadHistogramCache() const;
+    void saveHistogramCache() const;
   };
 }
\ No newline at end of file
@@ -67,6 +67,11 @@ JPEGEncoder::ChrominanceSubsampling JPEGEncoder::getSubsampling() const
 std::shared_ptr<std::vector<uint8_t>> JPEGEncoder::encode(const std::vector<uint8_t>& raw, int width, int height)
 {
   int channels = raw.size() / (width * height);
+  return encode(raw.data(), width, height, channels);
+}
+
+std::shared_ptr<std::vector<uint8_t>> JPEGEncoder::encode(const uint8_t* raw, int width, int height, int channels, int pitch)
+{
 //  LINFO("encoding: " << width << "x" << height << "@" << channels << " channels with quality " << m_quality << " and subsampling " << m_subsampling);
 
   // TODO: introduce and use some reasonable pixel format description within trinity
@@ -85,8 +90,10 @@ std::shared_ptr<std::vector<uint8_t>> JPEGEncoder::encode(const std::vector<uint
   
   // libjpeg-turbo 1.4.2 doc promises to not modify the src buffer but does not decalre it as const
   // libjpeg-turbo 1.5 which is still in beta fixes this issue
-  unsigned char * src = const_cast<unsigned char *>(raw.data());
-  int pitch = width * tjPixelSize[format];
+  unsigned char * src = const_cast<unsigned char *>(raw);
+  if (pitch == 0) {
+    pitch = width * tjPixelSize[format];
+  }
   int flags = TJFLAG_BOTTOMUP;
 
   int success = tjCompress2(m_handle, src, width, pitch, height, format, &m_buffer, &m_size, m_subsampling, m_quality, flags);
@@ -47,6 +47,9 @@ public:
   ChrominanceSubsampling getSubsampling() const;
   
   std::shared_ptr<std::vector<uint8_t>> encode(const std::vector<uint8_t>& raw, int width, int height);
+  // encodes height rows of RGB (3 channels) or RGBA (4 channels) pixels starting at raw, consecutive rows
+  // are pitch bytes apart (0 means tightly packed)
+  std::shared_ptr<std::vector<uint8_t>> encode(const uint8_t* raw, int width, int height, int channels, int pitch = 0);
   
 private:
   void * m_handle;
@@ -0,0 +1,149 @@
+#include "JPEGStripEncoder.h"
+
+#include "mocca/log/LogManager.h"
+
+#include <algorithm>
+
+using namespace trinity;
+
+namespace {
+// strip heights are multiples of the largest MCU height, so that the block grid of the strips
+// matches the one of a single image and no extra seams are introduced
+const int mcuHeight = 16;
+}
+
+JPEGStripEncoder::JPEGStripEncoder(size_t threadCount, int quality, JPEGEncoder::ChrominanceSubsampling subsampling)
+: m_quality(quality)
+, m_subsampling(subsampling)
+, m_job()
+, m_jobGeneration(0)
+, m_pendingWorkers(0)
+, m_shutdown(false)
+{
+  threadCount = std::max<size_t>(threadCount, 1);
+  for (size_t i = 0; i < threadCount; ++i) {
+    m_encoders.push_back(std::unique_ptr<JPEGEncoder>(new JPEGEncoder(quality, subsampling)));
+  }
+  for (size_t i = 0; i < threadCount; ++i) {
+    m_workers.emplace_back(&JPEGStripEncoder::workerFunc, this, i);
+  }
+}
+
+JPEGStripEncoder::~JPEGStripEncoder()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shutdown = true;
+  }
+  m_jobAvailable.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void JPEGStripEncoder::setQuality(int quality)
+{
+  m_quality = quality;
+}
+
+int JPEGStripEncoder::getQuality() const
+{
+  return m_quality;
+}
+
+void JPEGStripEncoder::setSubsampling(JPEGEncoder::ChrominanceSubsampling subsampling)
+{
+  m_subsampling = subsampling;
+}
+
+JPEGEncoder::ChrominanceSubsampling JPEGStripEncoder::getSubsampling() const
+{
+  return m_subsampling;
+}
+
+size_t JPEGStripEncoder::getThreadCount() const
+{
+  return m_workers.size();
+}
+
+std::vector<JPEGStripEncoder::Region> JPEGStripEncoder::strips(int width, int height) const
+{
+  std::vector<Region> regions;
+  if (width <= 0 || height <= 0) {
+    return regions;
+  }
+  const int rowsPerWorker = (height + int(m_workers.size()) - 1) / int(m_workers.size());
+  const int stripHeight = ((rowsPerWorker + mcuHeight - 1) / mcuHeight) * mcuHeight;
+  for (int y = 0; y < height; y += stripHeight) {
+    regions.push_back(Region{0, y, width, std::min(stripHeight, height - y)});
+  }
+  return regions;
+}
+
+std::vector<std::shared_ptr<std::vector<uint8_t>>> JPEGStripEncoder::encode(const std::vector<uint8_t>& raw, int width, int height)
+{
+  return encode(raw, width, height, strips(width, height));
+}
+
+std::vector<std::shared_ptr<std::vector<uint8_t>>> JPEGStripEncoder::encode(const std::vector<uint8_t>& raw, int width, int height,
+                                                                            const std::vector<Region>& regions)
+{
+  if (width <= 0 || height <= 0) {
+    LERROR("invalid frame size " << width << "x" << height);
+    return {};
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_job.raw = raw.data();
+  m_job.width = width;
+  m_job.channels = int(raw.size() / (size_t(width) * height));
+  m_job.regions = &regions;
+  m_job.quality = m_quality;
+  m_job.subsampling = m_subsampling;
+  m_images.assign(regions.size(), nullptr);
+  m_pendingWorkers = m_workers.size();
+  ++m_jobGeneration;
+  m_jobAvailable.notify_all();
+
+  m_jobDone.wait(lock, [&] { return m_pendingWorkers == 0; });
+
+  for (const auto& image : m_images) {
+    if (image == nullptr) {
+      return {};
+    }
+  }
+  return std::move(m_images);
+}
+
+void JPEGStripEncoder::workerFunc(size_t worker)
+{
+  uint64_t lastGeneration = 0;
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_jobAvailable.wait(lock, [&] { return m_shutdown || m_jobGeneration != lastGeneration; });
+      if (m_shutdown) {
+        return;
+      }
+      lastGeneration = m_jobGeneration;
+      job = m_job;
+    }
+
+    // the regions are dealt out round robin, every worker writes to distinct elements of m_images
+    JPEGEncoder& encoder = *m_encoders[worker];
+    encoder.setQuality(job.quality);
+    encoder.setSubsampling(job.subsampling);
+    const size_t pitch = size_t(job.width) * job.channels;
+    for (size_t i = worker; i < job.regions->size(); i += m_workers.size()) {
+      const Region& region = (*job.regions)[i];
+      const uint8_t* origin = job.raw + region.y * pitch + size_t(region.x) * job.channels;
+      m_images[i] = encoder.encode(origin, region.width, region.height, job.channels, int(pitch));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_pendingWorkers == 0) {
+      m_jobDone.notify_one();
+    }
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "JPEGEncoder.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trinity {
+
+/**
+ * Encodes rectangular regions of a frame as independent JPEG images on a small pool of worker
+ * threads (turbojpeg handles are not thread safe, so every worker owns its own JPEGEncoder). The
+ * regions are usually horizontal strips of consecutive rows; decoding the strips in order and
+ * concatenating the raw rows yields the full frame again.
+*/
+class JPEGStripEncoder
+{
+public:
+  JPEGStripEncoder(size_t threadCount, int quality = 75,
+                   JPEGEncoder::ChrominanceSubsampling subsampling = JPEGEncoder::Subsample_444);
+  JPEGStripEncoder(JPEGStripEncoder const&) = delete;
+  ~JPEGStripEncoder();
+
+  JPEGStripEncoder& operator=(JPEGStripEncoder const&) = delete;
+
+  struct Region {
+    int x;
+    int y;
+    int width;
+    int height;
+  };
+
+  void setQuality(int quality);
+  int getQuality() const;
+  void setSubsampling(JPEGEncoder::ChrominanceSubsampling subsampling);
+  JPEGEncoder::ChrominanceSubsampling getSubsampling() const;
+  size_t getThreadCount() const;
+
+  // splits the frame into one strip per worker, strip heights are multiples of the MCU height
+  std::vector<Region> strips(int width, int height) const;
+
+  // @return one JPEG image per strip in row order, empty if any strip failed to encode
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> encode(const std::vector<uint8_t>& raw, int width, int height);
+  // @return one JPEG image per region, empty if any region failed to encode
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> encode(const std::vector<uint8_t>& raw, int width, int height,
+                                                            const std::vector<Region>& regions);
+
+private:
+  struct Job {
+    const uint8_t* raw;
+    int width;
+    int channels;
+    const std::vector<Region>* regions;
+    int quality;
+    JPEGEncoder::ChrominanceSubsampling subsampling;
+  };
+
+  void workerFunc(size_t worker);
+
+  int m_quality;
+  JPEGEncoder::ChrominanceSubsampling m_subsampling;
+
+  std::vector<std::unique_ptr<JPEGEncoder>> m_encoders;
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_jobAvailable;
+  std::condition_variable m_jobDone;
+  Job m_job;
+  uint64_t m_jobGeneration;
+  size_t m_pendingWorkers;
+  bool m_shutdown;
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> m_images;
+};
+
+}
@@ -0,0 +1,82 @@
+#include "GLPixelReadback.h"
+#include "GLFrameBufferObject.h"
+#include "GLCommon.h"
+
+#include <cassert>
+#include <cstring>
+
+GLPixelReadback::GLPixelReadback(GLsizei width, GLsizei height,
+                                 GLenum format, GLenum type,
+                                 uint32_t iBufferCount) :
+  m_iSizeX(width),
+  m_iSizeY(height),
+  m_iFrameSize(size_t(width) * size_t(height) *
+               gl_components(format) * gl_byte_width(type)),
+  m_vBuffers(iBufferCount),
+  m_ring(iBufferCount)
+{
+  for (PackBuffer& buffer : m_vBuffers) {
+    buffer.hFence = 0;
+    GL_CHECK(glGenBuffers(1, &buffer.hBuffer));
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.hBuffer));
+    GL_CHECK(glBufferData(GL_PIXEL_PACK_BUFFER, m_iFrameSize, nullptr,
+                          GL_STREAM_READ));
+  }
+  GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+}
+
+GLPixelReadback::~GLPixelReadback() {
+  for (PackBuffer& buffer : m_vBuffers) {
+    Release(buffer);
+    GL_CHECK(glDeleteBuffers(1, &buffer.hBuffer));
+  }
+}
+
+void GLPixelReadback::Read(GLRenderTexture& target, int iBuffer) {
+  assert(target.Width() == GLuint(m_iSizeX) && target.Height() == GLuint(m_iSizeY));
+  PackBuffer& buffer = m_vBuffers[m_ring.BeginRead()];
+  GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.hBuffer));
+  // with a pack buffer bound the pointer is an offset into the buffer and
+  // the call returns as soon as the transfer is queued
+  target.ReadBackPixels(0, 0, m_iSizeX, m_iSizeY, nullptr, iBuffer);
+  GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  buffer.hFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool GLPixelReadback::Fetch(void* pData, bool bWait) {
+  // waiting for the oldest read when all buffers are in flight is what
+  // limits how far the render thread may run ahead of the GPU
+  const int iBuffer = m_ring.NewestFinished(bWait,
+    [this](uint32_t i, bool bWaitForRead) {
+      return IsFinished(m_vBuffers[i], bWaitForRead);
+    });
+  if (iBuffer < 0) return false;
+
+  GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_vBuffers[iBuffer].hBuffer));
+  const void* pMapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                         m_iFrameSize, GL_MAP_READ_BIT);
+  if (pMapped) {
+    std::memcpy(pData, pMapped, m_iFrameSize);
+    GL_CHECK(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+  }
+  GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+  // the fetched read and all older ones are done with
+  m_ring.ReleaseThrough(uint32_t(iBuffer),
+                        [this](uint32_t i) { Release(m_vBuffers[i]); });
+  return pMapped != nullptr;
+}
+
+bool GLPixelReadback::IsFinished(PackBuffer& buffer, bool bWait) {
+  const GLuint64 iTimeout = bWait ? GL_TIMEOUT_IGNORED : 0;
+  const GLenum result = glClientWaitSync(buffer.hFence,
+                                         GL_SYNC_FLUSH_COMMANDS_BIT, iTimeout);
+  return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void GLPixelReadback::Release(PackBuffer& buffer) {
+  if (buffer.hFence) {
+    GL_CHECK(glDeleteSync(buffer.hFence));
+    buffer.hFence = 0;
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "OpenGLincludes.h"
+#include "ReadbackRing.h"
+
+class GLRenderTexture;
+
+// Asynchronous framebuffer readback through a ring of pixel pack buffers.
+// Read only enqueues the transfer into the next buffer and fences it, Fetch
+// later maps the newest finished buffer, so the render thread does not wait
+// for the GPU as it does with a plain glReadPixels. Older finished reads are
+// dropped in favor of newer ones.
+class GLPixelReadback {
+public:
+  GLPixelReadback(GLsizei width, GLsizei height,
+                  GLenum format=GL_RGBA, GLenum type=GL_UNSIGNED_BYTE,
+                  uint32_t iBufferCount=3);
+  ~GLPixelReadback();
+
+  // starts reading the given buffer of the currently bound render target,
+  // requires a free buffer, i.e. Fetch has to be called after each Read
+  void Read(GLRenderTexture& target, int iBuffer=0);
+
+  // copies the pixels of the newest finished read to pData (which must hold
+  // GetFrameSize() bytes); blocks only if bWait is set or if all buffers
+  // are in flight
+  // @return true if pixels have been copied
+  bool Fetch(void* pData, bool bWait=false);
+
+  bool HasPendingReads() const { return m_ring.PendingCount() > 0; }
+  size_t GetFrameSize() const { return m_iFrameSize; }
+  GLsizei Width() const { return m_iSizeX; }
+  GLsizei Height() const { return m_iSizeY; }
+
+private:
+  struct PackBuffer {
+    GLuint hBuffer;
+    GLsync hFence;   // set while the read is pending, i.e. not fetched yet
+  };
+
+  bool IsFinished(PackBuffer& buffer, bool bWait);
+  void Release(PackBuffer& buffer);
+
+  GLsizei                 m_iSizeX;
+  GLsizei                 m_iSizeY;
+  size_t                  m_iFrameSize;
+  std::vector<PackBuffer> m_vBuffers;
+  ReadbackRing            m_ring;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+// Bookkeeping of a ring of readback buffers, without any GL calls: which
+// buffer the next read goes to and which pending read a fetch delivers.
+// Reads finish in the order they were issued, a fetch delivers the newest
+// finished one and drops the older ones.
+class ReadbackRing {
+public:
+  explicit ReadbackRing(uint32_t iBufferCount) :
+    m_iBufferCount(iBufferCount),
+    m_iNextBuffer(0),
+    m_iPendingCount(0)
+  {
+    assert(iBufferCount > 0);
+  }
+
+  // @return the buffer the next read goes to, requires a free buffer
+  uint32_t BeginRead() {
+    assert(m_iPendingCount < m_iBufferCount);
+    const uint32_t iBuffer = m_iNextBuffer;
+    m_iNextBuffer = (m_iNextBuffer + 1) % m_iBufferCount;
+    ++m_iPendingCount;
+    return iBuffer;
+  }
+
+  // finds the newest pending read that has finished; isFinished(iBuffer,
+  // bWait) polls a buffer or waits for it. The oldest read is waited for if
+  // all buffers are in flight, so the next read finds a free buffer, and the
+  // newest one if bWait is set
+  // @return the buffer of the read or -1 if none has finished
+  template <class IsFinished>
+  int NewestFinished(bool bWait, IsFinished isFinished) const {
+    if (m_iPendingCount == 0) return -1;
+    if (!bWait && m_iPendingCount == m_iBufferCount)
+      isFinished(Pending(0), true);
+
+    for (uint32_t i = m_iPendingCount; i > 0; --i) {
+      if (isFinished(Pending(i - 1), bWait && i == m_iPendingCount))
+        return int(Pending(i - 1));
+    }
+    return -1;
+  }
+
+  // ends the read in iBuffer and all older ones, calling release(iBuffer)
+  // for each of them, oldest first
+  template <class Release>
+  void ReleaseThrough(uint32_t iBuffer, Release release) {
+    uint32_t i = 0;
+    bool bDone = false;
+    while (!bDone) {
+      assert(i < m_iPendingCount);
+      bDone = Pending(i) == iBuffer;
+      release(Pending(i++));
+    }
+    m_iPendingCount -= i;
+  }
+
+  uint32_t PendingCount() const { return m_iPendingCount; }
+  uint32_t BufferCount() const { return m_iBufferCount; }
+
+private:
+  // buffer of the i-th pending read, 0 is the oldest
+  uint32_t Pending(uint32_t i) const {
+    return (m_iNextBuffer + m_iBufferCount - m_iPendingCount + i) %
+           m_iBufferCount;
+  }
+
+  const uint32_t m_iBufferCount;
+  uint32_t       m_iNextBuffer;
+  uint32_t       m_iPendingCount;
+};
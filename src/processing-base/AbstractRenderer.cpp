@@ -393,12 +393,14 @@ void AbstractRenderer::setUserViewMatrix(Core::Math::Mat4f m)
 {
   m_userViewMatrix = m;
   recomputeModelViewMatrix();
+  viewChanged(false);
 }
 
 void AbstractRenderer::setUserWorldMatrix(Core::Math::Mat4f m)
 {
   m_userWorldMatrix = m;
   recomputeModelViewMatrix();
+  viewChanged(false);
 }
 
 void AbstractRenderer::recomputeModelViewMatrix() {
@@ -424,6 +426,7 @@ void AbstractRenderer::rotateCamera(Vec3f rotation) {
   rotZ.RotationZ(rotation.z);
   m_camRotation = m_camRotation * rotX * rotY * rotZ;
   recomputeModelViewMatrix();
+  viewChanged(true);
   paint();
 }
 
@@ -432,6 +435,7 @@ void AbstractRenderer::moveCamera(Vec3f direction) {
   trans.Translation(direction);
   m_camTranslation = m_camTranslation * trans;
   recomputeModelViewMatrix();
+  viewChanged(true);
   paint();
 }
 
@@ -440,6 +444,7 @@ void AbstractRenderer::zoomCamera(float zoom) {
   scale.Scaling(zoom,zoom,zoom);
   m_camZoom = m_camZoom * scale;
   recomputeModelViewMatrix();
+  viewChanged(true);
   paint();
 }
 
@@ -450,6 +455,7 @@ void AbstractRenderer::rotateScene(Vec3f rotation) {
   rotZ.RotationZ(rotation.z);
   m_rotation = m_rotation * rotX * rotY * rotZ;
   recomputeModelViewMatrix();
+  viewChanged(true);
   paint();
 }
 
@@ -458,6 +464,7 @@ void AbstractRenderer::moveScene(Vec3f direction) {
   trans.Translation(direction);
   m_translation = m_translation * trans;
   recomputeModelViewMatrix();
+  viewChanged(true);
   paint();
 }
 
@@ -466,6 +473,7 @@ void AbstractRenderer::rescaleScene(float scale) {
   matScale.Scaling(scale,scale,scale);
   m_scale = m_scale * matScale;
   recomputeModelViewMatrix();
+  viewChanged(true);
   paint();
 }
 
@@ -482,6 +490,7 @@ void AbstractRenderer::resetCamera() {
   m_camZoom = Mat4f();
   
   recomputeModelViewMatrix();
+  viewChanged(false);
   paint();
 }
 
@@ -493,6 +502,7 @@ void AbstractRenderer::resetScene() {
   m_scale = Mat4f();
 
   recomputeModelViewMatrix();
+  viewChanged(false);
   paint();
 }
 
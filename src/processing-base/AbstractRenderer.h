@@ -116,6 +116,9 @@ namespace trinity {
   protected:
     virtual void paintInternal(PaintLevel paintlevel) = 0;
     virtual void performClipping();
+    // called after an interaction changed the view and before it is painted,
+    // bContinuous is false if the view jumped (e.g. reset or user matrices)
+    virtual void viewChanged(bool /*bContinuous*/) {}
 
     ERenderMode m_renderMode;
     uint64_t m_activeModality;
@@ -0,0 +1,91 @@
+#include "processing-base/FrameTileDiff.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRINITY_FRAMEDIFF_SSE2
+#endif
+
+using namespace trinity;
+
+namespace {
+bool equalBytes(const uint8_t* a, const uint8_t* b, size_t count) {
+    size_t i = 0;
+#ifdef TRINITY_FRAMEDIFF_SSE2
+    for (; i + 16 <= count; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF) {
+            return false;
+        }
+    }
+#endif
+    return std::memcmp(a + i, b + i, count - i) == 0;
+}
+}
+
+FrameTileDiff::FrameTileDiff(uint32_t tileSize)
+    : m_tileSize(tileSize)
+    , m_width(0)
+    , m_height(0) {}
+
+std::vector<FrameRegion> FrameTileDiff::update(const Frame& frame, uint32_t width, uint32_t height) {
+    if (width != m_width || height != m_height || frame.size() != m_reference.size()) {
+        m_reference = frame;
+        m_width = width;
+        m_height = height;
+        return std::vector<FrameRegion>(1, FrameRegion{0, 0, width, height});
+    }
+
+    std::vector<FrameRegion> regions;
+    if (width == 0 || height == 0) {
+        return regions;
+    }
+    const size_t channels = frame.size() / (size_t(width) * height);
+    const size_t pitch = size_t(width) * channels;
+    const uint32_t tilesX = (width + m_tileSize - 1) / m_tileSize;
+    std::vector<bool> changed(tilesX);
+
+    for (uint32_t y0 = 0; y0 < height; y0 += m_tileSize) {
+        const uint32_t rows = std::min(m_tileSize, height - y0);
+        std::fill(changed.begin(), changed.end(), false);
+        for (uint32_t y = y0; y < y0 + rows; ++y) {
+            const uint8_t* current = frame.data() + y * pitch;
+            const uint8_t* reference = m_reference.data() + y * pitch;
+            for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                if (changed[tx]) continue;
+                const size_t offset = size_t(tx) * m_tileSize * channels;
+                const size_t bytes = size_t(std::min(m_tileSize, width - tx * m_tileSize)) * channels;
+                changed[tx] = !equalBytes(current + offset, reference + offset, bytes);
+            }
+        }
+
+        const auto first = std::find(changed.begin(), changed.end(), true);
+        if (first == changed.end()) continue;
+        const auto last = std::find(changed.rbegin(), changed.rend(), true);
+        const uint32_t x0 = uint32_t(first - changed.begin()) * m_tileSize;
+        const uint32_t x1 = std::min(width, uint32_t(changed.rend() - last) * m_tileSize);
+        regions.push_back(FrameRegion{x0, y0, x1 - x0, rows});
+
+        for (uint32_t y = y0; y < y0 + rows; ++y) {
+            std::memcpy(m_reference.data() + y * pitch + x0 * channels, frame.data() + y * pitch + x0 * channels, (x1 - x0) * channels);
+        }
+    }
+    return regions;
+}
+
+void FrameTileDiff::reset() {
+    m_reference.clear();
+    m_width = 0;
+    m_height = 0;
+}
+
+uint64_t FrameTileDiff::area(const std::vector<FrameRegion>& regions) {
+    uint64_t result = 0;
+    for (const auto& region : regions) {
+        result += uint64_t(region.width) * region.height;
+    }
+    return result;
+}
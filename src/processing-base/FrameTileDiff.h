@@ -0,0 +1,29 @@
+#pragma once
+
+#include "common/VisStream.h"
+#include "common/VisStreamProtocol.h"
+
+#include <vector>
+
+namespace trinity {
+
+// finds the parts of a frame that changed since the previous one by comparing square tiles; the
+// changed tiles of each tile row are merged into a single region to keep the per-region overhead low
+class FrameTileDiff {
+public:
+    explicit FrameTileDiff(uint32_t tileSize = 32);
+
+    // compares the frame with the reference frame and makes it the new reference
+    // @return the changed regions, the whole frame if there is no reference of the same size
+    std::vector<FrameRegion> update(const Frame& frame, uint32_t width, uint32_t height);
+    void reset();
+
+    static uint64_t area(const std::vector<FrameRegion>& regions);
+
+private:
+    const uint32_t m_tileSize;
+    Frame m_reference;
+    uint32_t m_width;
+    uint32_t m_height;
+};
+}
@@ -185,6 +185,9 @@ std::unique_ptr<ICommandHandler> ProcessingSessionCommandFactory::createHandler(
     case VclType::SetUserWorldMatrix:
         return mocca::make_unique<SetUserWorldMatrixHdl>(static_cast<const SetUserWorldMatrixRequest&>(request), session);
         break;
+    case VclType::GetStreamQuality:
+        return mocca::make_unique<GetStreamQualityHdl>(static_cast<const GetStreamQualityRequest&>(request), session);
+        break;
     /* AUTOGEN ProcCommandFactoryEntry */
     default:
         throw TrinityError("command unknown: " + (Vcl::instance().toString(type)), __FILE__, __LINE__);
@@ -505,4 +505,13 @@ std::unique_ptr<Reply> SetUserWorldMatrixHdl::execute() {
     return nullptr;
 }
 
+GetStreamQualityHdl::GetStreamQualityHdl(const GetStreamQualityRequest& request, RenderSession* session)
+    : m_request(request)
+    , m_session(session) {}
+
+std::unique_ptr<Reply> GetStreamQualityHdl::execute() {
+    GetStreamQualityCmd::ReplyParams params(m_session->getStreamQuality());
+    return mocca::make_unique<GetStreamQualityReply>(params, m_request.getRid(), m_session->getSid());
+}
+
 /* AUTOGEN ProcCommandHandlerImpl */
\ No newline at end of file
@@ -583,5 +583,16 @@ private:
     RenderSession* m_session;
 };
 
+class GetStreamQualityHdl : public ICommandHandler {
+public:
+    GetStreamQualityHdl(const GetStreamQualityRequest& request, RenderSession* session);
+
+    std::unique_ptr<Reply> execute() override;
+
+private:
+    GetStreamQualityRequest m_request;
+    RenderSession* m_session;
+};
+
 /* AUTOGEN ProcCommandHandlerHeader */
 }
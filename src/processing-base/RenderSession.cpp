@@ -67,6 +67,10 @@ IRenderer& RenderSession::getRenderer() {
     return *m_renderer;
 }
 
+StreamQuality RenderSession::getStreamQuality() const {
+    return m_visSender ? m_visSender->getStreamQuality() : StreamQuality();
+}
+
 std::unique_ptr<ICommandHandler> RenderSession::createHandler(const Request& request) {
     return m_factory.createHandler(request, this);
 }
@@ -24,6 +24,7 @@ public:
 
     std::string getVisPort() const;
     IRenderer& getRenderer();
+    StreamQuality getStreamQuality() const;
 
 private:
     void performThreadSpecificTeardown() override;
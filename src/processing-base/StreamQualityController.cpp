@@ -0,0 +1,106 @@
+#include "processing-base/StreamQualityController.h"
+
+#include "jpeg/JPEGEncoder.h"
+
+#include "mocca/log/LogManager.h"
+
+#include <algorithm>
+
+using namespace trinity;
+
+namespace {
+struct QualityLevel {
+    int jpegQuality;
+    JPEGEncoder::ChrominanceSubsampling subsampling;
+    float resolutionScale;
+};
+
+const QualityLevel qualityLevels[] = {
+    {90, JPEGEncoder::Subsample_444, 1.0f}, {85, JPEGEncoder::Subsample_422, 1.0f}, {75, JPEGEncoder::Subsample_420, 1.0f},
+    {60, JPEGEncoder::Subsample_420, 1.0f}, {45, JPEGEncoder::Subsample_420, 1.0f}, {60, JPEGEncoder::Subsample_420, 0.5f},
+    {40, JPEGEncoder::Subsample_420, 0.5f},
+};
+const size_t levelCount = sizeof(qualityLevels) / sizeof(qualityLevels[0]);
+const size_t defaultLevel = 2; // 75, 4:2:0 at full resolution
+
+// weight of the newest sample in the moving averages
+const double smoothing = 0.2;
+// frames to wait after a change before the averages reflect the new level
+const size_t framesPerDecision = 8;
+// quality is only raised again if less than this fraction of the budgets is used
+const double headroom = 0.5;
+}
+
+StreamQualityController::StreamQualityController(float targetFramesPerSecond, float targetBytesPerSecond)
+    : m_targetFramesPerSecond(targetFramesPerSecond)
+    , m_targetBytesPerSecond(targetBytesPerSecond)
+    , m_level(defaultLevel)
+    , m_framesAtLevel(0)
+    , m_encodeSeconds(0.0)
+    , m_sendSeconds(0.0)
+    , m_bytesPerFrame(0.0)
+    , m_framesPerSecond(0.0) {}
+
+void StreamQualityController::frameSent(double encodeSeconds, double sendSeconds, size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto now = std::chrono::steady_clock::now();
+    const double alpha = m_framesAtLevel == 0 ? 1.0 : smoothing;
+    if (m_framesAtLevel > 0) {
+        const double interval = std::chrono::duration<double>(now - m_lastFrame).count();
+        if (interval > 0.0) {
+            m_framesPerSecond = m_framesPerSecond == 0.0 ? 1.0 / interval : (1.0 - smoothing) * m_framesPerSecond + smoothing / interval;
+        }
+    }
+    m_lastFrame = now;
+
+    m_encodeSeconds = (1.0 - alpha) * m_encodeSeconds + alpha * encodeSeconds;
+    m_sendSeconds = (1.0 - alpha) * m_sendSeconds + alpha * sendSeconds;
+    m_bytesPerFrame = (1.0 - alpha) * m_bytesPerFrame + alpha * double(bytes);
+    ++m_framesAtLevel;
+
+    if (m_framesAtLevel >= framesPerDecision) {
+        adjustLevel();
+    }
+}
+
+void StreamQualityController::adjustLevel() {
+    // the time spent in send is the backpressure of the connection
+    const double frameBudget = 1.0 / m_targetFramesPerSecond;
+    const double frameCost = m_encodeSeconds + m_sendSeconds;
+    // a renderer that delivers fewer frames than the target needs less bandwidth; the frame rate is not
+    // used for the time budget, as slow encoding lowers it as well
+    const double framesPerSecond =
+        m_framesPerSecond > 0.0 ? std::min(m_framesPerSecond, double(m_targetFramesPerSecond)) : m_targetFramesPerSecond;
+    const double requiredBandwidth = m_bytesPerFrame * framesPerSecond;
+
+    size_t newLevel = m_level;
+    if ((frameCost > frameBudget || requiredBandwidth > m_targetBytesPerSecond) && m_level + 1 < levelCount) {
+        newLevel = m_level + 1;
+    } else if (frameCost < headroom * frameBudget && requiredBandwidth < headroom * m_targetBytesPerSecond && m_level > 0) {
+        newLevel = m_level - 1;
+    }
+
+    if (newLevel != m_level) {
+        LDEBUG("(p) stream quality level " << m_level << " -> " << newLevel << " (frame cost " << frameCost * 1000.0 << " ms, "
+                                          << m_bytesPerFrame << " bytes per frame)");
+        m_level = newLevel;
+        m_framesAtLevel = 0;
+    }
+}
+
+StreamQuality StreamQualityController::getQuality() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const QualityLevel& level = qualityLevels[m_level];
+    return StreamQuality(level.jpegQuality, level.subsampling, level.resolutionScale, float(m_framesPerSecond),
+                         float(m_framesPerSecond * m_bytesPerFrame));
+}
+
+size_t StreamQualityController::getLevel() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_level;
+}
+
+size_t StreamQualityController::getLevelCount() {
+    return levelCount;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "commands/ProcessingCommands.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace trinity {
+
+// feedback controller for the vis stream encoding: walks a ladder of settings from best quality
+// (high JPEG quality, no chroma subsampling) down to reduced resolution, depending on whether the
+// measured encode and send times fit the frame budget and the bytes per frame fit the bandwidth
+class StreamQualityController {
+public:
+    StreamQualityController(float targetFramesPerSecond = 25.0f, float targetBytesPerSecond = 12.5e6f);
+
+    // to be called by the sender for every frame it has sent
+    void frameSent(double encodeSeconds, double sendSeconds, size_t bytes);
+
+    StreamQuality getQuality() const;
+    size_t getLevel() const;
+    static size_t getLevelCount();
+
+private:
+    void adjustLevel();
+
+private:
+    const float m_targetFramesPerSecond;
+    const float m_targetBytesPerSecond;
+
+    mutable std::mutex m_mutex;
+    size_t m_level;
+    size_t m_framesAtLevel;
+    // exponential moving averages
+    double m_encodeSeconds;
+    double m_sendSeconds;
+    double m_bytesPerFrame;
+    double m_framesPerSecond;
+    std::chrono::steady_clock::time_point m_lastFrame;
+};
+}
@@ -3,12 +3,58 @@
 #include "mocca/log/LogManager.h"
 #include "mocca/net/ConnectionFactorySelector.h"
 #include "mocca/net/NetworkError.h"
-#include "jpeg/JPEGEncoder.h"
+#include "common/VisStreamProtocol.h"
+#include "jpeg/JPEGStripEncoder.h"
+#include "processing-base/FrameTileDiff.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 using namespace trinity;
 
+namespace {
+// upper bound for the strips a frame is split into, one encoder thread each
+const unsigned maxEncoderThreads = 4;
+// above this fraction of changed pixels a full frame is cheaper than patching the previous one
+const double maxDeltaArea = 0.5;
+
+// box filters the frame down by an integer factor in both directions
+void downsample(const Frame& source, int width, int height, int factor, Frame& target) {
+    const size_t channels = source.size() / (size_t(width) * height);
+    const int targetWidth = width / factor;
+    const int targetHeight = height / factor;
+    const unsigned area = unsigned(factor * factor);
+    target.resize(size_t(targetWidth) * targetHeight * channels);
+    for (int y = 0; y < targetHeight; ++y) {
+        for (int x = 0; x < targetWidth; ++x) {
+            for (size_t c = 0; c < channels; ++c) {
+                unsigned sum = 0;
+                for (int fy = 0; fy < factor; ++fy) {
+                    const size_t row = size_t(y * factor + fy) * width;
+                    for (int fx = 0; fx < factor; ++fx) {
+                        sum += source[(row + x * factor + fx) * channels + c];
+                    }
+                }
+                target[(size_t(y) * targetWidth + x) * channels + c] = uint8_t(sum / area);
+            }
+        }
+    }
+}
+
+double secondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+bool sameEncoding(const StreamQuality& lhs, const StreamQuality& rhs) {
+    return lhs.getJpegQuality() == rhs.getJpegQuality() && lhs.getSubsampling() == rhs.getSubsampling() &&
+           lhs.getResolutionScale() == rhs.getResolutionScale();
+}
+}
+
 VisStreamSender::VisStreamSender(const mocca::net::Endpoint endpoint, std::shared_ptr<VisStream> s)
-    : m_visStream(s) {
+    : m_visStream(s)
+    , m_deltaEncoding(true) {
     m_acceptor = std::move(mocca::net::ConnectionFactorySelector::bind(endpoint));
 }
 
@@ -22,6 +68,7 @@ void VisStreamSender::startStreaming() {
 
 void VisStreamSender::endStreaming() {
     interrupt();
+    m_visStream->close();
 }
 
 std::string VisStreamSender::getPort() const {
@@ -43,7 +90,11 @@ void VisStreamSender::run() {
     }
 
     LINFO("(p) vis sender was bound");
-    JPEGEncoder jpeg(75, JPEGEncoder::Subsample_420);
+    const unsigned encoderThreads = std::max(1u, std::min(std::thread::hardware_concurrency(), maxEncoderThreads));
+    JPEGStripEncoder jpeg(encoderThreads);
+    Frame scaledFrame;
+    FrameTileDiff tileDiff;
+    StreamQuality sentQuality;
     
     while (!isInterrupted()) {
         if(!m_connection->isConnected()) {
@@ -51,21 +102,78 @@ void VisStreamSender::run() {
             continue;
         }
 
-        auto frame = m_visStream->get();
+        auto const& frame = m_visStream->get();
         if (m_connection->isConnected() && !frame.empty()) {
             try {
                 auto const& params = m_visStream->getStreamingParams();
-                auto encodedFrame = jpeg.encode(frame, params.getResX(), params.getResY());
+                auto const quality = m_qualityController.getQuality();
+                jpeg.setQuality(quality.getJpegQuality());
+                jpeg.setSubsampling(static_cast<JPEGEncoder::ChrominanceSubsampling>(quality.getSubsampling()));
+
+                auto const encodeStart = std::chrono::steady_clock::now();
+                // a reduced resolution is scaled up again by the receiver
+                int width = params.getResX();
+                int height = params.getResY();
+                const int scaleFactor = int(1.0f / quality.getResolutionScale() + 0.5f);
+                if (scaleFactor > 1) {
+                    downsample(frame, width, height, scaleFactor, scaledFrame);
+                    width /= scaleFactor;
+                    height /= scaleFactor;
+                }
+                const Frame& image = scaleFactor > 1 ? scaledFrame : frame;
+
+                // the receiver keeps the previous frame, so unless the encoding has changed or most of the frame
+                // differs, only the changed tiles are sent; receivers without region support get single images
+                const bool regionSupport = params.getFrameRegions();
+                const auto changedRegions =
+                    regionSupport ? tileDiff.update(image, width, height) : std::vector<FrameRegion>();
+                const bool fullFrame = !regionSupport || !m_deltaEncoding || !sameEncoding(quality, sentQuality) ||
+                                       FrameTileDiff::area(changedRegions) > maxDeltaArea * width * height;
+                FrameHeader header{fullFrame ? FrameHeader::Encoding::Full : FrameHeader::Encoding::Delta, uint32_t(width),
+                                   uint32_t(height), std::vector<FrameRegion>()};
+                std::vector<JPEGStripEncoder::Region> regions;
+                if (!regionSupport) {
+                    regions.push_back(JPEGStripEncoder::Region{0, 0, width, height});
+                } else if (fullFrame) {
+                    regions = jpeg.strips(width, height);
+                } else {
+                    for (const auto& region : changedRegions) {
+                        regions.push_back(JPEGStripEncoder::Region{int(region.x), int(region.y), int(region.width), int(region.height)});
+                    }
+                }
+                for (const auto& region : regions) {
+                    header.regions.push_back(FrameRegion{uint32_t(region.x), uint32_t(region.y), uint32_t(region.width), uint32_t(region.height)});
+                }
+
+                std::vector<std::shared_ptr<std::vector<uint8_t>>> encodedRegions;
+                if (!regions.empty()) {
+                    encodedRegions = jpeg.encode(image, width, height, regions);
+                    if (encodedRegions.empty()) {
+                        // the receiver misses these changes, start over with a full frame
+                        tileDiff.reset();
+                    }
+                }
+                auto const encodeEnd = std::chrono::steady_clock::now();
                 
-				if (encodedFrame != nullptr) {
+                if (!encodedRegions.empty()) {
+                    // the header followed by one message part per region
                     mocca::net::Message message;
-                    message.push_back(encodedFrame);
+                    message.push_back(header.write());
+                    message.insert(message.end(), encodedRegions.begin(), encodedRegions.end());
                     m_connection->send(message);
-					//LINFO("(p) frame out");
-				}
- 	} catch (const mocca::net::NetworkError& err) {
+                    sentQuality = quality;
+                    //LINFO("(p) frame out");
+
+                    size_t bytes = 0;
+                    for (const auto& part : encodedRegions) {
+                        bytes += part->size();
+                    }
+                    m_qualityController.frameSent(secondsBetween(encodeStart, encodeEnd),
+                                                  secondsBetween(encodeEnd, std::chrono::steady_clock::now()), bytes);
+                }
+            } catch (const mocca::net::NetworkError& err) {
                 LERROR("(p) cannot send vis: " << err.what());
-		interrupt();
+                interrupt();
             }
         }
     }
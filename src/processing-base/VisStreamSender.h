@@ -1,7 +1,9 @@
 #pragma once
+#include <atomic>
 #include <memory>
 
 #include "common/VisStream.h"
+#include "processing-base/StreamQualityController.h"
 #include "mocca/base/Thread.h"
 #include "mocca/net/Endpoint.h"
 #include "mocca/net/IMessageConnection.h"
@@ -21,6 +23,9 @@ public:
 
     std::string getPort() const;
     std::shared_ptr<VisStream> getStream() const { return m_visStream; }
+    StreamQuality getStreamQuality() const { return m_qualityController.getQuality(); }
+    // if enabled (default), only the tiles that changed since the previous frame are sent
+    void setDeltaEncoding(bool enable) { m_deltaEncoding = enable; }
 
 private:
     std::shared_ptr<VisStream> m_visStream;
@@ -28,5 +33,7 @@ private:
 
     std::unique_ptr<mocca::net::IMessageConnectionAcceptor> m_acceptor;
     std::unique_ptr<mocca::net::IMessageConnection> m_connection;
+    StreamQualityController m_qualityController;
+    std::atomic<bool> m_deltaEncoding;
 };
 }
\ No newline at end of file
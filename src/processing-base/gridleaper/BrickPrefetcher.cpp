@@ -0,0 +1,203 @@
+#include "BrickPrefetcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+using namespace Core::Math;
+
+BrickPrefetcher::BrickPrefetcher(const std::vector<Vec3ui>& vLayouts,
+                                 const std::vector<Vec3f>& vFloatLayouts,
+                                 uint32_t iPredictedViews) :
+m_vLayouts(vLayouts),
+m_vFloatLayouts(vFloatLayouts),
+m_vLoDOffsets(vLayouts.size()),
+m_iPredictedViews(iPredictedViews),
+m_fLoDFactor(0.0f),
+m_fLevelZeroWorldSpaceError(1.0f),
+m_bHasView(false),
+m_bHasMotion(false)
+{
+  uint32_t iOffset = 0;
+  for (size_t i = 0;i<m_vLayouts.size();++i) {
+    m_vLoDOffsets[i] = iOffset;
+    iOffset += m_vLayouts[i].volume();
+  }
+}
+
+void BrickPrefetcher::setProjection(const Mat4f& mProjection, float fLoDFactor,
+                                    float fLevelZeroWorldSpaceError) {
+  m_mProjection = mProjection;
+  m_fLoDFactor = fLoDFactor;
+  m_fLevelZeroWorldSpaceError = fLevelZeroWorldSpaceError;
+}
+
+void BrickPrefetcher::addView(const Mat4f& mModelToView, bool bContinuous) {
+  m_bHasMotion = m_bHasView && bContinuous;
+  m_mLastView = m_mView;
+  m_mView = mModelToView;
+  m_bHasView = true;
+}
+
+std::vector<BrickPrefetcher::Prediction>
+BrickPrefetcher::predict(const Classifier& classify, size_t iMaxCount) const {
+  std::vector<Prediction> vResult;
+  if (!m_bHasMotion || m_vLayouts.empty() || iMaxCount == 0) return vResult;
+
+  // the change from the last to the current view in view space, repeated
+  // camera or scene rotations by the same angle lead to the same change
+  const Mat4f mStep = m_mLastView.inverse() * m_mView;
+  const uint32_t iCoarsestLoD = uint32_t(m_vLayouts.size() - 1);
+
+  std::unordered_set<uint32_t> reported;
+  Mat4f mView = m_mView;
+  for (uint32_t iStep = 1;iStep<=m_iPredictedViews;++iStep) {
+    mView = mView * mStep;
+    const Mat4f mViewProjection = mView * m_mProjection;
+
+    std::vector<Vec4ui> vLevel;
+    vLevel.reserve(m_vLayouts[iCoarsestLoD].volume());
+    const Vec3ui& vCoarsestLayout = m_vLayouts[iCoarsestLoD];
+    for (uint32_t z = 0;z<vCoarsestLayout.z;++z) {
+      for (uint32_t y = 0;y<vCoarsestLayout.y;++y) {
+        for (uint32_t x = 0;x<vCoarsestLayout.x;++x) {
+          vLevel.push_back(Vec4ui(x, y, z, iCoarsestLoD));
+        }
+      }
+    }
+
+    // one LoD after the other, so coarse bricks are reported first
+    while (!vLevel.empty()) {
+      std::vector<Vec4ui> vChildren;
+      vChildren.reserve(8*vLevel.size());
+      for (const Vec4ui& vBrickID : vLevel) {
+        uint32_t iNearLoD, iFarLoD;
+        if (!project(mView, mViewProjection, vBrickID, iNearLoD, iFarLoD))
+          continue;
+
+        const Decision decision = classify(vBrickID);
+        if (decision == BD_SKIP_SUBTREE) continue;
+
+        // the shader samples this brick where its LoD matches the distance
+        if (decision == BD_REQUEST &&
+            iNearLoD <= vBrickID.w && vBrickID.w <= iFarLoD) {
+          const Vec3ui& vLayout = m_vLayouts[vBrickID.w];
+          const uint32_t iBrickID = m_vLoDOffsets[vBrickID.w] + vBrickID.x +
+                                    vBrickID.y * vLayout.x +
+                                    vBrickID.z * vLayout.x * vLayout.y;
+          if (reported.insert(iBrickID).second) {
+            vResult.push_back(Prediction{vBrickID, iStep});
+            if (vResult.size() >= iMaxCount) return vResult;
+          }
+        }
+
+        // and finer LoDs for the parts that are nearer
+        if (iNearLoD < vBrickID.w) {
+          const Vec3ui& vChildLayout = m_vLayouts[vBrickID.w-1];
+          for (uint32_t z = 2*vBrickID.z;z<std::min(2*vBrickID.z+2, vChildLayout.z);++z) {
+            for (uint32_t y = 2*vBrickID.y;y<std::min(2*vBrickID.y+2, vChildLayout.y);++y) {
+              for (uint32_t x = 2*vBrickID.x;x<std::min(2*vBrickID.x+2, vChildLayout.x);++x) {
+                vChildren.push_back(Vec4ui(x, y, z, vBrickID.w-1));
+              }
+            }
+          }
+        }
+      }
+      vLevel.swap(vChildren);
+    }
+  }
+  return vResult;
+}
+
+float BrickPrefetcher::screenFootprint(const Vec4ui& vBrickID) const {
+  if (!m_bHasView) return 1.0f;
+
+  Vec3f vMin, vMax;
+  getBounds(vBrickID, vMin, vMax);
+  const Mat4f mViewProjection = m_mView * m_mProjection;
+  Vec2f vScreenMin(std::numeric_limits<float>::max(),
+                   std::numeric_limits<float>::max());
+  Vec2f vScreenMax(std::numeric_limits<float>::lowest(),
+                   std::numeric_limits<float>::lowest());
+  for (uint32_t i = 0;i<8;++i) {
+    const Vec4f vCorner((i & 1) ? vMax.x : vMin.x,
+                        (i & 2) ? vMax.y : vMin.y,
+                        (i & 4) ? vMax.z : vMin.z, 1.0f);
+    const Vec4f vClip = vCorner * mViewProjection;
+    if (vClip.w <= 0.0f) return 1.0f;
+    const Vec2f vScreen(vClip.x / vClip.w, vClip.y / vClip.w);
+    vScreenMin.x = std::min(vScreenMin.x, vScreen.x);
+    vScreenMin.y = std::min(vScreenMin.y, vScreen.y);
+    vScreenMax.x = std::max(vScreenMax.x, vScreen.x);
+    vScreenMax.y = std::max(vScreenMax.y, vScreen.y);
+  }
+  // normalized device coordinates span 2 units in x and y
+  const float fWidth = std::max(0.0f, std::min(1.0f, vScreenMax.x) -
+                                      std::max(-1.0f, vScreenMin.x));
+  const float fHeight = std::max(0.0f, std::min(1.0f, vScreenMax.y) -
+                                       std::max(-1.0f, vScreenMin.y));
+  return fWidth * fHeight / 4.0f;
+}
+
+void BrickPrefetcher::getBounds(const Vec4ui& vBrickID, Vec3f& vMin,
+                                Vec3f& vMax) const {
+  const Vec3f& vLayout = m_vFloatLayouts[vBrickID.w];
+  vMin = Vec3f(vBrickID.x / vLayout.x,
+               vBrickID.y / vLayout.y,
+               vBrickID.z / vLayout.z);
+  vMax = Vec3f(std::min(1.0f, (vBrickID.x + 1) / vLayout.x),
+               std::min(1.0f, (vBrickID.y + 1) / vLayout.y),
+               std::min(1.0f, (vBrickID.z + 1) / vLayout.z));
+}
+
+uint32_t BrickPrefetcher::getLoD(float fDistance) const {
+  const uint32_t iMaxLoD = uint32_t(m_vLayouts.size() - 1);
+  const float fLoD = std::log2(m_fLoDFactor * fDistance /
+                               m_fLevelZeroWorldSpaceError);
+  // the shader truncates to an unsigned value, i.e. negative LoDs become 0,
+  // this also covers points at or behind the eye
+  if (!(fLoD > 0.0f)) return 0;
+  if (fLoD >= float(iMaxLoD)) return iMaxLoD;
+  return uint32_t(fLoD);
+}
+
+bool BrickPrefetcher::project(const Mat4f& mModelToView,
+                              const Mat4f& mModelToClip,
+                              const Vec4ui& vBrickID,
+                              uint32_t& iNearLoD, uint32_t& iFarLoD) const {
+  Vec3f vMin, vMax;
+  getBounds(vBrickID, vMin, vMax);
+
+  // the brick is outside if all its corners are outside of the same plane
+  uint32_t iOutside[6] = {0, 0, 0, 0, 0, 0};
+  float fNear = std::numeric_limits<float>::max();
+  float fFar = std::numeric_limits<float>::lowest();
+  for (uint32_t i = 0;i<8;++i) {
+    const Vec4f vCorner((i & 1) ? vMax.x : vMin.x,
+                        (i & 2) ? vMax.y : vMin.y,
+                        (i & 4) ? vMax.z : vMin.z, 1.0f);
+    const Vec4f vClip = vCorner * mModelToClip;
+    iOutside[0] += vClip.x < -vClip.w;
+    iOutside[1] += vClip.x >  vClip.w;
+    iOutside[2] += vClip.y < -vClip.w;
+    iOutside[3] += vClip.y >  vClip.w;
+    iOutside[4] += vClip.z < -vClip.w;
+    iOutside[5] += vClip.z >  vClip.w;
+    // opengl -> negative z-axis hence the minus
+    // only the depth is needed in view space
+    const float fDepth = -(vCorner.x * mModelToView.m13 +
+                           vCorner.y * mModelToView.m23 +
+                           vCorner.z * mModelToView.m33 +
+                           mModelToView.m43);
+    fNear = std::min(fNear, fDepth);
+    fFar = std::max(fFar, fDepth);
+  }
+  for (uint32_t iPlane = 0;iPlane<6;++iPlane) {
+    if (iOutside[iPlane] == 8) return false;
+  }
+
+  iNearLoD = getLoD(fNear);
+  iFarLoD = getLoD(fFar);
+  return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <silverbullet/math/Vectors.h>
+
+// Predicts the bricks the ray caster is going to ask for next. The camera
+// motion is extrapolated from the last two views, and for every predicted
+// view the brick hierarchy is traversed from the coarsest LoD down to the
+// LoD the shader selects for the view distance (see ComputeLOD in
+// GLVolumePool), skipping all bricks outside of the view frustum.
+class BrickPrefetcher {
+public:
+  enum Decision {
+    BD_REQUEST,     // brick is wanted if the predicted views sample it
+    BD_SKIP,        // brick is not wanted but its children may be
+    BD_SKIP_SUBTREE // neither the brick nor its children are wanted
+  };
+  typedef std::function<Decision(const Core::Math::Vec4ui&)> Classifier;
+
+  struct Prediction {
+    Core::Math::Vec4ui vBrickID; // x, y, z, lod (w)
+    uint32_t iStep;              // number of views ahead, starts at 1
+  };
+
+  // @param vLayouts brick layouts of all LoDs, LoD 0 is the finest
+  // @param vFloatLayouts fractional brick layouts as used by the shader
+  BrickPrefetcher(const std::vector<Core::Math::Vec3ui>& vLayouts,
+                  const std::vector<Core::Math::Vec3f>& vFloatLayouts,
+                  uint32_t iPredictedViews = 4);
+
+  void setProjection(const Core::Math::Mat4f& mProjection, float fLoDFactor,
+                     float fLevelZeroWorldSpaceError);
+  // @param mModelToView transformation of normalized model coordinates
+  //        ([0,1]^3) into view space
+  // @param bContinuous false if the view jumped, e.g. after a reset, the
+  //        motion is not extrapolated across such a jump
+  void addView(const Core::Math::Mat4f& mModelToView, bool bContinuous);
+  bool hasMotion() const { return m_bHasMotion; }
+
+  // bricks of the predicted views, nearer views and coarser LoDs first,
+  // each brick is reported once
+  std::vector<Prediction> predict(const Classifier& classify,
+                                  size_t iMaxCount) const;
+
+  // fraction of the screen the bounding box of the brick covers in the
+  // current view, 1 if there is no view yet or the brick reaches behind the
+  // eye; used to serve the requests of large bricks first
+  float screenFootprint(const Core::Math::Vec4ui& vBrickID) const;
+
+private:
+  std::vector<Core::Math::Vec3ui> m_vLayouts;
+  std::vector<Core::Math::Vec3f>  m_vFloatLayouts;
+  std::vector<uint32_t>           m_vLoDOffsets;
+  uint32_t const                  m_iPredictedViews;
+
+  Core::Math::Mat4f m_mProjection;
+  float             m_fLoDFactor;
+  float             m_fLevelZeroWorldSpaceError;
+
+  Core::Math::Mat4f m_mLastView;
+  Core::Math::Mat4f m_mView;
+  bool              m_bHasView;
+  bool              m_bHasMotion;
+
+  uint32_t getLoD(float fDistance) const;
+  void getBounds(const Core::Math::Vec4ui& vBrickID, Core::Math::Vec3f& vMin,
+                 Core::Math::Vec3f& vMax) const;
+  // @return false if the brick lies outside of the view frustum, otherwise
+  //         the LoDs the shader selects for the nearest and farthest point
+  bool project(const Core::Math::Mat4f& mModelToView,
+               const Core::Math::Mat4f& mModelToClip,
+               const Core::Math::Vec4ui& vBrickID,
+               uint32_t& iNearLoD, uint32_t& iFarLoD) const;
+};
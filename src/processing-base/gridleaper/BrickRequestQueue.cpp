@@ -0,0 +1,226 @@
+#include "BrickRequestQueue.h"
+
+#include "mocca/log/LogManager.h"
+
+// timeout after which a blocked getter re-checks its continue predicate
+static const uint32_t popWaitMilliseconds = 100;
+
+bool BrickRequestQueue::HeapItem::operator<(const HeapItem& other) const {
+  if (bSpeculative != other.bSpeculative) return bSpeculative;
+  if (iLoD != other.iLoD) return iLoD < other.iLoD;
+  if (fImportance != other.fImportance) return fImportance < other.fImportance;
+  return iSequence > other.iSequence;
+}
+
+BrickRequestQueue::BrickRequestQueue(uint32_t iMaxRequestAge) :
+m_iMaxRequestAge(iMaxRequestAge),
+m_iRequestRound(0),
+m_iSequence(0),
+m_iQueuedCount(0),
+m_iInFlightCount(0)
+{
+}
+
+size_t BrickRequestQueue::push(const std::vector<BrickRequest>& vRequests) {
+  size_t iNewRequests = 0;
+  {
+    SCOPEDLOCK(m_Guard);
+    ++m_iRequestRound;
+
+    for (const BrickRequest& request : vRequests) {
+      auto it = m_Entries.find(request.key);
+      if (it == m_Entries.end()) {
+        Entry entry = {request, State::Queued, m_iRequestRound, 0, false};
+        Entry& inserted = m_Entries.emplace(request.key, entry).first->second;
+        pushHeapItem(inserted);
+        ++m_iQueuedCount;
+        ++iNewRequests;
+        continue;
+      }
+
+      Entry& entry = it->second;
+      entry.iLastRequestRound = m_iRequestRound;
+      switch (entry.eState) {
+        case State::Queued:
+          if (entry.request.fImportance != request.fImportance ||
+              entry.request.bSpeculative != request.bSpeculative) {
+            entry.request.fImportance = request.fImportance;
+            entry.request.bSpeculative = request.bSpeculative;
+            pushHeapItem(entry);
+          }
+          break;
+        case State::InFlight:
+          // still needed, so keep the data once it arrives
+          entry.bCanceled = false;
+          break;
+        case State::Done:
+          break;
+      }
+    }
+
+    cancelStaleRequests();
+    compactHeap();
+  }
+
+  if (iNewRequests > 0) m_RequestsAvailable.wakeAll();
+  return iNewRequests;
+}
+
+size_t BrickRequestQueue::prefetch(const std::vector<BrickRequest>& vRequests) {
+  size_t iNewRequests = 0;
+  {
+    SCOPEDLOCK(m_Guard);
+    for (const BrickRequest& request : vRequests) {
+      auto it = m_Entries.find(request.key);
+      if (it == m_Entries.end()) {
+        Entry entry = {request, State::Queued, m_iRequestRound, 0, false};
+        entry.request.bSpeculative = true;
+        Entry& inserted = m_Entries.emplace(request.key, entry).first->second;
+        pushHeapItem(inserted);
+        ++m_iQueuedCount;
+        ++iNewRequests;
+        continue;
+      }
+
+      // regular requests are never demoted
+      Entry& entry = it->second;
+      if (entry.eState == State::Queued && entry.request.bSpeculative) {
+        entry.iLastRequestRound = m_iRequestRound;
+        if (entry.request.fImportance != request.fImportance) {
+          entry.request.fImportance = request.fImportance;
+          pushHeapItem(entry);
+        }
+      }
+    }
+    compactHeap();
+  }
+
+  if (iNewRequests > 0) m_RequestsAvailable.wakeAll();
+  return iNewRequests;
+}
+
+std::vector<BrickRequest> BrickRequestQueue::pop(size_t iMaxCount,
+                                                 Predicate pContinue) {
+  std::vector<BrickRequest> vResult;
+
+  SCOPEDLOCK(m_Guard);
+  while (m_iQueuedCount == 0) {
+    if (pContinue && !pContinue()) return vResult;
+    m_RequestsAvailable.wait(m_Guard, popWaitMilliseconds);
+  }
+
+  while (!m_Heap.empty() && vResult.size() < iMaxCount) {
+    const HeapItem item = m_Heap.top();
+    m_Heap.pop();
+
+    // skip items of canceled requests and of outdated priorities
+    auto it = m_Entries.find(item.key);
+    if (it == m_Entries.end() ||
+        it->second.eState != State::Queued ||
+        it->second.iHeapSequence != item.iSequence) continue;
+
+    it->second.eState = State::InFlight;
+    --m_iQueuedCount;
+    ++m_iInFlightCount;
+    vResult.push_back(it->second.request);
+  }
+  return vResult;
+}
+
+bool BrickRequestQueue::finish(const BrickRequest& request, bool bSuccess) {
+  SCOPEDLOCK(m_Guard);
+  auto it = m_Entries.find(request.key);
+  if (it == m_Entries.end() || it->second.eState != State::InFlight) {
+    return false;
+  }
+  --m_iInFlightCount;
+
+  // failed requests are forgotten so that the next request round can retry
+  if (it->second.bCanceled || !bSuccess) {
+    m_Entries.erase(it);
+    return false;
+  }
+  it->second.eState = State::Done;
+  return true;
+}
+
+void BrickRequestQueue::release(const BrickKey& key) {
+  SCOPEDLOCK(m_Guard);
+  auto it = m_Entries.find(key);
+  if (it != m_Entries.end() && it->second.eState == State::Done) {
+    m_Entries.erase(it);
+  }
+}
+
+void BrickRequestQueue::cancelAll() {
+  SCOPEDLOCK(m_Guard);
+  for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+    if (it->second.eState == State::Queued) {
+      it = m_Entries.erase(it);
+    } else {
+      if (it->second.eState == State::InFlight) it->second.bCanceled = true;
+      ++it;
+    }
+  }
+  m_iQueuedCount = 0;
+  m_Heap = std::priority_queue<HeapItem>();
+}
+
+void BrickRequestQueue::wakeAll() {
+  m_RequestsAvailable.wakeAll();
+}
+
+size_t BrickRequestQueue::getQueuedCount() const {
+  SCOPEDLOCK(m_Guard);
+  return m_iQueuedCount;
+}
+
+size_t BrickRequestQueue::getInFlightCount() const {
+  SCOPEDLOCK(m_Guard);
+  return m_iInFlightCount;
+}
+
+void BrickRequestQueue::pushHeapItem(Entry& entry) {
+  entry.iHeapSequence = m_iSequence++;
+  HeapItem item = {entry.request.bSpeculative, entry.request.ID.w,
+                   entry.request.fImportance, entry.iHeapSequence,
+                   entry.request.key};
+  m_Heap.push(item);
+}
+
+void BrickRequestQueue::cancelStaleRequests() {
+  size_t iCanceled = 0;
+  for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+    Entry& entry = it->second;
+    if (entry.eState != State::Done &&
+        m_iRequestRound - entry.iLastRequestRound > m_iMaxRequestAge) {
+      ++iCanceled;
+      if (entry.eState == State::Queued) {
+        --m_iQueuedCount;
+        it = m_Entries.erase(it);
+        continue;
+      }
+      entry.bCanceled = true;
+    }
+    ++it;
+  }
+  if (iCanceled > 0) LDEBUGC("GLVolumePool", iCanceled << " stale brick requests canceled");
+}
+
+void BrickRequestQueue::compactHeap() {
+  // the heap contains outdated items of canceled or re-prioritized requests,
+  // rebuild it from the valid items once these dominate
+  if (m_Heap.size() < 1024 || m_Heap.size() < 4 * m_iQueuedCount) return;
+
+  std::priority_queue<HeapItem> compacted;
+  while (!m_Heap.empty()) {
+    const HeapItem& item = m_Heap.top();
+    auto it = m_Entries.find(item.key);
+    if (it != m_Entries.end() && it->second.eState == State::Queued &&
+        it->second.iHeapSequence == item.iSequence) {
+      compacted.push(item);
+    }
+    m_Heap.pop();
+  }
+  std::swap(m_Heap, compacted);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "Threads.h"
+
+#include <silverbullet/dataio/base/Brick.h>
+#include <silverbullet/math/Vectors.h>
+
+struct BrickRequest {
+  Core::Math::Vec4ui ID;  // x, y, z, lod (w)
+  BrickKey key;
+  float fImportance;      // screen footprint, more important requests of the same LoD are served first
+  bool bSpeculative;      // prefetched for a predicted view, served after all other requests
+  bool operator==(const BrickRequest& other) const {
+    return ID == other.ID && key == other.key;
+  }
+};
+
+// Thread safe priority queue that feeds the brick getter threads of the
+// GLVolumePool. Coarse LoDs are served first as they are the fallback for
+// all finer levels, within a LoD requests are ordered by importance;
+// speculative requests only get served when no other request is queued. Every
+// brick is tracked in a hash map from request until its data is released
+// again, so duplicate requests are rejected in O(1).
+class BrickRequestQueue {
+public:
+  BrickRequestQueue(uint32_t iMaxRequestAge = 3);
+
+  // starts a new request round and enqueues the given requests; requests
+  // that are known already only get their importance and age refreshed,
+  // queued requests that have not been repeated for more than iMaxRequestAge
+  // rounds are canceled
+  // @return number of new requests
+  size_t push(const std::vector<BrickRequest>& vRequests);
+
+  // enqueues speculative requests without starting a new request round,
+  // they age like the requests of the current round; a speculative request
+  // becomes a regular one once it is pushed by a later round
+  // @return number of new requests
+  size_t prefetch(const std::vector<BrickRequest>& vRequests);
+
+  // blocks until requests are available (or pContinue fails) and returns up
+  // to iMaxCount requests in priority order, the requests are flagged as
+  // in flight until finish is called
+  std::vector<BrickRequest> pop(size_t iMaxCount, Predicate pContinue);
+
+  // to be called by the getter when the data for an in flight request has
+  // arrived (or failed to arrive)
+  // @return false if the request has been canceled in the meantime and
+  //         the data should be discarded
+  bool finish(const BrickRequest& request, bool bSuccess);
+
+  // to be called once the data of a finished request has been consumed,
+  // from then on the brick can be requested again
+  void release(const BrickKey& key);
+
+  // removes all queued requests and flags in flight requests as canceled
+  void cancelAll();
+
+  // wakes up all threads blocked in pop, e.g. to let them check pContinue
+  void wakeAll();
+
+  size_t getQueuedCount() const;
+  size_t getInFlightCount() const;
+
+private:
+  enum class State { Queued, InFlight, Done };
+
+  struct Entry {
+    BrickRequest request;
+    State        eState;
+    uint64_t     iLastRequestRound;
+    uint64_t     iHeapSequence;  // only the heap item with this sequence is valid
+    bool         bCanceled;
+  };
+
+  struct HeapItem {
+    bool     bSpeculative;
+    uint32_t iLoD;
+    float    fImportance;
+    uint64_t iSequence;     // FIFO order among requests of equal priority
+    BrickKey key;
+    bool operator<(const HeapItem& other) const;
+  };
+
+  void pushHeapItem(Entry& entry);
+  void cancelStaleRequests();
+  void compactHeap();
+
+  mutable CriticalSection m_Guard;
+  WaitCondition           m_RequestsAvailable;
+  std::priority_queue<HeapItem> m_Heap;
+  std::unordered_map<BrickKey, Entry, BKeyHash> m_Entries;
+  uint32_t const m_iMaxRequestAge;
+  uint64_t m_iRequestRound;
+  uint64_t m_iSequence;
+  size_t   m_iQueuedCount;
+  size_t   m_iInFlightCount;
+};
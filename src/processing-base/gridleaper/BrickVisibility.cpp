@@ -0,0 +1,294 @@
+#include "BrickVisibility.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "common/ParallelFor.h"
+
+using namespace Core::Math;
+using namespace trinity;
+
+namespace {
+  // passes over fewer bricks than this per thread are not worth a thread
+  const size_t minBricksPerThread = 16384;
+
+  Vec3ui toPosition(uint32_t iIndexInLoD, const Vec3ui& layout) {
+    return Vec3ui(iIndexInLoD % layout.x,
+                  (iIndexInLoD / layout.x) % layout.y,
+                  iIndexInLoD / (layout.x * layout.y));
+  }
+}
+
+BrickVisibility::BrickVisibility(const std::vector<Vec3ui>& vLayouts) :
+m_vLayouts(vLayouts),
+m_iTotalBrickCount(0),
+m_vCounts(0, 0, 0, 0),
+m_bValid(false)
+{
+  m_vLoDOffsetTable.resize(m_vLayouts.size());
+  for (size_t i = 0; i < m_vLayouts.size(); ++i) {
+    m_vLoDOffsetTable[i] = m_iTotalBrickCount;
+    m_iTotalBrickCount += m_vLayouts[i].volume();
+  }
+  m_vContainsData.resize(m_iTotalBrickCount, 1);
+  m_vClass.resize(m_iTotalBrickCount, BC_VISIBLE);
+  m_vDirty.resize(m_iTotalBrickCount, 0);
+  m_vDirtyBricks.resize(m_vLayouts.size());
+}
+
+void BrickVisibility::setMetaData(const std::vector<BrickMetaData>& vMetaData) {
+  assert(vMetaData.size() >= m_iTotalBrickCount);
+  m_vMetaData = vMetaData;
+
+  auto sortBy = [this](std::vector<uint32_t>& vSorted, double BrickMetaData::* bound) {
+    vSorted.resize(m_iTotalBrickCount);
+    for (uint32_t i = 0; i < m_iTotalBrickCount; ++i) {
+      vSorted[i] = i;
+    }
+    std::sort(vSorted.begin(), vSorted.end(), [this, bound](uint32_t a, uint32_t b) {
+      return m_vMetaData[a].*bound < m_vMetaData[b].*bound;
+    });
+  };
+  sortBy(m_vByMinScalar, &BrickMetaData::minScalar);
+  sortBy(m_vByMaxScalar, &BrickMetaData::maxScalar);
+  sortBy(m_vByMinGradient, &BrickMetaData::minGradient);
+  sortBy(m_vByMaxGradient, &BrickMetaData::maxGradient);
+
+  m_bValid = false;
+}
+
+bool BrickVisibility::update(const VisibilityState& visibility) {
+  const bool bFullUpdate = !m_bValid ||
+    visibility.getRenderMode() != m_lastVisibility.getRenderMode();
+  if (bFullUpdate) {
+    updateAll(visibility);
+  } else {
+    updateChanged(visibility);
+  }
+  m_lastVisibility = visibility;
+  m_bValid = true;
+  return bFullUpdate;
+}
+
+void BrickVisibility::collectCandidates(const VisibilityState& from,
+                                        const VisibilityState& to,
+                                        std::vector<uint32_t>& vCandidates) const {
+  assert(from.getRenderMode() == to.getRenderMode());
+  // a "bound <= limit" test flips for bounds in (old, new], a
+  // "bound >= limit" test for bounds in [old, new)
+  switch (to.getRenderMode()) {
+    case IRenderer::ERenderMode::RM_1DTRANS:
+      collectBoundCandidates(m_vByMinScalar, &BrickMetaData::minScalar,
+                             from.get1DTransfer().fMax, to.get1DTransfer().fMax,
+                             true, vCandidates);
+      collectBoundCandidates(m_vByMaxScalar, &BrickMetaData::maxScalar,
+                             from.get1DTransfer().fMin, to.get1DTransfer().fMin,
+                             false, vCandidates);
+      break;
+    case IRenderer::ERenderMode::RM_2DTRANS:
+      collectBoundCandidates(m_vByMinScalar, &BrickMetaData::minScalar,
+                             from.get2DTransfer().fMax, to.get2DTransfer().fMax,
+                             true, vCandidates);
+      collectBoundCandidates(m_vByMaxScalar, &BrickMetaData::maxScalar,
+                             from.get2DTransfer().fMin, to.get2DTransfer().fMin,
+                             false, vCandidates);
+      collectBoundCandidates(m_vByMinGradient, &BrickMetaData::minGradient,
+                             from.get2DTransfer().fMaxGradient, to.get2DTransfer().fMaxGradient,
+                             true, vCandidates);
+      collectBoundCandidates(m_vByMaxGradient, &BrickMetaData::maxGradient,
+                             from.get2DTransfer().fMinGradient, to.get2DTransfer().fMinGradient,
+                             false, vCandidates);
+      break;
+    case IRenderer::ERenderMode::RM_ISOSURFACE:
+      collectBoundCandidates(m_vByMaxScalar, &BrickMetaData::maxScalar,
+                             from.getIsoSurface().fIsoValue, to.getIsoSurface().fIsoValue,
+                             false, vCandidates);
+      break;
+    case IRenderer::ERenderMode::RM_CLEARVIEW:
+      // both iso values have to be reached, i.e. the larger one
+      collectBoundCandidates(m_vByMaxScalar, &BrickMetaData::maxScalar,
+                             std::max(from.getIsoSurfaceCV().fIsoValue1,
+                                      from.getIsoSurfaceCV().fIsoValue2),
+                             std::max(to.getIsoSurfaceCV().fIsoValue1,
+                                      to.getIsoSurfaceCV().fIsoValue2),
+                             false, vCandidates);
+      break;
+    default:
+      break;
+  }
+}
+
+bool BrickVisibility::containsData(const BrickMetaData& metaData,
+                                   const VisibilityState& visibility) {
+  switch (visibility.getRenderMode()) {
+    case IRenderer::ERenderMode::RM_1DTRANS:
+      return visibility.get1DTransfer().fMax >= metaData.minScalar &&
+             visibility.get1DTransfer().fMin <= metaData.maxScalar;
+    case IRenderer::ERenderMode::RM_2DTRANS:
+      return visibility.get2DTransfer().fMax >= metaData.minScalar &&
+             visibility.get2DTransfer().fMin <= metaData.maxScalar &&
+             visibility.get2DTransfer().fMaxGradient >= metaData.minGradient &&
+             visibility.get2DTransfer().fMinGradient <= metaData.maxGradient;
+    case IRenderer::ERenderMode::RM_ISOSURFACE:
+      return visibility.getIsoSurface().fIsoValue <= metaData.maxScalar;
+    case IRenderer::ERenderMode::RM_CLEARVIEW:
+      return visibility.getIsoSurfaceCV().fIsoValue1 <= metaData.maxScalar &&
+             visibility.getIsoSurfaceCV().fIsoValue2 <= metaData.maxScalar;
+    default:
+      return true;
+  }
+}
+
+uint32_t BrickVisibility::getLoD(uint32_t iBrickID) const {
+  return uint32_t(std::upper_bound(m_vLoDOffsetTable.begin(), m_vLoDOffsetTable.end(), iBrickID) -
+                  m_vLoDOffsetTable.begin()) - 1;
+}
+
+uint32_t BrickVisibility::getParentID(uint32_t iBrickID) const {
+  const uint32_t iLoD = getLoD(iBrickID);
+  if (iLoD + 1 >= m_vLayouts.size()) return m_iTotalBrickCount;
+  const Vec3ui parent = toPosition(iBrickID - m_vLoDOffsetTable[iLoD], m_vLayouts[iLoD]) / 2;
+  const Vec3ui& parentLayout = m_vLayouts[iLoD + 1];
+  return m_vLoDOffsetTable[iLoD + 1] + parent.x + parent.y * parentLayout.x +
+         parent.z * parentLayout.x * parentLayout.y;
+}
+
+uint8_t BrickVisibility::classify(uint32_t iBrickID, uint32_t iLoD) const {
+  if (m_vContainsData[iBrickID]) return BC_VISIBLE;
+  if (iLoD == 0) return BC_CHILD_EMPTY; // finest level bricks are all child empty by definition
+
+  // the children of (x, y, z) are (2x..2x+1, 2y..2y+1, 2z..2z+1) clipped
+  // to the layout of the finer level
+  const Vec3ui position = toPosition(iBrickID - m_vLoDOffsetTable[iLoD], m_vLayouts[iLoD]);
+  const Vec3ui& childLayout = m_vLayouts[iLoD - 1];
+  const Vec3ui first = position * 2;
+  const Vec3ui last(std::min(first.x + 1, childLayout.x - 1),
+                    std::min(first.y + 1, childLayout.y - 1),
+                    std::min(first.z + 1, childLayout.z - 1));
+  const uint32_t iChildOffset = m_vLoDOffsetTable[iLoD - 1];
+  for (uint32_t z = first.z; z <= last.z; ++z) {
+    for (uint32_t y = first.y; y <= last.y; ++y) {
+      for (uint32_t x = first.x; x <= last.x; ++x) {
+        const uint32_t iChildID = iChildOffset + x + y * childLayout.x + z * childLayout.x * childLayout.y;
+        if (m_vClass[iChildID] != BC_CHILD_EMPTY) return BC_EMPTY;
+      }
+    }
+  }
+  return BC_CHILD_EMPTY;
+}
+
+void BrickVisibility::countBrick(uint32_t iLoD, uint8_t brickClass, int32_t iSign) {
+  if (iLoD == 0) {
+    if (brickClass != BC_VISIBLE) m_vCounts.w += iSign;
+  } else if (brickClass == BC_EMPTY) {
+    m_vCounts.y += iSign;
+  } else if (brickClass == BC_CHILD_EMPTY) {
+    m_vCounts.z += iSign;
+  }
+}
+
+void BrickVisibility::updateAll(const VisibilityState& visibility) {
+  assert(m_vMetaData.size() >= m_iTotalBrickCount);
+  m_vChangedBricks.clear();
+
+  parallelForRanges(m_iTotalBrickCount, minBricksPerThread, [&](uint64_t iBegin, uint64_t iEnd) {
+    for (size_t i = iBegin; i < iEnd; ++i) {
+      m_vContainsData[i] = containsData(m_vMetaData[i], visibility) ? 1 : 0;
+    }
+  });
+
+  // finest to coarsest level, the bricks of a level only depend on the
+  // level below and are classified in parallel
+  m_vCounts = Vec4ui(m_iTotalBrickCount, 0, 0, 0);
+  for (uint32_t iLoD = 0; iLoD < m_vLayouts.size(); ++iLoD) {
+    const uint32_t iOffset = m_vLoDOffsetTable[iLoD];
+    parallelForRanges(m_vLayouts[iLoD].volume(), minBricksPerThread, [&](uint64_t iBegin, uint64_t iEnd) {
+      for (size_t i = iBegin; i < iEnd; ++i) {
+        m_vClass[iOffset + i] = classify(uint32_t(iOffset + i), iLoD);
+      }
+    });
+    for (uint32_t i = 0; i < m_vLayouts[iLoD].volume(); ++i) {
+      countBrick(iLoD, m_vClass[iOffset + i], 1);
+    }
+  }
+}
+
+void BrickVisibility::updateChanged(const VisibilityState& visibility) {
+  m_vChangedBricks.clear();
+
+  std::vector<uint32_t> vCandidates;
+  collectCandidates(m_lastVisibility, visibility, vCandidates);
+
+  // a brick may be a candidate of several bounds, it is only marked once
+  std::vector<uint8_t> vContainsData(vCandidates.size());
+  parallelForRanges(vCandidates.size(), minBricksPerThread, [&](uint64_t iBegin, uint64_t iEnd) {
+    for (size_t i = iBegin; i < iEnd; ++i) {
+      vContainsData[i] = containsData(m_vMetaData[vCandidates[i]], visibility) ? 1 : 0;
+    }
+  });
+  for (size_t i = 0; i < vCandidates.size(); ++i) {
+    const uint32_t iBrickID = vCandidates[i];
+    if (vContainsData[i] != m_vContainsData[iBrickID]) {
+      m_vContainsData[iBrickID] = vContainsData[i];
+      markDirty(iBrickID, getLoD(iBrickID));
+    }
+  }
+
+  // re-classify the dirty bricks from finest to coarsest level, a brick
+  // whose class flipped makes its parent dirty
+  std::vector<uint8_t> vClasses;
+  for (uint32_t iLoD = 0; iLoD < m_vLayouts.size(); ++iLoD) {
+    std::vector<uint32_t>& vDirty = m_vDirtyBricks[iLoD];
+    if (vDirty.empty()) continue;
+
+    vClasses.resize(vDirty.size());
+    parallelForRanges(vDirty.size(), minBricksPerThread, [&](uint64_t iBegin, uint64_t iEnd) {
+      for (size_t i = iBegin; i < iEnd; ++i) {
+        vClasses[i] = classify(vDirty[i], iLoD);
+      }
+    });
+
+    for (size_t i = 0; i < vDirty.size(); ++i) {
+      const uint32_t iBrickID = vDirty[i];
+      m_vDirty[iBrickID] = 0;
+      if (vClasses[i] == m_vClass[iBrickID]) continue;
+
+      countBrick(iLoD, m_vClass[iBrickID], -1);
+      countBrick(iLoD, vClasses[i], 1);
+      m_vClass[iBrickID] = vClasses[i];
+      m_vChangedBricks.push_back(iBrickID);
+
+      if (iLoD + 1 < m_vLayouts.size()) {
+        markDirty(getParentID(iBrickID), iLoD + 1);
+      }
+    }
+    vDirty.clear();
+  }
+}
+
+void BrickVisibility::collectBoundCandidates(const std::vector<uint32_t>& vSorted,
+                                             double BrickMetaData::* bound,
+                                             double fOld, double fNew, bool bUpperBound,
+                                             std::vector<uint32_t>& vCandidates) const {
+  if (fOld == fNew) return;
+  const double fLow = std::min(fOld, fNew);
+  const double fHigh = std::max(fOld, fNew);
+
+  auto find = [&](double fValue) {
+    if (bUpperBound) {
+      return std::upper_bound(vSorted.begin(), vSorted.end(), fValue, [&](double v, uint32_t id) {
+        return v < m_vMetaData[id].*bound;
+      });
+    }
+    return std::lower_bound(vSorted.begin(), vSorted.end(), fValue, [&](uint32_t id, double v) {
+      return m_vMetaData[id].*bound < v;
+    });
+  };
+  vCandidates.insert(vCandidates.end(), find(fLow), find(fHigh));
+}
+
+void BrickVisibility::markDirty(uint32_t iBrickID, uint32_t iLoD) {
+  if (m_vDirty[iBrickID]) return;
+  m_vDirty[iBrickID] = 1;
+  m_vDirtyBricks[iLoD].push_back(iBrickID);
+}
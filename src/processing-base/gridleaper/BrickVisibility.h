@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <commands/BrickMetaData.h>
+#include <silverbullet/math/Vectors.h>
+
+#include "VisibilityState.h"
+
+// Classifies all bricks of the LoD hierarchy for a visibility state. A
+// brick is visible if its value range intersects the transfer function (or
+// reaches the iso value), an invisible brick is child empty if all bricks
+// below it are invisible too and empty otherwise.
+//
+// The bricks are kept sorted by the bounds of their value ranges, so a
+// transfer function or iso value change only re-tests the bricks whose
+// bounds lie between the old and the new limits. Only the ancestors of
+// bricks whose class flipped are re-classified afterwards, level by level.
+class BrickVisibility {
+public:
+  enum BrickClass {
+    BC_VISIBLE = 0,
+    BC_EMPTY,
+    BC_CHILD_EMPTY
+  };
+
+  // vLayouts holds the brick counts of all LoDs, level 0 is finest, brick
+  // IDs are serialized level by level as in the GLVolumePool
+  BrickVisibility(const std::vector<Core::Math::Vec3ui>& vLayouts);
+
+  // replaces the brick metadata (indexed by brick ID), the next update
+  // classifies all bricks again
+  void setMetaData(const std::vector<trinity::BrickMetaData>& vMetaData);
+
+  // brings the classification up to date with the given state, afterwards
+  // getChangedBricks() holds the bricks whose class changed
+  // @return true if all bricks were classified again, the changed bricks
+  //         are not recorded in this case
+  bool update(const VisibilityState& visibility);
+
+  // appends the bricks whose own visibility may differ between the two
+  // states of the same render mode, bricks may be appended more than once;
+  // only reads the metadata, so it may run concurrently with update()
+  void collectCandidates(const VisibilityState& from, const VisibilityState& to,
+                         std::vector<uint32_t>& vCandidates) const;
+
+  // @return ID of the brick one LoD coarser that covers iBrickID, or the
+  //         total brick count for the coarsest LoD
+  uint32_t getParentID(uint32_t iBrickID) const;
+
+  bool containsData(uint32_t iBrickID) const { return m_vContainsData[iBrickID] != 0; }
+  BrickClass getClass(uint32_t iBrickID) const { return BrickClass(m_vClass[iBrickID]); }
+  const std::vector<uint32_t>& getChangedBricks() const { return m_vChangedBricks; }
+  uint32_t getTotalBrickCount() const { return m_iTotalBrickCount; }
+
+  // @return (totalBrickCount, emptyBrickCount, childEmptyBrickCount, emptyLeafBrickCount)
+  //         where the empty and child empty counts only include inner bricks
+  Core::Math::Vec4ui getCounts() const { return m_vCounts; }
+
+  static bool containsData(const trinity::BrickMetaData& metaData,
+                           const VisibilityState& visibility);
+
+private:
+  std::vector<Core::Math::Vec3ui> m_vLayouts;
+  std::vector<uint32_t> m_vLoDOffsetTable;
+  uint32_t m_iTotalBrickCount;
+
+  std::vector<trinity::BrickMetaData> m_vMetaData;
+  // brick IDs sorted by the respective metadata bound
+  std::vector<uint32_t> m_vByMinScalar;
+  std::vector<uint32_t> m_vByMaxScalar;
+  std::vector<uint32_t> m_vByMinGradient;
+  std::vector<uint32_t> m_vByMaxGradient;
+
+  std::vector<uint8_t> m_vContainsData;
+  std::vector<uint8_t> m_vClass;
+  std::vector<uint8_t> m_vDirty;
+  std::vector<std::vector<uint32_t>> m_vDirtyBricks; // per LoD
+  std::vector<uint32_t> m_vChangedBricks;
+  Core::Math::Vec4ui m_vCounts;
+
+  VisibilityState m_lastVisibility;
+  bool m_bValid;
+
+  uint32_t getLoD(uint32_t iBrickID) const;
+  uint8_t classify(uint32_t iBrickID, uint32_t iLoD) const;
+  void countBrick(uint32_t iLoD, uint8_t brickClass, int32_t iSign);
+
+  void updateAll(const VisibilityState& visibility);
+  void updateChanged(const VisibilityState& visibility);
+
+  void collectBoundCandidates(const std::vector<uint32_t>& vSorted,
+                              double trinity::BrickMetaData::* bound,
+                              double fOld, double fNew, bool bUpperBound,
+                              std::vector<uint32_t>& vCandidates) const;
+  void markDirty(uint32_t iBrickID, uint32_t iLoD);
+};
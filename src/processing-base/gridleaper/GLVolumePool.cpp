@@ -21,6 +21,7 @@
 #include "VisibilityState.h"
 #include <opengl-base/GLProgram.h>
 #include "GLVolumePool.h"
+#include "BrickVisibility.h"
 #include <silverbullet/math/MinMaxBlock.h>
 
 enum BrickIDFlags {
@@ -36,6 +37,20 @@ using namespace Core::Time;
 using namespace trinity;
 
 const uint32_t asyncGetThreadWaitSecs = 5;
+// number of bricks a getter thread hands to a single IIO::getBricks call,
+// the IO proxy splits these into several batches that are in flight concurrently
+const size_t brickGetterBatchSize = 32;
+// at most this fraction of the pool is requested for predicted views, so the
+// prefetched bricks cannot push the bricks of the current view out
+const size_t prefetchPoolFraction = 8;
+// more changed bricks than this are uploaded as a whole metadata texture
+// after a visibility update instead of texel by texel
+const size_t maxMetadataTexelUpdates = 256;
+// visibility updates that test more bricks than this are computed by the
+// background updater while rendering goes on with conservative metadata
+const size_t asyncVisibilityThreshold = 32768;
+// timeout after which the idle updater re-checks its continue predicate
+const uint32_t asyncVisibilityWaitMilliseconds = 100;
 
 static Vec3ui GetLoDSize(const Vec3ui& volumeSize, uint32_t iLoD) {
   Vec3ui vLoDSize(uint32_t(ceil(double(volumeSize.x)/MathTools::pow2(iLoD))),
@@ -96,7 +111,9 @@ GLVolumePool::GLVolumePool(uint64_t GPUMemorySizeInByte,
                            uint64_t modality,
                            GLenum filter,
                            bool bUseGLCore,
-                           DebugMode dm)
+                           DebugMode dm,
+                           uint32_t iGetterThreadCount,
+                           PoolSlotReplacement::Policy eReplacementPolicy)
 : m_dataset(pDataset)
 , m_pPoolMetadataTexture(NULL),
 m_pPoolDataTexture(NULL),
@@ -111,12 +128,15 @@ m_iTimeOfCreation(2),
 m_iMetaTextureUnit(0),
 m_iDataTextureUnit(1),
 m_bUseGLCore(bUseGLCore),
-m_iInsertPos(0),
 m_bVisibilityUpdated(false)
+, m_bMetaDataChanged(true)
 , m_currentTimestep(0)
 , m_currentModality(0)
 , m_eDebugMode(dm)
-, m_brickGetterThread(nullptr)
+, m_bUpdaterRequested(false)
+, m_bUpdaterBusy(false)
+, m_bUpdaterDone(false)
+, m_bUpdaterFull(false)
 {
   trinity::IIO::ValueType type = m_dataset.getType(m_currentModality);
   
@@ -237,10 +257,24 @@ m_bVisibilityUpdated(false)
     m_vLoDOffsetTable[i] = iOffset;
     iOffset += GetBrickLayout(m_volumeSize, m_maxInnerBrickSize, i).volume();
   }
+  std::vector<Vec3ui> vLayouts(m_iLoDCount);
+  for (uint32_t i = 0;i<vLayouts.size();++i) {
+    vLayouts[i] = GetBrickLayout(m_volumeSize, m_maxInnerBrickSize, i);
+  }
+  m_pVisibility = mocca::make_unique<BrickVisibility>(vLayouts);
+  std::vector<Vec3f> vFloatLayouts(m_iLoDCount);
+  for (uint32_t i = 0;i<vFloatLayouts.size();++i) {
+    vFloatLayouts[i] = GetFloatBrickLayout(m_volumeSize, m_maxInnerBrickSize, i);
+  }
+  m_pPrefetcher = mocca::make_unique<BrickPrefetcher>(vLayouts, vFloatLayouts);
   
   createGLResources();
   if (!isValid()) return;
   
+  m_pSlotReplacement = PoolSlotReplacement::create(eReplacementPolicy,
+                                                   uint32_t(m_vPoolSlotData.size()),
+                                                   m_iTotalBrickCount);
+  
   // duplicate LoD size for efficient access
   m_LoDInfoCache.resize(m_dataset.getModalityCount());
   for (uint32_t modality = 0; modality < m_LoDInfoCache.size(); modality++) {
@@ -255,19 +289,18 @@ m_bVisibilityUpdated(false)
   LINFO("receiving brick metadata");
   m_brickMetadataCache =  m_dataset.getBrickMetaData(m_currentModality,
                                                       m_currentTimestep);
+  m_pVisibility->setMetaData(m_brickMetadataCache);
   
   LINFO("metadata transfer complete");
 
   switch (m_eDebugMode) {
     default:
     case DM_NONE:
-    {
-      // we can process 7500 bricks/ms (1500 running debug build)
-      uint32_t const iAsyncUpdaterThreshold = 7500 * 5;
-    }
-      break;
+      // small hierarchies never need the async updater, otherwise fall through
+      if (m_iTotalBrickCount <= asyncVisibilityThreshold) break;
     case DM_BUSY:
-      
+      m_pVisibilityUpdater = mocca::make_unique<LambdaThread>(std::bind(&GLVolumePool::visibilityUpdaterFunc, this, std::placeholders::_1, std::placeholders::_2));
+      m_pVisibilityUpdater->startThread();
       break;
     case DM_SYNC:
       // if we want to disable the async updater we just don't instantiate it
@@ -277,8 +310,12 @@ m_bVisibilityUpdated(false)
       //WARNING("Visibility computation is DISABLED, disabling empty space leaping.");
       break;
   }
-  m_brickGetterThread = mocca::make_unique<LambdaThread>(std::bind(&GLVolumePool::brickGetterFunc, this, std::placeholders::_1, std::placeholders::_2));
-  m_brickGetterThread->startThread();
+  // several getters let decompression and remote fetches of different
+  // batches overlap, the request queue hands out the most important bricks first
+  for (uint32_t i = 0; i < std::max(iGetterThreadCount, 1u); ++i) {
+    m_brickGetterThreads.push_back(mocca::make_unique<LambdaThread>(std::bind(&GLVolumePool::brickGetterFunc, this, std::placeholders::_1, std::placeholders::_2)));
+    m_brickGetterThreads.back()->startThread();
+  }
   
 }
 
@@ -675,6 +712,7 @@ void GLVolumePool::uploadBrick(uint32_t iBrickID, const Vec3ui& vVoxelSize, cons
   
   slot.m_iBrickID = iBrickID;
   slot.m_iTimeOfCreation = iTimeOfCreation;
+  m_pSlotReplacement->insert(uint32_t(iInsertPos), iBrickID);
   
   uint32_t iPoolCoordinate = slot.positionInPool().x +
   slot.positionInPool().y * m_vPoolCapacity.x +
@@ -717,18 +755,21 @@ void GLVolumePool::uploadFirstBrick(const BrickKey& bkey) {
 
 void GLVolumePool::uploadFirstBrick(const Vec3ui& m_vVoxelSize, const void* pData) {
   uint32_t iLastBrickIndex = *(m_vLoDOffsetTable.end()-1);
-  uploadBrick(iLastBrickIndex, m_vVoxelSize, pData, m_vPoolSlotData.size()-1, (std::numeric_limits<uint64_t>::max)());
+  size_t const iLastSlot = m_vPoolSlotData.size()-1;
+  uploadBrick(iLastBrickIndex, m_vVoxelSize, pData, iLastSlot, (std::numeric_limits<uint64_t>::max)());
+  // the single low-res brick is the fallback for everything, never evict it
+  m_pSlotReplacement->pin(uint32_t(iLastSlot));
 }
 
 bool GLVolumePool::uploadBrick(const BrickElemInfo& metaData, const void* pData) {
   // in this frame we already replaced all bricks (except the single low-res brick)
   // in the pool so now we should render them first
-  if (m_iInsertPos >= m_vPoolSlotData.size()-1)
+  uint32_t const iSlot = m_pSlotReplacement->nextSlot();
+  if (iSlot == m_pSlotReplacement->getSlotCount())
     return false;
   
   int32_t iBrickID = getIntegerBrickID(metaData.m_vBrickID);
-  uploadBrick(iBrickID, metaData.m_vVoxelSize, pData, m_iInsertPos, m_iTimeOfCreation++);
-  m_iInsertPos++;
+  uploadBrick(iBrickID, metaData.m_vVoxelSize, pData, iSlot, m_iTimeOfCreation++);
   return true;
 }
 
@@ -754,14 +795,23 @@ void GLVolumePool::disable() const {
 }
 
 GLVolumePool::~GLVolumePool() {
-  if (m_brickGetterThread) {
-    m_brickGetterThread->requestThreadStop();
+  if (m_pVisibilityUpdater) {
+    m_pVisibilityUpdater->requestThreadStop();
+    m_visibilityRequested.wakeAll();
+    m_pVisibilityUpdater->joinThread();
+  }
+  for (auto& getterThread : m_brickGetterThreads) {
+    getterThread->requestThreadStop();
+  }
+  m_requestQueue.cancelAll();
+  m_requestQueue.wakeAll();
+  for (auto& getterThread : m_brickGetterThreads) {
     // TODO: this should be larget than the network timeout
     //       replace th 30 secs by that timeout + x
-    m_brickGetterThread->joinThread(30*1000);
-    if (m_brickGetterThread->isRunning()) {
+    getterThread->joinThread(30*1000);
+    if (getterThread->isRunning()) {
       LWARNING("brickGetterThread join has timed out, killing thread.");
-      m_brickGetterThread->killThread();
+      getterThread->killThread();
     }
   }
   
@@ -897,12 +947,6 @@ void GLVolumePool::createGLResources() {
   
 }
 
-struct {
-  bool operator() (const PoolSlotData& i, const PoolSlotData& j) const {
-    return (i.m_iTimeOfCreation < j.m_iTimeOfCreation);
-  }
-} PoolSorter;
-
 void GLVolumePool::uploadMetadataTexture() {
   //StackTimer poolmd(PERF_POOL_UPLOAD_METADATA);
   // DEBUG code
@@ -943,9 +987,8 @@ void GLVolumePool::uploadMetadataTexel(uint32_t iBrickID) {
 }
 
 void GLVolumePool::prepareForPaging() {
-  //StackTimer ppage(PERF_POOL_SORT);
-  std::sort(m_vPoolSlotData.begin(), m_vPoolSlotData.end(), PoolSorter);
-  m_iInsertPos = 0;
+  // slots are handed out one by one by the replacement policy
+  m_pSlotReplacement->beginRound();
 }
 
 template<IRenderer::ERenderMode eRenderMode>
@@ -978,344 +1021,42 @@ bool GLVolumePool::ContainsData(const VisibilityState& visibility, uint32_t iBri
   return true;
 }
 
-template<IRenderer::ERenderMode eRenderMode>
-void GLVolumePool::RecomputeVisibilityForBrickPool(const VisibilityState& visibility)
+static uint32_t StatusFromClass(BrickVisibility::BrickClass brickClass) {
+  switch (brickClass) {
+    case BrickVisibility::BC_EMPTY:       return BI_EMPTY;
+    case BrickVisibility::BC_CHILD_EMPTY: return BI_CHILD_EMPTY;
+    default:                              return BI_MISSING;
+  }
+}
+
+void GLVolumePool::RecomputeVisibilityForBrickPool()
 {
-  assert(eRenderMode == visibility.getRenderMode());
   for (auto slot = m_vPoolSlotData.begin(); slot < m_vPoolSlotData.end(); slot++) {
     if (slot->wasEverUsed()) {
-      bool const bContainsData = ContainsData<eRenderMode>(visibility, slot->m_iBrickID);
+      uint32_t const iSlot = uint32_t(slot - m_vPoolSlotData.begin());
+      bool const bContainsData = m_pVisibility->containsData(slot->m_iBrickID);
       bool const bContainedData = slot->containsVisibleBrick();
       if (bContainsData) {
-        if (!bContainedData)
+        if (!bContainedData) {
           slot->restore();
+          m_pSlotReplacement->restore(iSlot);
+        }
         uint32_t const iPoolCoordinate = slot->positionInPool().x +
         slot->positionInPool().y * m_vPoolCapacity.x +
         slot->positionInPool().z * m_vPoolCapacity.x * m_vPoolCapacity.y;
         m_brickStatus[slot->m_iBrickID] = iPoolCoordinate + BI_FLAG_COUNT;
       } else {
-        if (bContainedData)
+        if (bContainedData) {
           slot->flagEmpty();
-        m_brickStatus[slot->m_iBrickID] = BI_EMPTY; //! \todo remove again
+          m_pSlotReplacement->flagEmpty(iSlot);
+        }
+        m_brickStatus[slot->m_iBrickID] = StatusFromClass(m_pVisibility->getClass(slot->m_iBrickID));
       }
     }
   } // for all slots in brick pool
 }
 
 
-template<bool bInterruptable, IRenderer::ERenderMode eRenderMode>
-Vec4ui GLVolumePool::RecomputeVisibilityForOctree(const VisibilityState& visibility
-//Tuvok::ThreadClass::PredicateFunction pContinue = Tuvok::ThreadClass::PredicateFunction()
-)
-{
-  Vec4ui vEmptyBrickCount(0, 0, 0, 0);
-#ifndef _DEBUG
-  uint32_t const iContinue = 375; // we approximately process 7500 bricks/ms, checking for interruption every 375 bricks allows us to pause in 0.05 ms (worst case)
-#else
-  uint32_t const iContinue = 75; // we'll just get 1500 bricks/ms running a debug build
-#endif
-  Vec3ui iChildLayout = GetBrickLayout(m_volumeSize, m_maxInnerBrickSize, 0);
-  
-  // evaluate child visibility for finest level
-  for (uint32_t z = 0; z < iChildLayout.z; z++) {
-    for (uint32_t y = 0; y < iChildLayout.y; y++) {
-      for (uint32_t x = 0; x < iChildLayout.x; x++) {
-        
-        if (bInterruptable && !(x % iContinue)/* && pContinue*/)
-          
-          vEmptyBrickCount.x++; // increment total brick count
-        
-        Vec4ui const vBrickID(x, y, z, 0);
-        uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-        if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-        {
-          bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-          if (!bContainsData) {
-            m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // finest level bricks are all child empty by definition
-            vEmptyBrickCount.w++; // increment leaf empty brick count
-          }
-        }
-      } // for x
-    } // for y
-  } // for z
-  
-  // walk up hierarchy (from finest to coarsest level) and propagate child empty visibility
-  for (uint32_t iLoD = 1; iLoD < m_iLoDCount; iLoD++)
-  {
-    Vec3ui const iLayout = GetBrickLayout(m_volumeSize, m_maxInnerBrickSize, iLoD);
-    
-    // process even-sized volume
-    Vec3ui const iEvenLayout = iChildLayout / 2;
-    for (uint32_t z = 0; z < iEvenLayout.z; z++) {
-      for (uint32_t y = 0; y < iEvenLayout.y; y++) {
-        for (uint32_t x = 0; x < iEvenLayout.x; x++) {
-          
-          vEmptyBrickCount.x++; // increment total brick count
-          
-          Vec4ui const vBrickID(x, y, z, iLoD);
-          uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-          if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-          {
-            bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-            if (!bContainsData) {
-              m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // flag parent brick to be child empty for now so that we can save a couple of tests below
-              
-              Vec4ui const childPosition(x*2, y*2, z*2, iLoD-1);
-              if ((m_brickStatus[getIntegerBrickID(childPosition)] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 0, 1, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 1, 0, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 1, 1, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 0, 0, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 0, 1, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 1, 0, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 1, 1, 0))] != BI_CHILD_EMPTY))
-              {
-                m_brickStatus[brickIndex] = BI_EMPTY; // downgrade parent brick if we found a non child empty child
-                vEmptyBrickCount.y++; // increment empty brick count
-              } else {
-                vEmptyBrickCount.z++; // increment child empty brick count
-              }
-            }
-          }
-        } // for x
-      } // for y
-    } // for z
-    
-    // process odd boundaries (if any)
-    
-    // plane at the end of the x-axis
-    if (iChildLayout.x % 2) {
-      for (uint32_t z = 0; z < iEvenLayout.z; z++) {
-        for (uint32_t y = 0; y < iEvenLayout.y; y++) {
-          
-          vEmptyBrickCount.x++; // increment total brick count
-          
-          uint32_t const x = iLayout.x - 1;
-          Vec4ui const vBrickID(x, y, z, iLoD);
-          uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-          if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-          {
-            bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-            if (!bContainsData) {
-              m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // flag parent brick to be child empty for now so that we can save a couple of tests below
-              
-              Vec4ui const childPosition(x*2, y*2, z*2, iLoD-1);
-              if ((m_brickStatus[getIntegerBrickID(childPosition)] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 0, 1, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 1, 0, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 1, 1, 0))] != BI_CHILD_EMPTY))
-              {
-                m_brickStatus[brickIndex] = BI_EMPTY; // downgrade parent brick if we found a non child empty child
-                vEmptyBrickCount.y++; // increment empty brick count
-              } else {
-                vEmptyBrickCount.z++; // increment child empty brick count
-              }
-            }
-          }
-        } // for y
-      } // for z
-    } // if x is odd
-    
-    // plane at the end of the y-axis
-    if (iChildLayout.y % 2) {
-      for (uint32_t z = 0; z < iEvenLayout.z; z++) {
-        for (uint32_t x = 0; x < iEvenLayout.x; x++) {
-          
-          
-          
-          vEmptyBrickCount.x++; // increment total brick count
-          
-          uint32_t const y = iLayout.y - 1;
-          Vec4ui const vBrickID(x, y, z, iLoD);
-          uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-          if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-          {
-            bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-            if (!bContainsData) {
-              m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // flag parent brick to be child empty for now so that we can save a couple of tests below
-              
-              Vec4ui const childPosition(x*2, y*2, z*2, iLoD-1);
-              if ((m_brickStatus[getIntegerBrickID(childPosition)] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 0, 1, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 0, 0, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 0, 1, 0))] != BI_CHILD_EMPTY))
-              {
-                m_brickStatus[brickIndex] = BI_EMPTY; // downgrade parent brick if we found a non-empty child
-                vEmptyBrickCount.y++; // increment empty brick count
-              } else {
-                vEmptyBrickCount.z++; // increment child empty brick count
-              }
-            }
-          }
-        } // for x
-      } // for z
-    } // if y is odd
-    
-    // plane at the end of the z-axis
-    if (iChildLayout.z % 2) {
-      for (uint32_t y = 0; y < iEvenLayout.y; y++) {
-        for (uint32_t x = 0; x < iEvenLayout.x; x++) {
-          
-          
-          
-          vEmptyBrickCount.x++; // increment total brick count
-          
-          uint32_t const z = iLayout.z - 1;
-          Vec4ui const vBrickID(x, y, z, iLoD);
-          uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-          if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-          {
-            bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-            if (!bContainsData) {
-              m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // flag parent brick to be child empty for now so that we can save a couple of tests below
-              
-              Vec4ui const childPosition(x*2, y*2, z*2, iLoD-1);
-              if ((m_brickStatus[getIntegerBrickID(childPosition)] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 1, 0, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 0, 0, 0))] != BI_CHILD_EMPTY) ||
-                  (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 1, 0, 0))] != BI_CHILD_EMPTY))
-              {
-                m_brickStatus[brickIndex] = BI_EMPTY; // downgrade parent brick if we found a non-empty child
-                vEmptyBrickCount.y++; // increment empty brick count
-              } else {
-                vEmptyBrickCount.z++; // increment child empty brick count
-              }
-            }
-          }
-        } // for x
-      } // for y
-    } // if z is odd
-    
-    // line at the end of the x/y-axes
-    if (iChildLayout.x % 2 && iChildLayout.y % 2) {
-      for (uint32_t z = 0; z < iEvenLayout.z; z++) {
-        
-        
-        vEmptyBrickCount.x++; // increment total brick count
-        
-        uint32_t const y = iLayout.y - 1;
-        uint32_t const x = iLayout.x - 1;
-        Vec4ui const vBrickID(x, y, z, iLoD);
-        uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-        if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-        {
-          bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-          if (!bContainsData) {
-            m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // flag parent brick to be child empty for now so that we can save a couple of tests below
-            
-            Vec4ui const childPosition(x*2, y*2, z*2, iLoD-1);
-            if ((m_brickStatus[getIntegerBrickID(childPosition)] != BI_CHILD_EMPTY) ||
-                (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 0, 1, 0))] != BI_CHILD_EMPTY))
-            {
-              m_brickStatus[brickIndex] = BI_EMPTY; // downgrade parent brick if we found a non-empty child
-              vEmptyBrickCount.y++; // increment empty brick count
-            } else {
-              vEmptyBrickCount.z++; // increment child empty brick count
-            }
-          }
-        }
-      } // for z
-    } // if x and y are odd
-    
-    // line at the end of the x/z-axes
-    if (iChildLayout.x % 2 && iChildLayout.z % 2) {
-      for (uint32_t y = 0; y < iEvenLayout.y; y++) {
-        
-        
-        
-        vEmptyBrickCount.x++; // increment total brick count
-        
-        uint32_t const z = iLayout.z - 1;
-        uint32_t const x = iLayout.x - 1;
-        Vec4ui const vBrickID(x, y, z, iLoD);
-        uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-        if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-        {
-          bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-          if (!bContainsData) {
-            m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // flag parent brick to be child empty for now so that we can save a couple of tests below
-            
-            Vec4ui const childPosition(x*2, y*2, z*2, iLoD-1);
-            if ((m_brickStatus[getIntegerBrickID(childPosition)] != BI_CHILD_EMPTY) ||
-                (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(0, 1, 0, 0))] != BI_CHILD_EMPTY))
-            {
-              m_brickStatus[brickIndex] = BI_EMPTY; // downgrade parent brick if we found a non-empty child
-              vEmptyBrickCount.y++; // increment empty brick count
-            } else {
-              vEmptyBrickCount.z++; // increment child empty brick count
-            }
-          }
-        }
-      } // for y
-    } // if x and z are odd
-    
-    // line at the end of the y/z-axes
-    if (iChildLayout.y % 2 && iChildLayout.z % 2) {
-      for (uint32_t x = 0; x < iEvenLayout.x; x++) {
-        
-        
-        vEmptyBrickCount.x++; // increment total brick count
-        
-        uint32_t const z = iLayout.z - 1;
-        uint32_t const y = iLayout.y - 1;
-        Vec4ui const vBrickID(x, y, z, iLoD);
-        uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-        if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-        {
-          bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-          if (!bContainsData) {
-            m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // flag parent brick to be child empty for now so that we can save a couple of tests below
-            
-            Vec4ui const childPosition(x*2, y*2, z*2, iLoD-1);
-            if ((m_brickStatus[getIntegerBrickID(childPosition)] != BI_CHILD_EMPTY) ||
-                (m_brickStatus[getIntegerBrickID(childPosition + Vec4ui(1, 0, 0, 0))] != BI_CHILD_EMPTY))
-            {
-              m_brickStatus[brickIndex] = BI_EMPTY; // downgrade parent brick if we found a non-empty child
-              vEmptyBrickCount.y++; // increment empty brick count
-            } else {
-              vEmptyBrickCount.z++; // increment child empty brick count
-            }
-          }
-        }
-      } // for x
-    } // if y and z are odd
-    
-    // single brick at the x/y/z corner
-    if (iChildLayout.x % 2 && iChildLayout.y % 2 && iChildLayout.z % 2) {
-      
-      
-      vEmptyBrickCount.x++; // increment total brick count
-      
-      uint32_t const z = iLayout.z - 1;
-      uint32_t const y = iLayout.y - 1;
-      uint32_t const x = iLayout.x - 1;
-      Vec4ui const vBrickID(x, y, z, iLoD);
-      uint32_t const brickIndex = getIntegerBrickID(vBrickID);
-      if (m_brickStatus[brickIndex] < BI_FLAG_COUNT) // only check bricks that are not cached in the pool
-      {
-        bool const bContainsData = ContainsData<eRenderMode>(visibility, brickIndex);
-        if (!bContainsData) {
-          m_brickStatus[brickIndex] = BI_CHILD_EMPTY; // flag parent brick to be child empty for now so that we can save a couple of tests below
-          
-          Vec4ui const childPosition(x*2, y*2, z*2, iLoD-1);
-          if (m_brickStatus[getIntegerBrickID(childPosition)] != BI_CHILD_EMPTY)
-          {
-            m_brickStatus[brickIndex] = BI_EMPTY; // downgrade parent brick if we found a non-empty child
-            vEmptyBrickCount.y++; // increment empty brick count
-          } else {
-            vEmptyBrickCount.z++; // increment child empty brick count
-          }
-        }
-      }
-    } // if x, y and z are odd
-    
-    iChildLayout = iLayout;
-  } // for all levels
-  
-  return vEmptyBrickCount;
-}
-
-
 template<typename T>
 void GLVolumePool::UploadBricksToBrickPoolT(const std::vector<Vec4ui>& vBrickIDs) {
   
@@ -1327,7 +1068,8 @@ void GLVolumePool::UploadBricksToBrickPoolT(const std::vector<Vec4ui>& vBrickIDs
     const BrickKey key = IndexFrom4D(m_LoDInfoCache, m_currentModality,
                                      vBrickID, m_currentTimestep);
     
-    BrickRequest r = {vBrickID, key};
+    BrickRequest r = {vBrickID, key, m_pPrefetcher->screenFootprint(vBrickID),
+                      false};
     request.push_back(r);
   }
   
@@ -1404,7 +1146,9 @@ void GLVolumePool::PotentiallyUploadBricksToBrickPoolT(const VisibilityState& vi
       bool const bContainsData = ContainsData<eRenderMode>(visibility,
                                                            brickIndex);
       if (bContainsData) {
-        BrickRequest r = {vBrickID, key};
+        // bricks that cover more of the screen are served first
+        BrickRequest r = {vBrickID, key,
+                          m_pPrefetcher->screenFootprint(vBrickID), false};
         request.push_back(r);
       } else {
         m_brickStatus[brickIndex] = BI_EMPTY;
@@ -1500,54 +1244,58 @@ Vec4ui GLVolumePool::recomputeVisibility(const VisibilityState& visibility,
     
     m_brickMetadataCache =  m_dataset.getBrickMetaData(m_currentModality,
                                                         m_currentTimestep);
-    
+    // the updater must not classify while the metadata is replaced
+    if (m_pVisibilityUpdater) waitForVisibilityUpdater();
+    m_pVisibility->setMetaData(m_brickMetadataCache);
+    m_bMetaDataChanged = true;
   }
   
-  // reset meta data for all bricks (BI_MISSING means that we haven't test the data for visibility until the async updater finishes)
-  std::fill(m_brickStatus.begin(), m_brickStatus.end(), BI_MISSING);
-  
-  // TODO: if metadata texture grows too large (14 ms CPU update time for approx 2000x2000 texture) consider to
-  //       update texel regions efficiently that will be toched by RecomputeVisibilityForBrickPool()
-  //       updating every single texel turned out to be not efficient in this case
-  
-  // recompute visibility for cached bricks immediately
   switch (visibility.getRenderMode()) {
     case IRenderer::ERenderMode::RM_1DTRANS:
-      RecomputeVisibilityForBrickPool<IRenderer::ERenderMode::RM_1DTRANS>(visibility);
-      break;
     case IRenderer::ERenderMode::RM_2DTRANS:
-      RecomputeVisibilityForBrickPool<IRenderer::ERenderMode::RM_2DTRANS>(visibility);
-      break;
     case IRenderer::ERenderMode::RM_ISOSURFACE:
-      RecomputeVisibilityForBrickPool<IRenderer::ERenderMode::RM_ISOSURFACE>(visibility);
-      break;
     case IRenderer::ERenderMode::RM_CLEARVIEW:
-      RecomputeVisibilityForBrickPool<IRenderer::ERenderMode::RM_CLEARVIEW>(visibility);
       break;
     default:
       LERRORC("GLVolumePool","Unhandled rendering mode.");
       return vEmptyBrickCount;
   }
   
-  // recompute visibility for the entire hierarchy immediately
-  switch (visibility.getRenderMode()) {
-    case IRenderer::ERenderMode::RM_1DTRANS:
-      vEmptyBrickCount = RecomputeVisibilityForOctree<false, IRenderer::ERenderMode::RM_1DTRANS>(visibility);
-      break;
-    case IRenderer::ERenderMode::RM_2DTRANS:
-      vEmptyBrickCount = RecomputeVisibilityForOctree<false, IRenderer::ERenderMode::RM_2DTRANS>(visibility);
-      break;
-    case IRenderer::ERenderMode::RM_ISOSURFACE:
-      vEmptyBrickCount = RecomputeVisibilityForOctree<false, IRenderer::ERenderMode::RM_ISOSURFACE>(visibility);
-      break;
-    case IRenderer::ERenderMode::RM_CLEARVIEW:
-      vEmptyBrickCount = RecomputeVisibilityForOctree<false, IRenderer::ERenderMode::RM_CLEARVIEW>(visibility);
-      break;
-    default:
-      LERRORC("GLVolumePool","Unhandled rendering mode.");
-      return vEmptyBrickCount;
+  // usually only the bricks whose value range lies between the last and
+  // the current transfer function limits have to be tested
+  bool const bFullUpdate = m_bMetaDataChanged ||
+    visibility.getRenderMode() != m_requestedVisibility.getRenderMode();
+  std::vector<uint32_t> vCandidates;
+  if (!bFullUpdate) {
+    m_pVisibility->collectCandidates(m_requestedVisibility, visibility, vCandidates);
   }
-  m_bVisibilityUpdated = true; // will be true after we uploaded the metadata texture in the next line
+  m_requestedVisibility = visibility;
+  m_bMetaDataChanged = false;
+  
+  // large updates are left to the background updater, until it is done we
+  // render with conservative metadata
+  size_t const iTestCount = bFullUpdate ? m_iTotalBrickCount : vCandidates.size();
+  if (m_pVisibilityUpdater && !bForceSynchronousUpdate &&
+      iTestCount > asyncVisibilityThreshold) {
+    markProvisionalVisibility(bFullUpdate, vCandidates);
+    {
+      SCOPEDLOCK(m_visibilityCS);
+      m_updaterVisibility = visibility;
+      m_bUpdaterRequested = true;
+      m_bUpdaterDone = false;
+    }
+    m_visibilityRequested.wakeOne();
+    m_bVisibilityUpdated = false;
+    LDEBUGC("GLVolumePool","Started asynchronous visibility update for "
+            <<iTestCount<<" bricks");
+    return vEmptyBrickCount;
+  }
+  if (m_pVisibilityUpdater) waitForVisibilityUpdater();
+  
+  applyVisibility(m_pVisibility->update(visibility),
+                  m_pVisibility->getChangedBricks());
+  vEmptyBrickCount = m_pVisibility->getCounts();
+  
   if (vEmptyBrickCount.x != m_iTotalBrickCount) {
     //WARNING("%u of %u bricks were processed during synchronous visibility recomputation!");
   }
@@ -1578,13 +1326,164 @@ Vec4ui GLVolumePool::recomputeVisibility(const VisibilityState& visibility,
           <<" % of all bricks)");
   
   
-  // upload new metadata to GPU
-  LDEBUGC("GLVolumePool","will upload metadatatexture");
-  uploadMetadataTexture();
-  
   return vEmptyBrickCount;
 }
 
+void GLVolumePool::applyVisibility(bool bFullUpdate,
+                                   const std::vector<uint32_t>& vChangedBricks)
+{
+  if (bFullUpdate) {
+    // BI_MISSING for visible bricks, the pass below flags the cached ones
+    std::fill(m_brickStatus.begin(), m_brickStatus.end(), BI_MISSING);
+    for (uint32_t i = 0; i < m_iTotalBrickCount; ++i) {
+      m_brickStatus[i] = StatusFromClass(m_pVisibility->getClass(i));
+    }
+  } else {
+    for (uint32_t iBrickID : vChangedBricks) {
+      m_brickStatus[iBrickID] = StatusFromClass(m_pVisibility->getClass(iBrickID));
+    }
+    for (uint32_t iBrickID : m_vProvisionalBricks) {
+      m_brickStatus[iBrickID] = StatusFromClass(m_pVisibility->getClass(iBrickID));
+    }
+  }
+  
+  // restore or flag cached bricks
+  RecomputeVisibilityForBrickPool();
+  
+  // upload new metadata to GPU, only the texels of changed bricks differ
+  // but updating every single texel is slower than uploading the whole
+  // texture (14 ms for approx 2000x2000 texels) unless just a few changed
+  if (bFullUpdate ||
+      vChangedBricks.size() + m_vProvisionalBricks.size() > maxMetadataTexelUpdates) {
+    LDEBUGC("GLVolumePool","will upload metadatatexture");
+    uploadMetadataTexture();
+  } else {
+    for (uint32_t iBrickID : vChangedBricks) {
+      uploadMetadataTexel(iBrickID);
+    }
+    for (uint32_t iBrickID : m_vProvisionalBricks) {
+      uploadMetadataTexel(iBrickID);
+    }
+  }
+  m_vProvisionalBricks.clear();
+  m_bVisibilityUpdated = true;
+}
+
+void GLVolumePool::markProvisionalVisibility(bool bFullUpdate,
+                                             const std::vector<uint32_t>& vCandidates)
+{
+  if (bFullUpdate) {
+    // nothing is known about the new state, every brick that is not cached
+    // gets requested and tested individually by requestBricks
+    std::fill(m_brickStatus.begin(), m_brickStatus.end(), BI_MISSING);
+    for (const PoolSlotData& slot : m_vPoolSlotData) {
+      if (slot.wasEverUsed() && slot.containsVisibleBrick()) {
+        m_brickStatus[slot.m_iBrickID] = slot.positionInPool().x +
+        slot.positionInPool().y * m_vPoolCapacity.x +
+        slot.positionInPool().z * m_vPoolCapacity.x * m_vPoolCapacity.y + BI_FLAG_COUNT;
+      }
+    }
+    uploadMetadataTexture();
+    return;
+  }
+  
+  // empty candidates may contain data now and their child empty ancestors
+  // may have a visible descendant, above the first ancestor that is not
+  // child empty nothing is child empty
+  size_t const iFirstNew = m_vProvisionalBricks.size();
+  for (uint32_t iBrickID : vCandidates) {
+    if (m_brickStatus[iBrickID] == BI_EMPTY ||
+        m_brickStatus[iBrickID] == BI_CHILD_EMPTY) {
+      m_brickStatus[iBrickID] = BI_MISSING;
+      m_vProvisionalBricks.push_back(iBrickID);
+    }
+    for (uint32_t iParentID = m_pVisibility->getParentID(iBrickID);
+         iParentID < m_iTotalBrickCount && m_brickStatus[iParentID] == BI_CHILD_EMPTY;
+         iParentID = m_pVisibility->getParentID(iParentID)) {
+      m_brickStatus[iParentID] = BI_EMPTY;
+      m_vProvisionalBricks.push_back(iParentID);
+    }
+  }
+  
+  if (m_vProvisionalBricks.size() - iFirstNew > maxMetadataTexelUpdates) {
+    uploadMetadataTexture();
+  } else {
+    for (size_t i = iFirstNew; i < m_vProvisionalBricks.size(); ++i) {
+      uploadMetadataTexel(m_vProvisionalBricks[i]);
+    }
+  }
+}
+
+bool GLVolumePool::publishVisibility()
+{
+  bool bFullUpdate;
+  std::vector<uint32_t> vChangedBricks;
+  {
+    SCOPEDLOCK(m_visibilityCS);
+    if (!m_bUpdaterDone) return false;
+    m_bUpdaterDone = false;
+    bFullUpdate = m_bUpdaterFull;
+    m_bUpdaterFull = false;
+    vChangedBricks.swap(m_vUpdaterChangedBricks);
+  }
+  
+  applyVisibility(bFullUpdate, vChangedBricks);
+  LDEBUGC("GLVolumePool","async visibility update completed for "
+          << m_iTotalBrickCount << " bricks");
+  return true;
+}
+
+void GLVolumePool::waitForVisibilityUpdater()
+{
+  {
+    SCOPEDLOCK(m_visibilityCS);
+    while (m_bUpdaterRequested || m_bUpdaterBusy) {
+      m_visibilityIdle.wait(m_visibilityCS);
+    }
+    // publish even if the updater is kept busy for debugging
+    if (!m_bVisibilityUpdated) m_bUpdaterDone = true;
+  }
+  publishVisibility();
+}
+
+void GLVolumePool::visibilityUpdaterFunc(Predicate pContinue,
+                                         LambdaThread::Interface&) {
+  LINFO("visibilityUpdaterThread starting");
+  
+  while (pContinue()) {
+    VisibilityState visibility;
+    {
+      SCOPEDLOCK(m_visibilityCS);
+      while (!m_bUpdaterRequested) {
+        if (!pContinue()) return;
+        m_visibilityRequested.wait(m_visibilityCS, asyncVisibilityWaitMilliseconds);
+      }
+      visibility = m_updaterVisibility;
+      m_bUpdaterRequested = false;
+      m_bUpdaterBusy = true;
+    }
+    
+    // the render thread neither reads nor writes m_pVisibility meanwhile
+    bool const bFullUpdate = m_pVisibility->update(visibility);
+    
+    {
+      SCOPEDLOCK(m_visibilityCS);
+      m_bUpdaterBusy = false;
+      m_bUpdaterFull = m_bUpdaterFull || bFullUpdate;
+      if (!bFullUpdate) {
+        const std::vector<uint32_t>& vChangedBricks = m_pVisibility->getChangedBricks();
+        m_vUpdaterChangedBricks.insert(m_vUpdaterChangedBricks.end(),
+                                       vChangedBricks.begin(), vChangedBricks.end());
+      }
+      // results are only published for the latest state
+      m_bUpdaterDone = !m_bUpdaterRequested && m_eDebugMode != DM_BUSY;
+    }
+    m_visibilityIdle.wakeAll();
+  }
+  
+  LINFO("visibilityUpdaterThread stopped");
+}
+
 void GLVolumePool::requestBricks(const std::vector<Vec4ui>& vBrickIDs,
                                  const VisibilityState& visibility)
 {
@@ -1594,43 +1493,59 @@ void GLVolumePool::requestBricks(const std::vector<Vec4ui>& vBrickIDs,
   {
     prepareForPaging();
     
+    // bricks that are still resident in a slot flagged empty (e.g. while
+    // the metadata is conservative) are restored instead of paged in again
+    std::vector<Vec4ui> vMissingBrickIDs;
+    vMissingBrickIDs.reserve(vBrickIDs.size());
+    for (const Vec4ui& vBrickID : vBrickIDs) {
+      uint32_t const iBrickID = getIntegerBrickID(vBrickID);
+      uint32_t const iSlot = m_pSlotReplacement->request(iBrickID);
+      if (iSlot == m_pSlotReplacement->getSlotCount()) {
+        vMissingBrickIDs.push_back(vBrickID);
+        continue;
+      }
+      PoolSlotData& slot = m_vPoolSlotData[iSlot];
+      if (!slot.containsVisibleBrick()) {
+        slot.restore();
+        m_pSlotReplacement->restore(iSlot);
+      }
+      m_brickStatus[iBrickID] = slot.positionInPool().x +
+      slot.positionInPool().y * m_vPoolCapacity.x +
+      slot.positionInPool().z * m_vPoolCapacity.x * m_vPoolCapacity.y + BI_FLAG_COUNT;
+      uploadMetadataTexel(iBrickID);
+    }
+    
+    PoolSlotReplacement::Counters const& counters = m_pSlotReplacement->getCounters();
+    LDEBUGC("GLVolumePool", "brick pool: " << counters.iHits << " hits, "
+            << counters.iMisses << " misses, " << counters.iEvictions << " evictions");
+    
     if (!m_bVisibilityUpdated) {
       switch (visibility.getRenderMode()) {
         case IRenderer::ERenderMode::RM_1DTRANS:
           PotentiallyUploadBricksToBrickPool<IRenderer::ERenderMode::RM_1DTRANS>(visibility,
-                                                                                 vBrickIDs);
+                                                                                 vMissingBrickIDs);
           break;
         case IRenderer::ERenderMode::RM_2DTRANS:
           PotentiallyUploadBricksToBrickPool<IRenderer::ERenderMode::RM_2DTRANS>(visibility,
-                                                                                 vBrickIDs);
+                                                                                 vMissingBrickIDs);
           break;
         case IRenderer::ERenderMode::RM_ISOSURFACE:
           PotentiallyUploadBricksToBrickPool<IRenderer::ERenderMode::RM_ISOSURFACE>(visibility,
-                                                                                    vBrickIDs);
+                                                                                    vMissingBrickIDs);
           break;
         case IRenderer::ERenderMode::RM_CLEARVIEW:
           PotentiallyUploadBricksToBrickPool<IRenderer::ERenderMode::RM_CLEARVIEW>(visibility,
-                                                                                   vBrickIDs);
+                                                                                   vMissingBrickIDs);
           break;
         default:
           LERRORC("GLVolumePool","Unhandled rendering mode.");
       }
     } else {
       // visibility is updated guaranteeing that requested bricks contain data
-      UploadBricksToBrickPool(vBrickIDs);
+      UploadBricksToBrickPool(vMissingBrickIDs);
     }
   }
   
-  if (!m_bVisibilityUpdated)
-  {
-    // we want to upload the whole meta texture when async updater is done
-    uploadMetadataTexture();
-    // must be set one frame delayed otherwise we might upload empty bricks
-    m_bVisibilityUpdated = true;
-    
-    LDEBUGC("GLVolumePool","async visibility update completed for "
-            << m_iTotalBrickCount << " bricks");
-  }
 }
 
 void GLVolumePool::freeGLResources() {
@@ -1666,79 +1581,59 @@ bool GLVolumePool::isValid() const {
 }
 
 void GLVolumePool::requestBricksFromGetterThread(const std::vector<BrickRequest>& request) {
-
-  size_t actualRequests = 0;
-  // METHOD 1: add requests to queue
-
-  for (size_t j = 0;j<request.size();++j) {
-    
-    if (m_brickDataCS.lock(asyncGetThreadWaitSecs)) {
-      bool found = false;
-      for (size_t i = 0;i<m_requestTodo.size();++i) {
-        if (m_requestTodo[i] == request[j]) {
-          found = true;
-          break;
-        }
-      }
-      
-      if (found) {
-        m_brickDataCS.unlock();
-        continue;
-      }
-
-      for (size_t i = 0;i<m_requestDone.size();++i) {
-        if (m_requestDone[i] == request[j]) {
-          found = true;
-          break;
-        }
-      }
-      
-      if (found) {
-        m_brickDataCS.unlock();
-        continue;
-      }
-      
-      m_requestTodo.push_back(request[j]);
-      m_brickDataCS.unlock();
-      actualRequests++;
-
-      m_brickGetterThread->resume();
-    } else {
-      continue;
-    }
-    
-  }
-
-
-  /*
-  // METHOD 2: replace requests in queue
-  {
-    SCOPEDLOCK(m_brickDataCS);
-    std::vector<BrickRequest> requestTodo;
-    for (size_t j = 0;j<request.size();++j) {
-      bool found = false;
-      for (size_t i = 0;i<m_requestTodo.size();++i) {
-        if (m_requestTodo[i] == request[j]) {
-          found = true;
-          break;
-        }
-      }
-      if (!found)
-        requestTodo.push_back(request[j]);
-    }
-    m_requestTodo = requestTodo;
-    actualRequests = m_requestTodo.size();
-  }
-  m_brickGetterThread->resume();
-*/
+  // the queue rejects duplicates of queued, in flight and not yet uploaded
+  // requests and cancels requests that have not been repeated for a while
+  size_t actualRequests = m_requestQueue.push(request);
 
   LINFO(actualRequests << " new requests, " <<
         request.size()-actualRequests <<
         " already known");
 }
 
+void GLVolumePool::prefetchBricks(const Mat4f& mModelToView,
+                                  const Mat4f& mProjection,
+                                  float fLoDFactor, const Vec3f& vExtend,
+                                  bool bContinuous) {
+  if (!m_pSlotReplacement) return;
+  
+  float const fLevelZeroWorldSpaceError = (vExtend/Vec3f(m_volumeSize)).maxVal();
+  m_pPrefetcher->setProjection(mProjection, fLoDFactor, fLevelZeroWorldSpaceError);
+  m_pPrefetcher->addView(mModelToView, bContinuous);
+  if (!m_pPrefetcher->hasMotion()) return;
+  
+  // resident and empty bricks are not requested, subtrees without any
+  // visible brick are not traversed at all
+  auto classify = [this](const Vec4ui& vBrickID) {
+    uint32_t const iStatus = m_brickStatus[getIntegerBrickID(vBrickID)];
+    if (iStatus == BI_MISSING) return BrickPrefetcher::BD_REQUEST;
+    if (iStatus == BI_CHILD_EMPTY) return BrickPrefetcher::BD_SKIP_SUBTREE;
+    return BrickPrefetcher::BD_SKIP;
+  };
+  size_t const iMaxCount = std::max<size_t>(1, m_vPoolSlotData.size() / prefetchPoolFraction);
+  const auto vPredicted = m_pPrefetcher->predict(classify, iMaxCount);
+  
+  std::vector<BrickRequest> request;
+  request.reserve(vPredicted.size());
+  for (const auto& prediction : vPredicted) {
+    const BrickKey key = IndexFrom4D(m_LoDInfoCache, m_currentModality,
+                                     prediction.vBrickID, m_currentTimestep);
+    // nearer predictions are more likely to come true
+    BrickRequest r = {prediction.vBrickID, key,
+                      1.0f / float(prediction.iStep), true};
+    request.push_back(r);
+  }
+  
+  size_t const newRequests = m_requestQueue.prefetch(request);
+  LDEBUGC("GLVolumePool", newRequests << " bricks prefetched for " <<
+          request.size() << " missing bricks of the predicted views");
+}
+
 uint32_t GLVolumePool::uploadBricks() {
   uint32_t iPagedBricks = 0;
+  
+  // the metadata of a finished background update becomes visible with
+  // this frame
+  if (m_pVisibilityUpdater) publishVisibility();
 
 
   // Method 1: get the bricks request by request
@@ -1754,11 +1649,12 @@ uint32_t GLVolumePool::uploadBricks() {
         return iPagedBricks;
       }
       
-      data = m_requestStorage[0];
-      b = m_requestDone[0];
-      m_requestDone.erase(m_requestDone.begin());
-      m_requestStorage.erase(m_requestStorage.begin());
+      data = m_requestStorage.front();
+      b = m_requestDone.front();
+      m_requestDone.pop_front();
+      m_requestStorage.pop_front();
       m_brickDataCS.unlock();
+      m_requestQueue.release(b.key);
       
     } else {
       LINFO(iPagedBricks << " bricks uploaded");
@@ -1797,68 +1693,52 @@ uint32_t GLVolumePool::uploadBricks() {
 
 
 void GLVolumePool::brickGetterFunc(Predicate pContinue,
-                                   LambdaThread::Interface& threadInterface) {
+                                   LambdaThread::Interface&) {
   LINFO("brickGetterThread starting");
   
-  size_t todoCount = 0;
-  if (m_brickDataCS.lock(asyncGetThreadWaitSecs)) {
-    todoCount = m_requestTodo.size();
-    m_brickDataCS.unlock();
-  } else {
-    todoCount = 0;
-  }
-  
   while (pContinue()) {
-    if (todoCount == 0)
-      threadInterface.suspend(pContinue);
-
-    BrickRequest b;
-    if (m_brickDataCS.lock(asyncGetThreadWaitSecs)) {
-      todoCount = m_requestTodo.size();
-      if (todoCount == 0) {
-        m_brickDataCS.unlock();
-        continue;
-      }
-      
-      // get first element from todo list
-      b = m_requestTodo[0];
-      m_brickDataCS.unlock();
-    } else {
-      continue;
-    }
+    // blocks until there is something to do
+    std::vector<BrickRequest> batch = m_requestQueue.pop(brickGetterBatchSize,
+                                                         pContinue);
+    if (batch.empty()) continue;
     
-    // now request the brick (outside the lock)
-    bool success;
-    auto vUploadMem = m_dataset.getBrick(b.key, success);
-    if (!success) {
-      LERROR("Error getting brick" << b.key);
-      continue;
+    // now request the bricks (outside the lock)
+    std::vector<BrickKey> keys;
+    keys.reserve(batch.size());
+    for (const BrickRequest& b : batch) {
+      keys.push_back(b.key);
+    }
+    std::vector<bool> success;
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> vUploadMem;
+    try {
+      vUploadMem = m_dataset.getBricks(keys, success);
+    } catch (const std::exception& e) {
+      // any error fails the whole batch, so its bricks are requested again
+      // instead of staying in flight forever
+      LERROR("Error getting bricks: " << e.what());
+      success.assign(batch.size(), false);
+      vUploadMem.assign(batch.size(), nullptr);
+    } catch (...) {
+      LERROR("Unknown error getting bricks");
+      success.assign(batch.size(), false);
+      vUploadMem.assign(batch.size(), nullptr);
     }
     
-    if (m_brickDataCS.lock(asyncGetThreadWaitSecs)) {
+    for (size_t j = 0;j<batch.size();++j) {
       // check if request still exists
-      bool found = false;
-      for (size_t i = 0;i<m_requestTodo.size();++i) {
-        if (m_requestTodo[i] == b) {
-          found = true;
-          m_requestTodo.erase(m_requestTodo.begin()+i);
+      if (!m_requestQueue.finish(batch[j], success[j])) {
+        if (!success[j]) {
+          LERROR("Error getting brick" << batch[j].key);
+        } else {
+          LINFO("wasted a brick request");
         }
-      }
-      if (!found) {
-        LINFO("wasted a brick request");
-        m_brickDataCS.unlock();
         continue;
       }
       
-      m_requestStorage.push_back(vUploadMem);
-      m_requestDone.push_back(b);
-      
-      todoCount = m_requestTodo.size();
-      m_brickDataCS.unlock();
-    } else {
-      continue;
+      SCOPEDLOCK(m_brickDataCS);
+      m_requestStorage.push_back(vUploadMem[j]);
+      m_requestDone.push_back(batch[j]);
     }
-    
   }
   LINFO("brickGetterThread terminating");
 }
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <deque>
 #include <list>
 
 #include "Threads.h"
+#include "BrickRequestQueue.h"
 
 #include <opengl-base/OpenGLincludes.h>
 #include <opengl-base/GLTexture3D.h>
@@ -13,7 +15,10 @@
 
 
 #include "PoolSlotData.h"
+#include "PoolSlotReplacement.h"
 #include "BrickElemInfo.h"
+#include "BrickVisibility.h"
+#include "BrickPrefetcher.h"
 
 
 class VisibilityState;
@@ -39,14 +44,6 @@ public:
     SkipTwoLevels
   };
   
-  struct BrickRequest {
-    Core::Math::Vec4ui ID;
-    BrickKey key;
-    bool operator==(const BrickRequest& other) {
-      return ID == other.ID && key == other.key;
-    }
-  };
-    
   enum DebugMode {
     DM_NONE = 0, // no debugging
     DM_BUSY,     // prevent the async worker from doing anything useful forcing the situation when the async updater has not yet updated the metadata but should
@@ -57,7 +54,9 @@ public:
   /// @throws Tuvok::Exception on init error
   GLVolumePool(uint64_t GPUMemorySizeInByte, trinity::IIO& pDataset,
                uint64_t modality,
-               GLenum filter, bool bUseGLCore=true, DebugMode dm=DM_NONE);
+               GLenum filter, bool bUseGLCore=true, DebugMode dm=DM_NONE,
+               uint32_t iGetterThreadCount=4,
+               PoolSlotReplacement::Policy eReplacementPolicy=PoolSlotReplacement::LRU);
   virtual ~GLVolumePool();
   
   // signals if meta texture is up-to-date including child emptiness for
@@ -76,6 +75,17 @@ public:
   void requestBricks(const std::vector<Core::Math::Vec4ui>& vBrickIDs,
                      const VisibilityState& visibility);
   
+  // to be called whenever the view changes, extrapolates the camera motion
+  // and queues the missing bricks of the predicted views as speculative
+  // requests, which never delay the bricks rendered frames ask for
+  // @param mModelToView transformation of normalized volume coordinates
+  //        ([0,1]^3) into view space
+  // @param bContinuous false if the view jumped, e.g. after a camera reset
+  void prefetchBricks(const Core::Math::Mat4f& mModelToView,
+                      const Core::Math::Mat4f& mProjection,
+                      float fLoDFactor, const Core::Math::Vec3f& vExtend,
+                      bool bContinuous);
+  
   void uploadFirstBrick(const BrickKey& bkey);
   
   // returns false if we need to render first before we can continue to upload further bricks
@@ -117,14 +127,14 @@ protected:
   uint32_t m_iDataTextureUnit;
   bool m_bUseGLCore;
   
-  size_t m_iInsertPos;
-  
   uint32_t m_iTotalBrickCount;
   
   bool m_bVisibilityUpdated;
+  bool m_bMetaDataChanged; // the next visibility update has to classify all bricks
 
   std::vector<uint32_t>     m_brickStatus;  // ref by iBrickID, size of total brick count + some unused 2d texture padding
-  std::vector<PoolSlotData> m_vPoolSlotData;   // size of available pool slots
+  std::vector<PoolSlotData> m_vPoolSlotData;   // size of available pool slots, index is fixed to the position in the pool
+  std::unique_ptr<PoolSlotReplacement> m_pSlotReplacement; // chooses the slots to overwrite
   std::vector<uint32_t>     m_vLoDOffsetTable; // size of LoDs, stores index sums, level 0 is finest
   
   size_t m_currentModality;
@@ -132,6 +142,10 @@ protected:
   
   
   std::vector<trinity::BrickMetaData> m_brickMetadataCache;
+  std::unique_ptr<BrickVisibility> m_pVisibility; // classification of all bricks for the last visibility state
+  std::unique_ptr<BrickPrefetcher> m_pPrefetcher;
+  VisibilityState m_requestedVisibility;          // last state handed to m_pVisibility, possibly still in progress
+  std::vector<uint32_t> m_vProvisionalBricks;     // bricks flagged conservatively until the async update is published
   
   
   std::vector <std::vector<Core::Math::Vec3ui>> m_LoDInfoCache;
@@ -140,6 +154,31 @@ protected:
   
   DataSetCache m_sDataSetCache;
   
+  // background visibility updater, owns m_pVisibility while it is busy
+  std::unique_ptr<LambdaThread> m_pVisibilityUpdater;
+  CriticalSection               m_visibilityCS;
+  WaitCondition                 m_visibilityRequested;
+  WaitCondition                 m_visibilityIdle;
+  VisibilityState               m_updaterVisibility;
+  bool                          m_bUpdaterRequested;
+  bool                          m_bUpdaterBusy;
+  bool                          m_bUpdaterDone;
+  bool                          m_bUpdaterFull;
+  std::vector<uint32_t>         m_vUpdaterChangedBricks;
+  
+  void visibilityUpdaterFunc(Predicate pContinue,
+                             LambdaThread::Interface& threadInterface);
+  // applies the results of a finished background update
+  // @return false if no results were available
+  bool publishVisibility();
+  // blocks until the updater is idle and publishes its results
+  void waitForVisibilityUpdater();
+  // writes m_brickStatus from m_pVisibility and uploads it
+  void applyVisibility(bool bFullUpdate, const std::vector<uint32_t>& vChangedBricks);
+  // flags the bricks whose status may change with the next update as not
+  // empty until the update is published
+  void markProvisionalVisibility(bool bFullUpdate, const std::vector<uint32_t>& vCandidates);
+  
   uint32_t getIntegerBrickID(const Core::Math::Vec4ui& vBrickID) const; // x, y , z, lod (w) to iBrickID
   Core::Math::Vec4ui getVectorBrickID(uint32_t iBrickID) const;
   Vec3ui getBrickVoxelCounts(const Core::Math::Vec4ui& key) const {
@@ -163,12 +202,12 @@ protected:
                    size_t iInsertPos, uint64_t iTimeOfCreation);
   
   
-  std::vector<BrickRequest>     m_requestTodo;
-  std::vector<BrickRequest>     m_requestDone;
-  std::vector<std::shared_ptr<std::vector<uint8_t>>> m_requestStorage;
+  BrickRequestQueue             m_requestQueue;
+  std::deque<BrickRequest>      m_requestDone;
+  std::deque<std::shared_ptr<std::vector<uint8_t>>> m_requestStorage;
   
   CriticalSection               m_brickDataCS;
-  std::unique_ptr<LambdaThread> m_brickGetterThread;
+  std::vector<std::unique_ptr<LambdaThread>> m_brickGetterThreads;
   
   void brickGetterFunc(Predicate pContinue,
                        LambdaThread::Interface& threadInterface);
@@ -192,13 +231,8 @@ protected:
   template<trinity::IRenderer::ERenderMode eRenderMode>
   bool ContainsData(const VisibilityState& visibility, uint32_t iBrickID);
   
-  template<trinity::IRenderer::ERenderMode eRenderMode>
-  void RecomputeVisibilityForBrickPool(const VisibilityState& visibility);
-  
-  template<bool bInterruptable, trinity::IRenderer::ERenderMode eRenderMode>
-  Core::Math::Vec4ui RecomputeVisibilityForOctree(const VisibilityState& visibility
-  //Tuvok::ThreadClass::PredicateFunction pContinue = Tuvok::ThreadClass::PredicateFunction()
-  );
+  // restores or flags the cached bricks according to m_pVisibility
+  void RecomputeVisibilityForBrickPool();
   
   Core::Math::Vec3ui calculateVolumePoolSize(const trinity::IIO::ValueType type,
                                              const trinity::IIO::Semantic semantic,
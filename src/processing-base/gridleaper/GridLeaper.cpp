@@ -43,6 +43,7 @@ m_activeShaderProgram(nullptr),
 m_hashTable(nullptr),
 m_volumePool(nullptr),
 m_resultBuffer(nullptr),
+m_pixelReadback(nullptr),
 m_pFBORayStart(nullptr),
 m_pFBORayStartNext(nullptr),
 m_pFBOStartColor(nullptr),
@@ -80,6 +81,7 @@ void GridLeaper::deleteContext() {
   m_nearPlane = nullptr;
 
   m_resultBuffer = nullptr;
+  m_pixelReadback = nullptr;
   m_pFBORayStart = nullptr;
   m_pFBORayStartNext = nullptr;
   m_pFBOStartColor = nullptr;
@@ -412,6 +414,10 @@ void GridLeaper::initFrameBuffers() {
 	  GL_CLAMP_TO_EDGE, width, height,
 	  GL_RGBA, GL_RGBA,
 	  GL_UNSIGNED_BYTE, true, 1);
+
+  m_pixelReadback = mocca::make_unique<GLPixelReadback>(width, height,
+                                                        GL_RGBA,
+                                                        GL_UNSIGNED_BYTE);
 }
 
 void GridLeaper::initHashTable() {
@@ -512,6 +518,10 @@ void GridLeaper::paintInternal(PaintLevel paintlevel) {
       compose();
     }
   }
+
+  // no further frames will follow, so the last one has to be delivered now
+  if (m_isIdle) publishFrame(true);
+
   GL_CHECK_EXT();
 }
 
@@ -524,6 +534,17 @@ void GridLeaper::computeEyeToModelMatrix() {
 }
 
 
+void GridLeaper::viewChanged(bool bContinuous) {
+  if (!m_volumePool) return;
+  
+  // request the bricks of the views the interaction is heading for while
+  // the current one is rendered
+  computeEyeToModelMatrix();
+  m_volumePool->prefetchBricks(m_EyeToModelMatrix.inverse(), m_projection,
+                               m_fLODFactor, m_vExtend, bContinuous);
+}
+
+
 void GridLeaper::fillRayEntryBuffer() {
 #ifdef GLGRIDLEAPER_DEBUGVIEW
   m_targetBinder->bind(m_pFBOFinalColor, m_pFBOFinalColorNext, m_pFBOStartColor, m_pFBOStartColorNext);
@@ -634,18 +655,24 @@ void GridLeaper::compose(){
 
   GL_CHECK_EXT();
 
-  const uint32_t width = m_visStream->getStreamingParams().getResX();
-  const uint32_t height = m_visStream->getStreamingParams().getResY();
-
-  Frame frame(width * height * 4);
-  m_resultBuffer->ReadBackPixels(0, 0, width, height, frame.data());
+  // the pixels are fetched one of the next frames, meanwhile we keep rendering
+  m_pixelReadback->Read(*m_resultBuffer);
 
   GL_CHECK_EXT();
 
   m_targetBinder->Unbind();
   GL_CHECK_EXT();
 
-  getVisStream()->put(std::move(frame));
+  publishFrame(false);
+}
+
+void GridLeaper::publishFrame(bool bWait) {
+  Frame& frame = getVisStream()->beginPut();
+  frame.resize(m_pixelReadback->GetFrameSize());
+  if (m_pixelReadback->Fetch(frame.data(), bWait)) {
+    getVisStream()->endPut();
+  }
+  GL_CHECK_EXT();
 }
 
 
@@ -7,6 +7,7 @@
 #include "opengl-base/GLTexture1D.h"
 #include "opengl-base/GLTexture3D.h"
 #include "opengl-base/GLFrameBufferObject.h"
+#include "opengl-base/GLPixelReadback.h"
 #include "opengl-base/OpenGlHeadlessContext.h"
 #include "opengl-base/GLVolumeBox.h"
 #include "opengl-base/ShaderDescriptor.h"
@@ -40,6 +41,7 @@ namespace trinity {
     virtual void paintInternal(PaintLevel paintlevel) override;
     virtual void resizeFramebuffer() override;
     virtual void performClipping() override;
+    virtual void viewChanged(bool bContinuous) override;
     
   private:
     bool loadShaders(GLVolumePool::MissingBrickStrategy brickStrategy);
@@ -62,6 +64,7 @@ namespace trinity {
     void swapToNextBuffer();
     void selectShader();
     void setupRaycastShader();
+    void publishFrame(bool bWait);
     
     std::unique_ptr<GLTexture1D>      m_texTransferFunc;
     //	std::unique_ptr<GLTexture2D>      m_texTransfer2DFunc;
@@ -96,6 +99,7 @@ namespace trinity {
     
     //Buffers
     std::shared_ptr<GLRenderTexture>       m_resultBuffer;
+    std::unique_ptr<GLPixelReadback>       m_pixelReadback;
     std::shared_ptr<GLRenderTexture>       m_pFBORayStart;
     std::shared_ptr<GLRenderTexture>       m_pFBORayStartNext;
     std::shared_ptr<GLRenderTexture>       m_pFBOStartColor;
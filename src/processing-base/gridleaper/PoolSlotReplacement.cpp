@@ -0,0 +1,189 @@
+#include "PoolSlotReplacement.h"
+
+#include <cassert>
+
+namespace {
+
+// doubly linked list of the slots, the front is evicted first
+class LRUReplacement : public PoolSlotReplacement {
+public:
+  LRUReplacement(uint32_t iSlotCount, uint32_t iBrickCount) :
+  PoolSlotReplacement(iSlotCount, iBrickCount),
+  m_vPrev(iSlotCount + 1),
+  m_vNext(iSlotCount + 1),
+  m_iHead(iSlotCount)
+  {
+    // slot indices first, the sentinel closes the ring
+    for (uint32_t i = 0; i <= iSlotCount; ++i) {
+      m_vPrev[i] = i == 0 ? iSlotCount : i - 1;
+      m_vNext[i] = i == iSlotCount ? 0 : i + 1;
+    }
+  }
+
+protected:
+  void onInsert(uint32_t iSlot) override { moveToBack(iSlot); }
+  void onFlagEmpty(uint32_t iSlot) override { moveToFront(iSlot); }
+  void onRestore(uint32_t iSlot) override { moveToBack(iSlot); }
+  void onHit(uint32_t iSlot) override { moveToBack(iSlot); }
+  void onPin(uint32_t iSlot) override { unlink(iSlot); }
+
+  uint32_t pickVictim() override {
+    const uint32_t iFront = m_vNext[m_iHead];
+    // slots filled in this round are all behind the front
+    if (iFront == m_iHead || !isAvailable(iFront)) return none;
+    return iFront;
+  }
+
+private:
+  std::vector<uint32_t> m_vPrev;
+  std::vector<uint32_t> m_vNext;
+  const uint32_t m_iHead; // sentinel
+
+  void unlink(uint32_t iSlot) {
+    m_vNext[m_vPrev[iSlot]] = m_vNext[iSlot];
+    m_vPrev[m_vNext[iSlot]] = m_vPrev[iSlot];
+    m_vPrev[iSlot] = m_vNext[iSlot] = iSlot;
+  }
+
+  void linkAfter(uint32_t iSlot, uint32_t iPosition) {
+    m_vPrev[iSlot] = iPosition;
+    m_vNext[iSlot] = m_vNext[iPosition];
+    m_vPrev[m_vNext[iPosition]] = iSlot;
+    m_vNext[iPosition] = iSlot;
+  }
+
+  void moveToBack(uint32_t iSlot) { unlink(iSlot); linkAfter(iSlot, m_vPrev[m_iHead]); }
+  void moveToFront(uint32_t iSlot) { unlink(iSlot); linkAfter(iSlot, m_iHead); }
+};
+
+// clock hand over all slots, empty slots are handed out from a stack first
+class ClockReplacement : public PoolSlotReplacement {
+public:
+  ClockReplacement(uint32_t iSlotCount, uint32_t iBrickCount) :
+  PoolSlotReplacement(iSlotCount, iBrickCount),
+  m_vReferenced(iSlotCount, 0),
+  m_vFree(iSlotCount, 1),
+  m_vStacked(iSlotCount, 1),
+  m_iHand(0)
+  {
+    m_vFreeStack.reserve(iSlotCount);
+    for (uint32_t i = iSlotCount; i > 0; --i) {
+      m_vFreeStack.push_back(i - 1);
+    }
+  }
+
+protected:
+  void onInsert(uint32_t iSlot) override { m_vFree[iSlot] = 0; m_vReferenced[iSlot] = 0; }
+  void onFlagEmpty(uint32_t iSlot) override {
+    m_vFree[iSlot] = 1;
+    m_vReferenced[iSlot] = 0;
+    if (!m_vStacked[iSlot]) {
+      m_vStacked[iSlot] = 1;
+      m_vFreeStack.push_back(iSlot);
+    }
+  }
+  void onRestore(uint32_t iSlot) override { m_vFree[iSlot] = 0; m_vReferenced[iSlot] = 1; }
+  void onHit(uint32_t iSlot) override { m_vReferenced[iSlot] = 1; }
+  void onPin(uint32_t iSlot) override { m_vFree[iSlot] = 0; }
+
+  uint32_t pickVictim() override {
+    // stacked slots that were filled or restored meanwhile are dropped
+    while (!m_vFreeStack.empty()) {
+      const uint32_t iSlot = m_vFreeStack.back();
+      if (m_vFree[iSlot] && isAvailable(iSlot)) return iSlot;
+      m_vStacked[iSlot] = 0;
+      m_vFreeStack.pop_back();
+    }
+
+    // two sweeps clear all reference bits
+    const uint32_t iSlotCount = getSlotCount();
+    for (uint32_t i = 0; i < 2 * iSlotCount; ++i) {
+      const uint32_t iSlot = m_iHand;
+      m_iHand = (m_iHand + 1) % iSlotCount;
+      if (!isAvailable(iSlot)) continue;
+      if (m_vReferenced[iSlot]) {
+        m_vReferenced[iSlot] = 0;
+        continue;
+      }
+      return iSlot;
+    }
+    return none;
+  }
+
+private:
+  std::vector<uint8_t>  m_vReferenced;
+  std::vector<uint8_t>  m_vFree;
+  std::vector<uint8_t>  m_vStacked;
+  std::vector<uint32_t> m_vFreeStack;
+  uint32_t m_iHand;
+};
+
+}
+
+const uint32_t PoolSlotReplacement::none;
+
+std::unique_ptr<PoolSlotReplacement> PoolSlotReplacement::create(Policy ePolicy,
+                                                                 uint32_t iSlotCount,
+                                                                 uint32_t iBrickCount) {
+  switch (ePolicy) {
+    case CLOCK:
+      return std::unique_ptr<PoolSlotReplacement>(new ClockReplacement(iSlotCount, iBrickCount));
+    case LRU:
+    default:
+      return std::unique_ptr<PoolSlotReplacement>(new LRUReplacement(iSlotCount, iBrickCount));
+  }
+}
+
+PoolSlotReplacement::PoolSlotReplacement(uint32_t iSlotCount, uint32_t iBrickCount) :
+m_vSlotOfBrick(iBrickCount, none),
+m_vBrickOfSlot(iSlotCount, none),
+m_vRound(iSlotCount, 0),
+m_vPinned(iSlotCount, 0),
+m_iRound(1),
+m_counters()
+{
+}
+
+uint32_t PoolSlotReplacement::nextSlot() {
+  const uint32_t iSlot = pickVictim();
+  return iSlot == none ? getSlotCount() : iSlot;
+}
+
+void PoolSlotReplacement::insert(uint32_t iSlot, uint32_t iBrickID) {
+  assert(iSlot < getSlotCount() && iBrickID < m_vSlotOfBrick.size());
+  const uint32_t iOldBrickID = m_vBrickOfSlot[iSlot];
+  if (iOldBrickID != none) {
+    // the brick may have been paged in again into another slot
+    if (m_vSlotOfBrick[iOldBrickID] == iSlot) m_vSlotOfBrick[iOldBrickID] = none;
+    ++m_counters.iEvictions;
+  }
+  m_vBrickOfSlot[iSlot] = iBrickID;
+  m_vSlotOfBrick[iBrickID] = iSlot;
+  m_vRound[iSlot] = m_iRound;
+  if (!m_vPinned[iSlot]) onInsert(iSlot);
+}
+
+void PoolSlotReplacement::pin(uint32_t iSlot) {
+  if (m_vPinned[iSlot]) return;
+  m_vPinned[iSlot] = 1;
+  onPin(iSlot);
+}
+
+void PoolSlotReplacement::flagEmpty(uint32_t iSlot) {
+  if (!m_vPinned[iSlot]) onFlagEmpty(iSlot);
+}
+
+void PoolSlotReplacement::restore(uint32_t iSlot) {
+  if (!m_vPinned[iSlot]) onRestore(iSlot);
+}
+
+uint32_t PoolSlotReplacement::request(uint32_t iBrickID) {
+  const uint32_t iSlot = m_vSlotOfBrick[iBrickID];
+  if (iSlot == none) {
+    ++m_counters.iMisses;
+    return getSlotCount();
+  }
+  ++m_counters.iHits;
+  if (!m_vPinned[iSlot]) onHit(iSlot);
+  return iSlot;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Replacement policy of the GLVolumePool brick pool. It knows which brick
+// occupies which slot and hands out the slots to overwrite one at a time,
+// unused and empty slots first, so a paging round never has to order all
+// slots. Slots keep their index (i.e. their position in the pool) forever.
+class PoolSlotReplacement {
+public:
+  enum Policy {
+    LRU,   // evicts the brick that was uploaded or restored least recently
+    CLOCK  // second chance, bricks requested while resident are kept longer
+  };
+
+  struct Counters {
+    uint64_t iHits;      // requested bricks that were still resident
+    uint64_t iMisses;    // requested bricks that had to be paged in
+    uint64_t iEvictions; // bricks overwritten by other bricks
+  };
+
+  static std::unique_ptr<PoolSlotReplacement> create(Policy ePolicy,
+                                                     uint32_t iSlotCount,
+                                                     uint32_t iBrickCount);
+  virtual ~PoolSlotReplacement() {}
+
+  // starts a paging round, a slot filled within a round is not handed out
+  // again in the same round
+  void beginRound() { ++m_iRound; }
+  // @return slot that receives the next brick or getSlotCount() if all
+  //         slots were filled in this round
+  uint32_t nextSlot();
+  // iBrickID now occupies iSlot, the previous brick of the slot is evicted
+  void insert(uint32_t iSlot, uint32_t iBrickID);
+  // the slot is never handed out again
+  void pin(uint32_t iSlot);
+  // the brick of the slot became invisible, its slot is handed out first
+  void flagEmpty(uint32_t iSlot);
+  // the brick of a flagged slot became visible again
+  void restore(uint32_t iSlot);
+  // looks up a requested brick and counts a hit or a miss
+  // @return slot of the brick or getSlotCount() if it is not resident
+  uint32_t request(uint32_t iBrickID);
+
+  uint32_t getSlotCount() const { return uint32_t(m_vBrickOfSlot.size()); }
+  const Counters& getCounters() const { return m_counters; }
+
+protected:
+  PoolSlotReplacement(uint32_t iSlotCount, uint32_t iBrickCount);
+
+  // policy specific bookkeeping, slots handed to the hooks are never pinned
+  virtual void onInsert(uint32_t iSlot) = 0;
+  virtual void onFlagEmpty(uint32_t iSlot) = 0;
+  virtual void onRestore(uint32_t iSlot) = 0;
+  virtual void onHit(uint32_t iSlot) = 0;
+  virtual void onPin(uint32_t iSlot) = 0;
+  // @return victim that is neither pinned nor filled in this round, or
+  //         none if there is no such slot
+  virtual uint32_t pickVictim() = 0;
+
+  bool isAvailable(uint32_t iSlot) const {
+    return !m_vPinned[iSlot] && m_vRound[iSlot] != m_iRound;
+  }
+
+  static const uint32_t none = uint32_t(-1);
+
+private:
+  std::vector<uint32_t> m_vSlotOfBrick; // ref by brick ID
+  std::vector<uint32_t> m_vBrickOfSlot;
+  std::vector<uint64_t> m_vRound;       // round in which the slot was filled
+  std::vector<uint8_t>  m_vPinned;
+  uint64_t m_iRound;
+  Counters m_counters;
+};
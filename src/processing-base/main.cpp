@@ -12,6 +12,7 @@
 #include "mocca/net/ConnectionFactorySelector.h"
 #include "mocca/net/Endpoint.h"
 
+#include "common/HostBrickCache.h"
 #include "processing-base/ProcessingNode.h"
 
 #include <silverbullet/base/DetectEnv.h>
@@ -43,6 +44,22 @@ mocca::CommandLineParser::Option WsPortOption(int16_t& port) {
     return option;
 }
 
+mocca::CommandLineParser::Option BrickCacheSizeOption(uint64_t& megabytes) {
+    mocca::CommandLineParser::Option option;
+    option.key = "--BrickCacheMB";
+    option.help = "host memory for bricks received from IO nodes in MB, shared by all datasets, 0 disables the cache (default: 1024)";
+    option.callback = [&](const std::string& value) { megabytes = std::stoull(value); };
+    return option;
+}
+
+mocca::CommandLineParser::Option BrickCacheLz4Option(bool& compress) {
+    mocca::CommandLineParser::Option option;
+    option.key = "--BrickCacheLz4";
+    option.help = "LZ4 compress the bricks in the host memory cache, 0 or 1 (default: 0)";
+    option.callback = [&](const std::string& value) { compress = std::stoi(value) != 0; };
+    return option;
+}
+
 void init() {
     using mocca::LogManager;
     LogManager::initialize(LogManager::LogLevel::Debug, true);
@@ -61,10 +78,14 @@ int main(int argc, const char** argv) {
 
     int16_t TcpPort = 8678;
     int16_t WsPort = 8679;
+    uint64_t brickCacheMB = HostBrickCache::defaultBudget >> 20;
+    bool brickCacheLz4 = false;
 
     mocca::CommandLineParser parser;
     parser.addOption(TcpPortOption(TcpPort));
     parser.addOption(WsPortOption(WsPort));
+    parser.addOption(BrickCacheSizeOption(brickCacheMB));
+    parser.addOption(BrickCacheLz4Option(brickCacheLz4));
 
     try {
         parser.parse(argc, argv);
@@ -73,6 +94,7 @@ int main(int argc, const char** argv) {
         std::cerr << err.what() << std::endl;
         std::exit(0);
     }
+    HostBrickCache::setDefaults(brickCacheMB << 20, brickCacheLz4);
 
     // endpoints
     Endpoint e1(ConnectionFactorySelector::tcpPrefixed(), "localhost", std::to_string(TcpPort));
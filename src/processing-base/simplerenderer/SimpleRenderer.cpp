@@ -282,15 +282,18 @@ void SimpleRenderer::paintInternal(PaintLevel paintlevel) {
 
         m_backfaceBuffer->FinishRead();
         // auto t1 = std::chrono::high_resolution_clock::now();
-        Frame frame(width * height * 4);
+        Frame& frame = getVisStream()->beginPut();
+        frame.resize(width * height * 4);
         m_resultBuffer->ReadBackPixels(0, 0, width, height, frame.data());
         // auto t2 = std::chrono::high_resolution_clock::now();
         // LINFO("Time " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count());
 
         m_targetBinder->Unbind();
-        getVisStream()->put(std::move(frame));
+        getVisStream()->endPut();
     } else {
-        getVisStream()->put(Frame());
+        // an empty frame, the recycled buffer keeps its storage for the next one
+        getVisStream()->beginPut().clear();
+        getVisStream()->endPut();
     }
 }
 
@@ -117,6 +117,10 @@ namespace Core {
       
       bool isDirectory(const std::string& name);
       bool isDirectory(const std::wstring& name);
+
+      // moves source to target, unlike std::rename this replaces an existing
+      // target on all platforms
+      bool replaceFile(const std::string& source, const std::string& target);
     }
   }
 }
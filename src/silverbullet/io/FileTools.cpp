@@ -2,6 +2,7 @@
 
 #include <iterator> // back_inserter
 #include <algorithm> // transform
+#include <cstdio> // rename
  
 
 #ifndef DETECTED_OS_WINDOWS
@@ -878,6 +879,15 @@ namespace Core {
         getFileStats(name, stat_buf);
         return S_ISDIR(stat_buf.st_mode);
       }
+
+      bool replaceFile(const std::string& source, const std::string& target) {
+#ifdef DETECTED_OS_WINDOWS
+        return MoveFileExA(source.c_str(), target.c_str(),
+                           MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return std::rename(source.c_str(), target.c_str()) == 0;
+#endif
+      }
       
     }
   }
@@ -0,0 +1,73 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "commands/BinaryFrame.h"
+#include "commands/JsonReader.h"
+#include "common/MemBlockPool.h"
+#include "common/TrinityError.h"
+
+#include "lz4/lz4.h"
+
+using namespace trinity;
+
+class BinaryFrameTest : public ::testing::Test {
+protected:
+    static std::vector<uint8_t> createFrame(BinaryCodec codec, uint64_t uncompressedSize, const std::vector<uint8_t>& payload) {
+        std::vector<uint8_t> frame(BinaryFrameHeader::size);
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        BinaryFrameHeader{codec, {}, uncompressedSize}.write(frame);
+        return frame;
+    }
+
+    static std::vector<uint8_t> compressLZ4(const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> compressed(LZ4_compressBound(static_cast<int>(data.size())));
+        const int size = LZ4_compress_limitedOutput(reinterpret_cast<const char*>(data.data()), reinterpret_cast<char*>(compressed.data()),
+                                                    static_cast<int>(data.size()), static_cast<int>(compressed.size()));
+        compressed.resize(size);
+        return compressed;
+    }
+};
+
+TEST_F(BinaryFrameTest, DecodesValidFrames) {
+    std::vector<uint8_t> data(10000);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = uint8_t(i % 17);
+    }
+    ASSERT_EQ(data, *decodeBinaryFrame(createFrame(BinaryCodec::None, data.size(), data), BinaryFrameHeader::defaultMaxSize));
+    ASSERT_EQ(data, *decodeBinaryFrame(createFrame(BinaryCodec::LZ4, data.size(), compressLZ4(data)), BinaryFrameHeader::defaultMaxSize));
+    // a frame of exactly the bound is accepted
+    ASSERT_EQ(data, *decodeBinaryFrame(createFrame(BinaryCodec::None, data.size(), data), data.size()));
+}
+
+// the size in the header comes from the wire, a frame announcing more than the bound must not get its memory
+TEST_F(BinaryFrameTest, RejectsOversizedFramesBeforeAllocating) {
+    const std::vector<uint8_t> payload(100, 1);
+    auto& pool = MemBlockPool::instance();
+    const auto before = pool.getStatistics();
+    for (auto codec : {BinaryCodec::None, BinaryCodec::Blosc, BinaryCodec::LZ4, BinaryCodec::LZMA}) {
+        ASSERT_THROW(decodeBinaryFrame(createFrame(codec, BinaryFrameHeader::defaultMaxSize + 1, payload), BinaryFrameHeader::defaultMaxSize),
+                     TrinityError);
+        ASSERT_THROW(decodeBinaryFrame(createFrame(codec, UINT64_MAX, payload), BinaryFrameHeader::defaultMaxSize), TrinityError);
+        ASSERT_THROW(decodeBinaryFrame(createFrame(codec, 101, payload), 100), TrinityError);
+    }
+    const auto after = pool.getStatistics();
+    ASSERT_EQ(before.allocations, after.allocations);
+    ASSERT_EQ(before.usedBytes, after.usedBytes);
+}
+
+TEST_F(BinaryFrameTest, RejectsUncompressedFramesOfWrongSize) {
+    const std::vector<uint8_t> payload(100, 1);
+    ASSERT_THROW(decodeBinaryFrame(createFrame(BinaryCodec::None, 101, payload), 1000), TrinityError);
+    ASSERT_THROW(decodeBinaryFrame(createFrame(BinaryCodec::None, 99, payload), 1000), TrinityError);
+}
+
+TEST_F(BinaryFrameTest, ReaderAppliesItsBound) {
+    const auto payload = std::make_shared<std::vector<uint8_t>>(createFrame(BinaryCodec::None, 100, std::vector<uint8_t>(100, 1)));
+    BinaryFramedReader reader(100);
+    ASSERT_EQ(size_t(100), reader.read(payload)->size());
+    BinaryFramedReader smallReader(99);
+    ASSERT_THROW(smallReader.read(payload), TrinityError);
+}
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "io-base/fractal/BrickCacher.h"
+
+class BrickCacherTest : public ::testing::Test {
+protected:
+    BrickCacherTest() { removeFiles(); }
+    virtual ~BrickCacherTest() { removeFiles(); }
+
+    const std::string m_prefix = "BrickCacherTest";
+    const std::string m_ext = "testCache";
+
+    std::string dataFilename() const { return "./" + m_prefix + "." + m_ext + "Data"; }
+    std::string indexFilename() const { return "./" + m_prefix + "." + m_ext + "Index"; }
+
+    void removeFiles() {
+        std::remove(dataFilename().c_str());
+        std::remove(indexFilename().c_str());
+    }
+
+    static std::vector<uint8_t> randomBrick(size_t size, unsigned seed) {
+        std::mt19937 generator(seed);
+        std::vector<uint8_t> brick(size);
+        for (auto& value : brick) {
+            value = uint8_t(generator() % 200 + 10);
+        }
+        return brick;
+    }
+
+    static uint64_t fileSize(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        return uint64_t(file.tellg());
+    }
+};
+
+TEST_F(BrickCacherTest, StoresBricksAndRanges) {
+    BrickCacher cacher(".", m_prefix, m_ext);
+    const BrickKey key(0, 0, 1, 2);
+    const auto brick = randomBrick(1000, 1);
+    const std::vector<uint8_t> constant(5000, 42);
+    ASSERT_TRUE(cacher.setBrick<uint8_t>(key, brick));
+    ASSERT_TRUE(cacher.setBrick<uint8_t>(BrickKey(0, 0, 1, 3), constant));
+    ASSERT_FALSE(cacher.setBrick<uint8_t>(key, constant));
+
+    std::vector<uint8_t> result;
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(key, result));
+    ASSERT_EQ(brick, result);
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 1, 3), result));
+    ASSERT_EQ(constant, result);
+    ASSERT_FALSE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 1, 4), result));
+
+    uint8_t min, max;
+    ASSERT_TRUE(cacher.getMaxMin(key, min, max));
+    ASSERT_EQ(*std::min_element(brick.begin(), brick.end()), min);
+    ASSERT_EQ(*std::max_element(brick.begin(), brick.end()), max);
+
+    // the constant brick is compressed
+    ASSERT_LT(fileSize(dataFilename()), 2000u);
+}
+
+TEST_F(BrickCacherTest, PersistsAcrossInstances) {
+    const auto brick = randomBrick(1000, 2);
+    {
+        BrickCacher cacher(".", m_prefix, m_ext);
+        ASSERT_TRUE(cacher.setBrick<uint8_t>(BrickKey(0, 0, 0, 7), brick));
+    }
+    BrickCacher cacher(".", m_prefix, m_ext);
+    std::vector<uint8_t> result;
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 7), result));
+    ASSERT_EQ(brick, result);
+}
+
+TEST_F(BrickCacherTest, EvictsLeastRecentlyUsedBricks) {
+    BrickCacher cacher(".", m_prefix, m_ext, 3500, false);
+    for (uint64_t i = 0; i < 3; ++i) {
+        ASSERT_TRUE(cacher.setBrick<uint8_t>(BrickKey(0, 0, 0, i), randomBrick(1000, unsigned(i))));
+    }
+    std::vector<uint8_t> result;
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 0), result));
+    ASSERT_TRUE(cacher.setBrick<uint8_t>(BrickKey(0, 0, 0, 3), randomBrick(1000, 3)));
+
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 0), result));
+    ASSERT_FALSE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 1), result));
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 2), result));
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 3), result));
+}
+
+TEST_F(BrickCacherTest, ReclaimsSpaceOfEvictedBricks) {
+    BrickCacher cacher(".", m_prefix, m_ext, 10000, false);
+    for (uint64_t i = 0; i < 100; ++i) {
+        ASSERT_TRUE(cacher.setBrick<uint8_t>(BrickKey(0, 0, 0, i), randomBrick(1000, unsigned(i))));
+    }
+    ASSERT_LE(fileSize(dataFilename()), 20000u);
+    std::vector<uint8_t> result;
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 99), result));
+    ASSERT_EQ(randomBrick(1000, 99), result);
+}
+
+TEST_F(BrickCacherTest, RecoversFromDamagedFiles) {
+    const auto brick = randomBrick(1000, 4);
+    {
+        BrickCacher cacher(".", m_prefix, m_ext, 1 << 20, false);
+        ASSERT_TRUE(cacher.setBrick<uint8_t>(BrickKey(0, 0, 0, 0), brick));
+        ASSERT_TRUE(cacher.setBrick<uint8_t>(BrickKey(0, 0, 0, 1), randomBrick(1000, 5)));
+    }
+    // a crash while appending the second brick, before the index was written
+    std::vector<char> data(size_t(fileSize(dataFilename())));
+    std::ifstream(dataFilename(), std::ios::binary).read(data.data(), data.size());
+    data.resize(data.size() - 10);
+    std::ofstream(dataFilename(), std::ios::binary | std::ios::trunc).write(data.data(), data.size());
+    std::remove(indexFilename().c_str());
+
+    BrickCacher cacher(".", m_prefix, m_ext, 1 << 20, false);
+    std::vector<uint8_t> result;
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 0), result));
+    ASSERT_EQ(brick, result);
+    ASSERT_FALSE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 1), result));
+    ASSERT_TRUE(cacher.setBrick<uint8_t>(BrickKey(0, 0, 0, 1), brick));
+    ASSERT_TRUE(cacher.getBrick<uint8_t>(BrickKey(0, 0, 0, 1), result));
+    ASSERT_EQ(brick, result);
+}
+
+TEST_F(BrickCacherTest, SharesInstancesPerFile) {
+    const auto first = randomBrick(1000, 6);
+    const auto second = randomBrick(1000, 7);
+    {
+        // e.g. the FractalIOs of two sessions on the same dataset
+        auto a = BrickCacher::shared(".", m_prefix, m_ext);
+        auto b = BrickCacher::shared("./", m_prefix, m_ext);
+        ASSERT_EQ(a, b);
+        ASSERT_NE(a, BrickCacher::shared(".", m_prefix, m_ext + "Other"));
+
+        ASSERT_TRUE(a->setBrick<uint8_t>(BrickKey(0, 0, 0, 1), first));
+        ASSERT_TRUE(b->setBrick<uint8_t>(BrickKey(0, 0, 0, 2), second));
+        std::vector<uint8_t> result;
+        ASSERT_TRUE(b->getBrick<uint8_t>(BrickKey(0, 0, 0, 1), result));
+        ASSERT_EQ(first, result);
+    }
+    auto cacher = BrickCacher::shared(".", m_prefix, m_ext);
+    std::vector<uint8_t> result;
+    ASSERT_TRUE(cacher->getBrick<uint8_t>(BrickKey(0, 0, 0, 1), result));
+    ASSERT_EQ(first, result);
+    ASSERT_TRUE(cacher->getBrick<uint8_t>(BrickKey(0, 0, 0, 2), result));
+    ASSERT_EQ(second, result);
+}
@@ -0,0 +1,147 @@
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "processing-base/gridleaper/BrickPrefetcher.h"
+
+using namespace Core::Math;
+
+class BrickPrefetcherTest : public ::testing::Test {
+protected:
+    // brick layouts of all LoDs down to a single brick
+    static std::vector<Vec3ui> layouts(Vec3ui base) {
+        std::vector<Vec3ui> result{base};
+        while (base.volume() > 1) {
+            base = Vec3ui((base.x + 1) / 2, (base.y + 1) / 2, (base.z + 1) / 2);
+            result.push_back(base);
+        }
+        return result;
+    }
+
+    // the shader layouts are slightly smaller than the integer ones
+    static std::vector<Vec3f> floatLayouts(const std::vector<Vec3ui>& vLayouts) {
+        std::vector<Vec3f> result;
+        for (const auto& layout : vLayouts) {
+            result.push_back(Vec3f(layout) * (1.0f - std::numeric_limits<float>::epsilon()));
+        }
+        return result;
+    }
+
+    // looks down the negative z-axis at (x, 0.5, 0.5) of the normalized volume from the given distance
+    static Mat4f view(float x, float distance) {
+        Mat4f center, back;
+        center.Translation(-x, -0.5f, -0.5f);
+        back.Translation(0.0f, 0.0f, -distance);
+        return center * back;
+    }
+
+    static BrickPrefetcher create(const std::vector<Vec3ui>& vLayouts) {
+        BrickPrefetcher prefetcher(vLayouts, floatLayouts(vLayouts));
+        Mat4f projection;
+        projection.Perspective(45.0f, 1.0f, 0.01f, 100.0f);
+        prefetcher.setProjection(projection, 1.0f, 1.0f);
+        return prefetcher;
+    }
+
+    static BrickPrefetcher::Decision requestAll(const Vec4ui&) { return BrickPrefetcher::BD_REQUEST; }
+};
+
+TEST_F(BrickPrefetcherTest, NoPredictionWithoutMotion) {
+    auto prefetcher = create(layouts(Vec3ui(4, 4, 4)));
+    prefetcher.addView(view(0.5f, 1.0f), true);
+    ASSERT_FALSE(prefetcher.hasMotion());
+    ASSERT_TRUE(prefetcher.predict(requestAll, 100).empty());
+
+    prefetcher.addView(view(0.6f, 1.0f), false);
+    ASSERT_FALSE(prefetcher.hasMotion());
+    ASSERT_TRUE(prefetcher.predict(requestAll, 100).empty());
+
+    prefetcher.addView(view(0.7f, 1.0f), true);
+    ASSERT_TRUE(prefetcher.hasMotion());
+    ASSERT_FALSE(prefetcher.predict(requestAll, 100).empty());
+}
+
+TEST_F(BrickPrefetcherTest, BricksComeIntoView) {
+    // a row of bricks the camera moves along, nothing is visible yet
+    auto prefetcher = create({Vec3ui(8, 1, 1)});
+    prefetcher.addView(view(-1.0f, 1.0f), true);
+    prefetcher.addView(view(-0.75f, 1.0f), true);
+    const auto predicted = prefetcher.predict(requestAll, 100);
+
+    ASSERT_FALSE(predicted.empty());
+    ASSERT_EQ(Vec4ui(0, 0, 0, 0), predicted.front().vBrickID);
+    ASSERT_EQ(1u, predicted.front().iStep);
+    for (size_t i = 1; i < predicted.size(); ++i) {
+        ASSERT_LE(predicted[i - 1].iStep, predicted[i].iStep);
+    }
+    // still out of view after four more steps of the camera
+    for (const auto& prediction : predicted) {
+        ASSERT_NE(7u, prediction.vBrickID.x);
+    }
+}
+
+TEST_F(BrickPrefetcherTest, DistanceSelectsLoD) {
+    const auto vLayouts = layouts(Vec3ui(4, 4, 4));
+    auto nearPrefetcher = create(vLayouts);
+    nearPrefetcher.addView(view(0.5f, 1.0f), true);
+    nearPrefetcher.addView(view(0.55f, 1.0f), true);
+    const auto nearBricks = nearPrefetcher.predict(requestAll, 1000);
+    ASSERT_FALSE(nearBricks.empty());
+    for (const auto& prediction : nearBricks) {
+        ASSERT_EQ(0u, prediction.vBrickID.w);
+    }
+
+    auto farPrefetcher = create(vLayouts);
+    farPrefetcher.addView(view(0.5f, 10.0f), true);
+    farPrefetcher.addView(view(0.55f, 10.0f), true);
+    const auto farBricks = farPrefetcher.predict(requestAll, 1000);
+    ASSERT_EQ(1u, farBricks.size());
+    ASSERT_EQ(Vec4ui(0, 0, 0, 2), farBricks.front().vBrickID);
+}
+
+TEST_F(BrickPrefetcherTest, ClassifierAndLimit) {
+    auto prefetcher = create(layouts(Vec3ui(4, 4, 4)));
+    prefetcher.addView(view(0.5f, 1.0f), true);
+    prefetcher.addView(view(0.55f, 1.0f), true);
+
+    ASSERT_EQ(3u, prefetcher.predict(requestAll, 3).size());
+
+    auto skipCoarsest = [](const Vec4ui& vBrickID) {
+        return vBrickID.w == 2 ? BrickPrefetcher::BD_SKIP_SUBTREE : BrickPrefetcher::BD_REQUEST;
+    };
+    ASSERT_TRUE(prefetcher.predict(skipCoarsest, 1000).empty());
+
+    auto skipFirst = [](const Vec4ui& vBrickID) {
+        return vBrickID == Vec4ui(1, 1, 1, 0) ? BrickPrefetcher::BD_SKIP : BrickPrefetcher::BD_REQUEST;
+    };
+    const auto all = prefetcher.predict(requestAll, 1000);
+    const auto skipped = prefetcher.predict(skipFirst, 1000);
+    ASSERT_EQ(all.size() - 1, skipped.size());
+    for (const auto& prediction : skipped) {
+        ASSERT_NE(Vec4ui(1, 1, 1, 0), prediction.vBrickID);
+    }
+}
+
+// the footprint orders the requests of the visible bricks
+TEST_F(BrickPrefetcherTest, ScreenFootprint) {
+    auto prefetcher = create(layouts(Vec3ui(4, 4, 4)));
+    ASSERT_EQ(1.0f, prefetcher.screenFootprint(Vec4ui(0, 0, 0, 0)));
+
+    prefetcher.addView(view(0.5f, 2.0f), true);
+    // the view looks along the negative z-axis, so bricks with a larger z are nearer
+    const float nearBrick = prefetcher.screenFootprint(Vec4ui(1, 1, 3, 0));
+    const float farBrick = prefetcher.screenFootprint(Vec4ui(1, 1, 0, 0));
+    const float coarseBrick = prefetcher.screenFootprint(Vec4ui(0, 0, 0, 1));
+    ASSERT_GT(nearBrick, 0.0f);
+    ASSERT_GT(nearBrick, farBrick);
+    ASSERT_GT(coarseBrick, nearBrick);
+    ASSERT_LE(prefetcher.screenFootprint(Vec4ui(0, 0, 0, 2)), 1.0f);
+
+    // a brick beside the view has no footprint, one reaching behind the eye covers the screen
+    prefetcher.addView(view(3.0f, 0.3f), true);
+    ASSERT_EQ(0.0f, prefetcher.screenFootprint(Vec4ui(0, 0, 0, 0)));
+    prefetcher.addView(view(0.5f, 0.1f), true);
+    ASSERT_EQ(1.0f, prefetcher.screenFootprint(Vec4ui(1, 1, 2, 0)));
+}
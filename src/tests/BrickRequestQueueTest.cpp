@@ -0,0 +1,178 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "processing-base/gridleaper/BrickRequestQueue.h"
+
+using namespace Core::Math;
+
+class BrickRequestQueueTest : public ::testing::Test {
+protected:
+    static BrickRequest request(uint32_t x, uint32_t lod, float importance = 1.0f) {
+        return BrickRequest{Vec4ui(x, 0, 0, lod), BrickKey(0, 0, lod, x), importance, false};
+    }
+
+    static std::vector<uint64_t> popIndices(BrickRequestQueue& queue, size_t count) {
+        std::vector<uint64_t> result;
+        for (const auto& popped : queue.pop(count, [] { return false; })) {
+            result.push_back(popped.key.index);
+        }
+        return result;
+    }
+};
+
+TEST_F(BrickRequestQueueTest, ServesCoarseLoDsAndImportantBricksFirst) {
+    BrickRequestQueue queue;
+    ASSERT_EQ(4u, queue.push({request(0, 0, 1.0f), request(1, 1, 1.0f), request(2, 0, 5.0f), request(3, 0, 1.0f)}));
+
+    const auto popped = queue.pop(10, [] { return false; });
+    ASSERT_EQ(4u, popped.size());
+    ASSERT_EQ(1u, popped[0].key.index);
+    ASSERT_EQ(2u, popped[1].key.index);
+    // equal priorities in request order
+    ASSERT_EQ(0u, popped[2].key.index);
+    ASSERT_EQ(3u, popped[3].key.index);
+    ASSERT_EQ(0u, queue.getQueuedCount());
+    ASSERT_EQ(4u, queue.getInFlightCount());
+}
+
+TEST_F(BrickRequestQueueTest, RejectsDuplicateRequests) {
+    BrickRequestQueue queue;
+    ASSERT_EQ(2u, queue.push({request(0, 0), request(1, 0)}));
+    ASSERT_EQ(0u, queue.push({request(0, 0), request(1, 0)}));
+    ASSERT_EQ(2u, queue.getQueuedCount());
+
+    // in flight and delivered bricks are not requested again until they are released
+    ASSERT_EQ(1u, popIndices(queue, 1).size());
+    ASSERT_EQ(0u, queue.push({request(0, 0), request(1, 0)}));
+    ASSERT_TRUE(queue.finish(request(0, 0), true));
+    ASSERT_EQ(0u, queue.push({request(0, 0)}));
+    queue.release(request(0, 0).key);
+    ASSERT_EQ(1u, queue.push({request(0, 0)}));
+}
+
+TEST_F(BrickRequestQueueTest, ReprioritizesQueuedRequests) {
+    BrickRequestQueue queue;
+    queue.push({request(0, 0, 1.0f), request(1, 0, 2.0f)});
+    queue.push({request(0, 0, 3.0f), request(1, 0, 2.0f)});
+    ASSERT_EQ(std::vector<uint64_t>({0, 1}), popIndices(queue, 10));
+}
+
+TEST_F(BrickRequestQueueTest, CancelsStaleRequests) {
+    BrickRequestQueue queue(1);
+    queue.push({request(0, 0), request(1, 0)});
+    ASSERT_EQ(std::vector<uint64_t>({0}), popIndices(queue, 1));
+
+    // neither brick is requested for more than one round
+    queue.push({});
+    ASSERT_EQ(1u, queue.getQueuedCount());
+    queue.push({});
+    ASSERT_EQ(0u, queue.getQueuedCount());
+
+    // the data of the canceled in flight request is discarded
+    ASSERT_FALSE(queue.finish(request(0, 0), true));
+    ASSERT_EQ(0u, queue.getInFlightCount());
+    ASSERT_EQ(2u, queue.push({request(0, 0), request(1, 0)}));
+}
+
+TEST_F(BrickRequestQueueTest, RepeatedRequestsKeepInFlightData) {
+    BrickRequestQueue queue(0);
+    queue.push({request(0, 0)});
+    popIndices(queue, 1);
+    queue.cancelAll();
+    queue.push({request(0, 0)});
+    ASSERT_TRUE(queue.finish(request(0, 0), true));
+}
+
+TEST_F(BrickRequestQueueTest, RetriesFailedRequests) {
+    BrickRequestQueue queue;
+    queue.push({request(0, 0)});
+    popIndices(queue, 1);
+    ASSERT_FALSE(queue.finish(request(0, 0), false));
+    ASSERT_EQ(1u, queue.push({request(0, 0)}));
+}
+
+TEST_F(BrickRequestQueueTest, CancelsAllRequests) {
+    BrickRequestQueue queue;
+    queue.push({request(0, 0), request(1, 0), request(2, 0)});
+    popIndices(queue, 1);
+    queue.cancelAll();
+    ASSERT_EQ(0u, queue.getQueuedCount());
+    ASSERT_TRUE(popIndices(queue, 10).empty());
+    ASSERT_FALSE(queue.finish(request(0, 0), true));
+}
+
+TEST_F(BrickRequestQueueTest, ServesSpeculativeRequestsLast) {
+    BrickRequestQueue queue;
+    queue.push({request(0, 1)});
+    ASSERT_EQ(2u, queue.prefetch({request(1, 2, 10.0f), request(2, 2, 1.0f)}));
+    // prefetching never demotes a regular request
+    ASSERT_EQ(0u, queue.prefetch({request(0, 1)}));
+    queue.push({request(0, 1), request(3, 0)});
+    ASSERT_EQ(std::vector<uint64_t>({0, 3, 1, 2}), popIndices(queue, 10));
+
+    // a regular request for a queued speculative brick promotes it
+    queue.prefetch({request(4, 2)});
+    queue.push({request(5, 0), request(4, 2)});
+    ASSERT_EQ(std::vector<uint64_t>({4, 5}), popIndices(queue, 10));
+}
+
+TEST_F(BrickRequestQueueTest, PopWaitsForRequests) {
+    BrickRequestQueue queue;
+    ASSERT_TRUE(queue.pop(10, [] { return false; }).empty());
+
+    std::atomic<bool> keepWaiting(true);
+    std::vector<BrickRequest> popped;
+    std::thread getter([&] { popped = queue.pop(10, [&] { return keepWaiting.load(); }); });
+    queue.push({request(0, 0)});
+    getter.join();
+    ASSERT_EQ(1u, popped.size());
+
+    std::thread idleGetter([&] { popped = queue.pop(10, [&] { return keepWaiting.load(); }); });
+    keepWaiting = false;
+    queue.wakeAll();
+    idleGetter.join();
+    ASSERT_TRUE(popped.empty());
+}
+
+TEST_F(BrickRequestQueueTest, ServesEveryRequestOnceToConcurrentGetters) {
+    BrickRequestQueue queue(1000);
+    const uint32_t requestCount = 10000;
+    std::atomic<bool> pushing(true);
+    std::vector<std::vector<uint64_t>> served(4);
+    std::vector<std::thread> getters;
+    for (size_t t = 0; t < served.size(); ++t) {
+        getters.emplace_back([&, t] {
+            for (;;) {
+                const auto popped = queue.pop(16, [&] { return pushing.load(); });
+                if (popped.empty() && !pushing) break;
+                for (const auto& r : popped) {
+                    served[t].push_back(r.key.index);
+                    queue.finish(r, true);
+                }
+            }
+        });
+    }
+    for (uint32_t i = 0; i < requestCount; i += 100) {
+        std::vector<BrickRequest> round;
+        for (uint32_t j = i; j < i + 100; ++j) {
+            round.push_back(request(j, j % 3, float(j % 7)));
+        }
+        queue.push(round);
+    }
+    while (queue.getQueuedCount() > 0) std::this_thread::yield();
+    pushing = false;
+    queue.wakeAll();
+    for (auto& getter : getters) getter.join();
+
+    std::vector<int> counts(requestCount);
+    for (const auto& indices : served) {
+        for (auto index : indices) ++counts[size_t(index)];
+    }
+    for (uint32_t i = 0; i < requestCount; ++i) {
+        ASSERT_EQ(1, counts[i]) << "request " << i;
+    }
+    ASSERT_EQ(0u, queue.getInFlightCount());
+}
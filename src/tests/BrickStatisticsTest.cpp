@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/BrickStatistics.h"
+#include "io-base/uvf/Dataset/UVF-File/RasterDataBlock.h"
+
+using namespace trinity;
+
+class BrickStatisticsTest : public ::testing::Test {
+protected:
+    virtual ~BrickStatisticsTest() { setSimdLevel(supportedSimdLevel()); }
+
+    static std::vector<SimdLevel> levels() {
+        std::vector<SimdLevel> result{SimdLevel::Scalar};
+        if (supportedSimdLevel() >= SimdLevel::SSE41) result.push_back(SimdLevel::SSE41);
+        if (supportedSimdLevel() >= SimdLevel::AVX2) result.push_back(SimdLevel::AVX2);
+        return result;
+    }
+
+    template <typename T> static std::vector<T> randomData(size_t count, double minValue, double maxValue) {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> distribution(minValue, maxValue);
+        std::vector<T> data(count);
+        for (auto& value : data) {
+            value = T(distribution(generator));
+        }
+        return data;
+    }
+
+    template <typename T> static void checkMinMax(double minValue, double maxValue) {
+        const auto data = randomData<T>(1000, minValue, maxValue);
+        for (size_t componentCount : {1, 2, 3, 4}) {
+            for (size_t count : {1, 7, 33, 250}) {
+                std::vector<T> expectedMin(componentCount), expectedMax(componentCount);
+                for (size_t c = 0; c < componentCount; ++c) {
+                    expectedMin[c] = expectedMax[c] = data[c];
+                    for (size_t i = 1; i < count; ++i) {
+                        expectedMin[c] = std::min(expectedMin[c], data[i * componentCount + c]);
+                        expectedMax[c] = std::max(expectedMax[c], data[i * componentCount + c]);
+                    }
+                }
+                for (auto level : levels()) {
+                    setSimdLevel(level);
+                    std::vector<T> min(componentCount), max(componentCount);
+                    minMax(data.data(), count, componentCount, min.data(), max.data());
+                    ASSERT_EQ(expectedMin, min);
+                    ASSERT_EQ(expectedMax, max);
+                }
+            }
+        }
+    }
+
+    // the computation the 2D histogram used before the kernels
+    template <typename T>
+    static double referenceGradient(const std::vector<T>& data, const Core::Math::Vec3ui& size, uint32_t x, uint32_t y, uint32_t z) {
+        const size_t center = x + size.x * y + size.x * size.y * z;
+        Core::Math::Vec3d gradient((double(data[center - 1]) - double(data[center + 1])) / 2,
+                                   (double(data[center - size.x]) - double(data[center + size.x])) / 2,
+                                   (double(data[center - size.x * size.y]) - double(data[center + size.x * size.y])) / 2);
+        return gradient.length();
+    }
+
+    template <typename T> static void checkGradient(double minValue, double maxValue) {
+        const Core::Math::Vec3ui size(37, 11, 5);
+        const auto data = randomData<T>(size.volume(), minValue, maxValue);
+        std::vector<double> magnitudes(size.x);
+        for (auto level : levels()) {
+            setSimdLevel(level);
+            for (uint32_t z = 1; z < size.z - 1; ++z) {
+                for (uint32_t y = 1; y < size.y - 1; ++y) {
+                    gradientMagnitudes(data.data(), size, 1, 1, size.x - 1, y, z, 1.0, magnitudes.data());
+                    for (uint32_t x = 1; x < size.x - 1; ++x) {
+                        ASSERT_EQ(referenceGradient(data, size, x, y, z), magnitudes[x - 1]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+TEST_F(BrickStatisticsTest, MinMaxAllTypes) {
+    checkMinMax<uint8_t>(0, 255);
+    checkMinMax<int8_t>(-128, 127);
+    checkMinMax<uint16_t>(0, 65535);
+    checkMinMax<int16_t>(-32768, 32767);
+    checkMinMax<uint32_t>(0, 4294967295.0);
+    checkMinMax<int32_t>(-2147483648.0, 2147483647.0);
+    checkMinMax<uint64_t>(0, 1e18);
+    checkMinMax<int64_t>(-1e18, 1e18);
+    checkMinMax<float>(-1e6, 1e6);
+    checkMinMax<double>(-1e6, 1e6);
+}
+
+TEST_F(BrickStatisticsTest, MinMaxHistogram) {
+    const auto data = randomData<uint16_t>(5000, 0, 4096);
+    std::vector<uint64_t> expected(4096);
+    for (auto value : data) {
+        ++expected[value];
+    }
+    for (auto level : levels()) {
+        setSimdLevel(level);
+        std::vector<uint64_t> histogram(4096);
+        uint16_t min, max;
+        minMaxHistogram(data.data(), data.size(), 1, &min, &max, histogram.data());
+        ASSERT_EQ(expected, histogram);
+        ASSERT_EQ(*std::min_element(data.begin(), data.end()), min);
+        ASSERT_EQ(*std::max_element(data.begin(), data.end()), max);
+    }
+}
+
+TEST_F(BrickStatisticsTest, HistogramOfFirstComponent) {
+    const std::vector<uint8_t> data{1, 200, 2, 100, 1, 50};
+    std::vector<uint64_t> histogram(256);
+    uint8_t min[2], max[2];
+    minMaxHistogram(data.data(), 3, 2, min, max, histogram.data());
+    ASSERT_EQ(2, histogram[1]);
+    ASSERT_EQ(1, histogram[2]);
+    ASSERT_EQ(0, histogram[200]);
+    ASSERT_EQ(50, min[1]);
+    ASSERT_EQ(200, max[1]);
+}
+
+TEST_F(BrickStatisticsTest, GradientMagnitudesMatchReference) {
+    checkGradient<uint8_t>(0, 255);
+    checkGradient<int8_t>(-128, 127);
+    checkGradient<uint16_t>(0, 65535);
+    checkGradient<int16_t>(-32768, 32767);
+    checkGradient<uint32_t>(0, 4294967295.0);
+    checkGradient<int32_t>(-2147483648.0, 2147483647.0);
+    checkGradient<uint64_t>(0, 1e18);
+    checkGradient<int64_t>(-1e18, 1e18);
+    checkGradient<float>(-1e6, 1e6);
+    checkGradient<double>(-1e6, 1e6);
+}
+
+TEST_F(BrickStatisticsTest, SimpleMaxMinOfNoVoxelsIsEmpty) {
+    const std::vector<int16_t> data{-5, 7, 3, -9};
+    std::vector<Core::Math::Vec4d> minMax;
+    SimpleMaxMin<int16_t, 2>(data.data(), 1, 0, minMax);
+    ASSERT_EQ(2, minMax.size());
+    for (const auto& range : minMax) {
+        ASSERT_EQ(32767.0, range.x);
+        ASSERT_EQ(-32768.0, range.y);
+    }
+    SimpleMaxMin<int16_t, 2>(data.data(), 0, 2, minMax);
+    ASSERT_EQ(-5.0, minMax[0].x);
+    ASSERT_EQ(3.0, minMax[0].y);
+    ASSERT_EQ(-9.0, minMax[1].x);
+    ASSERT_EQ(7.0, minMax[1].y);
+}
+
+TEST_F(BrickStatisticsTest, SimdLevelIsLimitedToSupported) {
+    setSimdLevel(SimdLevel::AVX2);
+    ASSERT_EQ(supportedSimdLevel(), activeSimdLevel());
+    setSimdLevel(SimdLevel::Scalar);
+    ASSERT_EQ(SimdLevel::Scalar, activeSimdLevel());
+}
+
+// micro benchmark comparing the kernels with the loops they replaced, run with --gtest_also_run_disabled_tests
+TEST_F(BrickStatisticsTest, DISABLED_Benchmark) {
+    const Core::Math::Vec3ui size(256, 256, 256);
+    const auto data = randomData<uint16_t>(size.volume(), 0, 4096);
+    const int repetitions = 5;
+    auto measure = [&](const std::string& name, const std::function<void()>& function) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repetitions; ++i) {
+            function();
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << elapsed.count() / repetitions << " ms" << std::endl;
+    };
+
+    uint16_t min = 0, max = 0;
+    measure("min/max, previous loop", [&] {
+        min = max = data[0];
+        for (size_t i = 1; i < data.size(); ++i) {
+            if (data[i] < min) min = data[i];
+            if (data[i] > max) max = data[i];
+        }
+    });
+    std::vector<uint64_t> histogram(4096);
+    measure("histogram, previous loop", [&] {
+        for (auto value : data) {
+            histogram[size_t(value)]++;
+        }
+    });
+    double maxGradient = 0;
+    measure("gradient, previous loop", [&] {
+        for (uint32_t z = 1; z < size.z - 1; ++z) {
+            for (uint32_t y = 1; y < size.y - 1; ++y) {
+                for (uint32_t x = 1; x < size.x - 1; ++x) {
+                    maxGradient = std::max(maxGradient, referenceGradient(data, size, x, y, z));
+                }
+            }
+        }
+    });
+
+    std::vector<double> magnitudes(size.x);
+    for (auto level : levels()) {
+        setSimdLevel(level);
+        const std::string suffix = level == SimdLevel::AVX2 ? "AVX2" : level == SimdLevel::SSE41 ? "SSE4.1" : "scalar";
+        measure("min/max, " + suffix, [&] { minMax(data.data(), data.size(), 1, &min, &max); });
+        measure("min/max and histogram, " + suffix, [&] { minMaxHistogram(data.data(), data.size(), 1, &min, &max, histogram.data()); });
+        measure("gradient, " + suffix, [&] {
+            for (uint32_t z = 1; z < size.z - 1; ++z) {
+                for (uint32_t y = 1; y < size.y - 1; ++y) {
+                    gradientMagnitudes(data.data(), size, 1, 1, size.x - 1, y, z, 1.0, magnitudes.data());
+                    for (uint32_t x = 0; x < size.x - 2; ++x) {
+                        maxGradient = std::max(maxGradient, magnitudes[x]);
+                    }
+                }
+            }
+        });
+    }
+}
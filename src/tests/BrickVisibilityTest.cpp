@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "processing-base/gridleaper/BrickVisibility.h"
+
+using namespace trinity;
+using namespace Core::Math;
+
+class BrickVisibilityTest : public ::testing::Test {
+protected:
+    // brick layouts of all LoDs down to a single brick
+    static std::vector<Vec3ui> layouts(Vec3ui base) {
+        std::vector<Vec3ui> result{base};
+        while (base.volume() > 1) {
+            base = Vec3ui((base.x + 1) / 2, (base.y + 1) / 2, (base.z + 1) / 2);
+            result.push_back(base);
+        }
+        return result;
+    }
+
+    static uint32_t brickCount(const std::vector<Vec3ui>& vLayouts) {
+        uint32_t count = 0;
+        for (const auto& layout : vLayouts) {
+            count += layout.volume();
+        }
+        return count;
+    }
+
+    static std::vector<BrickMetaData> randomMetaData(uint32_t count, std::mt19937& random) {
+        std::uniform_real_distribution<double> value(0.0, 255.0);
+        std::vector<BrickMetaData> result(count);
+        for (auto& metaData : result) {
+            const double a = value(random), b = value(random);
+            const double c = value(random), d = value(random);
+            metaData = BrickMetaData{std::min(a, b), std::max(a, b), std::min(c, d), std::max(c, d), Vec3ui(32, 32, 32)};
+        }
+        return result;
+    }
+
+    // classification from the definition: a brick is child empty if no
+    // brick of its subtree contains data
+    static std::vector<BrickVisibility::BrickClass> reference(const std::vector<Vec3ui>& vLayouts,
+                                                              const std::vector<BrickMetaData>& metaData,
+                                                              const VisibilityState& visibility) {
+        std::vector<BrickVisibility::BrickClass> result;
+        std::vector<bool> subtreeVisible;
+        uint32_t offset = 0, childOffset = 0;
+        for (uint32_t lod = 0; lod < vLayouts.size(); ++lod) {
+            const Vec3ui& layout = vLayouts[lod];
+            for (uint32_t z = 0; z < layout.z; ++z) {
+                for (uint32_t y = 0; y < layout.y; ++y) {
+                    for (uint32_t x = 0; x < layout.x; ++x) {
+                        const uint32_t id = offset + x + y * layout.x + z * layout.x * layout.y;
+                        bool childVisible = false;
+                        if (lod > 0) {
+                            const Vec3ui& childLayout = vLayouts[lod - 1];
+                            for (uint32_t cz = 2 * z; cz < std::min(2 * z + 2, childLayout.z); ++cz) {
+                                for (uint32_t cy = 2 * y; cy < std::min(2 * y + 2, childLayout.y); ++cy) {
+                                    for (uint32_t cx = 2 * x; cx < std::min(2 * x + 2, childLayout.x); ++cx) {
+                                        childVisible = childVisible ||
+                                                       subtreeVisible[childOffset + cx + cy * childLayout.x +
+                                                                      cz * childLayout.x * childLayout.y];
+                                    }
+                                }
+                            }
+                        }
+                        const bool visible = BrickVisibility::containsData(metaData[id], visibility);
+                        result.push_back(visible ? BrickVisibility::BC_VISIBLE
+                                                 : childVisible ? BrickVisibility::BC_EMPTY : BrickVisibility::BC_CHILD_EMPTY);
+                        subtreeVisible.push_back(visible || childVisible);
+                    }
+                }
+            }
+            childOffset = offset;
+            offset += layout.volume();
+        }
+        return result;
+    }
+
+    static std::vector<BrickVisibility::BrickClass> classes(const BrickVisibility& visibility) {
+        std::vector<BrickVisibility::BrickClass> result;
+        for (uint32_t i = 0; i < visibility.getTotalBrickCount(); ++i) {
+            result.push_back(visibility.getClass(i));
+        }
+        return result;
+    }
+
+    // applies the states one after the other and compares the incremental
+    // updates against the definition and a full update
+    static void checkSequence(const std::vector<Vec3ui>& vLayouts, const std::vector<BrickMetaData>& metaData,
+                              const std::vector<VisibilityState>& states) {
+        BrickVisibility incremental(vLayouts);
+        incremental.setMetaData(metaData);
+        auto previous = classes(incremental);
+        for (size_t i = 0; i < states.size(); ++i) {
+            const bool full = incremental.update(states[i]);
+            ASSERT_EQ(i == 0, full);
+            const auto current = classes(incremental);
+            ASSERT_EQ(reference(vLayouts, metaData, states[i]), current);
+
+            BrickVisibility fresh(vLayouts);
+            fresh.setMetaData(metaData);
+            fresh.update(states[i]);
+            ASSERT_EQ(fresh.getCounts(), incremental.getCounts());
+
+            if (!full) {
+                std::vector<uint32_t> changed;
+                for (uint32_t id = 0; id < current.size(); ++id) {
+                    if (current[id] != previous[id]) changed.push_back(id);
+                }
+                auto reported = incremental.getChangedBricks();
+                std::sort(reported.begin(), reported.end());
+                ASSERT_EQ(changed, reported);
+            }
+            previous = current;
+        }
+    }
+};
+
+TEST_F(BrickVisibilityTest, IsoScrubbing) {
+    std::mt19937 random(7);
+    const auto vLayouts = layouts(Vec3ui(13, 7, 5));
+    const auto metaData = randomMetaData(brickCount(vLayouts), random);
+    std::vector<VisibilityState> states;
+    for (double iso : {100.0, 120.0, 119.0, 250.0, 0.0, 180.5, 180.5, 300.0, 42.0}) {
+        states.emplace_back();
+        states.back().needsUpdate(iso);
+    }
+    checkSequence(vLayouts, metaData, states);
+}
+
+TEST_F(BrickVisibilityTest, TransferFunctionChanges) {
+    std::mt19937 random(11);
+    const auto vLayouts = layouts(Vec3ui(9, 9, 6));
+    const auto metaData = randomMetaData(brickCount(vLayouts), random);
+    std::uniform_real_distribution<double> value(0.0, 255.0);
+    std::vector<VisibilityState> states;
+    for (int i = 0; i < 20; ++i) {
+        const double a = value(random), b = value(random);
+        states.emplace_back();
+        states.back().needsUpdate(std::min(a, b), std::max(a, b));
+    }
+    checkSequence(vLayouts, metaData, states);
+
+    states.clear();
+    for (int i = 0; i < 20; ++i) {
+        const double a = value(random), b = value(random);
+        const double c = value(random), d = value(random);
+        states.emplace_back();
+        states.back().needsUpdate(std::min(a, b), std::max(a, b), std::min(c, d), std::max(c, d));
+    }
+    checkSequence(vLayouts, metaData, states);
+
+    states.clear();
+    for (int i = 0; i < 20; ++i) {
+        states.emplace_back();
+        states.back().needsUpdateCV(value(random), value(random));
+    }
+    checkSequence(vLayouts, metaData, states);
+}
+
+TEST_F(BrickVisibilityTest, ModeAndMetaDataChangesClassifyAll) {
+    std::mt19937 random(3);
+    const auto vLayouts = layouts(Vec3ui(4, 4, 4));
+    const auto metaData = randomMetaData(brickCount(vLayouts), random);
+    BrickVisibility visibility(vLayouts);
+    visibility.setMetaData(metaData);
+
+    VisibilityState iso;
+    iso.needsUpdate(128.0);
+    ASSERT_TRUE(visibility.update(iso));
+    ASSERT_FALSE(visibility.update(iso));
+    ASSERT_TRUE(visibility.getChangedBricks().empty());
+
+    VisibilityState transfer;
+    transfer.needsUpdate(10.0, 20.0);
+    ASSERT_TRUE(visibility.update(transfer));
+    ASSERT_EQ(reference(vLayouts, metaData, transfer), classes(visibility));
+
+    const auto otherMetaData = randomMetaData(brickCount(vLayouts), random);
+    visibility.setMetaData(otherMetaData);
+    ASSERT_TRUE(visibility.update(transfer));
+    ASSERT_EQ(reference(vLayouts, otherMetaData, transfer), classes(visibility));
+}
+
+TEST_F(BrickVisibilityTest, CandidatesCoverVisibilityChanges) {
+    std::mt19937 random(13);
+    const auto vLayouts = layouts(Vec3ui(6, 5, 3));
+    const auto metaData = randomMetaData(brickCount(vLayouts), random);
+    BrickVisibility visibility(vLayouts);
+    visibility.setMetaData(metaData);
+
+    std::uniform_real_distribution<double> value(0.0, 255.0);
+    VisibilityState from, to;
+    from.needsUpdate(50.0, 60.0);
+    for (int i = 0; i < 20; ++i) {
+        const double a = value(random), b = value(random);
+        to.needsUpdate(std::min(a, b), std::max(a, b));
+        std::vector<uint32_t> candidates;
+        visibility.collectCandidates(from, to, candidates);
+        for (uint32_t id = 0; id < metaData.size(); ++id) {
+            if (BrickVisibility::containsData(metaData[id], from) != BrickVisibility::containsData(metaData[id], to)) {
+                ASSERT_NE(candidates.end(), std::find(candidates.begin(), candidates.end(), id));
+            }
+        }
+        from = to;
+    }
+}
+
+TEST_F(BrickVisibilityTest, ParentIDs) {
+    const auto vLayouts = layouts(Vec3ui(5, 3, 2));
+    BrickVisibility visibility(vLayouts);
+    // (4, 2, 1) of LoD 0 lies in (2, 1, 0) of LoD 1, which starts at 30
+    ASSERT_EQ(30u + 2 + 1 * 3, visibility.getParentID(4 + 2 * 5 + 1 * 15));
+    ASSERT_EQ(30u, visibility.getParentID(0));
+    ASSERT_EQ(visibility.getTotalBrickCount(), visibility.getParentID(visibility.getTotalBrickCount() - 1));
+}
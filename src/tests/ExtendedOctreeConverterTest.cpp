@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "io-base/uvf/Dataset/UVF-File/ExtendedOctree/ExtendedOctreeConverter.h"
+
+using namespace Core::Math;
+
+class ExtendedOctreeConverterTest : public ::testing::Test {
+protected:
+    ExtendedOctreeConverterTest()
+        : m_size(70, 50, 90) {
+        // 16 bit values, so the bricks do not compress to nothing, on a volume that is no multiple of the brick size
+        std::vector<uint16_t> volume(m_size.volume());
+        for (size_t i = 0; i < volume.size(); ++i) {
+            const uint64_t x = i % m_size.x;
+            const uint64_t y = (i / m_size.x) % m_size.y;
+            const uint64_t z = i / (m_size.x * m_size.y);
+            volume[i] = uint16_t((x * 3 + y * y / 4 + z * 2 + ((i * 2654435761u) >> 28)) % 5000);
+        }
+        std::ofstream raw(m_rawFilename, std::ios::binary);
+        raw.write(reinterpret_cast<const char*>(volume.data()), volume.size() * sizeof(uint16_t));
+    }
+
+    virtual ~ExtendedOctreeConverterTest() {
+        std::remove(m_rawFilename.c_str());
+        std::remove(m_targetFilename.c_str());
+    }
+
+    struct Settings {
+        uint32_t threadCount;
+        uint64_t memLimit; // small limits make the converter read the input in several slabs and evict bricks
+        COMPRESSION_TYPE compression;
+        bool median;
+        LAYOUT_TYPE layout;
+    };
+
+    // the converted file and the statistics of its bricks
+    std::vector<char> convert(const Settings& settings, BrickStatVec& stats) {
+        ExtendedOctreeConverter converter(Vec3ui64(16, 16, 16), 2, settings.memLimit, settings.threadCount);
+        EXPECT_TRUE(converter.Convert(m_rawFilename, 0, ExtendedOctree::CT_UINT16, 1, m_size, Vec3d(1, 1, 1),
+                                      m_targetFilename, 0, &stats, settings.compression, 4, settings.median, false,
+                                      settings.layout));
+        std::ifstream file(m_targetFilename, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // FNV-1a
+    static uint64_t hash(const std::vector<char>& data) {
+        uint64_t result = 14695981039346656037ull;
+        for (char c : data) {
+            result = (result ^ uint8_t(c)) * 1099511628211ull;
+        }
+        return result;
+    }
+
+    static void expectEqual(const BrickStatVec& expected, const BrickStatVec& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(expected[i].minScalar, actual[i].minScalar) << "brick " << i;
+            ASSERT_EQ(expected[i].maxScalar, actual[i].maxScalar) << "brick " << i;
+        }
+    }
+
+    const Vec3ui64 m_size;
+    const std::string m_rawFilename = "./ExtendedOctreeConverterTest.raw";
+    const std::string m_targetFilename = "./ExtendedOctreeConverterTest.eo";
+};
+
+// the workers downsample and compress the bricks in any order, the file has to be the same as the one of a single
+// thread
+TEST_F(ExtendedOctreeConverterTest, ParallelConversionMatchesSerialOne) {
+    const Settings settings[] = {
+        {1, 1 << 26, CT_NONE, false, LT_SCANLINE},
+        {1, 1 << 20, CT_LZ4, true, LT_MORTON},
+        {1, 1 << 18, CT_LZ4, false, LT_HILBERT},
+    };
+    for (Settings serial : settings) {
+        BrickStatVec serialStats;
+        const auto expected = convert(serial, serialStats);
+        ASSERT_FALSE(expected.empty());
+        for (uint32_t threadCount : {2u, 4u}) {
+            Settings parallel = serial;
+            parallel.threadCount = threadCount;
+            BrickStatVec parallelStats;
+            const auto actual = convert(parallel, parallelStats);
+            ASSERT_EQ(expected.size(), actual.size()) << threadCount << " threads, memory " << serial.memLimit;
+            ASSERT_TRUE(expected == actual) << threadCount << " threads, memory " << serial.memLimit;
+            expectEqual(serialStats, parallelStats);
+        }
+    }
+}
+
+// the slabbed input and the downsampling of layers as they complete must not change the output, the hashes are the
+// ones of the files the converter wrote before, when it read every brick from the input and built the levels one
+// after the other
+TEST_F(ExtendedOctreeConverterTest, MatchesReferenceOutput) {
+    const Settings settings[] = {
+        {0, 1 << 26, CT_NONE, false, LT_SCANLINE},
+        {0, 1 << 18, CT_NONE, true, LT_HILBERT},
+    };
+    const uint64_t expected[] = {0x440c596abc1c57c7ull, 0x10dddc677ee9fa53ull};
+    for (size_t i = 0; i < 2; ++i) {
+        BrickStatVec stats;
+        const auto file = convert(settings[i], stats);
+        ASSERT_EQ(size_t(1871565), file.size());
+        ASSERT_EQ(expected[i], hash(file)) << "settings " << i;
+    }
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/BrickStatistics.h"
+#include "io-base/FractalListData.h"
+#include "io-base/fractal/FractalIO.h"
+
+using namespace trinity;
+
+namespace {
+// small bricked datasets, with power of two and other sizes and both generators
+class TestFractalListData : public FractalListData {
+public:
+    Core::Math::Vec3ui64 totalSize(const std::string& fileID) const override { return find(fileID).size; }
+    Core::Math::Vec3ui64 brickSize(const std::string& fileID) const override { return find(fileID).brick; }
+    MandelbulbMode generatorMode(const std::string& fileID) const override { return find(fileID).mode; }
+
+private:
+    struct Dataset {
+        Core::Math::Vec3ui64 size;
+        Core::Math::Vec3ui64 brick;
+        MandelbulbMode mode;
+    };
+
+    static const Dataset& find(const std::string& fileID) {
+        static const std::map<std::string, Dataset> datasets{
+            {"FractalIOTest@1", {Core::Math::Vec3ui64(128, 128, 128), Core::Math::Vec3ui64(32, 32, 32), MandelbulbMode::VectorizedFloat}},
+            {"FractalIOTest@2", {Core::Math::Vec3ui64(100, 100, 100), Core::Math::Vec3ui64(32, 32, 32), MandelbulbMode::VectorizedFloat}},
+            {"FractalIOTest@3", {Core::Math::Vec3ui64(24, 24, 24), Core::Math::Vec3ui64(12, 12, 12), MandelbulbMode::Reference}}};
+        return datasets.at(fileID);
+    }
+};
+}
+
+class FractalIOTest : public ::testing::Test {
+protected:
+    virtual ~FractalIOTest() {
+        for (const auto& fileId : m_fileIds) {
+            removeFiles(fileId);
+        }
+    }
+
+    const std::vector<std::string> m_fileIds{"FractalIOTest@1", "FractalIOTest@2", "FractalIOTest@3"};
+
+    static void removeFiles(const std::string& fileId) {
+        std::remove(("./" + fileId + ".brickMeta").c_str());
+        std::remove(("./" + fileId + ".brickCacheData").c_str());
+        std::remove(("./" + fileId + ".brickCacheIndex").c_str());
+    }
+
+    TestFractalListData m_listData;
+};
+
+// the metadata is computed without caching the bricks, it has to contain the range of the generated voxels
+TEST_F(FractalIOTest, MetaDataContainsBrickRanges) {
+    for (const auto& fileId : m_fileIds) {
+        removeFiles(fileId);
+        FractalIO io(fileId, m_listData);
+        const auto metaData = io.getBrickMetaData(0, 0);
+        ASSERT_EQ(io.getTotalBrickCount(0), metaData.size());
+
+        size_t first = 0;
+        for (uint64_t lod = 0; lod < io.getLODLevelCount(0); ++lod) {
+            const uint64_t brickCount = io.getBrickLayout(lod, 0).volume();
+            for (uint64_t index = 0; index < brickCount; ++index) {
+                const BrickKey key(0, 0, lod, index);
+                bool success = false;
+                const auto brick = io.getBrick(key, success);
+                ASSERT_TRUE(success);
+                uint8_t min, max;
+                minMax(brick->data(), brick->size(), 1, &min, &max);
+                const BrickMetaData& meta = metaData[first + size_t(index)];
+                EXPECT_LE(meta.minScalar, double(min)) << fileId << " lod " << lod << " brick " << index;
+                EXPECT_GE(meta.maxScalar, double(max)) << fileId << " lod " << lod << " brick " << index;
+            }
+            first += size_t(brickCount);
+        }
+    }
+}
+
+TEST_F(FractalIOTest, ReloadsStoredMetaData) {
+    const std::string& fileId = m_fileIds.front();
+    removeFiles(fileId);
+    FractalIO io(fileId, m_listData);
+    const auto metaData = io.getBrickMetaData(0, 0);
+
+    FractalIO reopened(fileId, m_listData);
+    const auto reloaded = reopened.getBrickMetaData(0, 0);
+    ASSERT_EQ(metaData.size(), reloaded.size());
+    for (size_t i = 0; i < metaData.size(); ++i) {
+        ASSERT_EQ(metaData[i].minScalar, reloaded[i].minScalar);
+        ASSERT_EQ(metaData[i].maxScalar, reloaded[i].maxScalar);
+        ASSERT_EQ(metaData[i].voxelSize, reloaded[i].voxelSize);
+    }
+}
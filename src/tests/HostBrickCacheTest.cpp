@@ -0,0 +1,111 @@
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/HostBrickCache.h"
+
+using namespace trinity;
+
+class HostBrickCacheTest : public ::testing::Test {
+protected:
+    static std::shared_ptr<std::vector<uint8_t>> brick(size_t size, uint8_t value) {
+        auto result = std::make_shared<std::vector<uint8_t>>(size, value);
+        result->shrink_to_fit();
+        return result;
+    }
+};
+
+TEST_F(HostBrickCacheTest, ReturnsCachedBricks) {
+    HostBrickCache cache(1024);
+    auto data = brick(100, 1);
+    cache.put(BrickKey(0, 0, 0, 1), data);
+
+    ASSERT_EQ(data, cache.get(BrickKey(0, 0, 0, 1)));
+    ASSERT_EQ(nullptr, cache.get(BrickKey(0, 0, 0, 2)));
+    ASSERT_EQ(nullptr, cache.get(BrickKey(1, 0, 0, 1)));
+
+    const auto statistics = cache.getStatistics();
+    ASSERT_EQ(1u, statistics.hits);
+    ASSERT_EQ(2u, statistics.misses);
+    ASSERT_EQ(1u, statistics.brickCount);
+}
+
+TEST_F(HostBrickCacheTest, EvictsLeastRecentlyUsedBricks) {
+    HostBrickCache cache(300);
+    cache.put(BrickKey(0, 0, 0, 0), brick(100, 0));
+    cache.put(BrickKey(0, 0, 0, 1), brick(100, 1));
+    cache.put(BrickKey(0, 0, 0, 2), brick(100, 2));
+    ASSERT_NE(nullptr, cache.get(BrickKey(0, 0, 0, 0)));
+
+    cache.put(BrickKey(0, 0, 0, 3), brick(100, 3));
+    ASSERT_EQ(nullptr, cache.get(BrickKey(0, 0, 0, 1)));
+    ASSERT_NE(nullptr, cache.get(BrickKey(0, 0, 0, 0)));
+    ASSERT_NE(nullptr, cache.get(BrickKey(0, 0, 0, 2)));
+    ASSERT_NE(nullptr, cache.get(BrickKey(0, 0, 0, 3)));
+
+    // bricks larger than the budget are not cached at all
+    cache.put(BrickKey(0, 0, 0, 4), brick(400, 4));
+    ASSERT_EQ(nullptr, cache.get(BrickKey(0, 0, 0, 4)));
+
+    const auto statistics = cache.getStatistics();
+    ASSERT_EQ(1u, statistics.evictions);
+    ASSERT_EQ(300u, statistics.cachedBytes);
+}
+
+TEST_F(HostBrickCacheTest, CompressesBricks) {
+    HostBrickCache cache(1024, true);
+    auto data = brick(4096, 7);
+    cache.put(BrickKey(0, 0, 0, 0), data);
+    ASSERT_GT(1024u, cache.getStatistics().cachedBytes);
+
+    auto cached = cache.get(BrickKey(0, 0, 0, 0));
+    ASSERT_NE(nullptr, cached);
+    ASSERT_EQ(*data, *cached);
+}
+
+// the least recently used brick of all caches of a budget is dropped, whichever cache it belongs to
+TEST_F(HostBrickCacheTest, CachesShareBudget) {
+    auto budget = HostBrickCache::makeBudget(300);
+    HostBrickCache first(budget);
+    auto second = std::make_shared<HostBrickCache>(budget);
+    first.put(BrickKey(0, 0, 0, 0), brick(100, 0));
+    second->put(BrickKey(0, 0, 0, 0), brick(100, 1));
+    first.put(BrickKey(0, 0, 0, 1), brick(100, 2));
+    ASSERT_NE(nullptr, first.get(BrickKey(0, 0, 0, 0)));
+
+    second->put(BrickKey(0, 0, 0, 1), brick(100, 3));
+    ASSERT_EQ(nullptr, second->get(BrickKey(0, 0, 0, 0)));
+    ASSERT_EQ(1u, second->getStatistics().evictions);
+    ASSERT_EQ(100u, second->getStatistics().cachedBytes);
+    ASSERT_EQ(200u, first.getStatistics().cachedBytes);
+
+    // the bricks of a cache that is gone make room for the others
+    second.reset();
+    first.put(BrickKey(0, 0, 0, 2), brick(100, 4));
+    ASSERT_NE(nullptr, first.get(BrickKey(0, 0, 0, 0)));
+    ASSERT_NE(nullptr, first.get(BrickKey(0, 0, 0, 1)));
+    ASSERT_NE(nullptr, first.get(BrickKey(0, 0, 0, 2)));
+    ASSERT_EQ(0u, first.getStatistics().evictions);
+}
+
+TEST_F(HostBrickCacheTest, DatasetsShareCaches) {
+    auto first = HostBrickCache::forDataset("io|a");
+    auto second = HostBrickCache::forDataset("io|a");
+    auto other = HostBrickCache::forDataset("io|b");
+    ASSERT_NE(nullptr, first);
+    ASSERT_EQ(first, second);
+    ASSERT_NE(first, other);
+
+    // different datasets evict each other's bricks
+    HostBrickCache::setDefaults(300, false);
+    auto small = HostBrickCache::forDataset("io|d");
+    auto otherSmall = HostBrickCache::forDataset("io|e");
+    small->put(BrickKey(0, 0, 0, 0), brick(200, 0));
+    otherSmall->put(BrickKey(0, 0, 0, 0), brick(200, 1));
+    ASSERT_EQ(nullptr, small->get(BrickKey(0, 0, 0, 0)));
+
+    HostBrickCache::setDefaults(0, false);
+    ASSERT_EQ(nullptr, HostBrickCache::forDataset("io|c"));
+    HostBrickCache::setDefaults(HostBrickCache::defaultBudget, false);
+}
@@ -475,6 +475,113 @@ TEST_F(IOCommandsTest, GetBrickReqRep) {
     ASSERT_EQ(*brick, *reply.getParams().getBrick());
 }
 
+TEST_F(IOCommandsTest, GetBricksCmd) {
+    {
+        GetBricksCmd::RequestParams target({ BrickKey(1, 2, 3, 4), BrickKey(1, 2, 3, 5) });
+        auto result = trinity::testing::writeAndRead(target);
+        ASSERT_EQ(target, result);
+    }
+    {
+        auto brick1 = std::make_shared<std::vector<uint8_t>>(std::initializer_list<uint8_t>{ 0x12, 0x34, 0x56 });
+        auto brick2 = std::make_shared<std::vector<uint8_t>>(std::initializer_list<uint8_t>{ 0x78, 0x9A });
+        GetBricksCmd::ReplyParams target({ brick1, brick2 }, { true, false });
+        auto result = trinity::testing::writeAndRead(target);
+        ASSERT_EQ(target, result);
+    }
+}
+
+TEST_F(IOCommandsTest, GetBricksReqRep) {
+    auto session = createMockSession();
+    auto brick1 = std::make_shared<std::vector<uint8_t>>();
+    *brick1 = { 0x12, 0x34, 0x56 };
+    auto brick2 = std::make_shared<std::vector<uint8_t>>();
+    *brick2 = { 0x78, 0x9A };
+    EXPECT_CALL(static_cast<const IOMock&>(session->getIO()), getBrick(BrickKey(1, 2, 3, 4), _))
+        .Times(1)
+        .WillOnce(DoAll(SetArgReferee<1>(true), Return(brick1)));
+    EXPECT_CALL(static_cast<const IOMock&>(session->getIO()), getBrick(BrickKey(1, 2, 3, 5), _))
+        .Times(1)
+        .WillOnce(DoAll(SetArgReferee<1>(true), Return(brick2)));
+
+    GetBricksCmd::RequestParams requestParams({ BrickKey(1, 2, 3, 4), BrickKey(1, 2, 3, 5) });
+    GetBricksRequest request(requestParams, 1, 2);
+    auto reply = trinity::testing::handleRequest<GetBricksHdl>(request, session.get());
+    auto bricks = reply.getParams().getBricks();
+    ASSERT_EQ(2, bricks.size());
+    ASSERT_EQ(*brick1, *bricks[0]);
+    ASSERT_EQ(*brick2, *bricks[1]);
+    ASSERT_EQ(std::vector<bool>({ true, true }), reply.getParams().getSuccess());
+}
+
+namespace {
+// single modality with two LODs: 2x1x1 bricks at LOD 0 and a single brick at LOD 1
+void setupDatasetDescriptorMock(const IOMock& io) {
+    EXPECT_CALL(io, getMaxBrickSize()).WillRepeatedly(Return(Core::Math::Vec3ui64(32, 32, 32)));
+    EXPECT_CALL(io, getMaxUsedBrickSizes()).WillRepeatedly(Return(Core::Math::Vec3ui64(30, 30, 30)));
+    EXPECT_CALL(io, getBrickOverlapSize()).WillRepeatedly(Return(Core::Math::Vec3ui(1, 1, 1)));
+    EXPECT_CALL(io, getNumberOfTimesteps()).WillRepeatedly(Return(1));
+    EXPECT_CALL(io, getModalityCount()).WillRepeatedly(Return(1));
+    EXPECT_CALL(io, getType(0)).WillRepeatedly(Return(IIO::ValueType::T_UINT16));
+    EXPECT_CALL(io, getSemantic(0)).WillRepeatedly(Return(IIO::Semantic::Scalar));
+    EXPECT_CALL(io, getComponentCount(0)).WillRepeatedly(Return(1));
+    EXPECT_CALL(io, getLargestSingleBrickLOD(0)).WillRepeatedly(Return(1));
+    EXPECT_CALL(io, getRange(0)).WillRepeatedly(Return(Core::Math::Vec2f(0.0f, 4095.0f)));
+    EXPECT_CALL(io, getDomainScale(0)).WillRepeatedly(Return(Core::Math::Vec3f(1.0f, 1.0f, 2.0f)));
+    EXPECT_CALL(io, getTotalBrickCount(0)).WillRepeatedly(Return(3));
+    EXPECT_CALL(io, getLODLevelCount(0)).WillRepeatedly(Return(2));
+    EXPECT_CALL(io, getDomainSize(0, 0)).WillRepeatedly(Return(Core::Math::Vec3ui64(50, 20, 20)));
+    EXPECT_CALL(io, getDomainSize(1, 0)).WillRepeatedly(Return(Core::Math::Vec3ui64(25, 10, 10)));
+    EXPECT_CALL(io, getBrickLayout(0, 0)).WillRepeatedly(Return(Core::Math::Vec3ui(2, 1, 1)));
+    EXPECT_CALL(io, getBrickLayout(1, 0)).WillRepeatedly(Return(Core::Math::Vec3ui(1, 1, 1)));
+    EXPECT_CALL(io, getFloatBrickLayout(0, 0)).WillRepeatedly(Return(Core::Math::Vec3f(1.7f, 0.7f, 0.7f)));
+    EXPECT_CALL(io, getFloatBrickLayout(1, 0)).WillRepeatedly(Return(Core::Math::Vec3f(0.9f, 0.4f, 0.4f)));
+    EXPECT_CALL(io, getBrickVoxelCounts(BrickKey(0, 0, 0, 0))).WillRepeatedly(Return(Core::Math::Vec3ui(32, 22, 22)));
+    EXPECT_CALL(io, getBrickVoxelCounts(BrickKey(0, 0, 0, 1))).WillRepeatedly(Return(Core::Math::Vec3ui(22, 22, 22)));
+    EXPECT_CALL(io, getBrickVoxelCounts(BrickKey(0, 0, 1, 0))).WillRepeatedly(Return(Core::Math::Vec3ui(27, 12, 12)));
+    EXPECT_CALL(io, getBrickExtents(BrickKey(0, 0, 0, 0))).WillRepeatedly(Return(Core::Math::Vec3f(0.6f, 1.0f, 1.0f)));
+    EXPECT_CALL(io, getBrickExtents(BrickKey(0, 0, 0, 1))).WillRepeatedly(Return(Core::Math::Vec3f(0.4f, 1.0f, 1.0f)));
+    EXPECT_CALL(io, getBrickExtents(BrickKey(0, 0, 1, 0))).WillRepeatedly(Return(Core::Math::Vec3f(1.0f, 1.0f, 1.0f)));
+}
+}
+
+TEST_F(IOCommandsTest, GetDatasetDescriptorCmd) {
+    {
+        GetDatasetDescriptorCmd::RequestParams target;
+        auto result = trinity::testing::writeAndRead(target);
+        ASSERT_EQ(target, result);
+    }
+    {
+        IOMock io;
+        setupDatasetDescriptorMock(io);
+        GetDatasetDescriptorCmd::ReplyParams target(DatasetDescriptor::create(io));
+        auto result = trinity::testing::writeAndRead(target);
+        ASSERT_EQ(target, result);
+    }
+}
+
+TEST_F(IOCommandsTest, GetDatasetDescriptorReqRep) {
+    auto session = createMockSession();
+    setupDatasetDescriptorMock(static_cast<const IOMock&>(session->getIO()));
+
+    GetDatasetDescriptorCmd::RequestParams requestParams;
+    GetDatasetDescriptorRequest request(requestParams, 1, 2);
+    auto reply = trinity::testing::handleRequest<GetDatasetDescriptorHdl>(request, session.get());
+    auto descriptor = reply.releaseParams().releaseDescriptor();
+    ASSERT_EQ(2, descriptor.getLODLevelCount(0));
+    ASSERT_EQ(3, descriptor.getTotalBrickCount(0));
+    ASSERT_EQ(IIO::ValueType::T_UINT16, descriptor.getType(0));
+    ASSERT_EQ(Core::Math::Vec3ui64(25, 10, 10), descriptor.getDomainSize(1, 0));
+    ASSERT_EQ(Core::Math::Vec3ui(2, 1, 1), descriptor.getBrickLayout(0, 0));
+    ASSERT_EQ(Core::Math::Vec3ui(22, 22, 22), descriptor.getBrickVoxelCounts(BrickKey(0, 0, 0, 1)));
+    ASSERT_EQ(Core::Math::Vec3ui(27, 12, 12), descriptor.getBrickVoxelCounts(BrickKey(0, 0, 1, 0)));
+    ASSERT_EQ(Core::Math::Vec3f(0.4f, 1.0f, 1.0f), descriptor.getBrickExtents(BrickKey(0, 0, 0, 1)));
+    ASSERT_THROW(descriptor.getBrickVoxelCounts(BrickKey(0, 0, 1, 1)), TrinityError);
+    ASSERT_THROW(descriptor.getBrickVoxelCounts(BrickKey(1, 0, 0, 0)), TrinityError);
+    ASSERT_THROW(descriptor.getBrickExtents(BrickKey(1, 0, 0, 0)), TrinityError);
+    // replies about the dataset carry at most one brick of 32^3 voxels of one uint16 component
+    ASSERT_EQ(32 * 32 * 32 * 2, descriptor.getMaxBinaryPartSize());
+}
+
 TEST_F(IOCommandsTest, GetTypeCmd) {
     {
         GetTypeCmd::RequestParams target(23);
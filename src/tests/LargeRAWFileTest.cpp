@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "io-base/uvf/Dataset/UVF-File/LargeRAWFile.h"
+
+class LargeRAWFileTest : public ::testing::Test {
+protected:
+    // a few pages with a tail, so reads cross page boundaries of the mapping and end in a partial page
+    LargeRAWFileTest()
+        : m_content(3 * 4096 + 123) {
+        for (size_t i = 0; i < m_content.size(); ++i) {
+            m_content[i] = static_cast<unsigned char>(i * 7 + (i >> 8));
+        }
+        std::ofstream file(m_filename, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(m_content.data()), m_content.size());
+    }
+
+    virtual ~LargeRAWFileTest() { std::remove(m_filename.c_str()); }
+
+    std::shared_ptr<LargeRAWFile> open(bool mapped, uint64_t headerSize = 0) {
+        auto file = std::make_shared<LargeRAWFile>(m_filename, headerSize);
+        EXPECT_TRUE(file->Open(false));
+        if (mapped) {
+            EXPECT_TRUE(file->MapReadOnly());
+        }
+        return file;
+    }
+
+    // checks count bytes read at the position of the file, which starts headerSize bytes into the content
+    bool matches(const std::vector<unsigned char>& data, uint64_t headerSize, uint64_t pos, size_t count) const {
+        return std::equal(data.begin(), data.begin() + count, m_content.begin() + size_t(headerSize + pos));
+    }
+
+    const std::string m_filename = "./LargeRAWFileTest.raw";
+    std::vector<unsigned char> m_content;
+};
+
+TEST_F(LargeRAWFileTest, ReadsAcrossPageBoundaries) {
+    for (bool mapped : {false, true}) {
+        for (uint64_t headerSize : {uint64_t(0), uint64_t(100)}) {
+            auto file = open(mapped, headerSize);
+            ASSERT_EQ(mapped, file->IsMapped());
+            for (uint64_t page = 1; page <= 3; ++page) {
+                const uint64_t boundary = page * 4096 - headerSize;
+                for (uint64_t pos : {boundary - 1, boundary - 17, boundary}) {
+                    for (size_t count : {size_t(1), size_t(2), size_t(18), size_t(4097)}) {
+                        const size_t expected =
+                            size_t(std::min<uint64_t>(count, m_content.size() - headerSize - pos));
+                        std::vector<unsigned char> data(count);
+                        ASSERT_EQ(expected, file->ReadAt(pos, data.data(), count)) << pos << " " << count;
+                        ASSERT_TRUE(matches(data, headerSize, pos, expected)) << pos << " " << count;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(LargeRAWFileTest, ReadsAtEndOfFile) {
+    for (bool mapped : {false, true}) {
+        auto file = open(mapped, 100);
+        const uint64_t size = m_content.size() - 100;
+        std::vector<unsigned char> data(64);
+
+        // reads are cut at the end of the file
+        ASSERT_EQ(size_t(10), file->ReadAt(size - 10, data.data(), 64));
+        ASSERT_TRUE(matches(data, 100, size - 10, 10));
+        ASSERT_EQ(size_t(1), file->ReadAt(size - 1, data.data(), 1));
+        ASSERT_TRUE(matches(data, 100, size - 1, 1));
+        ASSERT_EQ(size_t(0), file->ReadAt(size, data.data(), 64));
+        ASSERT_EQ(size_t(0), file->ReadAt(size + 5000, data.data(), 64));
+        ASSERT_EQ(size_t(0), file->ReadAt(0, data.data(), 0));
+    }
+
+    auto file = open(true, 100);
+    const uint64_t size = m_content.size() - 100;
+    ASSERT_NE(nullptr, file->GetMappedData(size - 10, 10));
+    ASSERT_EQ(nullptr, file->GetMappedData(size - 10, 11));
+    ASSERT_EQ(nullptr, file->GetMappedData(size + 1, 0));
+}
+
+// the mapped data outlives the file object
+TEST_F(LargeRAWFileTest, MappedDataOutlivesClose) {
+    auto file = open(true);
+    auto data = file->GetMappedData(4000, 200);
+    ASSERT_NE(nullptr, data);
+    file->Close();
+    file.reset();
+    ASSERT_TRUE(std::equal(data.get(), data.get() + 200, m_content.begin() + 4000));
+}
+
+// ReadAt must neither use nor move the position of the sequential reads
+TEST_F(LargeRAWFileTest, ReadAtKeepsFilePosition) {
+    for (bool mapped : {false, true}) {
+        auto file = open(mapped);
+        std::vector<unsigned char> data(100);
+        file->SeekPos(1000);
+        ASSERT_EQ(size_t(100), file->ReadAt(5000, data.data(), 100));
+        ASSERT_TRUE(matches(data, 0, 5000, 100));
+        ASSERT_EQ(uint64_t(1000), file->GetPos());
+        ASSERT_EQ(size_t(100), file->ReadRAW(data.data(), 100));
+        ASSERT_TRUE(matches(data, 0, 1000, 100));
+    }
+}
+
+// pending writes have to be visible to ReadAt
+TEST_F(LargeRAWFileTest, ReadAtSeesWrites) {
+    LargeRAWFile file(m_filename);
+    ASSERT_TRUE(file.Open(true));
+    const std::vector<unsigned char> written(300, 42);
+    file.SeekPos(4000);
+    ASSERT_EQ(written.size(), file.WriteRAW(written.data(), written.size()));
+    std::vector<unsigned char> data(300);
+    ASSERT_EQ(data.size(), file.ReadAt(4000, data.data(), data.size()));
+    ASSERT_EQ(written, data);
+}
+
+TEST_F(LargeRAWFileTest, ConcurrentReads) {
+    for (bool mapped : {false, true}) {
+        auto file = open(mapped, 100);
+        const uint64_t size = m_content.size() - 100;
+        const size_t threadCount = 8;
+        std::vector<int> failures(threadCount);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937 generator(static_cast<unsigned>(t));
+                std::vector<unsigned char> data(6000);
+                for (int i = 0; i < 2000; ++i) {
+                    const uint64_t pos = generator() % (size + 10);
+                    const size_t count = generator() % data.size();
+                    const size_t expected = pos < size ? size_t(std::min<uint64_t>(count, size - pos)) : 0;
+                    if (file->ReadAt(pos, data.data(), count) != expected || !matches(data, 100, pos, expected)) {
+                        ++failures[t];
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (size_t t = 0; t < threadCount; ++t) {
+            ASSERT_EQ(0, failures[t]) << (mapped ? "mapped" : "pread");
+        }
+    }
+}
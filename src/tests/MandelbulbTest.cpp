@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/BrickStatistics.h"
+#include "io-base/fractal/Mandelbulb.h"
+
+using namespace trinity;
+
+class MandelbulbTest : public ::testing::Test {
+protected:
+    virtual ~MandelbulbTest() { setSimdLevel(supportedSimdLevel()); }
+
+    static std::vector<SimdLevel> levels() {
+        std::vector<SimdLevel> result{SimdLevel::Scalar};
+        if (supportedSimdLevel() >= SimdLevel::SSE41) result.push_back(SimdLevel::SSE41);
+        if (supportedSimdLevel() >= SimdLevel::AVX2) result.push_back(SimdLevel::AVX2);
+        return result;
+    }
+
+    // all voxels of a volume of the given size, generated row by row
+    static std::vector<uint8_t> generate(const Mandelbulb<uint8_t>& bulb, uint64_t size, MandelbulbMode mode) {
+        std::vector<uint64_t> xs(size);
+        for (uint64_t x = 0; x < size; ++x) {
+            xs[x] = x;
+        }
+        std::vector<uint8_t> result(size * size * size);
+        for (uint64_t z = 0; z < size; ++z) {
+            for (uint64_t y = 0; y < size; ++y) {
+                bulb.computeRow(xs.data(), size, y, z, mode, &result[size * (y + size * z)]);
+            }
+        }
+        return result;
+    }
+
+    static double agreement(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+        size_t equal = 0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i] == b[i]) ++equal;
+        }
+        return double(equal) / a.size();
+    }
+};
+
+TEST_F(MandelbulbTest, ReferenceRowMatchesPoints) {
+    const uint64_t size = 23;
+    Mandelbulb<uint8_t> bulb(size, size, size);
+    const auto volume = generate(bulb, size, MandelbulbMode::Reference);
+    for (uint64_t z = 0; z < size; ++z) {
+        for (uint64_t y = 0; y < size; ++y) {
+            for (uint64_t x = 0; x < size; ++x) {
+                ASSERT_EQ(bulb.computePoint(x, y, z), volume[x + size * (y + size * z)]);
+            }
+        }
+    }
+}
+
+TEST_F(MandelbulbTest, VectorizedMatchesReference) {
+    // odd size, so the last group of every row is incomplete
+    const uint64_t size = 45;
+    Mandelbulb<uint8_t> bulb(size, size, size);
+    const auto reference = generate(bulb, size, MandelbulbMode::Reference);
+    for (auto level : levels()) {
+        setSimdLevel(level);
+        // the results only differ by rounding, i.e. for points on the surface of the bulb
+        ASSERT_GT(agreement(reference, generate(bulb, size, MandelbulbMode::Vectorized)), 0.995);
+        ASSERT_GT(agreement(reference, generate(bulb, size, MandelbulbMode::VectorizedFloat)), 0.98);
+    }
+}
+
+TEST_F(MandelbulbTest, InstructionSetsAgree) {
+    const uint64_t size = 37;
+    Mandelbulb<uint8_t> bulb(size, size, size);
+    for (auto mode : {MandelbulbMode::Vectorized, MandelbulbMode::VectorizedFloat}) {
+        setSimdLevel(SimdLevel::Scalar);
+        const auto scalar = generate(bulb, size, mode);
+        for (auto level : levels()) {
+            setSimdLevel(level);
+            ASSERT_EQ(scalar, generate(bulb, size, mode));
+        }
+    }
+}
+
+TEST_F(MandelbulbTest, OtherPowersUseReference) {
+    const uint64_t size = 17;
+    Mandelbulb<uint8_t> bulb(size, size, size, 2.25, 20, 100.0, 5);
+    ASSERT_EQ(generate(bulb, size, MandelbulbMode::Reference), generate(bulb, size, MandelbulbMode::VectorizedFloat));
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/MemBlockPool.h"
+
+class MemBlockPoolTest : public ::testing::Test {
+protected:
+    // fills a block with a pattern of the owner, a block handed out twice at the same time breaks the pattern
+    static void fill(MemBlockPool::MemBlock& block, size_t size, uint8_t owner) {
+        block->assign(size, owner);
+    }
+
+    static bool holds(const MemBlockPool::MemBlock& block, uint8_t owner) {
+        for (uint8_t value : *block) {
+            if (value != owner) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+TEST_F(MemBlockPoolTest, ReusesReleasedBlocks) {
+    auto& pool = MemBlockPool::instance();
+    const auto before = pool.getStatistics();
+    uint8_t* data;
+    {
+        auto block = pool.get(100 * 1024);
+        ASSERT_GE(block->capacity(), size_t(100 * 1024));
+        ASSERT_TRUE(block->empty());
+        block->resize(1000);
+        data = block->data();
+    }
+    auto block = pool.get(100 * 1024);
+    ASSERT_TRUE(block->empty());
+    ASSERT_EQ(data, block->data());
+    const auto after = pool.getStatistics();
+    ASSERT_LE(after.allocations, before.allocations + 1);
+    ASSERT_GE(after.reuses, before.reuses + 1);
+}
+
+// blocks released by one thread beyond its bounded cache have to be available to other threads
+TEST_F(MemBlockPoolTest, BoundsThreadCaches) {
+    auto& pool = MemBlockPool::instance();
+    const size_t blockCount = 64;
+    const size_t blockSize = 1024 * 1024;
+
+    std::promise<void> released;
+    std::promise<void> done;
+    std::thread releaser([&] {
+        std::vector<MemBlockPool::MemBlock> blocks;
+        for (size_t i = 0; i < blockCount; ++i) {
+            blocks.push_back(pool.get(blockSize));
+        }
+        blocks.clear();
+        released.set_value();
+        // stay alive, so the blocks in the thread cache are not handed back on exit
+        done.get_future().wait();
+    });
+    released.get_future().wait();
+
+    const auto before = pool.getStatistics();
+    std::vector<MemBlockPool::MemBlock> blocks;
+    for (size_t i = 0; i < blockCount; ++i) {
+        blocks.push_back(pool.get(blockSize));
+    }
+    const auto after = pool.getStatistics();
+    done.set_value();
+    releaser.join();
+
+    // at most 4 MiB stay in the cache of the releasing thread
+    ASSERT_LE(after.allocations - before.allocations, uint64_t(4));
+}
+
+// threads get blocks of all size classes and free most of them on other threads, no block may be handed out twice
+// and all memory has to be returned; run it with the thread sanitizer to check the lock-free free lists
+TEST_F(MemBlockPoolTest, ConcurrentGetAndCrossThreadRelease) {
+    auto& pool = MemBlockPool::instance();
+    const auto before = pool.getStatistics();
+    const size_t threadCount = 8;
+    const size_t iterations = 2000;
+
+    struct Handover {
+        std::mutex mutex;
+        std::deque<std::pair<MemBlockPool::MemBlock, uint8_t>> blocks;
+    };
+    std::vector<Handover> handovers(threadCount);
+    std::vector<int> failures(threadCount);
+
+    auto worker = [&](size_t t) {
+        std::mt19937 generator(static_cast<unsigned>(t));
+        std::vector<std::pair<MemBlockPool::MemBlock, uint8_t>> held;
+        for (size_t i = 0; i < iterations; ++i) {
+            const size_t size = size_t(1) << (10 + generator() % 13); // 1 KiB to 4 MiB
+            const uint8_t owner = uint8_t(t * 31 + i);
+            auto block = pool.get(size);
+            if (!block->empty()) {
+                ++failures[t];
+            }
+            fill(block, std::min<size_t>(size, 4096), owner);
+            held.push_back(std::make_pair(block, owner));
+
+            // the same node popped by several threads (ABA) would show up as a broken pattern
+            if (held.size() > 4) {
+                auto& oldest = held.front();
+                if (!holds(oldest.first, oldest.second)) {
+                    ++failures[t];
+                }
+                Handover& target = handovers[generator() % threadCount];
+                std::lock_guard<std::mutex> lock(target.mutex);
+                target.blocks.push_back(oldest);
+                held.erase(held.begin());
+            }
+
+            std::deque<std::pair<MemBlockPool::MemBlock, uint8_t>> received;
+            {
+                std::lock_guard<std::mutex> lock(handovers[t].mutex);
+                received.swap(handovers[t].blocks);
+            }
+            for (const auto& entry : received) {
+                if (!holds(entry.first, entry.second)) {
+                    ++failures[t];
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    handovers.clear();
+
+    for (size_t t = 0; t < threadCount; ++t) {
+        ASSERT_EQ(0, failures[t]);
+    }
+    const auto after = pool.getStatistics();
+    ASSERT_EQ(before.usedBytes, after.usedBytes);
+    ASSERT_GT(after.reuses, before.reuses);
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/ParallelFor.h"
+
+using namespace trinity;
+
+TEST(ParallelForTest, CallsEveryItemOnce) {
+    const uint64_t itemCount = 10000;
+    const uint32_t workerCount = 4;
+    std::vector<std::atomic<int>> calls(itemCount);
+    std::atomic<uint32_t> maxWorker(0);
+    parallelFor(itemCount,
+                [&](uint32_t w, uint64_t i) {
+                    ++calls[i];
+                    uint32_t current = maxWorker;
+                    while (w > current && !maxWorker.compare_exchange_weak(current, w)) {
+                    }
+                },
+                workerCount);
+    for (const auto& count : calls) {
+        ASSERT_EQ(1, count);
+    }
+    ASSERT_LT(maxWorker, workerCount);
+}
+
+TEST(ParallelForTest, HandlesFewerItemsThanWorkers) {
+    std::atomic<int> calls(0);
+    parallelFor(0, [&](uint32_t, uint64_t) { ++calls; });
+    ASSERT_EQ(0, calls);
+    parallelFor(2, [&](uint32_t w, uint64_t) {
+        ASSERT_LT(w, 2u);
+        ++calls;
+    }, 8);
+    ASSERT_EQ(2, calls);
+}
+
+TEST(ParallelForTest, RethrowsFirstException) {
+    std::atomic<int> calls(0);
+    ASSERT_THROW(parallelFor(1000,
+                             [&](uint32_t, uint64_t i) {
+                                 ++calls;
+                                 if (i == 10) {
+                                     throw std::runtime_error("item failed");
+                                 }
+                             },
+                             4),
+                 std::runtime_error);
+    ASSERT_LT(calls, 1000);
+}
+
+TEST(ParallelForTest, RangesCoverAllItems) {
+    for (uint64_t itemCount : {uint64_t(0), uint64_t(5), uint64_t(100000)}) {
+        std::vector<std::atomic<int>> calls(itemCount);
+        std::atomic<int> rangeCount(0);
+        parallelForRanges(itemCount, 1000, [&](uint64_t begin, uint64_t end) {
+            ASSERT_LE(begin, end);
+            ++rangeCount;
+            for (uint64_t i = begin; i < end; ++i) {
+                ++calls[i];
+            }
+        });
+        for (const auto& count : calls) {
+            ASSERT_EQ(1, count);
+        }
+        ASSERT_GE(rangeCount, 1);
+        ASSERT_LE(uint64_t(rangeCount), std::max<uint64_t>(1, itemCount / 1000));
+    }
+}
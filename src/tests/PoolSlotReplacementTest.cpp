@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "processing-base/gridleaper/PoolSlotReplacement.h"
+
+class PoolSlotReplacementTest : public ::testing::TestWithParam<PoolSlotReplacement::Policy> {
+protected:
+    std::unique_ptr<PoolSlotReplacement> create(uint32_t slotCount, uint32_t brickCount) const {
+        return PoolSlotReplacement::create(GetParam(), slotCount, brickCount);
+    }
+
+    // fills slots with the next bricks until the round is exhausted
+    static std::vector<uint32_t> fillRound(PoolSlotReplacement& replacement, uint32_t& nextBrick) {
+        std::vector<uint32_t> slots;
+        replacement.beginRound();
+        for (;;) {
+            const uint32_t slot = replacement.nextSlot();
+            if (slot == replacement.getSlotCount()) break;
+            replacement.insert(slot, nextBrick++);
+            slots.push_back(slot);
+        }
+        return slots;
+    }
+};
+
+TEST_P(PoolSlotReplacementTest, RoundFillsEverySlotOnce) {
+    auto replacement = create(8, 100);
+    uint32_t brick = 0;
+    replacement->beginRound();
+    replacement->insert(7, 99);
+    replacement->pin(7);
+
+    for (int round = 0; round < 3; ++round) {
+        const auto slots = fillRound(*replacement, brick);
+        ASSERT_EQ(7u, slots.size());
+        ASSERT_EQ(7u, std::set<uint32_t>(slots.begin(), slots.end()).size());
+        ASSERT_EQ(0u, std::set<uint32_t>(slots.begin(), slots.end()).count(7));
+    }
+    ASSERT_EQ(7u, replacement->request(99));
+    ASSERT_EQ(14u, replacement->getCounters().iEvictions);
+}
+
+TEST_P(PoolSlotReplacementTest, EmptySlotsAreReplacedFirst) {
+    auto replacement = create(4, 100);
+    uint32_t brick = 0;
+    fillRound(*replacement, brick);
+
+    replacement->flagEmpty(2);
+    replacement->beginRound();
+    ASSERT_EQ(2u, replacement->nextSlot());
+    replacement->insert(2, brick++);
+
+    // a restored slot is not handed out as empty anymore
+    replacement->flagEmpty(1);
+    replacement->restore(1);
+    replacement->beginRound();
+    ASSERT_NE(1u, replacement->nextSlot());
+}
+
+TEST_P(PoolSlotReplacementTest, RequestsFindResidentBricks) {
+    auto replacement = create(2, 10);
+    replacement->beginRound();
+    replacement->insert(replacement->nextSlot(), 3);
+    replacement->insert(replacement->nextSlot(), 4);
+    replacement->beginRound();
+    const uint32_t slot = replacement->nextSlot();
+    const uint32_t evicted = slot == replacement->request(3) ? 3 : 4;
+    replacement->insert(slot, 5);
+
+    ASSERT_EQ(slot, replacement->request(5));
+    ASSERT_EQ(replacement->getSlotCount(), replacement->request(evicted));
+    const auto& counters = replacement->getCounters();
+    ASSERT_EQ(2u, counters.iHits);
+    ASSERT_EQ(1u, counters.iMisses);
+    ASSERT_EQ(1u, counters.iEvictions);
+}
+
+TEST_P(PoolSlotReplacementTest, RecentlyRequestedBricksStay) {
+    auto replacement = create(4, 100);
+    uint32_t brick = 0;
+    fillRound(*replacement, brick);
+
+    // brick 0 is the oldest one but requested again
+    const uint32_t slot = replacement->request(0);
+    replacement->beginRound();
+    ASSERT_NE(slot, replacement->nextSlot());
+}
+
+INSTANTIATE_TEST_CASE_P(Policies, PoolSlotReplacementTest,
+                        ::testing::Values(PoolSlotReplacement::LRU, PoolSlotReplacement::CLOCK));
@@ -27,9 +27,18 @@ protected:
 
 
 TEST_F(ProcessingCommandsTest, StreamParams) {
-    StreamingParams target(2048, 1000);
-    auto result = trinity::testing::writeAndRead(target);
-    ASSERT_EQ(target, result);
+    {
+        StreamingParams target(2048, 1000);
+        auto result = trinity::testing::writeAndRead(target);
+        ASSERT_EQ(target, result);
+        ASSERT_TRUE(result.getFrameRegions());
+    }
+    {
+        StreamingParams target(2048, 1000, false);
+        auto result = trinity::testing::writeAndRead(target);
+        ASSERT_EQ(target, result);
+        ASSERT_FALSE(result.getFrameRegions());
+    }
 }
 
 TEST_F(ProcessingCommandsTest, InitProcessingSessionCmd) {
@@ -143,4 +152,26 @@ TEST_F(ProcessingCommandsTest, GetActiveTimestepReqRep) {
     GetActiveTimestepRequest request(requestParams, 1, 2);
     auto reply = trinity::testing::handleRequest<GetActiveTimestepHdl>(request, session.get());
     ASSERT_EQ(42, reply.getParams().getTimestep());
+}
+
+TEST_F(ProcessingCommandsTest, GetStreamQualityCmd) {
+    {
+        GetStreamQualityCmd::RequestParams target;
+        auto result = trinity::testing::writeAndRead(target);
+        ASSERT_EQ(target, result);
+    }
+    {
+        GetStreamQualityCmd::ReplyParams target(StreamQuality(60, 2, 0.5f, 24.0f, 1.0e6f));
+        auto result = trinity::testing::writeAndRead(target);
+        ASSERT_EQ(target, result);
+    }
+}
+
+TEST_F(ProcessingCommandsTest, GetStreamQualityReqRep) {
+    auto session = createMockSession();
+
+    GetStreamQualityCmd::RequestParams requestParams;
+    GetStreamQualityRequest request(requestParams, 1, 2);
+    auto reply = trinity::testing::handleRequest<GetStreamQualityHdl>(request, session.get());
+    ASSERT_EQ(StreamQuality(), reply.getParams().getQuality());
 }
\ No newline at end of file
@@ -12,7 +12,11 @@
 
 #include "frontend-base/ProcessingNodeProxy.h"
 #include "io-base/IOCommandFactory.h"
+#include "common/TrinityError.h"
+#include "common/VisStreamProtocol.h"
+#include "processing-base/FrameTileDiff.h"
 #include "processing-base/ProcessingCommandFactory.h"
+#include "processing-base/StreamQualityController.h"
 #include "processing-base/VisStreamSender.h"
 
 
@@ -46,6 +50,110 @@ TEST_F(ProcessingTest, VisStreamPutGetTest) {
     ASSERT_EQ(f2, ff2);
 }
 
+TEST_F(ProcessingTest, VisStreamLatestFrameWinsTest) {
+    trinity::StreamingParams p(2, 2);
+    trinity::VisStream stream(p);
+    ASSERT_TRUE(stream.tryGet().empty());
+
+    trinity::Frame f1 = { 0x11, 0x22, 0x33 };
+    trinity::Frame f2 = { 0x44, 0x55, 0x55 };
+    stream.put(f1);
+    stream.put(f2);
+    ASSERT_EQ(f2, stream.tryGet());
+    ASSERT_EQ(1u, stream.getDroppedFrameCount());
+    ASSERT_TRUE(stream.tryGet().empty());
+
+    auto& f3 = stream.beginPut();
+    f3.assign(16, 0x66);
+    stream.endPut();
+    ASSERT_EQ(trinity::Frame(16, 0x66), stream.get());
+}
+
+TEST_F(ProcessingTest, StreamQualityControllerTest) {
+    trinity::StreamQualityController controller(25.0f, 1.0e6f);
+    const auto initialQuality = controller.getQuality().getJpegQuality();
+
+    // frames that blow the time budget reduce the quality down to the lowest level
+    for (int i = 0; i < 100; ++i) {
+        controller.frameSent(0.05, 0.01, 100000);
+    }
+    ASSERT_EQ(trinity::StreamQualityController::getLevelCount() - 1, controller.getLevel());
+    ASSERT_LT(controller.getQuality().getJpegQuality(), initialQuality);
+    ASSERT_LT(controller.getQuality().getResolutionScale(), 1.0f);
+
+    // cheap frames raise it again
+    for (int i = 0; i < 100; ++i) {
+        controller.frameSent(0.001, 0.0, 1000);
+    }
+    ASSERT_EQ(0u, controller.getLevel());
+    ASSERT_EQ(1.0f, controller.getQuality().getResolutionScale());
+}
+
+// frames that would exceed the bandwidth at the target rate fit it at the rate the renderer delivers them
+TEST_F(ProcessingTest, StreamQualityControllerUsesFrameRate) {
+    trinity::StreamQualityController controller(25.0f, 1.0e6f);
+    const auto initialLevel = controller.getLevel();
+    for (int i = 0; i < 10; ++i) {
+        controller.frameSent(0.001, 0.0, 60000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    ASSERT_EQ(initialLevel, controller.getLevel());
+
+    // at the target rate they do not
+    for (int i = 0; i < 100; ++i) {
+        controller.frameSent(0.001, 0.0, 60000);
+    }
+    ASSERT_GT(controller.getLevel(), initialLevel);
+}
+
+TEST_F(ProcessingTest, VisStreamCloseTest) {
+    trinity::StreamingParams p;
+    trinity::VisStream stream(p);
+    std::thread consumer([&] { ASSERT_TRUE(stream.get().empty()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stream.close();
+    consumer.join();
+}
+
+TEST_F(ProcessingTest, FrameTileDiffTest) {
+    trinity::FrameTileDiff diff;
+    const uint32_t width = 100;
+    const uint32_t height = 70;
+    trinity::Frame frame(width * height * 4, 1);
+
+    // the first frame has no reference and is sent completely, an unchanged frame not at all
+    auto regions = diff.update(frame, width, height);
+    ASSERT_EQ(1u, regions.size());
+    ASSERT_EQ(width * height, trinity::FrameTileDiff::area(regions));
+    ASSERT_TRUE(diff.update(frame, width, height).empty());
+
+    // a single changed pixel covers its (clipped) tile only
+    frame[(69 * width + 99) * 4] = 2;
+    regions = diff.update(frame, width, height);
+    ASSERT_EQ(1u, regions.size());
+    ASSERT_EQ(96u, regions[0].x);
+    ASSERT_EQ(64u, regions[0].y);
+    ASSERT_EQ(4u, regions[0].width);
+    ASSERT_EQ(6u, regions[0].height);
+    ASSERT_TRUE(diff.update(frame, width, height).empty());
+}
+
+TEST_F(ProcessingTest, FrameHeaderTest) {
+    trinity::FrameHeader header;
+    header.encoding = trinity::FrameHeader::Encoding::Delta;
+    header.width = 640;
+    header.height = 480;
+    header.regions.push_back(trinity::FrameRegion{32, 64, 96, 32});
+    auto result = trinity::FrameHeader::read(*header.write());
+    ASSERT_EQ(trinity::FrameHeader::Encoding::Delta, result.encoding);
+    ASSERT_EQ(640u, result.width);
+    ASSERT_EQ(480u, result.height);
+    ASSERT_EQ(1u, result.regions.size());
+    ASSERT_EQ(96u, result.regions[0].width);
+
+    ASSERT_THROW(trinity::FrameHeader::read(std::vector<uint8_t>(3)), trinity::TrinityError);
+}
+
 /*deprecated since libjpeg
 TEST_F(ProcessingTest, VisStreamTest) {
     Endpoint endpoint(ConnectionFactorySelector::loopback(), "localhost", "5678");
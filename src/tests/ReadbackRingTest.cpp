@@ -0,0 +1,122 @@
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "opengl-base/ReadbackRing.h"
+
+// the ring of pixel pack buffers GridLeaper reads its frames back through, with fences faked by flags
+class ReadbackRingTest : public ::testing::Test {
+protected:
+    ReadbackRingTest()
+        : m_ring(3)
+        , m_finished(3, false) {}
+
+    // the GPU finishes the reads in order
+    void finishThrough(uint32_t buffer) {
+        for (uint32_t i = 0; i < m_finished.size(); ++i) {
+            m_finished[i] = m_finished[i] || i <= buffer;
+        }
+    }
+
+    // a wait finishes the read
+    int newestFinished(bool wait) {
+        return m_ring.NewestFinished(wait, [this](uint32_t buffer, bool waitForRead) {
+            m_polls.push_back(std::make_pair(buffer, waitForRead));
+            if (waitForRead) {
+                m_finished[buffer] = true;
+            }
+            return bool(m_finished[buffer]);
+        });
+    }
+
+    std::vector<uint32_t> releaseThrough(uint32_t buffer) {
+        std::vector<uint32_t> released;
+        m_ring.ReleaseThrough(buffer, [&](uint32_t i) {
+            released.push_back(i);
+            m_finished[i] = false;
+        });
+        return released;
+    }
+
+    ReadbackRing m_ring;
+    std::vector<bool> m_finished;
+    std::vector<std::pair<uint32_t, bool>> m_polls;
+};
+
+TEST_F(ReadbackRingTest, ReadsGoRoundTheRing) {
+    ASSERT_EQ(0u, m_ring.BeginRead());
+    ASSERT_EQ(1u, m_ring.BeginRead());
+    ASSERT_EQ(2u, releaseThrough(1).size());
+    ASSERT_EQ(2u, m_ring.BeginRead());
+    ASSERT_EQ(0u, m_ring.BeginRead());
+    ASSERT_EQ(2u, m_ring.PendingCount());
+}
+
+TEST_F(ReadbackRingTest, NothingToFetchWithoutFinishedReads) {
+    ASSERT_EQ(-1, newestFinished(false));
+    ASSERT_TRUE(m_polls.empty());
+
+    m_ring.BeginRead();
+    m_ring.BeginRead();
+    ASSERT_EQ(-1, newestFinished(false));
+    // only polled, the render thread must not block while a buffer is free
+    for (const auto& poll : m_polls) {
+        ASSERT_FALSE(poll.second);
+    }
+    ASSERT_EQ(2u, m_ring.PendingCount());
+}
+
+// older finished frames are dropped in favor of the newest one
+TEST_F(ReadbackRingTest, FetchesNewestFinishedRead) {
+    m_ring.BeginRead();
+    m_ring.BeginRead();
+    finishThrough(1);
+    ASSERT_EQ(1, newestFinished(false));
+    ASSERT_EQ((std::vector<uint32_t>{0, 1}), releaseThrough(1));
+    ASSERT_EQ(0u, m_ring.PendingCount());
+}
+
+TEST_F(ReadbackRingTest, KeepsReadsNewerThanTheFetchedOne) {
+    m_ring.BeginRead();
+    m_ring.BeginRead();
+    finishThrough(0);
+    ASSERT_EQ(0, newestFinished(false));
+    ASSERT_EQ(std::vector<uint32_t>{0}, releaseThrough(0));
+    ASSERT_EQ(1u, m_ring.PendingCount());
+
+    finishThrough(1);
+    ASSERT_EQ(1, newestFinished(false));
+}
+
+// with all buffers in flight the oldest read is waited for, so the next frame has a buffer to read into
+TEST_F(ReadbackRingTest, WaitsForOldestReadWhenAllBuffersAreInFlight) {
+    m_ring.BeginRead();
+    m_ring.BeginRead();
+    m_ring.BeginRead();
+    ASSERT_EQ(0, newestFinished(false));
+    ASSERT_EQ(std::make_pair(0u, true), m_polls.front());
+    ASSERT_EQ(std::vector<uint32_t>{0}, releaseThrough(0));
+    ASSERT_EQ(0u, m_ring.BeginRead());
+    ASSERT_EQ(3u, m_ring.PendingCount());
+}
+
+// the last frame before the renderer goes idle is waited for, so it is not held back
+TEST_F(ReadbackRingTest, WaitsForNewestReadOnRequest) {
+    m_ring.BeginRead();
+    m_ring.BeginRead();
+    ASSERT_EQ(1, newestFinished(true));
+    ASSERT_EQ(1u, m_polls.size());
+    ASSERT_EQ(std::make_pair(1u, true), m_polls.front());
+    ASSERT_EQ((std::vector<uint32_t>{0, 1}), releaseThrough(1));
+}
+
+TEST_F(ReadbackRingTest, WrapsAroundTheRing) {
+    for (int frame = 0; frame < 10; ++frame) {
+        const uint32_t buffer = m_ring.BeginRead();
+        ASSERT_EQ(uint32_t(frame % 3), buffer);
+        finishThrough(buffer);
+        ASSERT_EQ(int(buffer), newestFinished(false));
+        ASSERT_EQ(std::vector<uint32_t>{buffer}, releaseThrough(buffer));
+    }
+}
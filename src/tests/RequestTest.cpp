@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 
+#include "commands/BinaryFrame.h"
 #include "commands/Request.h"
 #include "commands/ProcessingCommands.h"
 #include "commands/IOCommands.h"
@@ -43,4 +44,52 @@ TEST_F(RequestTest, GetBrickWithMessage) {
     ASSERT_TRUE(castedResult != nullptr);
     ASSERT_EQ(true, castedResult->getParams().getSuccess());
     ASSERT_EQ(*binary, *castedResult->getParams().getBrick());
+}
+
+TEST_F(RequestTest, GetBricksFromView) {
+    auto owner = std::make_shared<std::vector<uint8_t>>(2000);
+    for (size_t i = 0; i < owner->size(); ++i) {
+        (*owner)[i] = static_cast<uint8_t>(i);
+    }
+    BinaryView view;
+    view.data = std::shared_ptr<const uint8_t>(owner, owner->data() + 1000);
+    view.size = 1000;
+    const std::vector<uint8_t> expected(owner->begin() + 1000, owner->end());
+    auto brick = std::make_shared<std::vector<uint8_t>>(10, 0xAA);
+
+    for (auto mode : {CompressionMode::Framed, CompressionMode::Uncompressed, CompressionMode::Compressed}) {
+        GetBricksCmd::ReplyParams replyParams({nullptr, brick}, {true, true}, {}, {view, BinaryView()});
+        GetBricksReply reply(replyParams, 0, 0);
+        auto serialized = Reply::createMessage(reply, mode);
+
+        auto result = Reply::createFromMessage(serialized, mode);
+        auto castedResult = dynamic_cast<GetBricksReply*>(result.get());
+        ASSERT_TRUE(castedResult != nullptr);
+        auto bricks = castedResult->getParams().getBricks();
+        ASSERT_EQ(2, bricks.size());
+        ASSERT_EQ(expected, *bricks[0]);
+        ASSERT_EQ(*brick, *bricks[1]);
+    }
+}
+
+TEST_F(RequestTest, GetBricksFramed) {
+    auto brick = std::make_shared<std::vector<uint8_t>>(1000, 0xAA);
+    auto frame = std::make_shared<std::vector<uint8_t>>(BinaryFrameHeader::size);
+    frame->insert(frame->end(), brick->begin(), brick->end());
+    BinaryFrameHeader{BinaryCodec::None, {}, brick->size()}.write(*frame);
+
+    // encoded bricks arrive decoded, whether they are forwarded as frames or decoded by the sender
+    for (auto mode : {CompressionMode::Framed, CompressionMode::Uncompressed, CompressionMode::Compressed}) {
+        GetBricksCmd::ReplyParams replyParams({frame, brick}, {true, true}, {true, false});
+        GetBricksReply reply(replyParams, 0, 0);
+        auto serialized = Reply::createMessage(reply, mode);
+
+        auto result = Reply::createFromMessage(serialized, mode);
+        auto castedResult = dynamic_cast<GetBricksReply*>(result.get());
+        ASSERT_TRUE(castedResult != nullptr);
+        auto bricks = castedResult->getParams().getBricks();
+        ASSERT_EQ(2, bricks.size());
+        ASSERT_EQ(*brick, *bricks[0]);
+        ASSERT_EQ(*brick, *bricks[1]);
+    }
 }
\ No newline at end of file
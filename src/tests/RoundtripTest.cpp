@@ -1,6 +1,9 @@
 #include "gtest/gtest.h"
 
+#include "commands/CommandInputChannel.h"
+#include "commands/IOCommands.h"
 #include "common/IONodeProxy.h"
+#include "common/ProxyUtils.h"
 #include "common/TrinityError.h"
 #include "frontend-base/ProcessingNodeProxy.h"
 #include "io-base/IONode.h"
@@ -9,13 +12,19 @@
 #include "processing-base/ProcessingNode.h"
 #include "processing-base/RenderSession.h"
 
+#include "tests/IOMock.h"
+
 #include "mocca/base/ContainerTools.h"
 #include "mocca/net/ConnectionAggregator.h"
 #include "mocca/net/ConnectionFactorySelector.h"
 #include "mocca/net/Endpoint.h"
 
+#include <atomic>
+#include <future>
+
 using namespace mocca::net;
 using namespace trinity;
+using namespace ::testing;
 
 class NodeTest : public ::testing::Test {
 protected:
@@ -48,6 +57,34 @@ std::unique_ptr<IONode> createIONode(const std::string& port) {
     return mocca::make_unique<IONode>(std::move(aggregator), std::move(listData));
 }
 
+// the control connection of a session that answers the requests of a CommandInputChannel in the order the test
+// chooses, the requests themselves are never read
+class ScriptedSession {
+public:
+    explicit ScriptedSession(const std::string& port)
+        : m_acceptor(ConnectionFactorySelector::bind(Endpoint(ConnectionFactorySelector::loopback(), "localhost", port))) {}
+
+    void accept() {
+        while (!m_connection) {
+            m_connection = m_acceptor->accept();
+        }
+    }
+
+    // the reply carries its request id as the LoD count
+    void reply(int rid) const {
+        GetLODLevelCountReply reply(GetLODLevelCountCmd::ReplyParams(rid), rid, 0);
+        m_connection->send(Reply::createMessage(reply, CompressionMode::Uncompressed));
+    }
+
+private:
+    std::unique_ptr<IMessageConnectionAcceptor> m_acceptor;
+    std::unique_ptr<IMessageConnection> m_connection;
+};
+
+uint64_t replyLODCount(const std::unique_ptr<Reply>& reply) {
+    return static_cast<const GetLODLevelCountReply&>(*reply).getParams().getLODLevelCount();
+}
+
 TEST_F(NodeTest, StartProcessingNodeTest) {
     auto node = createProcessingNode("5678");
     ASSERT_NO_THROW(node->start());
@@ -172,4 +209,104 @@ TEST_F(NodeTest, CallLodFromDummyRendererTest) {
 
     processingNode->join();
     ioNode->join();
+}
+
+TEST_F(NodeTest, IOSessionAnswersDuringBrickRequestTest) {
+    IOSession session(ConnectionFactorySelector::loopback(), CompressionMode::Uncompressed, mocca::make_unique<IOMock>());
+    const auto& io = static_cast<const IOMock&>(session.getIO());
+    // the brick request is blocked until the second request has been answered
+    std::promise<void> answered;
+    auto answeredFuture = answered.get_future().share();
+    std::atomic<bool> brickDone(false);
+    EXPECT_CALL(io, getBrick(_, _))
+        .WillOnce(DoAll(InvokeWithoutArgs([answeredFuture, &brickDone] {
+                            answeredFuture.wait_for(std::chrono::seconds(5));
+                            brickDone = true;
+                        }),
+                        SetArgReferee<1>(true), Return(std::make_shared<std::vector<uint8_t>>(8, 42))));
+    EXPECT_CALL(io, getLODLevelCount(0)).WillOnce(Return(3));
+    session.start();
+
+    CommandInputChannel channel(Endpoint(ConnectionFactorySelector::loopback(), "localhost", session.getControlPort()),
+                                CompressionMode::Uncompressed);
+    ASSERT_TRUE(channel.connect());
+    GetBrickRequest brickRequest(GetBrickCmd::RequestParams(BrickKey(0, 0, 0, 0)), 1, session.getSid());
+    GetLODLevelCountRequest countRequest(GetLODLevelCountCmd::RequestParams(0), 2, session.getSid());
+    channel.sendRequest(brickRequest);
+    channel.sendRequest(countRequest);
+
+    const auto countReply = receiveReplyChecked(channel, countRequest);
+    const bool answeredFirst = !brickDone;
+    answered.set_value();
+    ASSERT_EQ(3, countReply->getParams().getLODLevelCount());
+    ASSERT_TRUE(answeredFirst);
+    ASSERT_TRUE(receiveReplyChecked(channel, brickRequest)->getParams().getSuccess());
+}
+
+TEST_F(NodeTest, ThreadsShareInputChannelTest) {
+    IOSession session(ConnectionFactorySelector::loopback(), CompressionMode::Uncompressed, mocca::make_unique<IOMock>());
+    const auto& io = static_cast<const IOMock&>(session.getIO());
+    // the brick reply is held back until the other thread has its reply
+    std::promise<void> answered;
+    auto answeredFuture = answered.get_future().share();
+    EXPECT_CALL(io, getBrick(_, _))
+        .WillOnce(DoAll(InvokeWithoutArgs([answeredFuture] { answeredFuture.wait_for(std::chrono::seconds(5)); }),
+                        SetArgReferee<1>(true), Return(std::make_shared<std::vector<uint8_t>>(8, 42))));
+    EXPECT_CALL(io, getLODLevelCount(0)).WillOnce(Return(3));
+    session.start();
+
+    CommandInputChannel channel(Endpoint(ConnectionFactorySelector::loopback(), "localhost", session.getControlPort()),
+                                CompressionMode::Uncompressed);
+    ASSERT_TRUE(channel.connect());
+    GetBrickRequest brickRequest(GetBrickCmd::RequestParams(BrickKey(0, 0, 0, 0)), 1, session.getSid());
+    GetLODLevelCountRequest countRequest(GetLODLevelCountCmd::RequestParams(0), 2, session.getSid());
+    channel.sendRequest(brickRequest);
+    auto brickReply =
+        std::async(std::launch::async, [&channel, &brickRequest] { return receiveReplyChecked(channel, brickRequest); });
+
+    const auto countReply = sendRequestChecked(channel, countRequest);
+    answered.set_value();
+    ASSERT_EQ(3, countReply->getParams().getLODLevelCount());
+    ASSERT_TRUE(brickReply.get()->getParams().getSuccess());
+}
+TEST_F(NodeTest, InputChannelKeepsRepliesArrivingOutOfOrder) {
+    ScriptedSession session("7678");
+    CommandInputChannel channel(Endpoint(ConnectionFactorySelector::loopback(), "localhost", "7678"), CompressionMode::Uncompressed);
+    auto accepted = std::async(std::launch::async, [&session] { session.accept(); });
+    ASSERT_TRUE(channel.connect());
+    accepted.get();
+
+    session.reply(3);
+    session.reply(2);
+    session.reply(1);
+    ASSERT_EQ(1, replyLODCount(channel.getReply(1)));
+    ASSERT_EQ(2u, channel.getPendingReplyCount());
+    ASSERT_EQ(2, replyLODCount(channel.getReply(2)));
+    ASSERT_EQ(3, replyLODCount(channel.getReply(3)));
+    ASSERT_EQ(0u, channel.getPendingReplyCount());
+}
+
+TEST_F(NodeTest, InputChannelDropsStaleReplies) {
+    ScriptedSession session("7679");
+    CommandInputChannel channel(Endpoint(ConnectionFactorySelector::loopback(), "localhost", "7679"), CompressionMode::Uncompressed);
+    auto accepted = std::async(std::launch::async, [&session] { session.accept(); });
+    ASSERT_TRUE(channel.connect());
+    accepted.get();
+
+    // the reply to the first request arrives after its caller gave up
+    ASSERT_THROW(channel.getReply(1), TrinityError);
+    session.reply(1);
+    session.reply(2);
+    ASSERT_EQ(2, replyLODCount(channel.getReply(2)));
+    ASSERT_EQ(0u, channel.getPendingReplyCount());
+
+    // replies nobody asks for are bounded
+    const int count = int(CommandInputChannel::maxPendingReplies) + 10;
+    for (int rid = 3; rid < 3 + count; ++rid) {
+        session.reply(rid);
+    }
+    session.reply(3 + count);
+    ASSERT_EQ(3 + count, replyLODCount(channel.getReply(3 + count)));
+    ASSERT_EQ(CommandInputChannel::maxPendingReplies, channel.getPendingReplyCount());
+    ASSERT_EQ(3 + count - 1, replyLODCount(channel.getReply(3 + count - 1)));
 }
\ No newline at end of file
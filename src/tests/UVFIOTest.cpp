@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "io-base/UVFListData.h"
+#include "io-base/uvf/UVFIO.h"
+#include "io-base/uvf/Dataset/UVF-File/Histogram1DDataBlock.h"
+#include "io-base/uvf/Dataset/UVF-File/Histogram2DDataBlock.h"
+#include "io-base/uvf/Dataset/UVF-File/MaxMinDataBlock.h"
+#include "io-base/uvf/Dataset/UVF-File/TOCBlock.h"
+#include "io-base/uvf/Dataset/UVF-File/UVF.h"
+#include "silverbullet/base/StringTools.h"
+
+using namespace trinity;
+
+class UVFIOTest : public ::testing::Test {
+protected:
+    UVFIOTest() : m_listData(".") {}
+    virtual ~UVFIOTest() {
+        for (const auto& filename : m_files) {
+            std::remove(filename.c_str());
+        }
+    }
+
+    // writes a bricked UVF file of the given volume, scalar files get MaxMin data and histograms like the converter
+    // writes them, color files get neither
+    template <typename T>
+    std::string createUVF(const std::string& name, const std::vector<T>& volume, const Core::Math::Vec3ui64& size,
+                          ExtendedOctree::COMPONENT_TYPE type, uint64_t componentCount = 1) {
+        const std::string filename = "./UVFIOTest" + name + ".uvf";
+        const std::string rawFilename = "./UVFIOTest" + name + ".raw";
+        const std::string tempFilename = "./UVFIOTest" + name + ".tmp";
+        m_files.push_back(filename);
+        m_files.push_back(rawFilename);
+        m_files.push_back(tempFilename);
+        m_files.push_back("./UVFIOTest" + name + ".hist");
+        {
+            std::ofstream raw(rawFilename, std::ios::binary);
+            raw.write(reinterpret_cast<const char*>(volume.data()), volume.size() * sizeof(T));
+        }
+
+        UVF uvfFile(Core::StringTools::ToWString(filename));
+        GlobalHeader header;
+        header.bIsBigEndian = false;
+        header.ulChecksumSemanticsEntry = UVFTables::CS_NONE;
+        uvfFile.SetGlobalHeader(header);
+
+        std::shared_ptr<TOCBlock> toc = std::make_shared<TOCBlock>(UVF::ms_ulReaderVersion);
+        std::shared_ptr<MaxMinDataBlock> maxMin = std::make_shared<MaxMinDataBlock>(componentCount);
+        // zlib bricks cannot be decompressed by the octree
+        EXPECT_TRUE(toc->FlatDataToBrickedLOD(rawFilename, tempFilename, type, componentCount, size,
+                                              Core::Math::Vec3d(1, 1, 1), Core::Math::Vec3ui64(16, 16, 16), 2, false,
+                                              false, 1 << 20, maxMin, CT_LZ4));
+        uvfFile.AddDataBlock(toc);
+        if (componentCount == 1) {
+            std::shared_ptr<Histogram1DDataBlock> histogram1D = std::make_shared<Histogram1DDataBlock>();
+            EXPECT_TRUE(histogram1D->Compute(toc.get(), 0));
+            std::shared_ptr<Histogram2DDataBlock> histogram2D = std::make_shared<Histogram2DDataBlock>();
+            EXPECT_TRUE(histogram2D->Compute(toc.get(), 0, histogram1D->GetHistogram().size(),
+                                             maxMin->GetGlobalValue().maxScalar));
+            uvfFile.AddDataBlock(histogram1D);
+            uvfFile.AddDataBlock(histogram2D);
+            uvfFile.AddDataBlock(maxMin);
+        }
+        EXPECT_TRUE(uvfFile.Create());
+        uvfFile.Close();
+        return "UVFData@" + filename;
+    }
+
+    // the first component of the result is the scalar volume
+    template <typename T> static std::vector<T> colorVolume(const std::vector<T>& scalars) {
+        std::vector<T> volume(scalars.size() * 4);
+        for (size_t i = 0; i < scalars.size(); ++i) {
+            volume[i * 4] = scalars[i];
+            volume[i * 4 + 1] = T(i % 7);
+            volume[i * 4 + 2] = T(i % 13);
+            volume[i * 4 + 3] = T(100);
+        }
+        return volume;
+    }
+
+    static std::vector<uint8_t> smoothVolume(const Core::Math::Vec3ui64& size) {
+        std::vector<uint8_t> volume(size.volume());
+        size_t i = 0;
+        for (uint64_t z = 0; z < size.z; ++z) {
+            for (uint64_t y = 0; y < size.y; ++y) {
+                for (uint64_t x = 0; x < size.x; ++x) {
+                    volume[i++] = uint8_t(10 + (x * 3 + y * y / 4 + z * 2) % 200);
+                }
+            }
+        }
+        return volume;
+    }
+
+    UVFListData m_listData;
+    std::vector<std::string> m_files;
+};
+
+// color data has neither histograms nor MaxMin data, so the histograms of its first component are computed from the
+// voxels and have to match the ones stored for the same scalar volume
+TEST_F(UVFIOTest, ComputedHistogramsMatchStoredOnes) {
+    const Core::Math::Vec3ui64 size(40, 36, 30);
+    const auto volume = smoothVolume(size);
+    UVFIO stored(createUVF("Stored", volume, size, ExtendedOctree::CT_UINT8), m_listData);
+    UVFIO computed(createUVF("Computed", colorVolume(volume), size, ExtendedOctree::CT_UINT8, 4), m_listData);
+
+    const auto stored1D = stored.get1DHistogram();
+    ASSERT_EQ(size_t(210), stored1D.size());
+    ASSERT_EQ(size.volume(), std::accumulate(stored1D.begin(), stored1D.end(), uint64_t(0)));
+    ASSERT_EQ(stored1D, computed.get1DHistogram());
+    ASSERT_EQ(stored.get2DHistogram(), computed.get2DHistogram());
+}
+
+TEST_F(UVFIOTest, SpreadsSignedValuesWithoutMaxMinData) {
+    const Core::Math::Vec3ui64 size(20, 20, 20);
+    std::vector<int16_t> volume(size.volume());
+    for (size_t i = 0; i < volume.size(); ++i) {
+        volume[i] = int16_t(int(i % 1000) - 500);
+    }
+    UVFIO io(createUVF("Signed", colorVolume(volume), size, ExtendedOctree::CT_INT16, 4), m_listData);
+
+    const auto histogram1D = io.get1DHistogram();
+    ASSERT_EQ(size_t(MAX_TRANSFERFUNCTION_SIZE), histogram1D.size());
+    ASSERT_EQ(size.volume(), std::accumulate(histogram1D.begin(), histogram1D.end(), uint64_t(0)));
+    // -500 and 499 are the ends of the range
+    ASSERT_EQ(8u, histogram1D.front());
+    ASSERT_EQ(8u, histogram1D.back());
+}
+
+TEST_F(UVFIOTest, RebinsLargeStoredHistograms) {
+    const Core::Math::Vec3ui64 size(24, 24, 24);
+    std::vector<uint16_t> volume(size.volume());
+    for (size_t i = 0; i < volume.size(); ++i) {
+        volume[i] = uint16_t(i * 7 % 10000);
+    }
+    UVFIO io(createUVF("Rebin", volume, size, ExtendedOctree::CT_UINT16), m_listData);
+
+    // the stored histogram has a bin per value up to the maximum, each lands in the bin covering its start
+    const size_t storedBins = *std::max_element(volume.begin(), volume.end()) + 1;
+    std::vector<uint64_t> expected(MAX_TRANSFERFUNCTION_SIZE);
+    for (uint16_t value : volume) {
+        ++expected[value * expected.size() / storedBins];
+    }
+    ASSERT_EQ(expected, io.get1DHistogram());
+    const auto histogram2D = io.get2DHistogram();
+    ASSERT_EQ(expected.size() * 256, histogram2D.size());
+    ASSERT_EQ(size.volume(), std::accumulate(histogram2D.begin(), histogram2D.end(), uint64_t(0)));
+}